@@ -0,0 +1,56 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__BatchConsole__
+#define __TrenchBroom__BatchConsole__
+
+#include "Utility/Console.h"
+
+namespace TrenchBroom {
+    namespace Batch {
+        /*
+         Collects the messages that the parsers log while a map is processed so that they can be reported with the
+         map's results.
+         */
+        class BatchConsole : public Utility::Console {
+        public:
+            inline size_t messageCount() const {
+                return m_buffer.size();
+            }
+
+            inline bool isWarning(size_t index) const {
+                return m_buffer[index].level() == LLWarn;
+            }
+
+            inline bool isError(size_t index) const {
+                return m_buffer[index].level() == LLError;
+            }
+
+            inline const String& message(size_t index) const {
+                return m_buffer[index].string();
+            }
+
+            inline void clear() {
+                m_buffer.clear();
+            }
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__BatchConsole__) */
@@ -0,0 +1,41 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Utility/Console.h"
+
+/*
+ The batch tool has no log window and no log file. Every message stays in the console's buffer, where the map
+ processor picks it up for the report. These replace the functions in ConsoleWx.cpp.
+ */
+namespace TrenchBroom {
+    namespace Utility {
+        void Console::logToDebug(const LogMessage& message) {
+        }
+
+        void Console::logToConsole(const LogMessage& message) {
+        }
+
+        void Console::logToFile(const LogMessage& message) {
+        }
+
+        void Console::setTextCtrl(wxTextCtrl* textCtrl) {
+            m_textCtrl = NULL;
+        }
+    }
+}
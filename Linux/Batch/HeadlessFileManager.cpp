@@ -0,0 +1,99 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "IO/AbstractFileManager.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/*
+ The file system access of the file manager for the batch tool, which doesn't link wxWidgets. These replace the
+ functions in AbstractFileManagerWx.cpp.
+ */
+namespace TrenchBroom {
+    namespace IO {
+        bool AbstractFileManager::isAbsolutePath(const String& path) {
+            return !path.empty() && path[0] == '/';
+        }
+
+        bool AbstractFileManager::isDirectory(const String& path) {
+            struct stat info;
+            if (stat(path.c_str(), &info) != 0)
+                return false;
+            return S_ISDIR(info.st_mode);
+        }
+
+        bool AbstractFileManager::exists(const String& path) {
+            struct stat info;
+            return stat(path.c_str(), &info) == 0;
+        }
+
+        bool AbstractFileManager::makeDirectory(const String& path) {
+            return mkdir(path.c_str(), 0777) == 0 || errno == EEXIST;
+        }
+
+        bool AbstractFileManager::deleteFile(const String& path) {
+            return unlink(path.c_str()) == 0;
+        }
+
+        bool AbstractFileManager::moveFile(const String& sourcePath, const String& destPath, bool overwrite) {
+            if (!overwrite && exists(destPath))
+                return false;
+            return std::rename(sourcePath.c_str(), destPath.c_str()) == 0;
+        }
+
+        char AbstractFileManager::pathSeparator() {
+            return '/';
+        }
+
+        StringList AbstractFileManager::directoryContents(const String& path, String extension, bool directories, bool files) {
+            StringList result;
+            if (!directories && !files)
+                return result;
+
+            DIR* directory = opendir(path.c_str());
+            if (directory == NULL)
+                return result;
+
+            const String lowerExtension = Utility::toLower(extension);
+            struct dirent* entry = NULL;
+            while ((entry = readdir(directory)) != NULL) {
+                const String filename = entry->d_name;
+                if (filename == "." || filename == "..")
+                    continue;
+
+                const bool isDir = isDirectory(appendPath(path, filename));
+                if ((isDir && !directories) || (!isDir && !files))
+                    continue;
+
+                if (extension.empty() || Utility::toLower(pathExtension(filename)) == lowerExtension)
+                    result.push_back(filename);
+            }
+            closedir(directory);
+
+            std::sort(result.begin(), result.end());
+            return result;
+        }
+    }
+}
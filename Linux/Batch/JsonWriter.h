@@ -0,0 +1,172 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__JsonWriter__
+#define __TrenchBroom__JsonWriter__
+
+#include "Utility/String.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Batch {
+        /*
+         Writes compact JSON to a string. The writer only inserts the separators; it's up to the caller to open and
+         close objects and arrays in the right order and to precede every value in an object with a key.
+         */
+        class JsonWriter {
+        private:
+            StringStream m_stream;
+            std::vector<bool> m_first;
+            bool m_afterKey;
+
+            inline void separate() {
+                if (m_afterKey) {
+                    m_afterKey = false;
+                    return;
+                }
+                if (m_first.empty())
+                    return;
+                if (!m_first.back())
+                    m_stream << ',';
+                m_first.back() = false;
+            }
+
+            inline void open(char c) {
+                separate();
+                m_stream << c;
+                m_first.push_back(true);
+            }
+
+            inline void close(char c) {
+                m_stream << c;
+                m_first.pop_back();
+            }
+
+            inline void writeString(const String& str) {
+                m_stream << '"';
+                for (size_t i = 0; i < str.size(); i++) {
+                    const char c = str[i];
+                    switch (c) {
+                        case '"':
+                            m_stream << "\\\"";
+                            break;
+                        case '\\':
+                            m_stream << "\\\\";
+                            break;
+                        case '\n':
+                            m_stream << "\\n";
+                            break;
+                        case '\r':
+                            m_stream << "\\r";
+                            break;
+                        case '\t':
+                            m_stream << "\\t";
+                            break;
+                        default:
+                            if (static_cast<unsigned char>(c) < 0x20) {
+                                char buffer[8];
+                                std::sprintf(buffer, "\\u%04x", static_cast<unsigned int>(c));
+                                m_stream << buffer;
+                            } else {
+                                m_stream << c;
+                            }
+                            break;
+                    }
+                }
+                m_stream << '"';
+            }
+        public:
+            JsonWriter() :
+            m_afterKey(false) {}
+
+            inline void beginObject() {
+                open('{');
+            }
+
+            inline void endObject() {
+                close('}');
+            }
+
+            inline void beginArray() {
+                open('[');
+            }
+
+            inline void endArray() {
+                close(']');
+            }
+
+            inline void key(const String& name) {
+                separate();
+                writeString(name);
+                m_stream << ':';
+                m_afterKey = true;
+            }
+
+            inline void value(const String& str) {
+                separate();
+                writeString(str);
+            }
+
+            inline void value(const char* str) {
+                value(String(str));
+            }
+
+            inline void value(bool b) {
+                separate();
+                m_stream << (b ? "true" : "false");
+            }
+
+            inline void value(int i) {
+                separate();
+                m_stream << i;
+            }
+
+            inline void value(size_t i) {
+                separate();
+                m_stream << i;
+            }
+
+            inline void value(long long i) {
+                separate();
+                m_stream << i;
+            }
+
+            inline void value(double d) {
+                separate();
+                m_stream << d;
+            }
+
+            /*
+             Inserts text that is already valid JSON, such as the result of another writer.
+             */
+            inline void raw(const String& json) {
+                separate();
+                m_stream << json;
+            }
+
+            inline String str() const {
+                return m_stream.str();
+            }
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__JsonWriter__) */
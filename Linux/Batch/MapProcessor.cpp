@@ -0,0 +1,399 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MapProcessor.h"
+
+#include "Batch/BatchConsole.h"
+#include "Batch/JsonWriter.h"
+#include "IO/FileManager.h"
+#include "IO/MapParser.h"
+#include "IO/MapWriter.h"
+#include "Model/Brush.h"
+#include "Model/Entity.h"
+#include "Model/EntityDefinition.h"
+#include "Model/EntityDefinitionManager.h"
+#include "Model/Face.h"
+#include "Model/Map.h"
+#include "Model/TextureManager.h"
+#include "Utility/MemoryStats.h"
+#include "Utility/Profiler.h"
+
+#include <map>
+#include <sys/resource.h>
+
+namespace TrenchBroom {
+    namespace Batch {
+        static inline double elapsedMillis(Utility::Profiler::Time start) {
+            return static_cast<double>(Utility::Profiler::profiler().time() - start) / 1000.0;
+        }
+
+        static inline bool contains(const BBoxf& outer, const BBoxf& inner) {
+            for (unsigned int i = 0; i < 3; i++)
+                if (inner.min[i] < outer.min[i] || inner.max[i] > outer.max[i])
+                    return false;
+            return true;
+        }
+
+        static inline void writeBounds(const BBoxf& bounds, JsonWriter& json) {
+            json.beginArray();
+            for (unsigned int i = 0; i < 3; i++)
+                json.value(static_cast<double>(bounds.min[i]));
+            for (unsigned int i = 0; i < 3; i++)
+                json.value(static_cast<double>(bounds.max[i]));
+            json.endArray();
+        }
+
+        static inline void writeIssue(const char* type, const Model::MapObject& object, const String& message, JsonWriter& json) {
+            json.beginObject();
+            json.key("type");
+            json.value(type);
+            json.key("line");
+            json.value(object.fileLine());
+            json.key("message");
+            json.value(message);
+            json.endObject();
+        }
+
+        void MapProcessor::writeStats(const Model::Map& map, JsonWriter& json) {
+            size_t pointEntities = 0;
+            size_t brushEntities = 0;
+            size_t brushes = 0;
+            size_t faces = 0;
+            size_t vertices = 0;
+            BBoxf bounds;
+            bool hasBounds = false;
+
+            const Model::EntityList& entities = map.entities();
+            Model::EntityList::const_iterator entityIt, entityEnd;
+            for (entityIt = entities.begin(), entityEnd = entities.end(); entityIt != entityEnd; ++entityIt) {
+                const Model::Entity& entity = **entityIt;
+                const Model::BrushList& entityBrushes = entity.brushes();
+                if (entityBrushes.empty()) {
+                    if (!entity.worldspawn())
+                        pointEntities++;
+                } else if (!entity.worldspawn()) {
+                    brushEntities++;
+                }
+
+                Model::BrushList::const_iterator brushIt, brushEnd;
+                for (brushIt = entityBrushes.begin(), brushEnd = entityBrushes.end(); brushIt != brushEnd; ++brushIt) {
+                    const Model::Brush& brush = **brushIt;
+                    faces += brush.faces().size();
+                    vertices += brush.vertices().size();
+                    if (hasBounds) {
+                        bounds.mergeWith(brush.bounds());
+                    } else {
+                        bounds = brush.bounds();
+                        hasBounds = true;
+                    }
+                }
+                brushes += entityBrushes.size();
+            }
+
+            json.key("stats");
+            json.beginObject();
+            json.key("entities");
+            json.value(entities.size());
+            json.key("pointEntities");
+            json.value(pointEntities);
+            json.key("brushEntities");
+            json.value(brushEntities);
+            json.key("brushes");
+            json.value(brushes);
+            json.key("faces");
+            json.value(faces);
+            json.key("vertices");
+            json.value(vertices);
+            if (hasBounds) {
+                json.key("bounds");
+                writeBounds(bounds, json);
+            }
+            json.endObject();
+        }
+
+        void MapProcessor::writeValidation(const Model::Map& map, BatchConsole& console, JsonWriter& json) {
+            size_t worldspawnCount = 0;
+
+            json.key("issues");
+            json.beginArray();
+
+            // the parser has already reported invalid and non-closed brushes
+            for (size_t i = 0; i < console.messageCount(); i++) {
+                if (console.isWarning(i) || console.isError(i)) {
+                    json.beginObject();
+                    json.key("type");
+                    json.value(console.isError(i) ? "parseError" : "parseWarning");
+                    json.key("message");
+                    json.value(console.message(i));
+                    json.endObject();
+                }
+            }
+
+            const Model::EntityList& entities = map.entities();
+            Model::EntityList::const_iterator entityIt, entityEnd;
+            for (entityIt = entities.begin(), entityEnd = entities.end(); entityIt != entityEnd; ++entityIt) {
+                const Model::Entity& entity = **entityIt;
+                const Model::PropertyValue* classname = entity.classname();
+                if (classname == NULL) {
+                    writeIssue("missingClassname", entity, "Entity has no classname", json);
+                } else if (entity.worldspawn()) {
+                    worldspawnCount++;
+                } else if (m_definitionManager != NULL) {
+                    Model::EntityDefinition* definition = m_definitionManager->definition(*classname);
+                    if (definition == NULL) {
+                        writeIssue("unknownClassname", entity, "Unknown entity class " + *classname, json);
+                    } else if (definition->type() == Model::EntityDefinition::PointEntity && !entity.brushes().empty()) {
+                        writeIssue("definitionMismatch", entity, "Point entity " + *classname + " has brushes", json);
+                    } else if (definition->type() == Model::EntityDefinition::BrushEntity && entity.brushes().empty()) {
+                        writeIssue("definitionMismatch", entity, "Brush entity " + *classname + " has no brushes", json);
+                    }
+                }
+
+                const Model::PropertyValue* target = entity.propertyForKey(Model::Entity::TargetKey);
+                if (target != NULL && !target->empty() && map.entitiesWithTargetname(*target).empty())
+                    writeIssue("missingTarget", entity, "No entity with targetname " + *target, json);
+                const Model::PropertyValue* killTarget = entity.propertyForKey(Model::Entity::KillTargetKey);
+                if (killTarget != NULL && !killTarget->empty() && map.entitiesWithTargetname(*killTarget).empty())
+                    writeIssue("missingTarget", entity, "No entity with targetname " + *killTarget, json);
+
+                const Model::BrushList& brushes = entity.brushes();
+                Model::BrushList::const_iterator brushIt, brushEnd;
+                for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt) {
+                    const Model::Brush& brush = **brushIt;
+                    if (brush.faces().size() < 4)
+                        writeIssue("degenerateBrush", brush, "Brush has fewer than four faces", json);
+                    if (!contains(m_worldBounds, brush.bounds()))
+                        writeIssue("outOfBounds", brush, "Brush exceeds the world bounds", json);
+                }
+            }
+
+            if (worldspawnCount != 1) {
+                json.beginObject();
+                json.key("type");
+                json.value("worldspawn");
+                json.key("message");
+                json.value(worldspawnCount == 0 ? String("Map has no worldspawn entity") : String("Map has more than one worldspawn entity"));
+                json.endObject();
+            }
+
+            json.endArray();
+        }
+
+        void MapProcessor::writeTextureUsage(Model::Map& map, const String& mapPath, BatchConsole& console, JsonWriter& json) {
+            typedef std::map<String, size_t> UsageMap;
+            UsageMap usage;
+
+            const Model::EntityList& entities = map.entities();
+            Model::EntityList::const_iterator entityIt, entityEnd;
+            for (entityIt = entities.begin(), entityEnd = entities.end(); entityIt != entityEnd; ++entityIt) {
+                const Model::BrushList& brushes = (*entityIt)->brushes();
+                Model::BrushList::const_iterator brushIt, brushEnd;
+                for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt) {
+                    const Model::FaceList& faces = (*brushIt)->faces();
+                    Model::FaceList::const_iterator faceIt, faceEnd;
+                    for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt)
+                        usage[(*faceIt)->textureName()]++;
+                }
+            }
+
+            // wads given on the command line take precedence over the ones listed in the worldspawn entity
+            IO::FileManager fileManager;
+            StringList wadPaths = m_options.wadPaths;
+            if (wadPaths.empty()) {
+                Model::Entity* worldspawn = map.worldspawn();
+                const String* wads = worldspawn != NULL ? worldspawn->propertyForKey(Model::Entity::WadKey) : NULL;
+                if (wads != NULL) {
+                    StringList rootPaths;
+                    rootPaths.push_back(mapPath);
+
+                    const StringList wadNames = Utility::split(*wads, ';');
+                    for (size_t i = 0; i < wadNames.size(); i++) {
+                        const String wadName = Utility::trim(wadNames[i]);
+                        if (wadName.empty())
+                            continue;
+
+                        String wadPath = wadName;
+                        if (fileManager.isAbsolutePath(wadPath) || fileManager.resolveRelativePath(wadName, rootPaths, wadPath))
+                            wadPaths.push_back(wadPath);
+                        else
+                            console.error("Could not open texture wad %s", wadName.c_str());
+                    }
+                }
+            }
+
+            Model::TextureManager textureManager;
+            for (size_t i = 0; i < wadPaths.size(); i++) {
+                try {
+                    Model::TextureCollection* collection = new Model::TextureCollection(wadPaths[i], wadPaths[i]);
+                    textureManager.addCollection(collection, textureManager.collections().size());
+                } catch (IO::IOException& e) {
+                    console.error("Could not open texture wad %s: %s", wadPaths[i].c_str(), e.what());
+                }
+            }
+            const bool checkMissing = !textureManager.collections().empty();
+
+            json.key("textures");
+            json.beginObject();
+            json.key("wads");
+            json.beginArray();
+            for (size_t i = 0; i < textureManager.collections().size(); i++)
+                json.value(textureManager.collections()[i]->path());
+            json.endArray();
+
+            json.key("usage");
+            json.beginObject();
+            UsageMap::const_iterator it, end;
+            for (it = usage.begin(), end = usage.end(); it != end; ++it) {
+                json.key(it->first);
+                json.value(it->second);
+            }
+            json.endObject();
+
+            if (checkMissing) {
+                json.key("missing");
+                json.beginArray();
+                for (it = usage.begin(), end = usage.end(); it != end; ++it)
+                    if (textureManager.texture(it->first) == NULL)
+                        json.value(it->first);
+                json.endArray();
+            }
+            json.endObject();
+        }
+
+        void MapProcessor::writeMessages(BatchConsole& console, JsonWriter& json) {
+            json.key("messages");
+            json.beginArray();
+            for (size_t i = 0; i < console.messageCount(); i++)
+                json.value(console.message(i));
+            json.endArray();
+        }
+
+        MapProcessor::MapProcessor(const BatchOptions& options, Model::EntityDefinitionManager* definitionManager) :
+        m_options(options),
+        m_definitionManager(definitionManager),
+        m_worldBounds(Vec3f(-16384.0f, -16384.0f, -16384.0f), Vec3f(16384.0f, 16384.0f, 16384.0f)) {}
+
+        String MapProcessor::process(const String& path) {
+            Utility::Profiler& profiler = Utility::Profiler::profiler();
+            const Utility::Profiler::Time start = profiler.time();
+            Utility::MemoryStats::stats().resetPeaks();
+
+            BatchConsole console;
+            JsonWriter json;
+            json.beginObject();
+            json.key("path");
+            json.value(path);
+
+            IO::FileManager fileManager;
+            IO::MappedFile::Ptr file = fileManager.mapFile(path);
+            if (file.get() == NULL) {
+                json.key("error");
+                json.value("Unable to open map file");
+                json.endObject();
+                return json.str();
+            }
+
+            json.key("timings");
+            json.beginObject();
+
+            Utility::Profiler::Time stageStart = profiler.time();
+            Model::Map map(m_worldBounds, false);
+            IO::MapParser parser(file->begin(), file->end(), console);
+            parser.parseMap(map, NULL);
+            json.key("parse");
+            json.value(elapsedMillis(stageStart));
+
+            // the validation must see the parser's messages before the texture usage adds its own
+            JsonWriter results;
+            results.beginObject();
+            if (m_options.stats) {
+                stageStart = profiler.time();
+                writeStats(map, results);
+                json.key("stats");
+                json.value(elapsedMillis(stageStart));
+            }
+
+            if (m_options.validate) {
+                stageStart = profiler.time();
+                writeValidation(map, console, results);
+                json.key("validate");
+                json.value(elapsedMillis(stageStart));
+            }
+
+            if (m_options.textures) {
+                stageStart = profiler.time();
+                writeTextureUsage(map, fileManager.deleteLastPathComponent(path), console, results);
+                json.key("textures");
+                json.value(elapsedMillis(stageStart));
+            }
+
+            if (m_options.resave) {
+                stageStart = profiler.time();
+                String outputPath = path;
+                if (!m_options.outputDirectory.empty())
+                    outputPath = fileManager.appendPath(m_options.outputDirectory, fileManager.pathComponents(path).back());
+
+                // release the mapping before the file is overwritten
+                file.reset();
+                try {
+                    IO::MapWriter mapWriter;
+                    mapWriter.writeToFileAtPath(map, outputPath, true);
+                    results.key("savedTo");
+                    results.value(outputPath);
+                } catch (IO::IOException& e) {
+                    console.error("Could not save map to %s: %s", outputPath.c_str(), e.what());
+                }
+                json.key("resave");
+                json.value(elapsedMillis(stageStart));
+            }
+            results.endObject();
+
+            json.key("total");
+            json.value(elapsedMillis(start));
+            json.endObject();
+
+            // strip the braces of the results object so that its members become members of the map's object
+            const String resultMembers = results.str();
+            if (resultMembers.size() > 2)
+                json.raw(resultMembers.substr(1, resultMembers.size() - 2));
+
+            writeMessages(console, json);
+
+            // the high-water marks of the model's memory categories while this map was processed
+            Utility::MemoryStats& memoryStats = Utility::MemoryStats::stats();
+            json.key("peakMemoryByCategory");
+            json.beginObject();
+            for (size_t i = 0; i < Utility::MemoryCategory::Count; i++) {
+                const Utility::MemoryCategory::Type category = static_cast<Utility::MemoryCategory::Type>(i);
+                json.key(Utility::MemoryStats::name(category));
+                json.value(memoryStats.peakBytes(category));
+            }
+            json.endObject();
+
+            struct rusage usage;
+            if (getrusage(RUSAGE_SELF, &usage) == 0) {
+                json.key("peakMemoryKB");
+                json.value(static_cast<long long>(usage.ru_maxrss));
+            }
+
+            json.endObject();
+            return json.str();
+        }
+    }
+}
@@ -0,0 +1,77 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__MapProcessor__
+#define __TrenchBroom__MapProcessor__
+
+#include "Utility/String.h"
+#include "Utility/VecMath.h"
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class EntityDefinitionManager;
+        class Map;
+    }
+
+    namespace Batch {
+        class BatchConsole;
+        class JsonWriter;
+
+        class BatchOptions {
+        public:
+            bool stats;
+            bool validate;
+            bool textures;
+            bool resave;
+            String outputDirectory;
+            StringList wadPaths;
+            String definitionPath;
+
+            BatchOptions() :
+            stats(false),
+            validate(false),
+            textures(false),
+            resave(false) {}
+        };
+
+        /*
+         Runs the requested tasks on a single map and reports the results as a JSON object. The entity definitions are
+         loaded by the caller so that they can be shared by all maps.
+         */
+        class MapProcessor {
+        private:
+            const BatchOptions& m_options;
+            Model::EntityDefinitionManager* m_definitionManager;
+            BBoxf m_worldBounds;
+
+            void writeStats(const Model::Map& map, JsonWriter& json);
+            void writeValidation(const Model::Map& map, BatchConsole& console, JsonWriter& json);
+            void writeTextureUsage(Model::Map& map, const String& mapPath, BatchConsole& console, JsonWriter& json);
+            void writeMessages(BatchConsole& console, JsonWriter& json);
+        public:
+            MapProcessor(const BatchOptions& options, Model::EntityDefinitionManager* definitionManager);
+
+            String process(const String& path);
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__MapProcessor__) */
@@ -0,0 +1,165 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Batch/BatchConsole.h"
+#include "Batch/JsonWriter.h"
+#include "Batch/MapProcessor.h"
+#include "Batch/WorkerPool.h"
+#include "IO/FileManager.h"
+#include "Model/EntityDefinitionManager.h"
+#include "Utility/Profiler.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sys/resource.h>
+
+using namespace TrenchBroom;
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options] map..." << std::endl
+              << std::endl
+              << "  -j N               process up to N maps in parallel (default 1)" << std::endl
+              << "  --stats            report entity, brush, face and vertex counts" << std::endl
+              << "  --validate         report invalid geometry, unknown classes and broken targets" << std::endl
+              << "  --textures         report texture usage and textures missing from the wads" << std::endl
+              << "  --resave           parse and write every map again" << std::endl
+              << "  --output-dir DIR   write re-saved maps to DIR instead of overwriting them" << std::endl
+              << "  --wad PATH         check textures against PATH instead of the worldspawn wads" << std::endl
+              << "  --def PATH         check classnames against the entity definition file PATH" << std::endl
+              << "  --json PATH        write the report to PATH instead of stdout" << std::endl
+              << std::endl
+              << "Without any of --stats, --validate, --textures and --resave, --stats --validate is assumed." << std::endl;
+}
+
+static bool parseArguments(int argc, char** argv, Batch::BatchOptions& options, size_t& jobCount, String& jsonPath, StringList& mapPaths) {
+    for (int i = 1; i < argc; i++) {
+        const String argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (argument == "-j" && hasValue) {
+            const int count = std::atoi(argv[++i]);
+            if (count <= 0)
+                return false;
+            jobCount = static_cast<size_t>(count);
+        } else if (argument == "--stats") {
+            options.stats = true;
+        } else if (argument == "--validate") {
+            options.validate = true;
+        } else if (argument == "--textures") {
+            options.textures = true;
+        } else if (argument == "--resave") {
+            options.resave = true;
+        } else if (argument == "--output-dir" && hasValue) {
+            options.outputDirectory = argv[++i];
+        } else if (argument == "--wad" && hasValue) {
+            options.wadPaths.push_back(argv[++i]);
+        } else if (argument == "--def" && hasValue) {
+            options.definitionPath = argv[++i];
+        } else if (argument == "--json" && hasValue) {
+            jsonPath = argv[++i];
+        } else if (!argument.empty() && argument[0] == '-') {
+            return false;
+        } else {
+            mapPaths.push_back(argument);
+        }
+    }
+
+    if (!options.stats && !options.validate && !options.textures && !options.resave)
+        options.stats = options.validate = true;
+    return !mapPaths.empty();
+}
+
+int main(int argc, char** argv) {
+    Batch::BatchOptions options;
+    size_t jobCount = 1;
+    String jsonPath;
+    StringList mapPaths;
+
+    if (!parseArguments(argc, argv, options, jobCount, jsonPath, mapPaths)) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    IO::FileManager fileManager;
+    if (!options.outputDirectory.empty() && !fileManager.makeDirectory(options.outputDirectory)) {
+        std::cerr << "Could not create output directory " << options.outputDirectory << std::endl;
+        return 1;
+    }
+
+    // only the profiler's clock is used for the timings, the zones recorded by the model code are dropped
+    Utility::Profiler& profiler = Utility::Profiler::profiler();
+    profiler.setEnabled(false);
+    const Utility::Profiler::Time start = profiler.time();
+
+    // the definitions are loaded once and inherited by every worker
+    Batch::BatchConsole definitionConsole;
+    Model::EntityDefinitionManager definitionManager(definitionConsole);
+    Model::EntityDefinitionManager* definitions = NULL;
+    if (!options.definitionPath.empty()) {
+        definitionManager.load(options.definitionPath, Color(1.0f, 1.0f, 1.0f, 1.0f));
+        for (size_t i = 0; i < definitionConsole.messageCount(); i++)
+            std::cerr << definitionConsole.message(i) << std::endl;
+        if (definitionConsole.messageCount() > 0)
+            return 1;
+        definitions = &definitionManager;
+    }
+
+    Batch::MapProcessor processor(options, definitions);
+    Batch::WorkerPool pool(jobCount);
+    const StringList results = pool.run(processor, mapPaths);
+
+    Batch::JsonWriter json;
+    json.beginObject();
+    json.key("maps");
+    json.beginArray();
+    for (size_t i = 0; i < results.size(); i++)
+        json.raw(results[i]);
+    json.endArray();
+    json.key("jobs");
+    json.value(jobCount);
+    json.key("totalTime");
+    json.value(static_cast<double>(profiler.time() - start) / 1000.0);
+
+    // the peak of the batch process itself, or of the largest worker if they ran in separate processes
+    struct rusage selfUsage;
+    struct rusage childUsage;
+    long long peakMemory = 0;
+    if (getrusage(RUSAGE_SELF, &selfUsage) == 0)
+        peakMemory = selfUsage.ru_maxrss;
+    if (getrusage(RUSAGE_CHILDREN, &childUsage) == 0 && childUsage.ru_maxrss > peakMemory)
+        peakMemory = childUsage.ru_maxrss;
+    json.key("peakMemoryKB");
+    json.value(peakMemory);
+    json.endObject();
+
+    if (jsonPath.empty()) {
+        std::cout << json.str() << std::endl;
+    } else {
+        std::ofstream stream(jsonPath.c_str());
+        if (!stream.is_open()) {
+            std::cerr << "Could not write report to " << jsonPath << std::endl;
+            return 1;
+        }
+        stream << json.str() << std::endl;
+    }
+
+    return 0;
+}
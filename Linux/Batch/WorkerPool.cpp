@@ -0,0 +1,164 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "WorkerPool.h"
+
+#include "Batch/JsonWriter.h"
+#include "Batch/MapProcessor.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace TrenchBroom {
+    namespace Batch {
+        static String errorResult(const String& path, const String& message) {
+            JsonWriter json;
+            json.beginObject();
+            json.key("path");
+            json.value(path);
+            json.key("error");
+            json.value(message);
+            json.endObject();
+            return json.str();
+        }
+
+        static void writeAll(int fd, const String& str) {
+            const char* data = str.data();
+            size_t remaining = str.size();
+            while (remaining > 0) {
+                const ssize_t written = write(fd, data, remaining);
+                if (written < 0) {
+                    if (errno == EINTR)
+                        continue;
+                    return;
+                }
+                data += written;
+                remaining -= static_cast<size_t>(written);
+            }
+        }
+
+        bool WorkerPool::spawn(MapProcessor& processor, const String& path, size_t index, WorkerList& workers) {
+            int fds[2];
+            if (pipe(fds) != 0)
+                return false;
+
+            const pid_t pid = fork();
+            if (pid < 0) {
+                close(fds[0]);
+                close(fds[1]);
+                return false;
+            }
+
+            if (pid == 0) {
+                close(fds[0]);
+                for (size_t i = 0; i < workers.size(); i++)
+                    close(workers[i].fd);
+
+                writeAll(fds[1], processor.process(path));
+                close(fds[1]);
+                _exit(0);
+            }
+
+            close(fds[1]);
+            workers.push_back(Worker(pid, fds[0], index));
+            return true;
+        }
+
+        String WorkerPool::finish(Worker& worker, const String& path) {
+            close(worker.fd);
+
+            int status = 0;
+            while (waitpid(worker.pid, &status, 0) < 0 && errno == EINTR);
+
+            if (WIFSIGNALED(status)) {
+                StringStream message;
+                message << "Worker crashed with signal " << WTERMSIG(status) << " (" << strsignal(WTERMSIG(status)) << ")";
+                return errorResult(path, message.str());
+            }
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || worker.output.empty())
+                return errorResult(path, "Worker exited without a result");
+            return worker.output;
+        }
+
+        WorkerPool::WorkerPool(size_t jobCount) :
+        m_jobCount(jobCount > 0 ? jobCount : 1) {}
+
+        StringList WorkerPool::run(MapProcessor& processor, const StringList& paths) {
+            StringList results(paths.size());
+            WorkerList workers;
+            size_t next = 0;
+
+            while (next < paths.size() || !workers.empty()) {
+                while (next < paths.size() && workers.size() < m_jobCount) {
+                    if (!spawn(processor, paths[next], next, workers)) {
+                        // fall back to processing the map in this process if no worker can be started
+                        if (workers.empty())
+                            results[next] = processor.process(paths[next]);
+                        else
+                            break;
+                    }
+                    next++;
+                }
+
+                if (workers.empty())
+                    continue;
+
+                std::vector<pollfd> fds(workers.size());
+                for (size_t i = 0; i < workers.size(); i++) {
+                    fds[i].fd = workers[i].fd;
+                    fds[i].events = POLLIN;
+                    fds[i].revents = 0;
+                }
+
+                if (poll(&fds[0], static_cast<nfds_t>(fds.size()), -1) < 0) {
+                    if (errno == EINTR)
+                        continue;
+                    for (size_t i = 0; i < workers.size(); i++)
+                        results[workers[i].index] = finish(workers[i], paths[workers[i].index]);
+                    workers.clear();
+                    continue;
+                }
+
+                // iterate backwards so that finished workers can be removed in place
+                for (size_t i = fds.size(); i > 0; i--) {
+                    if (fds[i - 1].revents == 0)
+                        continue;
+
+                    Worker& worker = workers[i - 1];
+                    char buffer[4096];
+                    const ssize_t count = read(worker.fd, buffer, sizeof(buffer));
+                    if (count > 0) {
+                        worker.output.append(buffer, static_cast<size_t>(count));
+                    } else if (count == 0 || errno != EINTR) {
+                        results[worker.index] = finish(worker, paths[worker.index]);
+                        workers.erase(workers.begin() + static_cast<WorkerList::difference_type>(i - 1));
+                    }
+                }
+            }
+
+            assert(workers.empty());
+            return results;
+        }
+    }
+}
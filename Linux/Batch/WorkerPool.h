@@ -0,0 +1,66 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__WorkerPool__
+#define __TrenchBroom__WorkerPool__
+
+#include "Utility/String.h"
+
+#include <sys/types.h>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Batch {
+        class MapProcessor;
+
+        /*
+         Processes maps in parallel, each in its own child process. The model code shares a pooled allocator and
+         global counters that aren't safe to use from several threads, so the workers are forked instead. This also
+         keeps a crash in one map from taking down the whole batch and gives every map its own peak memory figure.
+         */
+        class WorkerPool {
+        private:
+            class Worker {
+            public:
+                pid_t pid;
+                int fd;
+                size_t index;
+                String output;
+
+                Worker(pid_t i_pid, int i_fd, size_t i_index) :
+                pid(i_pid),
+                fd(i_fd),
+                index(i_index) {}
+            };
+
+            typedef std::vector<Worker> WorkerList;
+
+            size_t m_jobCount;
+
+            bool spawn(MapProcessor& processor, const String& path, size_t index, WorkerList& workers);
+            String finish(Worker& worker, const String& path);
+        public:
+            WorkerPool(size_t jobCount);
+
+            StringList run(MapProcessor& processor, const StringList& paths);
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__WorkerPool__) */
@@ -0,0 +1,58 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_Batch_wx_stopwatch_h
+#define TrenchBroom_Batch_wx_stopwatch_h
+
+#include <ctime>
+
+/*
+ The part of wxStopWatch that Profiler.cpp uses, so that the batch tool can link the profiler without wxWidgets.
+ */
+class wxLongLong {
+private:
+    long long m_value;
+public:
+    wxLongLong(long long value) :
+    m_value(value) {}
+
+    inline long long GetValue() const {
+        return m_value;
+    }
+};
+
+class wxStopWatch {
+private:
+    long long m_start;
+
+    static inline long long now() {
+        timespec time;
+        clock_gettime(CLOCK_MONOTONIC, &time);
+        return static_cast<long long>(time.tv_sec) * 1000000 + static_cast<long long>(time.tv_nsec) / 1000;
+    }
+public:
+    wxStopWatch() :
+    m_start(now()) {}
+
+    inline wxLongLong TimeInMicro() const {
+        return wxLongLong(now() - m_start);
+    }
+};
+
+#endif
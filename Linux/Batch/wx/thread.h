@@ -0,0 +1,45 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_Batch_wx_thread_h
+#define TrenchBroom_Batch_wx_thread_h
+
+/*
+ The part of wxMutex and wxThread that Profiler.cpp uses. The batch tool runs every map in a forked process with a
+ single thread, so the mutex does nothing.
+ */
+class wxMutex {
+public:
+    inline void Lock() {}
+    inline void Unlock() {}
+};
+
+class wxMutexLocker {
+public:
+    wxMutexLocker(wxMutex& mutex) {}
+};
+
+class wxThread {
+public:
+    static inline bool IsMain() {
+        return true;
+    }
+};
+
+#endif
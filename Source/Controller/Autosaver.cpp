@@ -159,7 +159,8 @@ namespace TrenchBroom {
             
             wxStopWatch watch;
             IO::MapWriter mapWriter;
-            mapWriter.writeToFileAtPath(m_document.map(), backupFilePath, true);
+            IO::MappedFile::Ptr mapFile = m_document.mapFile();
+            mapWriter.writeToFileAtPath(m_document.map(), backupFilePath, true, mapFile, false);
             m_document.console().debug("Autosaved to %s in %f seconds", backupFilePath.c_str(), watch.Time() / 1000.0f);
         }
         
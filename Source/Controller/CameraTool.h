@@ -38,6 +38,8 @@ namespace TrenchBroom {
             float panSpeed(bool vertical);
             float moveSpeed();
         protected:
+            inline bool navigationTool() const { return true; }
+
             void handleScroll(InputState& inputState);
 
             bool handleStartDrag(InputState& inputState);
@@ -87,6 +87,14 @@ namespace TrenchBroom {
                     return m_defaultFilter.brushVisible(brush);
                 }
                 
+                virtual inline Model::VisibilityClass::Type hiddenBrushClasses() const {
+                    return m_defaultFilter.hiddenBrushClasses();
+                }
+                
+                virtual inline bool brushMatches(const Model::Brush& brush) const {
+                    return m_defaultFilter.brushMatches(brush);
+                }
+                
                 virtual inline bool brushPickable(const Model::Brush& brush) const {
                     return m_defaultFilter.brushPickable(brush);
                 }
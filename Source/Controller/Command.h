@@ -33,12 +33,14 @@ namespace TrenchBroom {
             typedef enum {
                 LoadMap,
                 ClearMap,
+                LoadObjects,
                 ChangeGrid,
                 ChangeEditState,
                 SetEntityDefinitionFile,
                 SetFaceAttributes,
                 MoveTextures,
                 RotateTextures,
+                RebindTextures,
                 SetEntityPropertyValue,
                 SetEntityPropertyKey,
                 RemoveEntityProperty,
@@ -44,6 +44,8 @@ namespace TrenchBroom {
             MoveKey::Type m_moveKeys[4];
             wxLongLong m_lastUpdateTime;
         protected:
+            inline bool navigationTool() const { return true; }
+
             void execute();
         public:
             FlyTool(View::DocumentViewHolder& documentViewHolder, InputController& inputController);
@@ -47,6 +47,7 @@
 #include "Renderer/SharedResources.h"
 #include "Utility/Console.h"
 #include "Utility/Grid.h"
+#include "Utility/Profiler.h"
 #include "View/DocumentViewHolder.h"
 
 namespace TrenchBroom {
@@ -231,6 +232,7 @@ namespace TrenchBroom {
         }
 
         bool InputController::mouseDown(int x, int y, MouseButtonState mouseButton) {
+            Utility::ProfileZone zone("InputController::mouseDown");
             if (m_dragTool != NULL)
                 return false;
 
@@ -245,6 +247,7 @@ namespace TrenchBroom {
         }
 
         bool InputController::mouseUp(int x, int y, MouseButtonState mouseButton) {
+            Utility::ProfileZone zone("InputController::mouseUp");
             m_inputState.mouseMove(x, y);
             if (m_discardNextMouseUp) {
                 m_discardNextMouseUp = false;
@@ -271,6 +274,7 @@ namespace TrenchBroom {
         }
 
         bool InputController::mouseDClick(int x, int y, MouseButtonState mouseButton) {
+            Utility::ProfileZone zone("InputController::mouseDClick");
             m_discardNextMouseUp = true;
 
             m_inputState.mouseMove(x, y);
@@ -283,6 +287,7 @@ namespace TrenchBroom {
         }
 
         void InputController::mouseMove(int x, int y) {
+            Utility::ProfileZone zone("InputController::mouseMove");
             if (m_inputState.mouseButtons() != MouseButtons::MBNone) {
                 if (m_dragTool == NULL && !m_cancelledDrag &&
                     (std::abs(m_clickPos.x - x) > 1 ||
@@ -314,6 +319,7 @@ namespace TrenchBroom {
         }
 
         void InputController::scroll(float x, float y) {
+            Utility::ProfileZone zone("InputController::scroll");
             m_inputState.scroll(x, y);
             updateHits();
 
@@ -472,8 +478,15 @@ namespace TrenchBroom {
                 editStateManager.hasSelectedObjects()) {
                 Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
 
+                // the guide follows the selection while it is being dragged
+                const BBoxf bounds = editStateManager.bounds().transformed(m_documentViewHolder.view().renderer().selectionTransform());
+                if (m_selectionGuideRenderer != NULL && !(m_selectionGuideRenderer->bounds() == bounds)) {
+                    delete m_selectionGuideRenderer;
+                    m_selectionGuideRenderer = NULL;
+                }
+
                 if (m_selectionGuideRenderer == NULL)
-                    m_selectionGuideRenderer = new Renderer::BoxGuideRenderer(editStateManager.bounds(),
+                    m_selectionGuideRenderer = new Renderer::BoxGuideRenderer(bounds,
                                                                               m_documentViewHolder.document().picker(),
                                                                               m_documentViewHolder.view().filter(),
                                                                               m_documentViewHolder.document().sharedResources().fontManager());
@@ -0,0 +1,62 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TrenchBroom_LoadObjectsCommand_h
+#define TrenchBroom_LoadObjectsCommand_h
+
+#include "Controller/Command.h"
+#include "Model/BrushTypes.h"
+#include "Model/EntityTypes.h"
+
+namespace TrenchBroom {
+    namespace Controller {
+        /*
+         Notifies the views that objects were added to the map while it is being loaded. The entities are new, and
+         the brushes may belong to the new entities or to entities of an earlier batch. The last batch is sent
+         when loading has finished.
+         */
+        class LoadObjectsCommand : public Command {
+        protected:
+            Model::EntityList m_entities;
+            Model::BrushList m_brushes;
+            bool m_finished;
+        public:
+            LoadObjectsCommand(const Model::EntityList& entities, const Model::BrushList& brushes, bool finished) :
+            Command(LoadObjects),
+            m_entities(entities),
+            m_brushes(brushes),
+            m_finished(finished) {}
+
+            inline const Model::EntityList& entities() const {
+                return m_entities;
+            }
+
+            inline const Model::BrushList& brushes() const {
+                return m_brushes;
+            }
+
+            inline bool finished() const {
+                return m_finished;
+            }
+        };
+    }
+}
+
+#endif
@@ -80,31 +80,49 @@ namespace TrenchBroom {
                 m_mode = MMMove;
                 beginCommandGroup(Command::makeObjectActionName(wxT("Move"), entities, brushes));
             }
+            m_totalDelta = Vec3f::Null;
         }
 
         MoveTool::MoveResult MoveObjectsTool::performMove(const Vec3f& delta) {
             Model::EditStateManager& editStateManager = document().editStateManager();
-            const Model::EntityList& entities = editStateManager.selectedEntities();
-            const Model::BrushList& brushes = editStateManager.selectedBrushes();
             
             BBoxf bounds = editStateManager.bounds();
-            bounds.translate(delta);
+            bounds.translate(m_totalDelta + delta);
             if (!document().map().worldBounds().contains(bounds))
                 return Deny;
             
-            TransformObjectsCommand* command = TransformObjectsCommand::translateObjects(document(), entities, brushes, delta);
-            submitCommand(command);
+            // the objects are only moved once the drag ends, until then they are just displayed at their new position
+            m_totalDelta += delta;
+            setSelectionTransform(translationMatrix(m_totalDelta));
             
             return Continue;
         }
 
         void MoveObjectsTool::endDrag(InputState& inputState) {
+            clearSelectionTransform();
+            if (!m_totalDelta.null()) {
+                Model::EditStateManager& editStateManager = document().editStateManager();
+                const Model::EntityList& entities = editStateManager.selectedEntities();
+                const Model::BrushList& brushes = editStateManager.selectedBrushes();
+                
+                TransformObjectsCommand* command = TransformObjectsCommand::translateObjects(document(), entities, brushes, m_totalDelta);
+                submitCommand(command);
+                m_totalDelta = Vec3f::Null;
+            }
+            endCommandGroup();
+        }
+        
+        void MoveObjectsTool::abortDrag(InputState& inputState) {
+            clearSelectionTransform();
+            m_totalDelta = Vec3f::Null;
+            rollbackCommandGroup();
             endCommandGroup();
         }
 
         MoveObjectsTool::MoveObjectsTool(View::DocumentViewHolder& documentViewHolder, InputController& inputController) :
         MoveTool(documentViewHolder, inputController, true),
         m_filter(Model::SelectedFilter(view().filter())),
-        m_mode(MMMove) {}
+        m_mode(MMMove),
+        m_totalDelta(Vec3f::Null) {}
     }
 }
@@ -39,12 +39,14 @@ namespace TrenchBroom {
             
             Model::SelectedFilter m_filter;
             MoveMode m_mode;
+            Vec3f m_totalDelta;
 
             bool isApplicable(InputState& inputState, Vec3f& hitPoint);
             wxString actionName(InputState& inputState);
             void startDrag(InputState& inputState);
             MoveResult performMove(const Vec3f& delta);
             void endDrag(InputState& inputState);
+            void abortDrag(InputState& inputState);
         public:
             MoveObjectsTool(View::DocumentViewHolder& documentViewHolder, InputController& inputController);
         };
@@ -43,6 +43,10 @@ namespace TrenchBroom {
             MoveTexturesCommand(Model::MapDocument& document, const wxString& name, const Model::FaceList& faces, const Vec3f& up, const Vec3f& right, Direction direction, float distance);
         public:
             static MoveTexturesCommand* moveTextures(Model::MapDocument& document, const Model::FaceList& faces, const Vec3f& up, const Vec3f& right, Direction direction, float distance);
+
+            inline const Model::FaceList& faces() const {
+                return m_faces;
+            }
         };
     }
 }
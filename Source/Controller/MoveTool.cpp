@@ -135,6 +135,12 @@ namespace TrenchBroom {
             endCommandGroup();
             endDrag(inputState);
         }
+        
+        void MoveTool::handleCancelDrag(InputState& inputState) {
+            rollbackCommandGroup();
+            endCommandGroup();
+            abortDrag(inputState);
+        }
 
         MoveTool::MoveTool(View::DocumentViewHolder& documentViewHolder, InputController& inputController, bool activatable) :
         PlaneDragTool(documentViewHolder, inputController, activatable),
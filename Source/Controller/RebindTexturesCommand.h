@@ -0,0 +1,46 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_RebindTexturesCommand_h
+#define TrenchBroom_RebindTexturesCommand_h
+
+#include "Controller/Command.h"
+#include "Model/FaceTypes.h"
+
+namespace TrenchBroom {
+    namespace Controller {
+        /*
+         Notifies the views that the textures of the given faces were rebound after the texture collections changed.
+         */
+        class RebindTexturesCommand : public Command {
+        protected:
+            Model::FaceList m_faces;
+        public:
+            RebindTexturesCommand(const Model::FaceList& faces) :
+            Command(RebindTextures),
+            m_faces(faces) {}
+            
+            inline const Model::FaceList& faces() const {
+                return m_faces;
+            }
+        };
+    }
+}
+
+#endif
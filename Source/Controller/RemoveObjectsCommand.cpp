@@ -49,7 +49,7 @@ namespace TrenchBroom {
                 
                 if (entity != NULL &&
                     !entity->worldspawn() &&
-                    entity->brushes().empty() &&
+                    entity->brushCount() == 0 &&
                     std::find(m_entities.begin(), m_entities.end(), entity) == m_entities.end()) {
                     document().removeEntity(*entity);
                     m_removedEntities.push_back(entity);
@@ -102,7 +102,7 @@ namespace TrenchBroom {
             Model::BrushParentMap::const_iterator it, end;
             for (it = m_oldParents.begin(), end = m_oldParents.end(); it != end; ++it) {
                 Model::Entity& entity = *it->second;
-                if (!entity.worldspawn() && entity.brushes().empty())
+                if (!entity.worldspawn() && entity.brushCount() == 0)
                     result.insert(&entity);
             }
             return Utility::makeList(result);
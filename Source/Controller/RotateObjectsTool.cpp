@@ -154,9 +154,14 @@ namespace TrenchBroom {
             Utility::Grid& grid = document().grid();
             m_angle = grid.snapAngle(m_angle);
 
-            m_ignoreObjectsChange = true;
-            rollbackCommandGroup();
+            // the selection is only rotated once the drag ends, until then it is just displayed rotated
+            const Mat4f transform = translationMatrix(m_center) * rotationMatrix(m_angle, m_axis) * translationMatrix(-m_center);
+            setSelectionTransform(transform);
+            return true;
+        }
 
+        void RotateObjectsTool::handleEndDrag(InputState& inputState) {
+            clearSelectionTransform();
             if (m_angle != 0.0f) {
                 Model::EditStateManager& editStateManager = document().editStateManager();
                 const Model::EntityList& entities = editStateManager.selectedEntities();
@@ -164,12 +169,13 @@ namespace TrenchBroom {
                 TransformObjectsCommand* command = TransformObjectsCommand::rotateObjects(document(), entities, brushes, m_axis, m_angle, false, m_center);
                 submitCommand(command);
             }
-
-            m_ignoreObjectsChange = false;
-            return true;
+            endCommandGroup();
+            m_rotateHandle.unlock();
+            m_angle = 0.0f;
         }
 
-        void RotateObjectsTool::handleEndDrag(InputState& inputState) {
+        void RotateObjectsTool::handleCancelDrag(InputState& inputState) {
+            clearSelectionTransform();
             endCommandGroup();
             m_rotateHandle.unlock();
             m_angle = 0.0f;
@@ -179,7 +185,6 @@ namespace TrenchBroom {
         Tool(documentViewHolder, inputController, true),
         m_invert(false),
         m_angle(0.0f),
-        m_ignoreObjectsChange(false),
         m_rotateHandle(RotateHandle(axisLength, ringRadius, ringThickness)){}
     }
 }
@@ -39,7 +39,6 @@ namespace TrenchBroom {
             bool m_invert;
             float m_angle;
             Vec3f m_center;
-            bool m_ignoreObjectsChange;
             
             RotateHandle m_rotateHandle;
             
@@ -54,6 +53,7 @@ namespace TrenchBroom {
             bool handleStartDrag(InputState& inputState);
             bool handleDrag(InputState& inputState);
             void handleEndDrag(InputState& inputState);
+            void handleCancelDrag(InputState& inputState);
             
             void handleUpdate(const Command& command, InputState& inputState);
         public:
@@ -37,6 +37,10 @@ namespace TrenchBroom {
         public:
             static RotateTexturesCommand* rotateClockwise(Model::MapDocument& document, const Model::FaceList& faces, float angle);
             static RotateTexturesCommand* rotateCounterClockwise(Model::MapDocument& document, const Model::FaceList& faces, float angle);
+
+            inline const Model::FaceList& faces() const {
+                return m_faces;
+            }
         };
     }
 }
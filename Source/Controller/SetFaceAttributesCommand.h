@@ -63,6 +63,10 @@ namespace TrenchBroom {
         public:
             SetFaceAttributesCommand(Model::MapDocument& document, const Model::FaceList& faces, const wxString& name);
 
+            inline const Model::FaceList& faces() const {
+                return m_faces;
+            }
+
             inline void setXOffset(float xOffset) {
                 m_xOffset = xOffset;
                 m_xOffsetOp = OpSet;
@@ -20,6 +20,7 @@
 #include "SnapVerticesCommand.h"
 
 #include "Model/Brush.h"
+#include "Model/Map.h"
 #include "Utility/Grid.h"
 
 namespace TrenchBroom {
@@ -32,9 +33,9 @@ namespace TrenchBroom {
             Model::BrushList::const_iterator it, end;
             for (it = m_brushes.begin(), end = m_brushes.end(); it != end; ++it) {
                 Model::Brush& brush = **it;
-                if (m_snapTo == 0)
+                if (m_correct)
                     brush.correct(0.01f);
-                else
+                if (m_snapTo > 0)
                     brush.snap(m_snapTo);
             }
             
@@ -49,21 +50,27 @@ namespace TrenchBroom {
             return true;
         }
 
-        SnapVerticesCommand::SnapVerticesCommand(Model::MapDocument& document, const wxString& name, const Model::BrushList& brushes, unsigned int snapTo) :
+        SnapVerticesCommand::SnapVerticesCommand(Model::MapDocument& document, const wxString& name, const Model::BrushList& brushes, bool correct, unsigned int snapTo) :
         SnapshotCommand(Command::SnapVertices, document, name),
         m_brushes(brushes),
+        m_correct(correct),
         m_snapTo(snapTo) {}
 
         SnapVerticesCommand* SnapVerticesCommand::correct(Model::MapDocument& document, const Model::BrushList& brushes) {
-            return new SnapVerticesCommand(document, wxT("Correct Vertices"), brushes, 0);
+            return new SnapVerticesCommand(document, wxT("Correct Vertices"), brushes, true, 0);
         }
         
         SnapVerticesCommand* SnapVerticesCommand::snapTo1(Model::MapDocument& document, const Model::BrushList& brushes) {
-            return new SnapVerticesCommand(document, wxT("Snap Vertices"), brushes, 1);
+            return new SnapVerticesCommand(document, wxT("Snap Vertices"), brushes, false, 1);
         }
         
         SnapVerticesCommand* SnapVerticesCommand::snapToGrid(Model::MapDocument& document, const Model::BrushList& brushes) {
-            return new SnapVerticesCommand(document, wxT("Snap Vertices to Grid"), brushes, document.grid().actualSize());
+            return new SnapVerticesCommand(document, wxT("Snap Vertices to Grid"), brushes, false, document.grid().actualSize());
+        }
+
+        SnapVerticesCommand* SnapVerticesCommand::repair(Model::MapDocument& document, const Model::BrushList& brushes) {
+            // correcting the vertices may move face points off the integer grid again
+            return new SnapVerticesCommand(document, wxT("Repair Brushes"), brushes, true, document.map().forceIntegerFacePoints() ? 1 : 0);
         }
     }
 }
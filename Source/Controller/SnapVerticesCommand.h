@@ -27,16 +27,18 @@ namespace TrenchBroom {
         class SnapVerticesCommand : public SnapshotCommand {
         protected:
             Model::BrushList m_brushes;
+            bool m_correct;
             unsigned int m_snapTo;
             
             bool performDo();
             bool performUndo();
 
-            SnapVerticesCommand(Model::MapDocument& document, const wxString& name, const Model::BrushList& brushes, unsigned int snapTo = 0);
+            SnapVerticesCommand(Model::MapDocument& document, const wxString& name, const Model::BrushList& brushes, bool correct, unsigned int snapTo);
         public:
             static SnapVerticesCommand* correct(Model::MapDocument& document, const Model::BrushList& brushes);
             static SnapVerticesCommand* snapTo1(Model::MapDocument& document, const Model::BrushList& brushes);
             static SnapVerticesCommand* snapToGrid(Model::MapDocument& document, const Model::BrushList& brushes);
+            static SnapVerticesCommand* repair(Model::MapDocument& document, const Model::BrushList& brushes);
         };
     }
 }
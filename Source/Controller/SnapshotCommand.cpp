@@ -24,6 +24,7 @@
 #include "Model/EntityDefinitionManager.h"
 #include "Model/Face.h"
 #include "Utility/Map.h"
+#include "Utility/MemoryStats.h"
 
 #include <cassert>
 
@@ -33,6 +34,16 @@ namespace TrenchBroom {
         EntitySnapshot::EntitySnapshot(const Model::Entity& entity) {
             m_uniqueId = entity.uniqueId();
             m_properties = entity.properties();
+            
+            m_memorySize = sizeof(EntitySnapshot) + m_properties.size() * sizeof(Model::Property);
+            Model::PropertyList::const_iterator it, end;
+            for (it = m_properties.begin(), end = m_properties.end(); it != end; ++it)
+                m_memorySize += it->key().size() + it->value().size();
+            Utility::MemoryStats::stats().add(Utility::MemoryCategory::UndoSnapshots, m_memorySize);
+        }
+        
+        EntitySnapshot::~EntitySnapshot() {
+            Utility::MemoryStats::stats().remove(Utility::MemoryCategory::UndoSnapshots, m_memorySize);
         }
         
         unsigned int EntitySnapshot::uniqueId() {
@@ -50,10 +61,14 @@ namespace TrenchBroom {
                 Model::Face* snapshot = new Model::Face(*brushFaces[i]);
                 m_faces.push_back(snapshot);
             }
+            
+            // the face copies are pooled and counted with the other faces
+            Utility::MemoryStats::stats().add(Utility::MemoryCategory::UndoSnapshots, sizeof(BrushSnapshot) + m_faces.size() * sizeof(Model::Face*));
         }
         
         BrushSnapshot::~BrushSnapshot() {
             // must not delete the face snapshots because they are now in use by the original brush!
+            Utility::MemoryStats::stats().remove(Utility::MemoryCategory::UndoSnapshots, sizeof(BrushSnapshot) + m_faces.size() * sizeof(Model::Face*));
         }
         
         unsigned int BrushSnapshot::uniqueId() {
@@ -73,6 +88,11 @@ namespace TrenchBroom {
             m_rotation = face.rotation();
             m_texture = face.texture();
             m_textureName = face.textureName();
+            Utility::MemoryStats::stats().add(Utility::MemoryCategory::UndoSnapshots, sizeof(FaceSnapshot) + m_textureName.size());
+        }
+        
+        FaceSnapshot::~FaceSnapshot() {
+            Utility::MemoryStats::stats().remove(Utility::MemoryCategory::UndoSnapshots, sizeof(FaceSnapshot) + m_textureName.size());
         }
         
         unsigned int FaceSnapshot::faceId() {
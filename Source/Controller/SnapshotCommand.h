@@ -42,8 +42,10 @@ namespace TrenchBroom {
         private:
             unsigned int m_uniqueId;
             Model::PropertyList m_properties;
+            size_t m_memorySize;
         public:
             EntitySnapshot(const Model::Entity& entity);
+            ~EntitySnapshot();
             unsigned int uniqueId();
             void restore(Model::Entity& entity);
         };
@@ -71,6 +73,7 @@ namespace TrenchBroom {
             String m_textureName;
         public:
             FaceSnapshot(const Model::Face& face);
+            ~FaceSnapshot();
             unsigned int faceId();
             void restore(Model::Face& face);
         };
@@ -26,7 +26,9 @@
 #include "Model/BrushTypes.h"
 #include "Model/EntityTypes.h"
 #include "Model/MapDocument.h"
+#include "Model/Picker.h"
 #include "Renderer/Figure.h"
+#include "Renderer/MapRenderer.h"
 #include "View/DocumentViewHolder.h"
 #include "View/EditorView.h"
 #include "Utility/CommandProcessor.h"
@@ -171,8 +173,35 @@ namespace TrenchBroom {
                 Model::MapDocument& document = m_documentViewHolder.document();
                 CommandProcessor::Unblock(document.GetCommandProcessor());
             }
+            
+            /*
+             Previews a transformation of the selected objects while dragging. The selection is rendered and picked
+             as if it were transformed, but the objects themselves are only changed by the command that the tool
+             submits when the drag ends.
+             */
+            inline void setSelectionTransform(const Mat4f& transform) {
+                if (!m_documentViewHolder.valid())
+                    return;
+                
+                m_documentViewHolder.document().picker().setSelectionTransform(transform);
+                m_documentViewHolder.view().renderer().setSelectionTransform(transform);
+            }
+            
+            inline void clearSelectionTransform() {
+                if (!m_documentViewHolder.valid())
+                    return;
+                
+                m_documentViewHolder.document().picker().clearSelectionTransform();
+                m_documentViewHolder.view().renderer().clearSelectionTransform();
+            }
 
             inline Tool* nextTool() const { return m_nextTool; }
+
+            /*
+             Navigation tools also receive input while the document is loading; all other tools are disabled until
+             loading has finished.
+             */
+            virtual bool navigationTool() const { return false; }
             
             /* Activation Protocol */
             virtual bool handleActivate(InputState& inputState) { return true; }
@@ -259,6 +288,12 @@ namespace TrenchBroom {
                     nextTool()->setSuppressed(inputState, suppressed, except);
             }
             
+            inline bool enabled() const {
+                if (!active() || m_suppressed)
+                    return false;
+                return navigationTool() || !holderValid() || !document().loading();
+            }
+            
             inline bool isModal(InputState& inputState) {
                 return (active() /*&& !m_suppressed*/) && handleIsModal(inputState);
             }
@@ -275,7 +310,7 @@ namespace TrenchBroom {
 
             inline void render(InputState& inputState, Renderer::Vbo& vbo, Renderer::RenderContext& renderContext) {
                 deleteFigures();
-                if ((active() && !m_suppressed))
+                if (enabled())
                     handleRender(inputState, vbo, renderContext);
                 if (nextTool() != NULL)
                     nextTool()->render(inputState, vbo, renderContext);
@@ -283,7 +318,7 @@ namespace TrenchBroom {
             
             inline void renderOverlay(InputState& inputState, Renderer::Vbo& vbo, Renderer::RenderContext& renderContext) {
                 deleteFigures();
-                if ((active() && !m_suppressed))
+                if (enabled())
                     handleRenderOverlay(inputState, vbo, renderContext);
                 if (nextTool() != NULL)
                     nextTool()->renderOverlay(inputState, vbo, renderContext);
@@ -296,7 +331,7 @@ namespace TrenchBroom {
             }
             
             inline void updateHits(InputState& inputState) {
-                if ((active() && !m_suppressed))
+                if (enabled())
                     handlePick(inputState);
                 if (nextTool() != NULL)
                     nextTool()->updateHits(inputState);
@@ -305,14 +340,14 @@ namespace TrenchBroom {
             /* Input Protocol */
             
             void modifierKeyChange(InputState& inputState) {
-                if ((active() && !m_suppressed))
+                if (enabled())
                     handleModifierKeyChange(inputState);
                 if (nextTool() != NULL)
                     nextTool()->modifierKeyChange(inputState);
             }
             
             Tool* keyChange(InputState& inputState) {
-                if ((active() & !m_suppressed) && handleKeyChange(inputState))
+                if (enabled() && handleKeyChange(inputState))
                     return this;
                 if (nextTool() != NULL)
                     return nextTool()->keyChange(inputState);
@@ -320,7 +355,7 @@ namespace TrenchBroom {
             }
             
             Tool* mouseDown(InputState& inputState) {
-                if ((active() && !m_suppressed) && handleMouseDown(inputState))
+                if (enabled() && handleMouseDown(inputState))
                     return this;
                 if (nextTool() != NULL)
                     return nextTool()->mouseDown(inputState);
@@ -328,7 +363,7 @@ namespace TrenchBroom {
             }
             
             Tool* mouseUp(InputState& inputState) {
-                if ((active() && !m_suppressed) && handleMouseUp(inputState))
+                if (enabled() && handleMouseUp(inputState))
                     return this;
                 if (nextTool() != NULL)
                     return nextTool()->mouseUp(inputState);
@@ -336,7 +371,7 @@ namespace TrenchBroom {
             }
             
             Tool* mouseDClick(InputState& inputState) {
-                if ((active() & !m_suppressed) && handleMouseDClick(inputState))
+                if (enabled() && handleMouseDClick(inputState))
                     return this;
                 if (nextTool() != NULL)
                     return nextTool()->mouseDClick(inputState);
@@ -344,14 +379,14 @@ namespace TrenchBroom {
             }
             
             void mouseMove(InputState& inputState) {
-                if ((active() && !m_suppressed))
+                if (enabled())
                     handleMouseMove(inputState);
                 if (nextTool() != NULL)
                     nextTool()->mouseMove(inputState);
             }
             
             void scroll(InputState& inputState) {
-                if ((active() && !m_suppressed))
+                if (enabled())
                     handleScroll(inputState);
                 if (nextTool() != NULL)
                     nextTool()->scroll(inputState);
@@ -365,7 +400,7 @@ namespace TrenchBroom {
 
             Tool* startDrag(InputState& inputState) {
                 assert(dragType() == DTNone);
-                if ((active() && !m_suppressed) && handleStartDrag(inputState)) {
+                if (enabled() && handleStartDrag(inputState)) {
                     m_dragType = DTDrag;
                     return this;
                 }
@@ -375,20 +410,20 @@ namespace TrenchBroom {
             }
             
             bool drag(InputState& inputState) {
-                assert((active() && !m_suppressed));
+                assert(enabled());
                 assert(dragType() == DTDrag);
                 return handleDrag(inputState);
             }
             
             void endDrag(InputState& inputState) {
-                assert((active() && !m_suppressed));
+                assert(enabled());
                 assert(dragType() == DTDrag);
                 handleEndDrag(inputState);
                 m_dragType = DTNone;
             }
             
             void cancelDrag(InputState& inputState) {
-                assert((active() && !m_suppressed));
+                assert(enabled());
                 assert(dragType() == DTDrag);
                 handleCancelDrag(inputState);
                 m_dragType = DTNone;
@@ -398,7 +433,7 @@ namespace TrenchBroom {
             
             Tool* dragEnter(InputState& inputState, const String& payload) {
                 assert(dragType() == DTNone);
-                if ((active() && !m_suppressed) && handleDragEnter(inputState, payload)) {
+                if (enabled() && handleDragEnter(inputState, payload)) {
                     m_dragType = DTDragTarget;
                     m_dragPayload = payload;
                     return this;
@@ -409,13 +444,13 @@ namespace TrenchBroom {
             }
             
             void dragMove(InputState& inputState) {
-                assert((active() && !m_suppressed));
+                assert(enabled());
                 assert(dragType() == DTDragTarget);
                 handleDragMove(inputState, m_dragPayload);
             }
             
             void dragLeave(InputState& inputState) {
-                assert((active() && !m_suppressed));
+                assert(enabled());
                 assert(dragType() == DTDragTarget);
                 handleDragLeave(inputState, m_dragPayload);
                 m_dragPayload = "";
@@ -423,7 +458,7 @@ namespace TrenchBroom {
             }
             
             bool dragDrop(InputState& inputState) {
-                assert((active() && !m_suppressed));
+                assert(enabled());
                 assert(dragType() == DTDragTarget);
                 bool success = handleDragDrop(inputState, m_dragPayload);
                 m_dragPayload = "";
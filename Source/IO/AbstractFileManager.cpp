@@ -19,9 +19,6 @@
 
 #include "AbstractFileManager.h"
 
-#include <wx/wx.h>
-#include <wx/filename.h>
-
 #include <map> 
 
 #ifndef _WIN32
@@ -51,67 +48,6 @@ namespace TrenchBroom {
         }
 #endif
         
-        bool AbstractFileManager::isAbsolutePath(const String& path) {
-            return wxIsAbsolutePath(path);
-        }
-
-        bool AbstractFileManager::isDirectory(const String& path) {
-            return wxDirExists(path);
-        }
-        
-        bool AbstractFileManager::exists(const String& path) {
-            if (isDirectory(path))
-                return true;
-            return wxFileExists(path);
-        }
-        
-        bool AbstractFileManager::makeDirectory(const String& path) {
-            return wxMkdir(path);
-        }
-        
-        bool AbstractFileManager::deleteFile(const String& path) {
-            return wxRemoveFile(path);
-        }
-        
-        bool AbstractFileManager::moveFile(const String& sourcePath, const String& destPath, bool overwrite) {
-            return wxRenameFile(sourcePath, destPath, overwrite);
-        }
-        
-        char AbstractFileManager::pathSeparator() {
-            static const char c = wxFileName::GetPathSeparator();
-            return c;
-        }
-        
-        StringList AbstractFileManager::directoryContents(const String& path, String extension, bool directories, bool files) {
-            StringList result;
-            if (!isDirectory(path) || !wxSetWorkingDirectory(path))
-                return result;
-            if (!directories && !files)
-                return result;
-            
-            int flags;
-            if (directories && files)
-                flags = 0;
-            else if (directories)
-                flags = wxDIR;
-            else
-                flags = wxFILE;
-            
-            String lowerExtension = Utility::toLower(extension);
-            wxString filename = wxFindFirstFile("*", flags);
-            while (!filename.empty()) {
-                String stdFilename = filename.ToStdString();
-
-                bool matches = extension.empty() || Utility::toLower(pathExtension(stdFilename)) == lowerExtension;
-                if (matches)
-                    result.push_back(pathComponents(stdFilename).back());
-                
-                filename = wxFindNextFile();
-            }
-            
-            return result;
-        }
-        
         bool AbstractFileManager::resolveRelativePath(const String& relativePath, const StringList& rootPaths, String& absolutePath) {
             StringList::const_iterator rootIt, rootEnd;
             for (rootIt = rootPaths.begin(), rootEnd = rootPaths.end(); rootIt != rootEnd; ++rootIt) {
@@ -219,9 +155,9 @@ namespace TrenchBroom {
         }
 
         String AbstractFileManager::makeRelative(const String& absolutePath, const String& referencePath) {
-            if (!::wxIsAbsolutePath(absolutePath))
+            if (!isAbsolutePath(absolutePath))
                 return absolutePath;
-            if (!::wxIsAbsolutePath(referencePath))
+            if (!isAbsolutePath(referencePath))
                 return "";
             
             StringList absolutePathComponents = resolvePath(pathComponents(absolutePath));
@@ -249,9 +185,9 @@ namespace TrenchBroom {
         }
 
         String AbstractFileManager::makeAbsolute(const String& relativePath, const String& referencePath) {
-            if (::wxIsAbsolutePath(relativePath))
+            if (isAbsolutePath(relativePath))
                 return relativePath;
-            if (!::wxIsAbsolutePath(referencePath))
+            if (!isAbsolutePath(referencePath))
                 return "";
 
             String folderPath = isDirectory(referencePath) ? referencePath : deleteLastPathComponent(referencePath);
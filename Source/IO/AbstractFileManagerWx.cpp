@@ -0,0 +1,92 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AbstractFileManager.h"
+
+#include <wx/wx.h>
+#include <wx/filename.h>
+
+/*
+ The parts of the file manager that access the file system through wxWidgets. They are kept apart from the path
+ manipulation in AbstractFileManager.cpp so that tools which don't link wxWidgets can provide their own.
+ */
+namespace TrenchBroom {
+    namespace IO {
+        bool AbstractFileManager::isAbsolutePath(const String& path) {
+            return wxIsAbsolutePath(path);
+        }
+
+        bool AbstractFileManager::isDirectory(const String& path) {
+            return wxDirExists(path);
+        }
+        
+        bool AbstractFileManager::exists(const String& path) {
+            if (isDirectory(path))
+                return true;
+            return wxFileExists(path);
+        }
+        
+        bool AbstractFileManager::makeDirectory(const String& path) {
+            return wxMkdir(path);
+        }
+        
+        bool AbstractFileManager::deleteFile(const String& path) {
+            return wxRemoveFile(path);
+        }
+        
+        bool AbstractFileManager::moveFile(const String& sourcePath, const String& destPath, bool overwrite) {
+            return wxRenameFile(sourcePath, destPath, overwrite);
+        }
+        
+        char AbstractFileManager::pathSeparator() {
+            static const char c = wxFileName::GetPathSeparator();
+            return c;
+        }
+        
+        StringList AbstractFileManager::directoryContents(const String& path, String extension, bool directories, bool files) {
+            StringList result;
+            if (!isDirectory(path) || !wxSetWorkingDirectory(path))
+                return result;
+            if (!directories && !files)
+                return result;
+            
+            int flags;
+            if (directories && files)
+                flags = 0;
+            else if (directories)
+                flags = wxDIR;
+            else
+                flags = wxFILE;
+            
+            String lowerExtension = Utility::toLower(extension);
+            wxString filename = wxFindFirstFile("*", flags);
+            while (!filename.empty()) {
+                String stdFilename = filename.ToStdString();
+
+                bool matches = extension.empty() || Utility::toLower(pathExtension(stdFilename)) == lowerExtension;
+                if (matches)
+                    result.push_back(pathComponents(stdFilename).back());
+                
+                filename = wxFindNextFile();
+            }
+            
+            return result;
+        }
+    }
+}
@@ -30,6 +30,41 @@
 
 namespace TrenchBroom {
     namespace IO {
+        /*
+         Assembles a single entity from the objects reported by the parser.
+         */
+        class EntityCollector : public MapParserListener {
+        private:
+            Model::Entity* m_entity;
+        public:
+            EntityCollector() :
+            m_entity(NULL) {}
+
+            inline Model::Entity* entity() const {
+                return m_entity;
+            }
+
+            bool cancelled() {
+                return false;
+            }
+
+            void entityParsed(Model::Entity* entity) {
+                assert(m_entity == NULL);
+                m_entity = entity;
+            }
+
+            void brushParsed(Model::Brush* brush) {
+                assert(m_entity != NULL);
+                m_entity->addBrush(*brush);
+            }
+
+            void entityFinished(size_t firstLine, size_t lineCount, size_t fileOffset, size_t fileLength) {
+                assert(m_entity != NULL);
+                m_entity->setFilePosition(firstLine, lineCount);
+                m_entity->setFileRange(fileOffset, fileLength);
+            }
+        };
+
         Token MapTokenEmitter::doEmit(Tokenizer& tokenizer) {
             while (!tokenizer.eof()) {
                 size_t line = tokenizer.line();
@@ -126,17 +161,20 @@ namespace TrenchBroom {
             return vec;
         }
 
-        Model::Entity* MapParser::parseEntity(const BBoxf& worldBounds, FacePointFormat& facePointFormat, Utility::ProgressIndicator* indicator) {
+        bool MapParser::parseEntity(MapParserListener& listener, const BBoxf& worldBounds, FacePointFormat& facePointFormat, Utility::ProgressIndicator* indicator) {
             Token token = m_tokenizer.nextToken();
             if (token.type() == TokenType::Eof)
-                return NULL;
+                return false;
             
             expect(TokenType::OBrace | TokenType::CBrace, token);
             if (token.type() == TokenType::CBrace)
-                return NULL;
+                return false;
             
+            // the entity belongs to the listener once it has been passed on
             Model::Entity* entity = new Model::Entity(worldBounds);
+            bool passedOn = false;
             size_t firstLine = token.line();
+            size_t firstOffset = token.position();
             
             while ((token = m_tokenizer.nextToken()).type() != TokenType::Eof) {
                 switch (token.type()) {
@@ -159,12 +197,18 @@ namespace TrenchBroom {
                             m_console.info("Assuming floating point plane coordinates");
                             facePointFormat = Float;
                         }
+                        if (!passedOn) {
+                            listener.entityParsed(entity);
+                            passedOn = true;
+                        }
                         m_tokenizer.pushToken(token);
                         bool moreBrushes = true;
                         while (moreBrushes) {
+                            if (listener.cancelled())
+                                return false;
                             Model::Brush* brush = parseBrush(worldBounds, facePointFormat == Integer, indicator);
                             if (brush != NULL)
-                                entity->addBrush(*brush);
+                                listener.brushParsed(brush);
                             expect(TokenType::OBrace | TokenType::CBrace, token = m_tokenizer.nextToken());
                             moreBrushes = (token.type() == TokenType::OBrace);
                             m_tokenizer.pushToken(token);
@@ -178,16 +222,32 @@ namespace TrenchBroom {
                         }
                         if (indicator != NULL)
                             indicator->update(static_cast<int>(token.position()));
-                        entity->setFilePosition(firstLine, token.line() - firstLine);
-                        return entity;
+                        if (!passedOn)
+                            listener.entityParsed(entity);
+                        listener.entityFinished(firstLine, token.line() - firstLine, firstOffset, token.position() + 1 - firstOffset);
+                        return true;
                     }
                     default:
-                        delete entity;
+                        if (!passedOn)
+                            delete entity;
                         throw MapParserException(token, TokenType::String | TokenType::OBrace | TokenType::CBrace);
                 }
             }
             
-            return entity;
+            if (!passedOn)
+                listener.entityParsed(entity);
+            return false;
+        }
+
+        Model::Entity* MapParser::parseEntity(const BBoxf& worldBounds, FacePointFormat& facePointFormat, Utility::ProgressIndicator* indicator) {
+            EntityCollector collector;
+            try {
+                parseEntity(collector, worldBounds, facePointFormat, indicator);
+            } catch (MapParserException&) {
+                delete collector.entity();
+                throw;
+            }
+            return collector.entity();
         }
 
         MapParser::MapParser(const char* begin, const char* end, Utility::Console& console) :
@@ -220,9 +280,27 @@ namespace TrenchBroom {
                 indicator->update(static_cast<int>(m_size));
         }
         
+        void MapParser::parseMap(MapParserListener& listener, const BBoxf& worldBounds, Utility::ProgressIndicator* indicator) {
+            if (indicator != NULL) indicator->reset(static_cast<int>(m_size));
+            try {
+                FacePointFormat facePointFormat = Unknown;
+                while (!listener.cancelled() && parseEntity(listener, worldBounds, facePointFormat, indicator));
+            } catch (MapParserException& e) {
+                m_console.error(e.what());
+            }
+            
+            if (indicator != NULL)
+                indicator->update(static_cast<int>(m_size));
+        }
+        
         Model::Entity* MapParser::parseEntity(const BBoxf& worldBounds, bool forceIntegerFacePoints, Utility::ProgressIndicator* indicator) {
             FacePointFormat format = forceIntegerFacePoints ? Integer : Float;
-            return parseEntity(worldBounds, format, indicator);
+            Model::Entity* entity = parseEntity(worldBounds, format, indicator);
+            
+            // the entity was not read from a map file, so its byte range is meaningless
+            if (entity != NULL)
+                entity->invalidateFileRange();
+            return entity;
         }
         
         Model::Brush* MapParser::parseBrush(const BBoxf& worldBounds, bool forceIntegerFacePoints, Utility::ProgressIndicator* indicator) {
@@ -126,6 +126,22 @@ namespace TrenchBroom {
             MapParserException(const Token& token, unsigned int expectedType) : MessageException(buildMessage(token, expectedType)) {}
         };
 
+        /*
+         Receives the objects of a map file while it is being parsed. An entity is passed on as soon as its
+         properties have been read, and its brushes follow one by one, so that a receiver can show an entity before
+         the parser has reached its end. The receiver takes ownership of the entities and brushes.
+         */
+        class MapParserListener {
+        public:
+            virtual ~MapParserListener() {}
+
+            // checked between brushes, parsing stops early if this returns true
+            virtual bool cancelled() = 0;
+            virtual void entityParsed(Model::Entity* entity) = 0;
+            virtual void brushParsed(Model::Brush* brush) = 0;
+            virtual void entityFinished(size_t firstLine, size_t lineCount, size_t fileOffset, size_t fileLength) = 0;
+        };
+
         class MapParser {
         private:
             enum MapFormat {
@@ -153,11 +169,13 @@ namespace TrenchBroom {
             Vec3f parseVector();
 
             Model::Entity* parseEntity(const BBoxf& worldBounds, FacePointFormat& facePointFormat, Utility::ProgressIndicator* indicator);
+            bool parseEntity(MapParserListener& listener, const BBoxf& worldBounds, FacePointFormat& facePointFormat, Utility::ProgressIndicator* indicator);
         public:
             MapParser(const char* begin, const char* end, Utility::Console& console);
             MapParser(const String& str, Utility::Console& console);
             
             void parseMap(Model::Map& map, Utility::ProgressIndicator* indicator);
+            void parseMap(MapParserListener& listener, const BBoxf& worldBounds, Utility::ProgressIndicator* indicator);
             Model::Entity* parseEntity(const BBoxf& worldBounds, bool forceIntegerFacePoints, Utility::ProgressIndicator* indicator);
             Model::Brush* parseBrush(const BBoxf& worldBounds, bool forceIntegerFacePoints, Utility::ProgressIndicator* indicator);
             Model::Face* parseFace(const BBoxf& worldBounds, bool forceIntegerFacePoints);
@@ -29,6 +29,7 @@
 #include "IO/FileManager.h"
 #include "IO/IOException.h"
 
+#include <algorithm>
 #include <cassert>
 #include <fstream>
 #include <limits>
@@ -99,6 +100,39 @@ namespace TrenchBroom {
             return lineCount;
         }
 
+        size_t MapWriter::copyEntity(Model::Entity& entity, const MappedFile& originalFile, FILE* stream) {
+            if (!entity.hasFileRange() || entity.fileOffset() + entity.fileLength() > originalFile.size())
+                return 0;
+            
+            // don't trust a range that doesn't look like an entity, the file might have changed since it was read
+            const char* begin = originalFile.begin() + entity.fileOffset();
+            const char* end = begin + entity.fileLength();
+            if (*begin != '{' || *(end - 1) != '}')
+                return 0;
+            
+            std::fwrite(begin, 1, entity.fileLength(), stream);
+            std::fprintf(stream, "\n");
+            return static_cast<size_t>(std::count(begin, end, '\n')) + 1;
+        }
+        
+        void MapWriter::moveFilePositions(Model::Entity& entity, const size_t lineNumber, const size_t lineCount) {
+            const size_t oldLineNumber = entity.fileLine();
+            const Model::BrushList& brushes = entity.brushes();
+            Model::BrushList::const_iterator brushIt, brushEnd;
+            for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt) {
+                Model::Brush& brush = **brushIt;
+                brush.setFilePosition(lineNumber + brush.fileLine() - oldLineNumber, brush.fileLineCount());
+                
+                const Model::FaceList& faces = brush.faces();
+                Model::FaceList::const_iterator faceIt, faceEnd;
+                for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt) {
+                    Model::Face& face = **faceIt;
+                    face.setFilePosition(lineNumber + face.filePosition() - oldLineNumber);
+                }
+            }
+            entity.setFilePosition(lineNumber, lineCount);
+        }
+
         void MapWriter::writeFace(const Model::Face& face, std::ostream& stream) {
             const String textureName = Utility::isBlank(face.textureName()) ? Model::Texture::Empty : face.textureName();
             
@@ -265,5 +299,74 @@ namespace TrenchBroom {
                 lineNumber += writeEntity(*entities[i], lineNumber, stream);
             fclose(stream);
         }
+    
+        size_t MapWriter::writeToFileAtPath(Model::Map& map, const String& path, bool overwrite, MappedFile::Ptr& originalFile, bool updatePositions) {
+            FileManager fileManager;
+            if (fileManager.exists(path) && !overwrite)
+                return 0;
+            
+            const String directoryPath = fileManager.deleteLastPathComponent(path);
+            if (!fileManager.exists(directoryPath))
+                fileManager.makeDirectory(directoryPath);
+            
+            // binary mode so that the copied text keeps its line endings and the offsets match the written file
+            const String tempPath = path + ".tmp";
+            FILE* stream = fopen(tempPath.c_str(), "wb");
+            if (stream == NULL)
+                throw IOException::openError(tempPath);
+            
+            EntityFileRangeList ranges;
+            size_t copiedCount = 0;
+            size_t lineNumber = 1;
+            const Model::EntityList& entities = map.entities();
+            ranges.reserve(entities.size());
+            
+            Model::EntityList::const_iterator it, end;
+            for (it = entities.begin(), end = entities.end(); it != end; ++it) {
+                Model::Entity& entity = **it;
+                const size_t offset = static_cast<size_t>(std::ftell(stream));
+                
+                size_t lineCount = 0;
+                if (originalFile.get() != NULL)
+                    lineCount = copyEntity(entity, *originalFile, stream);
+                
+                const bool copied = lineCount > 0;
+                if (copied)
+                    copiedCount++;
+                else
+                    lineCount = writeEntity(entity, lineNumber, stream);
+                
+                // the range ends at the closing brace, without the line break that follows it
+                const size_t length = static_cast<size_t>(std::ftell(stream)) - offset - 1;
+                ranges.push_back(EntityFileRange(&entity, offset, length, lineNumber, lineCount, copied));
+                lineNumber += lineCount;
+            }
+            
+            const bool failed = std::ferror(stream) != 0;
+            fclose(stream);
+            if (failed) {
+                fileManager.deleteFile(tempPath);
+                throw IOException("Error writing file %s", tempPath.c_str());
+            }
+            
+            // the original file might be the file we're about to replace, and a mapped file cannot be replaced everywhere
+            originalFile.reset();
+            if (!fileManager.moveFile(tempPath, path, true)) {
+                fileManager.deleteFile(tempPath);
+                throw IOException("Could not replace file %s", path.c_str());
+            }
+            
+            if (updatePositions) {
+                EntityFileRangeList::const_iterator rangeIt, rangeEnd;
+                for (rangeIt = ranges.begin(), rangeEnd = ranges.end(); rangeIt != rangeEnd; ++rangeIt) {
+                    const EntityFileRange& range = *rangeIt;
+                    if (range.copied)
+                        moveFilePositions(*range.entity, range.lineNumber, range.lineCount);
+                    range.entity->setFileRange(range.offset, range.length);
+                }
+            }
+            
+            return copiedCount;
+        }
     }
 }
@@ -20,6 +20,7 @@
 #ifndef TrenchBroom_MapWriter_h
 #define TrenchBroom_MapWriter_h
 
+#include "IO/AbstractFileManager.h"
 #include "Model/EntityTypes.h"
 #include "Model/BrushTypes.h"
 #include "Model/FaceTypes.h"
@@ -27,6 +28,7 @@
 
 #include <cstdio>
 #include <ostream>
+#include <vector>
 
 #if defined _MSC_VER
 #include <cstdint>
@@ -47,12 +49,34 @@ namespace TrenchBroom {
         private:
             static const int FloatPrecision = 100;
             String FaceFormat;
+
+            class EntityFileRange {
+            public:
+                Model::Entity* entity;
+                size_t offset;
+                size_t length;
+                size_t lineNumber;
+                size_t lineCount;
+                bool copied;
+
+                EntityFileRange(Model::Entity* i_entity, size_t i_offset, size_t i_length, size_t i_lineNumber, size_t i_lineCount, bool i_copied) :
+                entity(i_entity),
+                offset(i_offset),
+                length(i_length),
+                lineNumber(i_lineNumber),
+                lineCount(i_lineCount),
+                copied(i_copied) {}
+            };
+
+            typedef std::vector<EntityFileRange> EntityFileRangeList;
         protected:
             size_t writeFace(Model::Face& face, const size_t lineNumber, FILE* stream);
             size_t writeBrush(Model::Brush& brush, const size_t lineNumber, FILE* stream);
             size_t writeEntityHeader(Model::Entity& entity, FILE* stream);
             size_t writeEntityFooter(FILE* stream);
             size_t writeEntity(Model::Entity& entity, const size_t lineNumber, FILE* stream);
+            size_t copyEntity(Model::Entity& entity, const MappedFile& originalFile, FILE* stream);
+            void moveFilePositions(Model::Entity& entity, const size_t lineNumber, const size_t lineCount);
             
             void writeFace(const Model::Face& face, std::ostream& stream);
             void writeBrush(const Model::Brush& brush, std::ostream& stream);
@@ -65,6 +89,19 @@ namespace TrenchBroom {
             void writeFacesToStream(const Model::FaceList& faces, std::ostream& stream);
             void writeToStream(const Model::Map& map, std::ostream& stream);
             void writeToFileAtPath(Model::Map& map, const String& path, bool overwrite);
+
+            /*
+             Writes the map like writeToFileAtPath, but copies the text of every entity that has not changed since it
+             was read from the given original file instead of serializing it again. Entities that have changed or whose
+             byte range does not match the original file are serialized as usual, so the result is the same as a full
+             rewrite if nothing can be copied. The map is written to a temporary file first, and the original file is
+             released before the temporary file replaces the file at the given path.
+             
+             If updatePositions is true, the byte ranges and line numbers of all entities are updated to refer to the
+             written file. This must only be done if the written file becomes the map's file. Returns the number of
+             entities that were copied.
+             */
+            size_t writeToFileAtPath(Model::Map& map, const String& path, bool overwrite, MappedFile::Ptr& originalFile, bool updatePositions);
         };
     }
 }
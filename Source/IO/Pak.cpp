@@ -25,6 +25,8 @@
 
 #include <algorithm>
 
+#include <wx/thread.h>
+
 namespace TrenchBroom {
     namespace IO {
         Pak::Pak(const String& path, MappedFile::Ptr file) :
@@ -66,6 +68,14 @@ namespace TrenchBroom {
 
         PakManager* PakManager::sharedManager = NULL;
         
+        PakManager::PakManager() :
+        m_lock(new wxCriticalSection()) {}
+        
+        PakManager::~PakManager() {
+            delete m_lock;
+            m_lock = NULL;
+        }
+        
         bool PakManager::findPaks(const String& path, PakList& result) {
             String lowerPath = Utility::toLower(path);
             PakMap::iterator it = m_paks.find(lowerPath);
@@ -98,6 +108,7 @@ namespace TrenchBroom {
         }
 
         MappedFile::Ptr PakManager::entry(const String& name, const String& searchPath) {
+            wxCriticalSectionLocker lock(*m_lock);
             PakList paks;
             if (findPaks(searchPath, paks)) {
                 PakList::reverse_iterator pak, endPak;
@@ -33,6 +33,8 @@
 #include <stdint.h>
 #endif
 
+class wxCriticalSection;
+
 namespace TrenchBroom {
     namespace IO {
         namespace PakLayout {
@@ -92,10 +94,14 @@ namespace TrenchBroom {
             typedef std::map<String, PakList> PakMap;
 
             PakMap m_paks;
+            wxCriticalSection* m_lock; // entity models are loaded on a background thread
             bool findPaks(const String& path, PakList& result);
         public:
             static PakManager* sharedManager;
 
+            PakManager();
+            ~PakManager();
+
             MappedFile::Ptr entry(const String& name, const String& searchPath);
         };
     }
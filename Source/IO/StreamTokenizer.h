@@ -84,7 +84,7 @@ namespace TrenchBroom {
             }
 
             inline float toFloat() const {
-                static char buffer[64];
+                char buffer[64];
                 memcpy(buffer, m_begin, length());
                 buffer[length()] = 0;
                 float f = static_cast<float>(std::atof(buffer));
@@ -92,7 +92,7 @@ namespace TrenchBroom {
             }
 
             inline int toInteger() const {
-                static char buffer[64];
+                char buffer[64];
                 memcpy(buffer, m_begin, length());
                 buffer[length()] = 0;
                 int i = static_cast<int>(std::atoi(buffer));
@@ -22,6 +22,7 @@
 #include "Model/AliasNormals.h"
 #include "IO/IOUtils.h"
 #include "Utility/List.h"
+#include "Utility/MemoryStats.h"
 
 #include <cassert>
 #include <cmath>
@@ -145,7 +146,8 @@ namespace TrenchBroom {
         }
 
         Alias::Alias(const String& name, char* begin, char* end) :
-        m_name(name) {
+        m_name(name),
+        m_memorySize(sizeof(Alias)) {
             using namespace IO;
             
             char* cursor = begin + AliasLayout::HeaderScale;
@@ -169,6 +171,7 @@ namespace TrenchBroom {
                 if (skinGroup == 0) {
                     unsigned char* skinPicture = new unsigned char[skinSize];
                     readBytes(cursor, skinPicture, skinSize);
+                    m_memorySize += skinSize;
 
                     AliasSkin* skin = new AliasSkin(skinPicture, skinWidth, skinHeight);
                     m_skins.push_back(skin);
@@ -185,6 +188,7 @@ namespace TrenchBroom {
                         unsigned char* skinPicture = new unsigned char[skinSize];
                         cursor = base + numPics * 4 + j * skinSize;
                         readBytes(cursor, skinPicture, skinSize);
+                        m_memorySize += skinSize;
 
                         skinPictures[j] = skinPicture;
                     }
@@ -215,6 +219,7 @@ namespace TrenchBroom {
                 int type = readInt<int32_t>(cursor);
                 if (type == 0) { // single frame
                     m_frames.push_back(readFrame(cursor, origin, scale, skinWidth, skinHeight, vertices, triangles));
+                    m_memorySize += triangleCount * (sizeof(AliasFrameTriangle) + sizeof(AliasFrameTriangle*));
                 } else { // frame group
                     char* base = cursor;
                     unsigned int groupFrameCount = readUnsignedInt<int32_t>(cursor);
@@ -227,40 +232,65 @@ namespace TrenchBroom {
                     for (unsigned int j = 0; j < groupFrameCount; j++) {
                         groupFrameTimes[i] = readFloat<float>(timeCursor);
                         groupFrames[j] = readFrame(frameCursor, origin, scale, skinWidth, skinHeight, vertices, triangles);
+                        m_memorySize += triangleCount * (sizeof(AliasFrameTriangle) + sizeof(AliasFrameTriangle*));
                     }
 
                     m_frames.push_back(new AliasFrameGroup(groupFrameTimes, groupFrames));
                     cursor = frameCursor;
                 }
             }
+            
+            Utility::MemoryStats::stats().add(Utility::MemoryCategory::ModelCaches, m_memorySize);
         }
 
         Alias::~Alias() {
+            Utility::MemoryStats::stats().remove(Utility::MemoryCategory::ModelCaches, m_memorySize);
             Utility::deleteAll(m_frames);
             Utility::deleteAll(m_skins);
         }
 
         AliasManager* AliasManager::sharedManager = NULL;
 
+        String AliasManager::key(const String& name, const StringList& paths) {
+            return Utility::join(paths, ",") + ":" + name;
+        }
+
         Alias const * const AliasManager::alias(const String& name, const StringList& paths, Utility::Console& console) {
-            String pathList = Utility::join(paths, ",");
-            String key = pathList + ":" + name;
+            const Alias* cached = cachedAlias(name, paths);
+            if (cached != NULL)
+                return cached;
+
+            console.info("Loading '%s' (searching %s)", name.c_str(), Utility::join(paths, ",").c_str());
+
+            Alias* alias = loadAlias(name, paths);
+            if (alias != NULL)
+                return addAlias(name, paths, alias);
+
+            console.warn("Unable to find MDL '%s'", name.c_str());
+            return NULL;
+        }
 
-            AliasMap::iterator it = m_aliases.find(key);
+        Alias const * const AliasManager::cachedAlias(const String& name, const StringList& paths) const {
+            AliasMap::const_iterator it = m_aliases.find(key(name, paths));
             if (it != m_aliases.end())
                 return it->second;
+            return NULL;
+        }
 
-            console.info("Loading '%s' (searching %s)", name.c_str(), pathList.c_str());
+        Alias const * const AliasManager::addAlias(const String& name, const StringList& paths, Alias* alias) {
+            typedef std::pair<AliasMap::iterator, bool> InsertResult;
 
-            IO::MappedFile::Ptr file = IO::findGameFile(name, paths);
-            if (file.get() != NULL) {
-                Alias* alias = new Alias(name, file->begin(), file->end());
-                m_aliases[key] = alias;
-                return alias;
-            }
+            InsertResult result = m_aliases.insert(AliasMap::value_type(key(name, paths), alias));
+            if (!result.second) // loaded twice, keep the first one
+                delete alias;
+            return result.first->second;
+        }
 
-            console.warn("Unable to find MDL '%s'", name.c_str());
-            return NULL;
+        Alias* AliasManager::loadAlias(const String& name, const StringList& paths) {
+            IO::MappedFile::Ptr file = IO::findGameFile(name, paths);
+            if (file.get() == NULL)
+                return NULL;
+            return new Alias(name, file->begin(), file->end());
         }
 
         AliasManager::AliasManager() {}
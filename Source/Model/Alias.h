@@ -218,6 +218,7 @@ namespace TrenchBroom {
             String m_name;
             AliasFrameList m_frames;
             AliasSkinList m_skins;
+            size_t m_memorySize;
             
             Vec3f unpackFrameVertex(const AliasPackedFrameVertex& packedVertex, const Vec3f& origin, const Vec3f& size);
             AliasSingleFrame* readFrame(char*& cursor, const Vec3f& origin, const Vec3f& scale, unsigned int skinWidth, unsigned int skinHeight, const AliasSkinVertexList& vertices, const AliasSkinTriangleList& triangles);
@@ -252,11 +253,22 @@ namespace TrenchBroom {
             typedef std::map<String, Alias*> AliasMap;
             
             AliasMap m_aliases;
+
+            static String key(const String& name, const StringList& paths);
         public:
             static AliasManager* sharedManager;
             AliasManager();
             ~AliasManager();
             Alias const * const alias(const String& name, const StringList& paths, Utility::Console& console);
+
+            /*
+             These split alias() into its parts so that the parsing can happen on a background thread. loadAlias does
+             not touch the cache and can be called from any thread; the cache itself must only be used by the main
+             thread.
+             */
+            Alias const * const cachedAlias(const String& name, const StringList& paths) const;
+            Alias const * const addAlias(const String& name, const StringList& paths, Alias* alias);
+            static Alias* loadAlias(const String& name, const StringList& paths);
         };
     }
 }
@@ -22,6 +22,7 @@
 #include "Model/Entity.h"
 #include "Model/Face.h"
 #include "Model/Filter.h"
+#include "Model/Map.h"
 #include "Model/Picker.h"
 #include "Model/Texture.h"
 #include "Utility/List.h"
@@ -32,8 +33,43 @@ namespace TrenchBroom {
     namespace Model {
         void Brush::init() {
             m_entity = NULL;
+            m_entityIndex = 0;
             setEditState(EditState::Default);
             m_selectedFaceCount = 0;
+            m_contentClass = VisibilityClass::None;
+            m_contentClassValid = false;
+        }
+
+        void Brush::validateContentClass() const {
+            m_contentClass = VisibilityClass::None;
+            m_contentClassValid = true;
+            if (m_faces.empty())
+                return;
+
+            const Face::ContentType contentType = m_faces.front()->contentType();
+            for (size_t i = 1; i < m_faces.size(); i++)
+                if (m_faces[i]->contentType() != contentType)
+                    return;
+
+            switch (contentType) {
+                case Face::CTLiquid:
+                    m_contentClass = VisibilityClass::Liquid;
+                    break;
+                case Face::CTClip:
+                    m_contentClass = VisibilityClass::Clip;
+                    break;
+                case Face::CTSkip:
+                    m_contentClass = VisibilityClass::Skip;
+                    break;
+                case Face::CTHint:
+                    m_contentClass = VisibilityClass::Hint;
+                    break;
+                case Face::CTTrigger:
+                    m_contentClass = VisibilityClass::Trigger;
+                    break;
+                default:
+                    break;
+            }
         }
 
         Brush::Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const FaceList& faces) :
@@ -167,10 +203,30 @@ namespace TrenchBroom {
             rebuildGeometry();
         }
 
+        VisibilityClass::Type Brush::visibilityClasses() const {
+            if (!m_contentClassValid)
+                validateContentClass();
+            if (m_entity != NULL && m_entity->trigger())
+                return m_contentClass | VisibilityClass::Trigger;
+            return m_contentClass;
+        }
+
         void Brush::setEntity(Entity* entity) {
             if (entity == m_entity)
                 return;
 
+            Map* oldMap = m_entity != NULL ? m_entity->map() : NULL;
+            Map* newMap = entity != NULL ? entity->map() : NULL;
+            if (oldMap != newMap) {
+                FaceList::const_iterator it, end;
+                for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it) {
+                    if (oldMap != NULL)
+                        oldMap->removeFace(**it);
+                    if (newMap != NULL)
+                        newMap->addFace(**it);
+                }
+            }
+
             if (m_entity != NULL) {
                 if (selected())
                     m_entity->decSelectedBrushCount();
@@ -194,6 +250,11 @@ namespace TrenchBroom {
             }
         }
 
+        void Brush::invalidateFileRange() {
+            if (m_entity != NULL)
+                m_entity->invalidateFileRange();
+        }
+
         EditState::Type Brush::setEditState(EditState::Type editState) {
             EditState::Type previous = MapObject::setEditState(editState);
             if (m_entity != NULL) {
@@ -243,11 +304,39 @@ namespace TrenchBroom {
             for (FaceList::iterator it = m_faces.begin(); it != m_faces.end(); ++it) {
                 Face* face = *it;
                 face->invalidateTexAxes();
-                face->invalidateVertexCache();
             }
 
-            if (m_entity != NULL)
+            if (m_entity != NULL) {
                 m_entity->invalidateGeometry();
+                m_entity->invalidateFileRange();
+            }
+        }
+
+        bool Brush::preservesTopology(const Mat4f& pointTransform) const {
+            // every axis must be mapped onto a distinct axis, possibly mirrored
+            bool usedRows[3] = {false, false, false};
+            for (size_t c = 0; c < 3; c++) {
+                size_t row = 3;
+                for (size_t r = 0; r < 3; r++) {
+                    const float value = pointTransform[c][r];
+                    if (Math<float>::eq(std::abs(value), 1.0f)) {
+                        if (row < 3 || usedRows[r])
+                            return false;
+                        row = r;
+                    } else if (!Math<float>::zero(value)) {
+                        return false;
+                    }
+                }
+                if (row == 3)
+                    return false;
+                usedRows[row] = true;
+                if (!Math<float>::zero(pointTransform[c][3]))
+                    return false;
+            }
+            
+            // integer face points must stay integer or they would be recomputed, moving the planes
+            const Vec3f translation(pointTransform[3][0], pointTransform[3][1], pointTransform[3][2]);
+            return !m_forceIntegerFacePoints || translation.isInteger();
         }
 
         void Brush::transform(const Mat4f& pointTransform, const Mat4f& vectorTransform, const bool lockTextures, const bool invertOrientation) {
@@ -257,7 +346,16 @@ namespace TrenchBroom {
                 face.transform(pointTransform, vectorTransform, lockTextures, invertOrientation);
             }
 
-            rebuildGeometry();
+            if (m_geometry == NULL || !preservesTopology(pointTransform)) {
+                rebuildGeometry();
+                return;
+            }
+            
+            m_geometry->transform(pointTransform, invertOrientation);
+            if (m_entity != NULL) {
+                m_entity->invalidateGeometry();
+                m_entity->invalidateFileRange();
+            }
         }
 
         bool Brush::clip(Face& face) {
@@ -367,7 +465,6 @@ namespace TrenchBroom {
             for (FaceList::iterator it = m_faces.begin(); it != m_faces.end(); ++it) {
                 Face* face = *it;
                 face->invalidateTexAxes();
-                face->invalidateVertexCache();
             }
 
             for (FaceSet::iterator it = newFaces.begin(); it != newFaces.end(); ++it) {
@@ -376,6 +473,7 @@ namespace TrenchBroom {
                 m_faces.push_back(face);
             }
 
+            invalidateFileRange();
             return newVertexPositions;
         }
 
@@ -399,7 +497,6 @@ namespace TrenchBroom {
             for (FaceList::iterator it = m_faces.begin(); it != m_faces.end(); ++it) {
                 Face* face = *it;
                 face->invalidateTexAxes();
-                face->invalidateVertexCache();
             }
 
             for (FaceSet::iterator it = newFaces.begin(); it != newFaces.end(); ++it) {
@@ -408,6 +505,7 @@ namespace TrenchBroom {
                 m_faces.push_back(face);
             }
 
+            invalidateFileRange();
             return newEdgeInfos;
         }
 
@@ -431,7 +529,6 @@ namespace TrenchBroom {
             for (FaceList::iterator it = m_faces.begin(); it != m_faces.end(); ++it) {
                 Face* face = *it;
                 face->invalidateTexAxes();
-                face->invalidateVertexCache();
             }
 
             for (FaceSet::iterator it = newFaces.begin(); it != newFaces.end(); ++it) {
@@ -440,6 +537,7 @@ namespace TrenchBroom {
                 m_faces.push_back(face);
             }
 
+            invalidateFileRange();
             return newFaceInfos;
         }
 
@@ -463,7 +561,6 @@ namespace TrenchBroom {
             for (FaceList::iterator it = m_faces.begin(); it != m_faces.end(); ++it) {
                 Face* face = *it;
                 face->invalidateTexAxes();
-                face->invalidateVertexCache();
             }
 
             for (FaceSet::iterator it = newFaces.begin(); it != newFaces.end(); ++it) {
@@ -472,6 +569,7 @@ namespace TrenchBroom {
                 m_faces.push_back(face);
             }
 
+            invalidateFileRange();
             return newVertexPosition;
         }
 
@@ -495,7 +593,6 @@ namespace TrenchBroom {
             for (FaceList::iterator it = m_faces.begin(); it != m_faces.end(); ++it) {
                 Face* face = *it;
                 face->invalidateTexAxes();
-                face->invalidateVertexCache();
             }
 
             for (FaceSet::iterator it = newFaces.begin(); it != newFaces.end(); ++it) {
@@ -504,6 +601,7 @@ namespace TrenchBroom {
                 m_faces.push_back(newFace);
             }
 
+            invalidateFileRange();
             return newVertexPosition;
         }
 
@@ -25,6 +25,7 @@
 #include "Model/EditState.h"
 #include "Model/FaceTypes.h"
 #include "Model/MapObject.h"
+#include "Model/VisibilityClass.h"
 #include "Utility/Allocator.h"
 #include "Utility/VecMath.h"
 
@@ -40,9 +41,10 @@ namespace TrenchBroom {
         class Face;
         class Texture;
 
-        class Brush : public MapObject, public Utility::Allocator<Brush> {
+        class Brush : public MapObject, public Utility::Allocator<Brush, Utility::MemoryCategory::Brushes> {
         protected:
             class Entity* m_entity;
+            size_t m_entityIndex;
             FaceList m_faces;
             BrushGeometry* m_geometry;
 
@@ -51,7 +53,12 @@ namespace TrenchBroom {
             const BBoxf& m_worldBounds;
             bool m_forceIntegerFacePoints;
 
+            // the class shared by all faces, determined when it is first requested after a face has changed
+            mutable VisibilityClass::Type m_contentClass;
+            mutable bool m_contentClassValid;
+
             void init();
+            void validateContentClass() const;
         public:
             Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const FaceList& faces);
             Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const Brush& brushTemplate);
@@ -70,6 +77,17 @@ namespace TrenchBroom {
             }
 
             void setEntity(class Entity* entity);
+            
+            /*
+             Position of this brush in its entity's brush list, used to remove it without searching the list.
+             */
+            inline size_t entityIndex() const {
+                return m_entityIndex;
+            }
+            
+            inline void setEntityIndex(size_t entityIndex) {
+                m_entityIndex = entityIndex;
+            }
 
             inline const FaceList& faces() const {
                 return m_faces;
@@ -87,6 +105,8 @@ namespace TrenchBroom {
                 m_selectedFaceCount--;
             }
 
+            void invalidateFileRange();
+
             virtual EditState::Type setEditState(EditState::Type editState);
 
             inline const BBoxf& worldBounds() const {
@@ -133,8 +153,23 @@ namespace TrenchBroom {
                 return m_geometry->closed();
             }
 
+            inline bool sanityCheck(bool verbose = true) const {
+                return m_geometry->sanityCheck(verbose);
+            }
+
+            VisibilityClass::Type visibilityClasses() const;
+
+            inline void invalidateContentClass() {
+                m_contentClassValid = false;
+            }
+
             void rebuildGeometry();
 
+            /*
+             Translations, rotations by multiples of 90 degrees and mirrors map the vertices onto the transformed
+             planes exactly, so the geometry is transformed in place instead of being rebuilt.
+             */
+            bool preservesTopology(const Mat4f& pointTransform) const;
             void transform(const Mat4f& pointTransform, const Mat4f& vectorTransform, const bool lockTextures, const bool invertOrientation);
 
             bool clip(Face& face);
@@ -22,6 +22,7 @@
 #include "Model/Face.h"
 #include "Utility/List.h"
 
+#include <algorithm>
 #include <map>
 #include <cstdio>
 
@@ -363,6 +364,13 @@ namespace TrenchBroom {
                          newEdge);
         }
 
+        void Side::flip() {
+            // the edges must already have their left and right sides swapped
+            std::reverse(edges.begin(), edges.end());
+            for (size_t i = 0; i < edges.size(); i++)
+                vertices[i] = edges[i]->startVertex(this);
+        }
+
         void Side::shift(size_t offset) {
             size_t count = edges.size();
             if (offset % count == 0)
@@ -1088,14 +1096,15 @@ namespace TrenchBroom {
             bounds = original.bounds;
         }
 
-        bool BrushGeometry::sanityCheck() {
+        bool BrushGeometry::sanityCheck(bool verbose) const {
             // check Euler characteristic http://en.wikipedia.org/wiki/Euler_characteristic
             unsigned int sideCount = 0;
             for (unsigned int i = 0; i < sides.size(); i++)
                 if (sides[i]->face != NULL)
                     sideCount++;
             if (vertices.size() - edges.size() + sideCount != 2) {
-                fprintf(stdout, "failed Euler check\n");
+                if (verbose)
+                    fprintf(stdout, "failed Euler check\n");
                 return false;
             }
 
@@ -1115,26 +1124,30 @@ namespace TrenchBroom {
                 for (unsigned int j = 0; j < side->edges.size(); j++) {
                     Edge* edge = side->edges[j];
                     if (edge->left != side && edge->right != side) {
-                        fprintf(stdout, "edge with index %u of side with index %u does not actually belong to it\n", j, i);
+                        if (verbose)
+                            fprintf(stdout, "edge with index %u of side with index %u does not actually belong to it\n", j, i);
                         return false;
                     }
 
                     size_t index = findElement(edges, edge);
                     if (index == edges.size()) {
-                        fprintf(stdout, "edge with index %u of side with index %u is missing from vertex data\n", j, i);
+                        if (verbose)
+                            fprintf(stdout, "edge with index %u of side with index %u is missing from vertex data\n", j, i);
                         return false;
                     }
                     eVisits[index]++;
 
                     Vertex* vertex = edge->startVertex(side);
                     if (side->vertices[j] != vertex) {
-                        fprintf(stdout, "start vertex of edge with index %u of side with index %u is not at position %u in the side's vertex list\n", j, i, j);
+                        if (verbose)
+                            fprintf(stdout, "start vertex of edge with index %u of side with index %u is not at position %u in the side's vertex list\n", j, i, j);
                         return false;
                     }
 
                     index = findElement(vertices, vertex);
                     if (index == vertices.size()) {
-                        fprintf(stdout, "start vertex of edge with index %u of side with index %u is missing from vertex data\n", j, i);
+                        if (verbose)
+                            fprintf(stdout, "start vertex of edge with index %u of side with index %u is missing from vertex data\n", j, i);
                         return false;
                     }
                     vVisits[index]++;
@@ -1143,30 +1156,35 @@ namespace TrenchBroom {
 
             for (unsigned int i = 0; i < vertices.size(); i++) {
                 if (vVisits[i] == 0) {
-                    fprintf(stdout, "vertex with index %u does not belong to any side\n", i);
+                    if (verbose)
+                        fprintf(stdout, "vertex with index %u does not belong to any side\n", i);
                     return false;
                 }
 
                 for (unsigned int j = i + 1; j < vertices.size(); j++)
                     if (vertices[i]->position.equals(vertices[j]->position)) {
-                        fprintf(stdout, "vertex with index %u is identical to vertex with index %u\n", i, j);
+                        if (verbose)
+                            fprintf(stdout, "vertex with index %u is identical to vertex with index %u\n", i, j);
                         return false;
                     }
             }
 
             for (unsigned int i = 0; i < edges.size(); i++) {
                 if (eVisits[i] != 2) {
-                    fprintf(stdout, "edge with index %u was visited %u times, should have been 2\n", i, eVisits[i]);
+                    if (verbose)
+                        fprintf(stdout, "edge with index %u was visited %u times, should have been 2\n", i, eVisits[i]);
                     return false;
                 }
 
                 if (edges[i]->start->position.equals(edges[i]->end->position)) {
-                    fprintf(stdout, "edge with index %u has almost identical vertices", i);
+                    if (verbose)
+                        fprintf(stdout, "edge with index %u has almost identical vertices", i);
                     return false;
                 }
                 
                 if (edges[i]->left == edges[i]->right) {
-                    fprintf(stdout, "edge with index %u has identical sides", i);
+                    if (verbose)
+                        fprintf(stdout, "edge with index %u has identical sides", i);
                     return false;
                 }
 
@@ -1175,7 +1193,8 @@ namespace TrenchBroom {
                     Edge* edge2 = edges[j];
                     if ((edge1->start == edge2->start && edge1->end == edge2->end) ||
                         (edge1->start == edge2->end && edge1->end == edge2->start)) {
-                        fprintf(stdout, "edge with index %u is identical to edge with index %u\n", i, j);
+                        if (verbose)
+                            fprintf(stdout, "edge with index %u is identical to edge with index %u\n", i, j);
                         return false;
                     }
                 }
@@ -1290,6 +1309,24 @@ namespace TrenchBroom {
             return true;
         }
 
+        void BrushGeometry::transform(const Mat4f& pointTransform, bool invertOrientation) {
+            for (size_t i = 0; i < vertices.size(); i++) {
+                Vertex& vertex = *vertices[i];
+                vertex.position = pointTransform * vertex.position;
+                vertex.position.correct();
+            }
+            
+            if (invertOrientation) {
+                for (size_t i = 0; i < edges.size(); i++)
+                    std::swap(edges[i]->left, edges[i]->right);
+                for (size_t i = 0; i < sides.size(); i++)
+                    sides[i]->flip();
+            }
+            
+            bounds = boundsOfVertices(vertices);
+            center = centerOfVertices(vertices);
+        }
+
         void BrushGeometry::restoreFaceSides() {
             for (unsigned int i = 0; i < sides.size(); i++)
                 sides[i]->face->setSide(sides[i]);
@@ -33,7 +33,7 @@ using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
     namespace Model {
-        class Vertex : public Utility::Allocator<Vertex> {
+        class Vertex : public Utility::Allocator<Vertex, Utility::MemoryCategory::BrushGeometry> {
         public:
             enum Mark {
                 Drop,
@@ -62,7 +62,7 @@ namespace TrenchBroom {
 
         class Side;
 
-        class Edge : public Utility::Allocator<Edge> {
+        class Edge : public Utility::Allocator<Edge, Utility::MemoryCategory::BrushGeometry> {
         public:
             enum Mark {
                 Drop,
@@ -228,7 +228,7 @@ namespace TrenchBroom {
 
         class Face;
 
-        class Side : public Utility::Allocator<Side> {
+        class Side : public Utility::Allocator<Side, Utility::MemoryCategory::BrushGeometry> {
         public:
             enum Mark {
                 Keep,
@@ -329,7 +329,6 @@ namespace TrenchBroom {
             Vertex* splitFace(Face* face, FaceManager& faceManager);
 
             void copy(const BrushGeometry& original);
-            bool sanityCheck();
         public:
             VertexList vertices;
             EdgeList edges;
@@ -343,7 +342,18 @@ namespace TrenchBroom {
             ~BrushGeometry();
 
             bool closed() const;
+            /*
+             Checks the consistency of the topology. If verbose, the first problem found is printed to stdout.
+             */
+            bool sanityCheck(bool verbose = true) const;
             void restoreFaceSides();
+            
+            /*
+             Applies the given transform to the vertices without changing the topology. This is only valid for
+             transforms which map the brush onto itself exactly, such as translations, rotations by multiples of 90
+             degrees and mirrors. If the transform is a mirror, the orientation of all sides is inverted.
+             */
+            void transform(const Mat4f& pointTransform, bool invertOrientation);
 
             CutResult addFace(Face& face, FaceSet& droppedFaces);
             bool addFaces(const FaceList& faces, FaceSet& droppedFaces);
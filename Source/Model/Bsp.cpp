@@ -21,6 +21,7 @@
 
 #include "IO/IOUtils.h"
 #include "Utility/List.h"
+#include "Utility/MemoryStats.h"
 
 #include <cmath>
 #include <cstring>
@@ -152,7 +153,8 @@ namespace TrenchBroom {
         }
 
         Bsp::Bsp(const String& name, char* begin, char* end) :
-        m_name(name) {
+        m_name(name),
+        m_memorySize(sizeof(Bsp)) {
             using namespace IO;
             
             char* cursor = begin;
@@ -274,10 +276,17 @@ namespace TrenchBroom {
 
                 BspModel* bspModel = new BspModel(bspFaces, totalVertexCount, center, bounds);
                 m_models.push_back(bspModel);
+                m_memorySize += sizeof(BspModel) + bspFaces.size() * sizeof(BspFace) + totalVertexCount * sizeof(Vec3f);
             }
+            
+            for (size_t i = 0; i < m_textures.size(); i++)
+                m_memorySize += sizeof(BspTexture) + m_textures[i]->width() * m_textures[i]->height();
+            m_memorySize += m_textureInfos.size() * sizeof(BspTextureInfo);
+            Utility::MemoryStats::stats().add(Utility::MemoryCategory::ModelCaches, m_memorySize);
         }
 
         Bsp::~Bsp() {
+            Utility::MemoryStats::stats().remove(Utility::MemoryCategory::ModelCaches, m_memorySize);
             Utility::deleteAll(m_textureInfos);
             Utility::deleteAll(m_textures);
             Utility::deleteAll(m_models);
@@ -285,25 +294,46 @@ namespace TrenchBroom {
 
         BspManager* BspManager::sharedManager = NULL;
 
+        String BspManager::key(const String& name, const StringList& paths) {
+            return Utility::join(paths, ",") + ":" + name;
+        }
+
         const Bsp* BspManager::bsp(const String& name, const StringList& paths, Utility::Console& console) {
-            String pathList = Utility::join(paths, ",");
-            String key = pathList + ":" + name;
+            const Bsp* cached = cachedBsp(name, paths);
+            if (cached != NULL)
+                return cached;
+
+            console.info("Loading '%s' (searching %s)", name.c_str(), Utility::join(paths, ",").c_str());
+
+            Bsp* bsp = loadBsp(name, paths);
+            if (bsp != NULL)
+                return addBsp(name, paths, bsp);
+
+            console.warn("Unable to find BSP '%s'", name.c_str());
+            return NULL;
+        }
 
-            BspMap::iterator it = m_bsps.find(key);
+        const Bsp* BspManager::cachedBsp(const String& name, const StringList& paths) const {
+            BspMap::const_iterator it = m_bsps.find(key(name, paths));
             if (it != m_bsps.end())
                 return it->second;
+            return NULL;
+        }
 
-            console.info("Loading '%s' (searching %s)", name.c_str(), pathList.c_str());
+        const Bsp* BspManager::addBsp(const String& name, const StringList& paths, Bsp* bsp) {
+            typedef std::pair<BspMap::iterator, bool> InsertResult;
 
-            IO::MappedFile::Ptr file = IO::findGameFile(name, paths);
-            if (file.get() != NULL) {
-                Bsp* bsp = new Bsp(name, file->begin(), file->end());
-                m_bsps[key] = bsp;
-                return bsp;
-            }
+            InsertResult result = m_bsps.insert(BspMap::value_type(key(name, paths), bsp));
+            if (!result.second) // loaded twice, keep the first one
+                delete bsp;
+            return result.first->second;
+        }
 
-            console.warn("Unable to find BSP '%s'", name.c_str());
-            return NULL;
+        Bsp* BspManager::loadBsp(const String& name, const StringList& paths) {
+            IO::MappedFile::Ptr file = IO::findGameFile(name, paths);
+            if (file.get() == NULL)
+                return NULL;
+            return new Bsp(name, file->begin(), file->end());
         }
 
         BspManager::BspManager() {}
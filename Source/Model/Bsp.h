@@ -189,6 +189,7 @@ namespace TrenchBroom {
             BspModelList m_models;
             BspTextureList m_textures;
             BspTextureInfoList m_textureInfos;
+            size_t m_memorySize;
 
             void readTextures(char*& cursor, unsigned int count);
             void readTextureInfos(char*& cursor, unsigned int count, BspTextureList& textures);
@@ -210,6 +211,8 @@ namespace TrenchBroom {
             typedef std::map<String, Bsp*> BspMap;
             
             BspMap m_bsps;
+
+            static String key(const String& name, const StringList& paths);
         public:
             static BspManager* sharedManager;
             
@@ -217,6 +220,11 @@ namespace TrenchBroom {
             ~BspManager();
 
             const Bsp* bsp(const String& name, const StringList& paths, Utility::Console& console);
+
+            // see AliasManager
+            const Bsp* cachedBsp(const String& name, const StringList& paths) const;
+            const Bsp* addBsp(const String& name, const StringList& paths, Bsp* bsp);
+            static Bsp* loadBsp(const String& name, const StringList& paths);
         };
     }
 }
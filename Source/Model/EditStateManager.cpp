@@ -22,32 +22,28 @@
 #include "Model/Brush.h"
 #include "Model/Entity.h"
 #include "Model/Face.h"
-#include "Utility/List.h"
+
+#include <algorithm>
+#include <functional>
 
 namespace TrenchBroom {
     namespace Model {
         bool EditStateManager::doSetEditState(const EntityList& entities, EditState::Type newState, EditStateChangeSet& changeSet) {
             bool changed = false;
             
-            for (unsigned int i = 0; i < entities.size(); i++) {
-                Entity& entity = *entities[i];
+            EntityList::const_iterator it, end;
+            for (it = entities.begin(), end = entities.end(); it != end; ++it) {
+                Entity& entity = **it;
                 if (entity.editState() != newState) {
                     EditState::Type previousState = entity.setEditState(newState);
-                    changeSet.addEntity(previousState, entity);
-                    
-                    if (previousState == EditState::Selected)
-                        Utility::erase(current().selectedEntities, &entity);
-                    else if (previousState == EditState::Hidden)
-                        Utility::erase(current().hiddenEntities, &entity);
-                    else if (previousState == EditState::Locked)
-                        Utility::erase(current().lockedEntities, &entity);
+                    if (previousState == entity.editState())
+                        continue;
                     
-                    if (newState == EditState::Selected)
-                        current().selectedEntities.push_back(&entity);
-                    else if (newState == EditState::Hidden)
-                        current().hiddenEntities.push_back(&entity);
-                    else if (newState == EditState::Locked)
-                        current().lockedEntities.push_back(&entity);
+                    changeSet.addEntity(previousState, entity);
+                    if (EntityList* previousList = current().entities(previousState))
+                        removeFromList(*previousList, entity);
+                    if (EntityList* newList = current().entities(entity.editState()))
+                        addToList(*newList, entity);
                     changed = true;
                 }
             }
@@ -58,25 +54,19 @@ namespace TrenchBroom {
         bool EditStateManager::doSetEditState(const BrushList& brushes, EditState::Type newState, EditStateChangeSet& changeSet) {
             bool changed = false;
             
-            for (unsigned int i = 0; i < brushes.size(); i++) {
-                Brush& brush = *brushes[i];
+            BrushList::const_iterator it, end;
+            for (it = brushes.begin(), end = brushes.end(); it != end; ++it) {
+                Brush& brush = **it;
                 if (brush.editState() != newState) {
                     EditState::Type previousState = brush.setEditState(newState);
-                    changeSet.addBrush(previousState, brush);
+                    if (previousState == brush.editState())
+                        continue;
                     
-                    if (previousState == EditState::Selected)
-                        Utility::erase(current().selectedBrushes, &brush);
-                    else if (previousState == EditState::Hidden)
-                        Utility::erase(current().hiddenBrushes, &brush);
-                    else if (previousState == EditState::Locked)
-                        Utility::erase(current().lockedBrushes, &brush);
-                    
-                    if (newState == EditState::Selected)
-                        current().selectedBrushes.push_back(&brush);
-                    else if (newState == EditState::Hidden)
-                        current().hiddenBrushes.push_back(&brush);
-                    else if (newState == EditState::Locked)
-                        current().lockedBrushes.push_back(&brush);
+                    changeSet.addBrush(previousState, brush);
+                    if (BrushList* previousList = current().brushes(previousState))
+                        removeFromList(*previousList, brush);
+                    if (BrushList* newList = current().brushes(brush.editState()))
+                        addToList(*newList, brush);
                     changed = true;
                 }
             }
@@ -85,69 +75,82 @@ namespace TrenchBroom {
         }
         
         bool EditStateManager::doSetSelected(const FaceList& faces, bool newState, EditStateChangeSet& changeSet) {
+            FaceList& selectedFaces = current().selectedFaces;
             bool changed = false;
+            
             for (unsigned int i = 0; i < faces.size(); i++) {
                 Face& face = *faces[i];
                 if (face.selected() != newState) {
                     if (newState)
-                        current().selectedFaces.push_back(&face);
-                    else
-                        Utility::erase(current().selectedFaces, &face);
+                        selectedFaces.push_back(&face);
                     face.setSelected(newState);
                     changeSet.addFace(!newState, face);
                     changed = true;
                 }
             }
+            
+            // remove all deselected faces in a single pass
+            if (changed && !newState)
+                selectedFaces.erase(std::remove_if(selectedFaces.begin(), selectedFaces.end(), std::not1(std::mem_fun(&Face::selected))), selectedFaces.end());
             return changed;
         }
 
         void EditStateManager::setDefaultAndClear(EntityList& entities, EditStateChangeSet& changeSet, const EntityList& except) {
-            if (except.empty()) {
-                EntityList::iterator it, end;
-                for (it = entities.begin(), end = entities.end(); it != end; ++it) {
-                    Entity& entity = **it;
-                    EditState::Type previousState = entity.setEditState(EditState::Default);
-                    changeSet.addEntity(previousState, entity);
-                }
-                entities.clear();
-            } else {
-                EntityList::iterator it = entities.begin();
-                while (it != entities.end()) {
-                    Entity& entity = **it;
-                    if (std::find(except.begin(), except.end(), &entity) == except.end()) {
-                        EditState::Type previousState = entity.setEditState(EditState::Default);
-                        changeSet.addEntity(previousState, entity);
-                        it = entities.erase(it);
-                    } else {
-                        ++it;
-                    }
+            // take the exceptions out of the list so that the remaining entities can be reset in one pass
+            EntityList keep;
+            EntityList::const_iterator exceptIt, exceptEnd;
+            for (exceptIt = except.begin(), exceptEnd = except.end(); exceptIt != exceptEnd; ++exceptIt) {
+                Entity& entity = **exceptIt;
+                if (listContains(entities, entity)) {
+                    removeFromList(entities, entity);
+                    keep.push_back(&entity);
                 }
             }
+            
+            EntityList::iterator it, end;
+            for (it = entities.begin(), end = entities.end(); it != end; ++it) {
+                Entity& entity = **it;
+                EditState::Type previousState = entity.setEditState(EditState::Default);
+                changeSet.addEntity(previousState, entity);
+                
+                // previously locked entities become locked again when they are unhidden
+                EntityList* newList = current().entities(entity.editState());
+                if (newList != NULL && newList != &entities)
+                    addToList(*newList, entity);
+            }
+            entities.clear();
+            
+            for (it = keep.begin(), end = keep.end(); it != end; ++it)
+                addToList(entities, **it);
         }
         
         void EditStateManager::setDefaultAndClear(BrushList& brushes, EditStateChangeSet& changeSet, const BrushList& except) {
-            if (except.empty()) {
-                BrushList::iterator it, end;
-                for (it = brushes.begin(), end = brushes.end(); it != end; ++it) {
-                    Brush& brush = **it;
-                    EditState::Type previousState = brush.setEditState(EditState::Default);
-                    changeSet.addBrush(previousState, brush);
-                }
-                brushes.clear();
-            } else {
-                BrushList::iterator it = brushes.begin();
-                while (it != brushes.end()) {
-                    Brush& brush = **it;
-                    if (std::find(except.begin(), except.end(), &brush) == except.end()) {
-                        EditState::Type previousState = brush.setEditState(EditState::Default);
-                        changeSet.addBrush(previousState, brush);
-                        it = brushes.erase(it);
-                    } else {
-                        ++it;
-                    }
+            // take the exceptions out of the list so that the remaining brushes can be reset in one pass
+            BrushList keep;
+            BrushList::const_iterator exceptIt, exceptEnd;
+            for (exceptIt = except.begin(), exceptEnd = except.end(); exceptIt != exceptEnd; ++exceptIt) {
+                Brush& brush = **exceptIt;
+                if (listContains(brushes, brush)) {
+                    removeFromList(brushes, brush);
+                    keep.push_back(&brush);
                 }
             }
             
+            BrushList::iterator it, end;
+            for (it = brushes.begin(), end = brushes.end(); it != end; ++it) {
+                Brush& brush = **it;
+                EditState::Type previousState = brush.setEditState(EditState::Default);
+                changeSet.addBrush(previousState, brush);
+                
+                // previously locked brushes become locked again when they are unhidden
+                BrushList* newList = current().brushes(brush.editState());
+                if (newList != NULL && newList != &brushes)
+                    addToList(*newList, brush);
+            }
+            brushes.clear();
+            
+            for (it = keep.begin(), end = keep.end(); it != end; ++it)
+                addToList(brushes, **it);
         }
         
         void EditStateManager::deselectAndClear(FaceList& faces, EditStateChangeSet& changeSet) {
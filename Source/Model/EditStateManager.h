@@ -73,6 +73,32 @@ namespace TrenchBroom {
                     return SMNone;
                 }
                 
+                inline EntityList* entities(EditState::Type state) {
+                    switch (state) {
+                        case EditState::Selected:
+                            return &selectedEntities;
+                        case EditState::Hidden:
+                            return &hiddenEntities;
+                        case EditState::Locked:
+                            return &lockedEntities;
+                        default:
+                            return NULL;
+                    }
+                }
+                
+                inline BrushList* brushes(EditState::Type state) {
+                    switch (state) {
+                        case EditState::Selected:
+                            return &selectedBrushes;
+                        case EditState::Hidden:
+                            return &hiddenBrushes;
+                        case EditState::Locked:
+                            return &lockedBrushes;
+                        default:
+                            return NULL;
+                    }
+                }
+                
                 inline void clear() {
                     selectedEntities.clear();
                     hiddenEntities.clear();
@@ -95,6 +121,33 @@ namespace TrenchBroom {
                 return m_states.back();
             }
             
+            /*
+             Every object remembers its position in the list of its current state, so that it can be
+             removed from that list in constant time by moving the last element into its slot.
+             */
+            template <typename T>
+            inline void addToList(std::vector<T*>& list, T& object) {
+                object.setEditStateIndex(list.size());
+                list.push_back(&object);
+            }
+            
+            template <typename T>
+            inline void removeFromList(std::vector<T*>& list, T& object) {
+                const size_t index = object.editStateIndex();
+                assert(index < list.size() && list[index] == &object);
+                
+                T* last = list.back();
+                list[index] = last;
+                last->setEditStateIndex(index);
+                list.pop_back();
+            }
+            
+            template <typename T>
+            inline bool listContains(const std::vector<T*>& list, const T& object) const {
+                const size_t index = object.editStateIndex();
+                return index < list.size() && list[index] == &object;
+            }
+            
             bool doSetEditState(const EntityList& entities, EditState::Type newState, EditStateChangeSet& changeSet);
             bool doSetEditState(const BrushList& brushes, EditState::Type newState, EditStateChangeSet& changeSet);
             bool doSetSelected(const FaceList& faces, bool newState, EditStateChangeSet& changeSet);
@@ -110,6 +110,8 @@ namespace TrenchBroom {
                     it = m_linkTargets.erase(it);
                     continue;
                 }
+                
+                ++it;
             }
         }
         
@@ -140,6 +142,8 @@ namespace TrenchBroom {
                     it = m_killTargets.erase(it);
                     continue;
                 }
+                
+                ++it;
             }
         }
         
@@ -244,22 +248,44 @@ namespace TrenchBroom {
         void Entity::init() {
             m_map = NULL;
             m_worldspawn = false;
+            m_trigger = false;
             m_definition = NULL;
             setEditState(EditState::Default);
+            m_removedBrushCount = 0;
             m_selectedBrushCount = 0;
             m_hiddenBrushCount = 0;
+            m_fileOffset = 0;
+            m_fileLength = 0;
             setProperty(SpawnFlagsKey, "0");
             invalidateGeometry();
         }
 
+        void Entity::compactBrushes() const {
+            size_t count = 0;
+            for (size_t i = 0; i < m_brushes.size(); i++) {
+                Brush* brush = m_brushes[i];
+                if (brush != NULL) {
+                    brush->setEntityIndex(count);
+                    m_brushes[count++] = brush;
+                }
+            }
+            m_brushes.resize(count);
+            m_removedBrushCount = 0;
+        }
+
+        bool Entity::brushBoundsEnabled() const {
+            return m_definition == NULL || m_definition->type() == EntityDefinition::BrushEntity;
+        }
+        
         void Entity::validateGeometry() const {
             assert(!m_geometryValid);
             
-            if (m_definition == NULL || m_definition->type() == EntityDefinition::BrushEntity) {
-                if (!m_brushes.empty()) {
-                    m_bounds = m_brushes[0]->bounds();
-                    for (unsigned int i = 1; i < m_brushes.size(); i++)
-                        m_bounds.mergeWith(m_brushes[i]->bounds());
+            if (brushBoundsEnabled()) {
+                const BrushList& brushList = brushes();
+                if (!brushList.empty()) {
+                    m_bounds = brushList[0]->bounds();
+                    for (unsigned int i = 1; i < brushList.size(); i++)
+                        m_bounds.mergeWith(brushList[i]->bounds());
                 } else {
                     m_bounds = BBoxf(Vec3f(-8, -8, -8), Vec3f(8, 8, 8));
                     m_bounds.translate(origin());
@@ -299,7 +325,7 @@ namespace TrenchBroom {
                         // spotlight with target, don't modify
                     }
                 } else {
-                    bool brushEntity = !m_brushes.empty() || (m_definition != NULL && m_definition->type() == EntityDefinition::BrushEntity);
+                    bool brushEntity = brushCount() > 0 || (m_definition != NULL && m_definition->type() == EntityDefinition::BrushEntity);
                     if (brushEntity) {
                         if (propertyForKey(AnglesKey) != NULL) {
                             type = RTEulerAngles;
@@ -456,6 +482,19 @@ namespace TrenchBroom {
             removeAllLinkSources();
             removeAllKillSources();
             
+            const BrushList& brushList = brushes();
+            BrushList::const_iterator brushIt, brushEnd;
+            for (brushIt = brushList.begin(), brushEnd = brushList.end(); brushIt != brushEnd; ++brushIt) {
+                const FaceList& faces = (*brushIt)->faces();
+                FaceList::const_iterator faceIt, faceEnd;
+                for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt) {
+                    if (m_map != NULL)
+                        m_map->removeFace(**faceIt);
+                    if (map != NULL)
+                        map->addFace(**faceIt);
+                }
+            }
+            
             m_map = map;
             
             addAllLinkTargets();
@@ -499,9 +538,9 @@ namespace TrenchBroom {
         }
 
         void Entity::renameProperty(const PropertyKey& oldKey, const PropertyKey& newKey) {
-            const PropertyValue* value = propertyForKey(oldKey);
+            const PropertyValue value = *propertyForKey(oldKey);
             removeProperty(oldKey);
-            setProperty(newKey, *value);
+            setProperty(newKey, value);
         }
         
         void Entity::removeProperty(const PropertyKey& key) {
@@ -514,6 +553,12 @@ namespace TrenchBroom {
         
         void Entity::setProperties(const PropertyList& properties, bool replace) {
             if (replace) {
+                if (m_map != NULL) {
+                    const PropertyList& oldProperties = m_propertyStore.properties();
+                    PropertyList::const_iterator it, end;
+                    for (it = oldProperties.begin(), end = oldProperties.end(); it != end; ++it)
+                        m_map->updateEntityProperty(*this, it->key(), NULL, &it->value());
+                }
                 m_propertyStore.clear();
                 setProperty(SpawnFlagsKey, "0");
             }
@@ -558,6 +603,7 @@ namespace TrenchBroom {
             
             if (key == ClassnameKey && value != classname()) {
                 m_worldspawn = *value == WorldspawnClassname;
+                m_trigger = Utility::startsWith(*value, "trigger_");
                 setDefinition(NULL);
             }
             
@@ -586,11 +632,15 @@ namespace TrenchBroom {
                     m_map->updateEntityTargetname(*this, value, oldValue);
             }
             
+            if (m_map != NULL)
+                m_map->updateEntityProperty(*this, key, value, oldValue);
+            
             if (value == NULL)
                 m_propertyStore.removeProperty(key);
             else
                 m_propertyStore.setPropertyValue(key, *value);
             invalidateGeometry();
+            invalidateFileRange();
         }
         
         StringList Entity::linkTargetnames() const {
@@ -655,23 +705,41 @@ namespace TrenchBroom {
 
         void Entity::addBrush(Brush& brush) {
             brush.setEntity(this);
+            
+            // grow the bounds instead of merging the bounds of all brushes again
+            if (m_geometryValid && brushBoundsEnabled() && brushCount() > 0) {
+                m_bounds.mergeWith(brush.bounds());
+                m_center = m_bounds.center();
+            } else {
+                invalidateGeometry();
+            }
+            
+            brush.setEntityIndex(m_brushes.size());
             m_brushes.push_back(&brush);
-            invalidateGeometry();
+            invalidateFileRange();
         }
         
         void Entity::addBrushes(const BrushList& brushes) {
-            for (unsigned int i = 0; i < brushes.size(); i++) {
-                Model::Brush* brush = brushes[i];
-                brush->setEntity(this);
-                m_brushes.push_back(brush);
-            }
-            invalidateGeometry();
+            for (unsigned int i = 0; i < brushes.size(); i++)
+                addBrush(*brushes[i]);
         }
         
         void Entity::removeBrush(Brush& brush) {
+            assert(brush.entity() == this);
+            assert(brush.entityIndex() < m_brushes.size() && m_brushes[brush.entityIndex()] == &brush);
+            
+            // the bounds only shrink if the brush touches them
+            if (m_geometryValid && brushBoundsEnabled()) {
+                const BBoxf& brushBounds = brush.bounds();
+                for (unsigned int i = 0; i < 3 && m_geometryValid; i++)
+                    if (brushBounds.min[i] <= m_bounds.min[i] || brushBounds.max[i] >= m_bounds.max[i])
+                        invalidateGeometry();
+            }
+            
+            m_brushes[brush.entityIndex()] = NULL;
+            m_removedBrushCount++;
             brush.setEntity(NULL);
-            m_brushes.erase(std::remove(m_brushes.begin(), m_brushes.end(), &brush), m_brushes.end());
-            invalidateGeometry();
+            invalidateFileRange();
         }
 
         void Entity::setDefinition(EntityDefinition* definition) {
@@ -684,7 +752,7 @@ namespace TrenchBroom {
         }
 
         bool Entity::selectable() const {
-            return m_brushes.empty();
+            return brushCount() == 0;
         }
 
         EditState::Type Entity::setEditState(EditState::Type editState) {
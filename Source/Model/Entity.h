@@ -38,7 +38,7 @@ namespace TrenchBroom {
         class EntityDefinition;
         class Map;
 
-        class Entity : public MapObject, public Utility::Allocator<Entity> {
+        class Entity : public MapObject, public Utility::Allocator<Entity, Utility::MemoryCategory::Entities> {
         public:
             static String const ClassnameKey;
             static String const NoClassnameValue;
@@ -75,8 +75,15 @@ namespace TrenchBroom {
         protected:
             Map* m_map;
             PropertyStore m_propertyStore;
-            BrushList m_brushes;
+            
+            /*
+             Removed brushes leave an empty slot behind which is compacted away the next time the brush list is
+             requested, so that removing many brushes does not shift the list once per brush.
+             */
+            mutable BrushList m_brushes;
+            mutable size_t m_removedBrushCount;
             bool m_worldspawn;
+            bool m_trigger;
 
             EntityDefinition* m_definition;
 
@@ -89,6 +96,9 @@ namespace TrenchBroom {
             mutable Vec3f m_center;
             mutable bool m_geometryValid;
 
+            size_t m_fileOffset;
+            size_t m_fileLength;
+
             EntityList m_linkTargets;
             EntityList m_linkSources;
             EntityList m_killTargets;
@@ -119,7 +129,9 @@ namespace TrenchBroom {
             void removeAllKillSources();
 
             void init();
+            void compactBrushes() const;
             void validateGeometry() const;
+            bool brushBoundsEnabled() const;
 
             typedef enum {
                 RTNone,
@@ -209,6 +221,10 @@ namespace TrenchBroom {
                 return m_worldspawn;
             }
 
+            inline bool trigger() const {
+                return m_trigger;
+            }
+
             inline const Vec3f origin() const {
                 const PropertyValue* value = propertyForKey(OriginKey);
                 if (value == NULL)
@@ -234,8 +250,14 @@ namespace TrenchBroom {
             const Quatf rotation() const;
 
             inline const BrushList& brushes() const {
+                if (m_removedBrushCount > 0)
+                    compactBrushes();
                 return m_brushes;
             }
+            
+            inline size_t brushCount() const {
+                return m_brushes.size() - m_removedBrushCount;
+            }
 
             void addBrush(Brush& brush);
             void addBrushes(const BrushList& brushes);
@@ -262,7 +284,7 @@ namespace TrenchBroom {
             }
 
             inline bool fullyHidden() const {
-                return !m_brushes.empty() && m_hiddenBrushCount == m_brushes.size();
+                return brushCount() > 0 && m_hiddenBrushCount == brushCount();
             }
 
             inline void incHiddenBrushCount() {
@@ -295,6 +317,32 @@ namespace TrenchBroom {
                 m_geometryValid = false;
             }
 
+            /*
+             The range of bytes this entity occupies in the map file it was loaded from or last saved to. Any change to
+             the entity, its brushes or their faces invalidates the range, and the map writer copies the original text of
+             every entity whose range is still valid instead of serializing it again.
+             */
+            inline bool hasFileRange() const {
+                return m_fileLength > 0;
+            }
+
+            inline size_t fileOffset() const {
+                return m_fileOffset;
+            }
+
+            inline size_t fileLength() const {
+                return m_fileLength;
+            }
+
+            inline void setFileRange(size_t offset, size_t length) {
+                m_fileOffset = offset;
+                m_fileLength = length;
+            }
+
+            inline void invalidateFileRange() {
+                m_fileLength = 0;
+            }
+
             void transform(const Mat4f& pointTransform, const Mat4f& vectorTransform, const bool lockTextures, const bool invertOrientation);
             void pick(const Rayf& ray, PickResult& pickResults);
         };
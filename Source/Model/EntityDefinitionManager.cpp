@@ -25,7 +25,6 @@
 #include "Utility/Color.h"
 #include "Utility/Console.h"
 #include "Utility/Map.h"
-#include "Utility/Preferences.h"
 #include "Utility/String.h"
 
 #include <algorithm>
@@ -56,9 +55,7 @@ namespace TrenchBroom {
             return result;
         }
 
-        void EntityDefinitionManager::load(const String& path) {
-            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
-            const Color& defaultColor = prefs.getColor(Preferences::EntityBoundsColor);
+        void EntityDefinitionManager::load(const String& path, const Color& defaultColor) {
             EntityDefinitionMap newDefinitions;
             
             IO::FileManager fileManager;
@@ -21,6 +21,7 @@
 
 #include "Model/EntityDefinitionTypes.h"
 #include "Model/EntityDefinition.h"
+#include "Utility/Color.h"
 #include "Utility/String.h"
 
 #include <map>
@@ -76,7 +77,7 @@ namespace TrenchBroom {
             
             static StringList builtinDefinitionFiles();
             
-            void load(const String& path);
+            void load(const String& path, const Color& defaultColor);
             void clear();
             
             EntityDefinition* definition(const String& name);
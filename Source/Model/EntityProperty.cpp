@@ -19,6 +19,8 @@
 
 #include "EntityProperty.h"
 
+#include "Utility/MemoryStats.h"
+
 #include <cassert>
 
 namespace TrenchBroom {
@@ -35,6 +37,29 @@ namespace TrenchBroom {
             return false;
         }
 
+        PropertyStore::PropertyStore() :
+        m_memorySize(0) {}
+        
+        PropertyStore::PropertyStore(const PropertyStore& other) :
+        m_properties(other.m_properties),
+        m_memorySize(other.m_memorySize) {
+            Utility::MemoryStats::stats().add(Utility::MemoryCategory::EntityProperties, m_memorySize, m_properties.size());
+        }
+        
+        PropertyStore::~PropertyStore() {
+            clear();
+        }
+        
+        PropertyStore& PropertyStore::operator=(const PropertyStore& other) {
+            if (this != &other) {
+                clear();
+                m_properties = other.m_properties;
+                m_memorySize = other.m_memorySize;
+                Utility::MemoryStats::stats().add(Utility::MemoryCategory::EntityProperties, m_memorySize, m_properties.size());
+            }
+            return *this;
+        }
+
         bool PropertyStore::setPropertyKey(const PropertyKey& oldKey, const PropertyKey& newKey) {
             if (containsProperty(newKey))
                 return false;
@@ -43,6 +68,9 @@ namespace TrenchBroom {
             for (it = m_properties.begin(), end = m_properties.end(); it != end; ++it) {
                 Property& property = *it;
                 if (property.key() == oldKey) {
+                    const size_t newSize = m_memorySize - oldKey.size() + newKey.size();
+                    Utility::MemoryStats::stats().resize(Utility::MemoryCategory::EntityProperties, m_memorySize, newSize);
+                    m_memorySize = newSize;
                     property.setKey(newKey);
                     assert(!hasDuplicates());
                     return true;
@@ -57,11 +85,17 @@ namespace TrenchBroom {
             for (it = m_properties.begin(), end = m_properties.end(); it != end; ++it) {
                 Property& property = *it;
                 if (property.key() == key) {
+                    const size_t newSize = m_memorySize - property.value().size() + value.size();
+                    Utility::MemoryStats::stats().resize(Utility::MemoryCategory::EntityProperties, m_memorySize, newSize);
+                    m_memorySize = newSize;
                     property.setValue(value);
                     return;
                 }
             }
             
+            const size_t propertySize = memorySize(key, value);
+            Utility::MemoryStats::stats().add(Utility::MemoryCategory::EntityProperties, propertySize);
+            m_memorySize += propertySize;
             m_properties.push_back(Property(key, value));
             assert(!hasDuplicates());
         }
@@ -71,6 +105,9 @@ namespace TrenchBroom {
             for (it = m_properties.begin(), end = m_properties.end(); it != end; ++it) {
                 Property& property = *it;
                 if (property.key() == key) {
+                    const size_t propertySize = memorySize(property.key(), property.value());
+                    Utility::MemoryStats::stats().remove(Utility::MemoryCategory::EntityProperties, propertySize);
+                    m_memorySize -= propertySize;
                     m_properties.erase(it);
                     return true;
                 }
@@ -80,6 +117,8 @@ namespace TrenchBroom {
         }
 
         void PropertyStore::clear() {
+            Utility::MemoryStats::stats().remove(Utility::MemoryCategory::EntityProperties, m_memorySize, m_properties.size());
+            m_memorySize = 0;
             m_properties.clear();
         }
     }
@@ -72,9 +72,20 @@ namespace TrenchBroom {
         class PropertyStore {
         private:
             PropertyList m_properties;
+            size_t m_memorySize;
             
             bool hasDuplicates() const;
+            
+            static inline size_t memorySize(const PropertyKey& key, const PropertyValue& value) {
+                return sizeof(Property) + key.size() + value.size();
+            }
         public:
+            PropertyStore();
+            PropertyStore(const PropertyStore& other);
+            ~PropertyStore();
+            
+            PropertyStore& operator=(const PropertyStore& other);
+            
             inline bool containsProperty(const PropertyKey& key) const {
                 PropertyList::const_iterator it, end;
                 for (it = m_properties.begin(), end = m_properties.end(); it != end; ++it) {
@@ -21,7 +21,10 @@
 
 #include "Model/Brush.h"
 #include "Model/BrushGeometry.h"
+#include "Model/Entity.h"
+#include "Model/Map.h"
 #include "Model/Texture.h"
+#include "Utility/Atomic.h"
 
 namespace TrenchBroom {
     namespace Model {
@@ -30,9 +33,15 @@ namespace TrenchBroom {
             findPoints(face.boundary(), points, numPoints);
         }
 
+        // the integer finder of the calling thread, if it has one
+        static TB_THREAD_LOCAL const FindIntegerFacePoints* CurrentThreadFindIntegerFacePoints = NULL;
+
         const FindFacePoints& FindFacePoints::instance(bool forceIntegerCoordinates) {
-            if (forceIntegerCoordinates)
+            if (forceIntegerCoordinates) {
+                if (CurrentThreadFindIntegerFacePoints != NULL)
+                    return *CurrentThreadFindIntegerFacePoints;
                 return FindIntegerFacePoints::Instance;
+            }
             return FindFloatFacePoints::Instance;
         }
 
@@ -77,6 +86,15 @@ namespace TrenchBroom {
 
         const FindIntegerFacePoints FindIntegerFacePoints::Instance = FindIntegerFacePoints();
 
+        ThreadFindFacePoints::ThreadFindFacePoints() :
+        m_previous(CurrentThreadFindIntegerFacePoints) {
+            CurrentThreadFindIntegerFacePoints = &m_findIntegerPoints;
+        }
+
+        ThreadFindFacePoints::~ThreadFindFacePoints() {
+            CurrentThreadFindIntegerFacePoints = m_previous;
+        }
+
         inline size_t FindFloatFacePoints::selectInitialPoints(const Face& face, FacePoints& points) const {
             face.getPoints(points[0], points[1], points[2]);
             return 3;
@@ -98,8 +116,9 @@ namespace TrenchBroom {
         };
         
         void Face::init() {
-            static unsigned int currentId = 1;
-            m_faceId = currentId++;
+            // faces are also created on the map loader thread
+            static volatile long long currentId = 0;
+            m_faceId = static_cast<unsigned int>(Utility::atomicAdd(&currentId, 1));
             for (size_t i = 0; i < 3; i++)
                 m_points[i] = Vec3f::Null;
             m_xOffset = 0.0f;
@@ -112,7 +131,6 @@ namespace TrenchBroom {
             m_filePosition = 0;
             m_selected = false;
             m_texAxesValid = false;
-            m_vertexCacheValid = false;
             m_contentType = CTDefault;
         }
         
@@ -159,41 +177,6 @@ namespace TrenchBroom {
             }
         }
 
-        void Face::validateVertexCache() const {
-            assert(m_side != NULL);
-            
-            if (!m_texAxesValid)
-                validateTexAxes(m_boundary.normal);
-            
-            unsigned int width = m_texture != NULL ? m_texture->width() : 1;
-            unsigned int height = m_texture != NULL ? m_texture->height() : 1;
-            
-            size_t vertexCount = m_side->vertices.size();
-            m_vertexCache.resize(3 * (vertexCount - 2));
-            
-            Vec2f texCoords;
-            size_t j = 0;
-            for (size_t i = 1; i < vertexCount - 1; i++) {
-                m_vertexCache[j++] = Renderer::FaceVertex(m_side->vertices[0]->position,
-                                                          m_boundary.normal,
-                                                          Vec2f((m_side->vertices[0]->position.dot(m_scaledTexAxisX) + m_xOffset) / width,
-                                                                (m_side->vertices[0]->position.dot(m_scaledTexAxisY) + m_yOffset) / height)
-                                                          );
-                m_vertexCache[j++] = Renderer::FaceVertex(m_side->vertices[i]->position,
-                                                          m_boundary.normal,
-                                                          Vec2f((m_side->vertices[i]->position.dot(m_scaledTexAxisX) + m_xOffset) / width,
-                                                                (m_side->vertices[i]->position.dot(m_scaledTexAxisY) + m_yOffset) / height)
-                                                          );
-                m_vertexCache[j++] = Renderer::FaceVertex(m_side->vertices[i+1]->position,
-                                                          m_boundary.normal,
-                                                          Vec2f((m_side->vertices[i+1]->position.dot(m_scaledTexAxisX) + m_xOffset) / width,
-                                                                (m_side->vertices[i+1]->position.dot(m_scaledTexAxisY) + m_yOffset) / height)
-                                                          );
-            }
-            
-            m_vertexCacheValid = true;
-        }
-        
         void Face::compensateTransformation(const Mat4f& transformation) {
             if (!m_texAxesValid)
                 validateTexAxes(m_boundary.normal);
@@ -332,6 +315,7 @@ namespace TrenchBroom {
         }
         
         void Face::updateContentType() {
+            const ContentType oldContentType = m_contentType;
             if (!m_textureName.empty()) {
                 if (m_textureName[0] == '*')
                     m_contentType = CTLiquid;
@@ -348,6 +332,9 @@ namespace TrenchBroom {
             } else {
                 m_contentType = CTDefault;
             }
+
+            if (m_contentType != oldContentType && m_brush != NULL)
+                m_brush->invalidateContentClass();
         }
 
         Face::Face(const BBoxf& worldBounds, bool forceIntegerFacePoints, const Vec3f& point1, const Vec3f& point2, const Vec3f& point3, const String& textureName) : m_worldBounds(worldBounds), m_textureName(textureName) {
@@ -383,7 +370,6 @@ namespace TrenchBroom {
         m_xScale(face.xScale()),
         m_yScale(face.yScale()),
         m_texAxesValid(false),
-        m_vertexCacheValid(false),
         m_filePosition(face.filePosition()),
         m_selected(false),
         m_contentType(face.contentType()) {
@@ -416,7 +402,6 @@ namespace TrenchBroom {
 			m_side = NULL;
 			m_filePosition = 0;
 			m_selected = false;
-			m_vertexCacheValid = false;
 			m_texAxesValid = false;
 		}
         
@@ -430,20 +415,59 @@ namespace TrenchBroom {
             m_yScale = faceTemplate.yScale();
             setTexture(faceTemplate.texture());
             m_texAxesValid = false;
-            m_vertexCacheValid = false;
 			m_selected = faceTemplate.selected();
             m_contentType = faceTemplate.contentType();
+            if (m_brush != NULL)
+                m_brush->invalidateContentClass();
+            invalidateFileRange();
         }
         
+        void Face::invalidateFileRange() {
+            if (m_brush != NULL)
+                m_brush->invalidateFileRange();
+        }
+
+        static inline Map* mapOf(const Brush* brush) {
+            if (brush == NULL || brush->entity() == NULL)
+                return NULL;
+            return brush->entity()->map();
+        }
+
         void Face::setBrush(Brush* brush) {
             if (brush == m_brush)
                 return;
             
-            if (m_brush != NULL && m_selected)
-                m_brush->decSelectedFaceCount();
+            Map* oldMap = mapOf(m_brush);
+            Map* newMap = mapOf(brush);
+            if (oldMap != newMap && oldMap != NULL)
+                oldMap->removeFace(*this);
+            
+            if (m_brush != NULL) {
+                if (m_selected)
+                    m_brush->decSelectedFaceCount();
+                m_brush->invalidateContentClass();
+            }
             m_brush = brush;
-            if (m_brush != NULL && m_selected)
-                m_brush->incSelectedFaceCount();
+            if (m_brush != NULL) {
+                if (m_selected)
+                    m_brush->incSelectedFaceCount();
+                m_brush->invalidateContentClass();
+            }
+            
+            if (oldMap != newMap && newMap != NULL)
+                newMap->addFace(*this);
+        }
+        
+        void Face::setTextureName(const String& textureName) {
+            Map* map = mapOf(m_brush);
+            if (map != NULL)
+                map->removeFace(*this);
+            m_textureName = textureName;
+            if (map != NULL)
+                map->addFace(*this);
+            
+            updateContentType();
+            invalidateFileRange();
         }
         
         void Face::updatePointsFromVertices() {
@@ -518,17 +542,24 @@ namespace TrenchBroom {
                 m_texture->decUsageCount();
             
             m_texture = texture;
-            if (m_texture != NULL)
+            if (m_texture != NULL && m_textureName != texture->name()) {
+                Map* map = mapOf(m_brush);
+                if (map != NULL)
+                    map->removeFace(*this);
                 m_textureName = texture->name();
+                if (map != NULL)
+                    map->addFace(*this);
+                invalidateFileRange();
+            }
             
             if (m_texture != NULL)
                 m_texture->incUsageCount();
-            m_vertexCacheValid = false;
             updateContentType();
         }
         
         void Face::moveTexture(const Vec3f& up, const Vec3f& right, Direction direction, float distance) {
             assert(direction != DForward && direction != DBackward);
+            invalidateFileRange();
             
             if (!m_texAxesValid)
                 validateTexAxes(m_boundary.normal);
@@ -625,7 +656,6 @@ namespace TrenchBroom {
                     return;
             }
             
-            m_vertexCacheValid = false;
         }
         
         void Face::rotateTexture(float angle) {
@@ -637,7 +667,7 @@ namespace TrenchBroom {
             else
                 m_rotation -= angle;
             m_texAxesValid = false;
-            m_vertexCacheValid = false;
+            invalidateFileRange();
         }
         
         void Face::setSelected(bool selected) {
@@ -668,7 +698,6 @@ namespace TrenchBroom {
                 correctFacePoints();
 
             m_texAxesValid = false;
-            m_vertexCacheValid = false;
         }
     }
 }
@@ -22,7 +22,6 @@
 
 #include "Model/BrushGeometry.h"
 #include "Model/FaceTypes.h"
-#include "Renderer/FaceVertex.h"
 #include "Utility/Allocator.h"
 #include "Utility/FindPlanePoints.h"
 #include "Utility/String.h"
@@ -57,6 +56,19 @@ namespace TrenchBroom {
             static const FindIntegerFacePoints Instance;
         };
 
+        /*
+         Gives the calling thread its own integer face point finder while this object exists. The plane point cache
+         of a finder is not synchronized, so a thread other than the main thread must hold one while it creates faces.
+         */
+        class ThreadFindFacePoints {
+        private:
+            FindIntegerFacePoints m_findIntegerPoints;
+            const FindIntegerFacePoints* m_previous;
+        public:
+            ThreadFindFacePoints();
+            ~ThreadFindFacePoints();
+        };
+
         class FindFloatFacePoints : public FindFacePoints {
         private:
             FindFloatPlanePoints m_findPoints;
@@ -67,7 +79,7 @@ namespace TrenchBroom {
             static const FindFloatFacePoints Instance;
         };
 
-        class Face : public Utility::Allocator<Face> {
+        class Face : public Utility::Allocator<Face, Utility::MemoryCategory::Brushes> {
         public:
             enum ContentType {
                 CTLiquid,
@@ -131,9 +143,6 @@ namespace TrenchBroom {
             mutable Vec3f m_scaledTexAxisX;
             mutable Vec3f m_scaledTexAxisY;
 
-            mutable bool m_vertexCacheValid;
-            mutable Renderer::FaceVertex::List m_vertexCache;
-
             size_t m_filePosition;
             bool m_selected;
             
@@ -149,7 +158,6 @@ namespace TrenchBroom {
             void init();
             void texAxesAndIndices(const Vec3f& faceNormal, Vec3f& xAxis, Vec3f& yAxis, unsigned int& planeNormIndex, unsigned int& faceNormIndex) const;
             void validateTexAxes(const Vec3f& faceNormal) const;
-            void validateVertexCache() const;
 
             void projectOntoTexturePlane(Vec3f& xAxis, Vec3f& yAxis);
             void compensateTransformation(const Mat4f& transformation);
@@ -235,10 +243,7 @@ namespace TrenchBroom {
                 return m_textureName;
             }
 
-            inline void setTextureName(const String& textureName) {
-                m_textureName = textureName;
-                updateContentType();
-            }
+            void setTextureName(const String& textureName);
 
             inline Texture* texture() const {
                 return m_texture;
@@ -254,7 +259,7 @@ namespace TrenchBroom {
                 if (xOffset == m_xOffset)
                     return;
                 m_xOffset = xOffset;
-                m_vertexCacheValid = false;
+                invalidateFileRange();
             }
 
             inline float yOffset() const {
@@ -265,7 +270,7 @@ namespace TrenchBroom {
                 if (yOffset == m_yOffset)
                     return;
                 m_yOffset = yOffset;
-                m_vertexCacheValid = false;
+                invalidateFileRange();
             }
 
             inline float rotation() const {
@@ -277,7 +282,7 @@ namespace TrenchBroom {
                     return;
                 m_rotation = rotation;
                 m_texAxesValid = false;
-                m_vertexCacheValid = false;
+                invalidateFileRange();
             }
 
             inline float xScale() const {
@@ -289,7 +294,7 @@ namespace TrenchBroom {
                     return;
                 m_xScale = xScale;
                 m_texAxesValid = false;
-                m_vertexCacheValid = false;
+                invalidateFileRange();
             }
 
             inline float yScale() const {
@@ -301,7 +306,7 @@ namespace TrenchBroom {
                     return;
                 m_yScale = yScale;
                 m_texAxesValid = false;
-                m_vertexCacheValid = false;
+                invalidateFileRange();
             }
 
             inline void setAttributes(const Face& face) {
@@ -318,17 +323,25 @@ namespace TrenchBroom {
                 m_texAxesValid = false;
             }
 
+            void invalidateFileRange();
+
             void moveTexture(const Vec3f& up, const Vec3f& right, Direction direction, float distance);
             void rotateTexture(float angle);
 
-            inline void invalidateVertexCache() {
-                m_vertexCacheValid = false;
+            /*
+             Returns the texture axes scaled by the inverse texture scale. The texture coordinates of a vertex are
+             ((v . scaledTexAxisX + xOffset) / textureWidth, (v . scaledTexAxisY + yOffset) / textureHeight).
+             */
+            inline const Vec3f& scaledTexAxisX() const {
+                if (!m_texAxesValid)
+                    validateTexAxes(m_boundary.normal);
+                return m_scaledTexAxisX;
             }
 
-            inline const Renderer::FaceVertex::List& cachedVertices() const {
-                if (!m_vertexCacheValid)
-                    validateVertexCache();
-                return m_vertexCache;
+            inline const Vec3f& scaledTexAxisY() const {
+                if (!m_texAxesValid)
+                    validateTexAxes(m_boundary.normal);
+                return m_scaledTexAxisY;
             }
 
             inline bool selected() const {
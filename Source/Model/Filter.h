@@ -24,6 +24,7 @@
 #include "Model/Entity.h"
 #include "Model/EntityDefinition.h"
 #include "Model/Face.h"
+#include "Model/VisibilityClass.h"
 #include "Utility/String.h"
 #include "View/ViewOptions.h"
 
@@ -56,6 +57,19 @@ namespace TrenchBroom {
 
             virtual bool brushVisible(const Model::Brush& brush) const = 0;
 
+            /*
+             The renderer batches brushes by their visibility classes and by whether they match this filter, so that
+             showing or hiding a class of brushes only enables or disables batches. A brush is visible if it matches,
+             none of its classes is hidden and brushes are shown at all.
+             */
+            virtual inline VisibilityClass::Type hiddenBrushClasses() const {
+                return VisibilityClass::None;
+            }
+
+            virtual inline bool brushMatches(const Model::Brush& brush) const {
+                return brushVisible(brush);
+            }
+
             virtual inline bool brushSelectable(const Model::Brush& brush) const {
                 if (brush.locked())
                     return false;
@@ -117,68 +131,45 @@ namespace TrenchBroom {
                 return entityVisible(entity);
             }
 
-            virtual inline bool brushVisible(const Model::Brush& brush) const {
-                if (!m_viewOptions.showBrushes() || brush.hidden())
+            virtual inline VisibilityClass::Type hiddenBrushClasses() const {
+                VisibilityClass::Type classes = VisibilityClass::None;
+                if (!m_viewOptions.showLiquidBrushes())
+                    classes |= VisibilityClass::Liquid;
+                if (!m_viewOptions.showClipBrushes())
+                    classes |= VisibilityClass::Clip;
+                if (!m_viewOptions.showSkipBrushes())
+                    classes |= VisibilityClass::Skip;
+                if (!m_viewOptions.showHintBrushes())
+                    classes |= VisibilityClass::Hint;
+                if (!m_viewOptions.showTriggerBrushes())
+                    classes |= VisibilityClass::Trigger;
+                return classes;
+            }
+
+            virtual inline bool brushMatches(const Model::Brush& brush) const {
+                if (brush.hidden())
                     return false;
 
                 const String& pattern = m_viewOptions.filterPattern();
-                if (!pattern.empty() ||
-                    !m_viewOptions.showClipBrushes() || !m_viewOptions.showSkipBrushes() ||
-                    !m_viewOptions.showHintBrushes() || !m_viewOptions.showLiquidBrushes() ||
-                    !m_viewOptions.showTriggerBrushes()) {
-                    
-                    if (!m_viewOptions.showTriggerBrushes()) {
-                        Model::Entity* entity = brush.entity();
-                        if (entity != NULL && Utility::startsWith(entity->safeClassname(), "trigger_"))
-                            return false;
-                    }
-                    
-                    const Model::FaceList& faces = brush.faces();
-                    unsigned int clipCount = 0;
-                    unsigned int skipCount = 0;
-                    unsigned int hintCount = 0;
-                    unsigned int liquidCount = 0;
-                    unsigned int triggerCount = 0;
-                    bool matches = pattern.empty();
-                    for (unsigned int i = 0; i < faces.size(); i++) {
-                        switch (faces[i]->contentType()) {
-                            case Face::CTLiquid:
-                                liquidCount++;
-                                break;
-                            case Face::CTClip:
-                                clipCount++;
-                                break;
-                            case Face::CTSkip:
-                                skipCount++;
-                                break;
-                            case Face::CTHint:
-                                hintCount++;
-                                break;
-                            case Face::CTTrigger:
-                                triggerCount++;
-                                break;
-                            default:
-                                if (!matches)
-                                    matches = Utility::containsString(faces[i]->textureName(), pattern, false);
-                                break;
-                        }
-                    }
+                if (pattern.empty())
+                    return true;
 
-                    if (!m_viewOptions.showClipBrushes() && clipCount == faces.size())
-                        return false;
-                    if (!m_viewOptions.showSkipBrushes() && skipCount == faces.size())
-                        return false;
-                    if (!m_viewOptions.showHintBrushes() && hintCount == faces.size())
-                        return false;
-                    if (!m_viewOptions.showLiquidBrushes() && liquidCount == faces.size())
-                        return false;
-                    if (!m_viewOptions.showTriggerBrushes() && triggerCount == faces.size())
-                        return false;
-
-                    return matches;
+                // faces with special content do not match the pattern by their texture name
+                const Model::FaceList& faces = brush.faces();
+                for (size_t i = 0; i < faces.size(); i++) {
+                    if (faces[i]->contentType() == Face::CTDefault &&
+                        Utility::containsString(faces[i]->textureName(), pattern, false))
+                        return true;
                 }
+                return false;
+            }
 
-                return true;
+            virtual inline bool brushVisible(const Model::Brush& brush) const {
+                if (!m_viewOptions.showBrushes())
+                    return false;
+                if ((brush.visibilityClasses() & hiddenBrushClasses()) != 0)
+                    return false;
+                return brushMatches(brush);
             }
 
             virtual inline bool brushPickable(const Model::Brush& brush) const {
@@ -213,6 +204,14 @@ namespace TrenchBroom {
             virtual inline bool brushVisible(const Model::Brush& brush) const {
                 return m_defaultFilter.brushVisible(brush);
             }
+
+            virtual inline VisibilityClass::Type hiddenBrushClasses() const {
+                return m_defaultFilter.hiddenBrushClasses();
+            }
+
+            virtual inline bool brushMatches(const Model::Brush& brush) const {
+                return m_defaultFilter.brushMatches(brush);
+            }
             
             virtual inline bool brushPickable(const Model::Brush& brush) const {
                 return brush.selected() && m_defaultFilter.brushPickable(brush);
@@ -245,6 +244,14 @@ namespace TrenchBroom {
             virtual inline bool brushVisible(const Model::Brush& brush) const {
                 return m_defaultFilter.brushVisible(brush);
             }
+
+            virtual inline VisibilityClass::Type hiddenBrushClasses() const {
+                return m_defaultFilter.hiddenBrushClasses();
+            }
+
+            virtual inline bool brushMatches(const Model::Brush& brush) const {
+                return m_defaultFilter.brushMatches(brush);
+            }
             
             virtual inline bool brushPickable(const Model::Brush& brush) const {
                 return brushVisible(brush);
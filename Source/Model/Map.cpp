@@ -21,6 +21,7 @@
 
 #include "Model/Brush.h"
 #include "Model/Entity.h"
+#include "Model/Face.h"
 #include "Utility/List.h"
 
 namespace TrenchBroom {
@@ -104,6 +105,62 @@ namespace TrenchBroom {
                 removeEntityKillTarget(entity, &*it);
         }
 
+        void Map::addEntityProperty(Entity& entity, const PropertyKey& key, const PropertyValue& value) {
+            m_entitiesWithProperty[key][value].insert(&entity);
+        }
+        
+        void Map::removeEntityProperty(Entity& entity, const PropertyKey& key, const PropertyValue& value) {
+            typedef PropertyEntityMap::iterator KeyIt;
+            typedef PropertyValueEntityMap::iterator ValueIt;
+            
+            KeyIt keyIt = m_entitiesWithProperty.find(key);
+            if (keyIt == m_entitiesWithProperty.end())
+                return;
+            
+            PropertyValueEntityMap& values = keyIt->second;
+            ValueIt valueIt = values.find(value);
+            if (valueIt == values.end())
+                return;
+            
+            valueIt->second.erase(&entity);
+            if (valueIt->second.empty()) {
+                values.erase(valueIt);
+                if (values.empty())
+                    m_entitiesWithProperty.erase(keyIt);
+            }
+        }
+        
+        void Map::addEntityProperties(Entity& entity) {
+            const PropertyList& properties = entity.properties();
+            PropertyList::const_iterator it, end;
+            for (it = properties.begin(), end = properties.end(); it != end; ++it)
+                addEntityProperty(entity, it->key(), it->value());
+        }
+        
+        void Map::removeEntityProperties(Entity& entity) {
+            const PropertyList& properties = entity.properties();
+            PropertyList::const_iterator it, end;
+            for (it = properties.begin(), end = properties.end(); it != end; ++it)
+                removeEntityProperty(entity, it->key(), it->value());
+        }
+        
+        void Map::linkSourceDidChange(Entity& entity) {
+            m_changedLinkSources.insert(&entity);
+        }
+        
+        void Map::linkSourcesDidChange(const String* targetname) {
+            if (targetname == NULL || targetname->empty())
+                return;
+            
+            typedef TargetnameEntityMap::const_iterator MapIt;
+            MapIt it = m_entitiesWithTarget.find(*targetname);
+            if (it != m_entitiesWithTarget.end())
+                m_changedLinkSources.insert(it->second.begin(), it->second.end());
+            it = m_entitiesWithKillTarget.find(*targetname);
+            if (it != m_entitiesWithKillTarget.end())
+                m_changedLinkSources.insert(it->second.begin(), it->second.end());
+        }
+
         Map::Map(const BBoxf& worldBounds, bool forceIntegerFacePoints) :
         m_worldBounds(worldBounds),
         m_forceIntegerFacePoints(forceIntegerFacePoints),
@@ -134,17 +191,28 @@ namespace TrenchBroom {
                 addEntityTargetname(entity, entity.propertyForKey(Entity::TargetnameKey));
                 addEntityTargets(entity);
                 addEntityKillTargets(entity);
+                addEntityProperties(entity);
                 entity.setMap(this);
+                
+                m_removedLinkSources.erase(&entity);
+                linkSourceDidChange(entity);
+                linkSourcesDidChange(entity.propertyForKey(Entity::TargetnameKey));
             }
         }
         
         void Map::removeEntity(Entity& entity) {
             if (entity.worldspawn())
                 m_worldspawn = NULL;
+            
+            linkSourcesDidChange(entity.propertyForKey(Entity::TargetnameKey));
+            m_changedLinkSources.erase(&entity);
+            m_removedLinkSources.insert(&entity);
+            
             entity.setMap(NULL);
             removeEntityTargetname(entity, entity.propertyForKey(Entity::TargetnameKey));
             removeEntityTargets(entity);
             removeEntityKillTargets(entity);
+            removeEntityProperties(entity);
             Utility::erase(m_entities, &entity);
         }
 
@@ -159,6 +227,8 @@ namespace TrenchBroom {
         void Map::updateEntityTargetname(Entity& entity, const String* newTargetname, const String* oldTargetname) {
             removeEntityTargetname(entity, oldTargetname);
             addEntityTargetname(entity, newTargetname);
+            linkSourcesDidChange(oldTargetname);
+            linkSourcesDidChange(newTargetname);
         }
 
         
@@ -173,6 +243,7 @@ namespace TrenchBroom {
         void Map::updateEntityTarget(Entity& entity, const String* newTargetname, const String* oldTargetname) {
             removeEntityTarget(entity, oldTargetname);
             addEntityTarget(entity, newTargetname);
+            linkSourceDidChange(entity);
         }
         
         EntityList Map::entitiesWithKillTarget(const String& targetname) const {
@@ -186,13 +257,79 @@ namespace TrenchBroom {
         void Map::updateEntityKillTarget(Entity& entity, const String* newTargetname, const String* oldTargetname) {
             removeEntityKillTarget(entity, oldTargetname);
             addEntityKillTarget(entity, newTargetname);
+            linkSourceDidChange(entity);
+        }
+
+        EntityList Map::entitiesWithClassname(const String& classname) const {
+            return entitiesWithProperty(Entity::ClassnameKey, classname);
+        }
+        
+        EntityList Map::entitiesWithProperty(const PropertyKey& key) const {
+            typedef PropertyEntityMap::const_iterator KeyIt;
+            typedef PropertyValueEntityMap::const_iterator ValueIt;
+            
+            KeyIt keyIt = m_entitiesWithProperty.find(key);
+            if (keyIt == m_entitiesWithProperty.end())
+                return EmptyEntityList;
+            
+            // an entity has at most one value per key, so the value sets are disjoint
+            EntityList result;
+            const PropertyValueEntityMap& values = keyIt->second;
+            ValueIt valueIt, valueEnd;
+            for (valueIt = values.begin(), valueEnd = values.end(); valueIt != valueEnd; ++valueIt)
+                result.insert(result.end(), valueIt->second.begin(), valueIt->second.end());
+            return result;
+        }
+        
+        EntityList Map::entitiesWithProperty(const PropertyKey& key, const PropertyValue& value) const {
+            typedef PropertyEntityMap::const_iterator KeyIt;
+            typedef PropertyValueEntityMap::const_iterator ValueIt;
+            
+            KeyIt keyIt = m_entitiesWithProperty.find(key);
+            if (keyIt == m_entitiesWithProperty.end())
+                return EmptyEntityList;
+            
+            const PropertyValueEntityMap& values = keyIt->second;
+            ValueIt valueIt = values.find(value);
+            if (valueIt == values.end())
+                return EmptyEntityList;
+            return Utility::makeList(valueIt->second);
+        }
+        
+        void Map::updateEntityProperty(Entity& entity, const PropertyKey& key, const PropertyValue* newValue, const PropertyValue* oldValue) {
+            if (oldValue != NULL)
+                removeEntityProperty(entity, key, *oldValue);
+            if (newValue != NULL)
+                addEntityProperty(entity, key, *newValue);
+        }
+
+        FaceList Map::facesWithTexture(const String& textureName) const {
+            typedef TextureNameFaceMap::const_iterator MapIt;
+            MapIt it = m_facesWithTexture.find(Utility::toLower(textureName));
+            if (it == m_facesWithTexture.end())
+                return EmptyFaceList;
+            return Utility::makeList(it->second);
+        }
+        
+        void Map::addFace(Face& face) {
+            m_facesWithTexture[Utility::toLower(face.textureName())].insert(&face);
+        }
+        
+        void Map::removeFace(Face& face) {
+            typedef TextureNameFaceMap::iterator MapIt;
+            MapIt it = m_facesWithTexture.find(Utility::toLower(face.textureName()));
+            if (it != m_facesWithTexture.end()) {
+                it->second.erase(&face);
+                if (it->second.empty())
+                    m_facesWithTexture.erase(it);
+            }
         }
 
         Entity* Map::worldspawn() {
-            for (unsigned int i = 0; i < m_entities.size() && m_worldspawn == NULL; i++) {
-                Entity* entity = m_entities[i];
-                if (entity->worldspawn())
-                    m_worldspawn = entity;
+            if (m_worldspawn == NULL) {
+                const EntityList worldspawns = entitiesWithClassname(Entity::WorldspawnClassname);
+                if (!worldspawns.empty())
+                    m_worldspawn = worldspawns.front();
             }
             
             return m_worldspawn;
@@ -202,6 +339,9 @@ namespace TrenchBroom {
             m_entitiesWithTargetname.clear();
             m_entitiesWithTarget.clear();
             m_entitiesWithKillTarget.clear();
+            m_entitiesWithProperty.clear();
+            m_facesWithTexture.clear();
+            clearLinkChanges();
             Utility::deleteAll(m_entities);
             m_worldspawn = NULL;
         }
@@ -20,7 +20,9 @@
 #ifndef __TrenchBroom__Map__
 #define __TrenchBroom__Map__
 
+#include "Model/EntityProperty.h"
 #include "Model/EntityTypes.h"
+#include "Model/FaceTypes.h"
 #include "Utility/VecMath.h"
 
 #include <map>
@@ -30,10 +32,14 @@ using namespace TrenchBroom::VecMath;
 namespace TrenchBroom {
     namespace Model {
         class Entity;
+        class Face;
         
         class Map {
         protected:
             typedef std::map<String, EntitySet> TargetnameEntityMap;
+            typedef std::map<PropertyValue, EntitySet> PropertyValueEntityMap;
+            typedef std::map<PropertyKey, PropertyValueEntityMap> PropertyEntityMap;
+            typedef std::map<String, FaceSet> TextureNameFaceMap;
             
             BBoxf m_worldBounds;
             bool m_forceIntegerFacePoints;
@@ -41,8 +47,13 @@ namespace TrenchBroom {
             TargetnameEntityMap m_entitiesWithTargetname;
             TargetnameEntityMap m_entitiesWithTarget;
             TargetnameEntityMap m_entitiesWithKillTarget;
+            PropertyEntityMap m_entitiesWithProperty;
+            TextureNameFaceMap m_facesWithTexture;
             Entity* m_worldspawn;
             
+            EntitySet m_changedLinkSources;
+            EntitySet m_removedLinkSources;
+            
             void addEntityTargetname(Entity& entity, const String* targetname);
             void removeEntityTargetname(Entity& entity, const String* targetname);
 
@@ -55,6 +66,14 @@ namespace TrenchBroom {
             void removeEntityKillTarget(Entity& entity, const String* targetname);
             void addEntityKillTargets(Entity& entity);
             void removeEntityKillTargets(Entity& entity);
+            
+            void addEntityProperty(Entity& entity, const PropertyKey& key, const PropertyValue& value);
+            void removeEntityProperty(Entity& entity, const PropertyKey& key, const PropertyValue& value);
+            void addEntityProperties(Entity& entity);
+            void removeEntityProperties(Entity& entity);
+            
+            void linkSourceDidChange(Entity& entity);
+            void linkSourcesDidChange(const String* targetname);
         public:
             Map(const BBoxf& worldBounds, bool forceIntegerFacePoints);
             ~Map();
@@ -81,10 +100,50 @@ namespace TrenchBroom {
             EntityList entitiesWithKillTarget(const String& targetname) const;
             void updateEntityKillTarget(Entity& entity, const String* newTargetname, const String* oldTargetname);
             
+            /*
+             Inverted index over all entity properties, maintained by Entity::setProperty. Lookups are logarithmic in
+             the number of distinct keys and values and linear in the number of returned entities.
+             */
+            EntityList entitiesWithClassname(const String& classname) const;
+            EntityList entitiesWithProperty(const PropertyKey& key) const;
+            EntityList entitiesWithProperty(const PropertyKey& key, const PropertyValue& value) const;
+            void updateEntityProperty(Entity& entity, const PropertyKey& key, const PropertyValue* newValue, const PropertyValue* oldValue);
+            
+            /*
+             Index of all faces in the map by their lower case texture name, maintained by Face::setTextureName and
+             by the face, brush and entity parent links. Used to rebind only the faces whose texture may have
+             changed when the texture collections change.
+             */
+            FaceList facesWithTexture(const String& textureName) const;
+            void addFace(Face& face);
+            void removeFace(Face& face);
+            
             inline const EntityList& entities() const {
                 return m_entities;
             }
             
+            /*
+             The entities whose outgoing target or killtarget links have changed since the last call to
+             clearLinkChanges, either because their own targets changed or because the targetnames they refer to were
+             added, removed or renamed.
+             */
+            inline const EntitySet& changedLinkSources() const {
+                return m_changedLinkSources;
+            }
+            
+            /*
+             The entities that were removed from the map since the last call to clearLinkChanges. These must not be
+             dereferenced, they are only reported so that cached link data for them can be dropped.
+             */
+            inline const EntitySet& removedLinkSources() const {
+                return m_removedLinkSources;
+            }
+            
+            inline void clearLinkChanges() {
+                m_changedLinkSources.clear();
+                m_removedLinkSources.clear();
+            }
+            
             Entity* worldspawn();
             
             void clear();
@@ -21,9 +21,9 @@
 
 #include "Controller/Autosaver.h"
 #include "Controller/Command.h"
+#include "Controller/LoadObjectsCommand.h"
 #include "IO/FileManager.h"
 #include "IO/IOException.h"
-#include "IO/MapParser.h"
 #include "IO/MapWriter.h"
 #include "IO/Wad.h"
 #include "Model/Brush.h"
@@ -32,6 +32,7 @@
 #include "Model/EntityDefinitionManager.h"
 #include "Model/Face.h"
 #include "Model/Map.h"
+#include "Model/MapLoader.h"
 #include "Model/Octree.h"
 #include "Model/Picker.h"
 #include "Model/PointFile.h"
@@ -42,14 +43,16 @@
 #include "Utility/Grid.h"
 #include "Utility/List.h"
 #include "Utility/Preferences.h"
+#include "Utility/Profiler.h"
 #include "Utility/String.h"
 #include "Utility/VecMath.h"
 #include "View/EditorView.h"
 #include "View/FaceInspector.h"
 #include "View/Inspector.h"
-#include "View/ProgressIndicatorDialog.h"
 
+#include <algorithm>
 #include <cassert>
+#include <set>
 
 #include <wx/msgdlg.h>
 #include <wx/stdpaths.h>
@@ -59,13 +62,29 @@ using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
     namespace Model {
+        class ValidationIssueLogger : public MapValidator::IssueListener {
+        private:
+            Utility::Console& m_console;
+        public:
+            ValidationIssueLogger(Utility::Console& console) :
+            m_console(console) {}
+
+            void issuesFound(const MapValidator::IssueList& issues) {
+                MapValidator::IssueList::const_iterator it, end;
+                for (it = issues.begin(), end = issues.end(); it != end; ++it)
+                    m_console.warn(MapValidator::formatIssue(*it));
+            }
+        };
+
         BEGIN_EVENT_TABLE(MapDocument, wxDocument)
-        EVT_TIMER(wxID_ANY, MapDocument::OnAutosaveTimer)
+        EVT_TIMER(AutosaveTimerId, MapDocument::OnAutosaveTimer)
+        EVT_TIMER(LoadTimerId, MapDocument::OnLoadTimer)
         END_EVENT_TABLE()
 
         IMPLEMENT_DYNAMIC_CLASS(MapDocument, wxDocument)
 
         bool MapDocument::DoOpenDocument(const wxString& file) {
+            Utility::ProfileZone zone("MapDocument::DoOpenDocument");
             const String path = file.ToStdString();
             IO::FileManager fileManager;
             IO::MappedFile::Ptr mappedFile = fileManager.mapFile(path);
@@ -74,11 +93,8 @@ namespace TrenchBroom {
                 clear();
                 
                 console().info("Loading file %s", file.mbc_str().data());
-                
-                View::ProgressIndicatorDialog progressIndicator;
-                loadMap(mappedFile->begin(), mappedFile->end(), progressIndicator);
-                loadTextures();
-                loadEntityDefinitionFile();
+                loadMap(mappedFile);
+                m_mapFile = mappedFile;
 
                 String title = fileManager.pathComponents(path).back();
                 SetTitle(title);
@@ -96,10 +112,14 @@ namespace TrenchBroom {
 
         bool MapDocument::DoSaveDocument(const wxString& file) {
             try {
+                const String path = file.ToStdString();
                 wxStopWatch watch;
                 IO::MapWriter mapWriter;
-                mapWriter.writeToFileAtPath(*m_map, file.ToStdString(), true);
-                console().info("Saved map file to %s in %f seconds", file.ToStdString().c_str(), watch.Time() / 1000.0f);
+                const size_t copiedCount = mapWriter.writeToFileAtPath(*m_map, path, true, m_mapFile, true);
+                console().info("Saved map file to %s in %f seconds (%u of %u entities unchanged)", path.c_str(), watch.Time() / 1000.0f, static_cast<unsigned int>(copiedCount), static_cast<unsigned int>(m_map->entities().size()));
+                
+                IO::FileManager fileManager;
+                m_mapFile = fileManager.mapFile(path);
                 return true;
             } catch (IO::IOException& e) {
                 console().error(e.what());
@@ -108,6 +128,12 @@ namespace TrenchBroom {
         }
 
         void MapDocument::clear() {
+            if (m_mapLoader != NULL) {
+                m_loadTimer->Stop();
+                delete m_mapLoader;
+                m_mapLoader = NULL;
+            }
+            
             m_sharedResources->textureRendererManager().invalidate();
             m_editStateManager->clear();
             m_map->clear();
@@ -115,12 +141,26 @@ namespace TrenchBroom {
             m_textureManager->clear();
             m_definitionManager->clear();
             unloadPointFile();
+            clearValidationIssues();
             invalidateSearchPaths();
+            m_mapFile.reset();
 
             Controller::Command clearCommand(Controller::Command::ClearMap);
             UpdateAllViews(NULL, &clearCommand);
         }
 
+        void MapDocument::removeValidationIssues(const Brush& brush) {
+            MapValidator::IssueList::iterator it = m_validationIssues.begin();
+            while (it != m_validationIssues.end()) {
+                if (it->brush == &brush)
+                    it = m_validationIssues.erase(it);
+                else
+                    ++it;
+            }
+            if (m_nextValidationIssue >= m_validationIssues.size())
+                m_nextValidationIssue = 0;
+        }
+
         void MapDocument::loadPalette() {
             IO::FileManager fileManager;
             String resourcePath = fileManager.resourceDirectory();
@@ -128,49 +168,103 @@ namespace TrenchBroom {
             m_sharedResources->loadPalette(palettePath);
         }
 
-        void MapDocument::loadMap(char* begin, char* end, Utility::ProgressIndicator& progressIndicator) {
-            progressIndicator.setText("Loading map file...");
-            
-            wxStopWatch watch;
-            IO::MapParser parser(begin, end, console());
-            parser.parseMap(*m_map, &progressIndicator);
-            
-            console().info("Loaded map file in %f seconds", watch.Time() / 1000.0f);
+        void MapDocument::loadMap(IO::MappedFile::Ptr file) {
+            // the file is parsed in the background, and the load timer adds the parsed objects to the map in batches
+            m_mapLoader = new MapLoader(file, m_map->worldBounds());
+            m_mapLoader->start();
+            m_loadWatch.Start();
+            m_loadTimer->Start(LoadInterval);
         }
 
-        void MapDocument::setAllTexturesToNull() {
-            const Model::EntityList& entities = m_map->entities();
-            for (size_t i = 0; i < entities.size(); i++) {
-                const Model::BrushList& brushes = entities[i]->brushes();
-                for (size_t j = 0; j < brushes.size(); j++) {
-                    const Model::FaceList& faces = brushes[j]->faces();
-                    for (size_t k = 0; k < faces.size(); k++) {
-                        faces[k]->setTexture(NULL);
+        void MapDocument::loadBatches() {
+            Utility::ProfileZone zone("MapDocument::loadBatches");
+            assert(m_mapLoader != NULL);
+            
+            MapLoader::BatchList batches;
+            const bool finished = m_mapLoader->collect(batches);
+            
+            EntityList entities;
+            BrushList brushes;
+            MapLoader::BatchList::const_iterator batchIt, batchEnd;
+            for (batchIt = batches.begin(), batchEnd = batches.end(); batchIt != batchEnd; ++batchIt) {
+                const MapLoader::Batch& batch = *batchIt;
+                Entity& entity = *batch.entity;
+                if (batch.newEntity) {
+                    addEntity(entity);
+                    entities.push_back(&entity);
+                    
+                    // the worldspawn names the wads and the entity definition file, and it usually comes first
+                    if (entity.worldspawn()) {
+                        loadTextures();
+                        loadEntityDefinitionFile();
                     }
                 }
+                
+                BrushList::const_iterator brushIt, brushEnd;
+                for (brushIt = batch.brushes.begin(), brushEnd = batch.brushes.end(); brushIt != brushEnd; ++brushIt)
+                    addBrush(entity, **brushIt);
+                brushes.insert(brushes.end(), batch.brushes.begin(), batch.brushes.end());
+                
+                if (batch.finished) {
+                    entity.setFilePosition(batch.firstLine, batch.lineCount);
+                    entity.setFileRange(batch.fileOffset, batch.fileLength);
+                }
+            }
+            
+            if (finished) {
+                m_loadTimer->Stop();
+                m_mapLoader->forwardMessages(console());
+                delete m_mapLoader;
+                m_mapLoader = NULL;
+                
+                // a map without a worldspawn gets a new one with the default wads and entity definitions
+                if (m_map->worldspawn() == NULL) {
+                    loadTextures();
+                    loadEntityDefinitionFile();
+                }
+                
+                console().info("Loaded map file in %f seconds", m_loadWatch.Time() / 1000.0f);
+                m_modificationCount = 0;
+                Modify(false);
+            }
+            
+            if (finished || !entities.empty() || !brushes.empty()) {
+                Controller::LoadObjectsCommand loadCommand(entities, brushes, finished);
+                UpdateAllViews(NULL, &loadCommand);
             }
         }
 
-        void MapDocument::refreshAllTextures() {
-            const Model::EntityList& entities = m_map->entities();
-            for (size_t i = 0; i < entities.size(); i++) {
-                const Model::BrushList& brushes = entities[i]->brushes();
-                for (size_t j = 0; j < brushes.size(); j++) {
-                    const Model::FaceList& faces = brushes[j]->faces();
-                    for (size_t k = 0; k < faces.size(); k++) {
-                        const String& textureName = faces[k]->textureName();
-                        Model::Texture* newTexture = m_textureManager->texture(textureName);
-                        faces[k]->setTexture(newTexture);
+        FaceList MapDocument::rebindTextures(const TextureCollectionList& collections) {
+            // a texture name resolves case insensitively, so all faces whose lower case texture name matches one of
+            // the collections' textures may have to be rebound
+            std::set<String> textureNames;
+            TextureCollectionList::const_iterator collectionIt, collectionEnd;
+            for (collectionIt = collections.begin(), collectionEnd = collections.end(); collectionIt != collectionEnd; ++collectionIt) {
+                const TextureList& textures = (*collectionIt)->textures();
+                TextureList::const_iterator textureIt, textureEnd;
+                for (textureIt = textures.begin(), textureEnd = textures.end(); textureIt != textureEnd; ++textureIt)
+                    textureNames.insert(Utility::toLower((*textureIt)->name()));
+            }
+            
+            FaceList changedFaces;
+            std::set<String>::const_iterator nameIt, nameEnd;
+            for (nameIt = textureNames.begin(), nameEnd = textureNames.end(); nameIt != nameEnd; ++nameIt) {
+                const FaceList faces = m_map->facesWithTexture(*nameIt);
+                FaceList::const_iterator faceIt, faceEnd;
+                for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt) {
+                    Face& face = **faceIt;
+                    Texture* texture = m_textureManager->texture(face.textureName());
+                    if (texture != face.texture()) {
+                        face.setTexture(texture);
+                        changedFaces.push_back(&face);
                     }
                 }
             }
             
-            if (m_mruTexture != NULL && m_mruTexture != m_textureManager->texture(m_mruTextureName))
-                setMruTexture(NULL);
+            return changedFaces;
         }
         
-        void MapDocument::loadTextureWad(const String& path) {
-            const size_t index = m_textureManager->collections().size();
+        TextureCollection* MapDocument::loadTextureWad(const String& path) {
             IO::FileManager fileManager;
             
             String wadPath = path;
@@ -184,28 +278,27 @@ namespace TrenchBroom {
                 
                 if (!fileManager.resolveRelativePath(path, rootPaths, wadPath)) {
                     console().error("Could not open texture wad %s (tried relative to current map file, TrenchBroom executable, and Quake path)", path.c_str());
-                    return;
+                    return NULL;
                 }
             }
             
             if (fileManager.exists(wadPath)) {
-                Model::TextureCollection* collection = NULL;
                 try {
-                    collection = new Model::TextureCollection(path, wadPath);
-                    m_textureManager->addCollection(collection, index);
+                    return new Model::TextureCollection(path, wadPath);
                 } catch (IO::IOException& e) {
-                    delete collection;
-                    collection = NULL;
                     console().error("Could not open texture wad %s: %s", wadPath.c_str(), e.what());
                 }
             } else {
                 console().error("Could not open texture wad %s", wadPath.c_str());
             }
+            return NULL;
         }
         
         MapDocument::MapDocument() :
         m_autosaver(NULL),
         m_autosaveTimer(NULL),
+        m_mapLoader(NULL),
+        m_loadTimer(NULL),
         m_console(NULL),
         m_sharedResources(NULL),
         m_map(NULL),
@@ -220,9 +313,14 @@ namespace TrenchBroom {
         m_textureLock(true),
         m_modificationCount(0),
         m_searchPathsValid(false),
-        m_pointFile(NULL) {}
+        m_pointFile(NULL),
+        m_nextValidationIssue(0) {}
 
         MapDocument::~MapDocument() {
+            delete m_loadTimer;
+            m_loadTimer = NULL;
+            delete m_mapLoader;
+            m_mapLoader = NULL;
             delete m_autosaveTimer;
             m_autosaveTimer = NULL;
             delete m_autosaver;
@@ -316,23 +414,20 @@ namespace TrenchBroom {
         }
 
         void MapDocument::entityWillChange(Entity& entity) {
-            m_octree->removeObject(entity);
+            m_octree->objectWillChange(entity);
         }
 
         void MapDocument::entityDidChange(Entity& entity) {
-            m_octree->addObject(entity);
+            // the octree reads the new bounds when it applies its pending updates
         }
 
         void MapDocument::entitiesWillChange(const EntityList& entities) {
             MapObjectList objects;
             objects.insert(objects.begin(), entities.begin(), entities.end());
-            m_octree->removeObjects(objects);
+            m_octree->objectsWillChange(objects);
         }
 
         void MapDocument::entitiesDidChange(const EntityList& entities) {
-            MapObjectList objects;
-            objects.insert(objects.begin(), entities.begin(), entities.end());
-            m_octree->addObjects(objects);
         }
 
         void MapDocument::removeEntity(Entity& entity) {
@@ -341,6 +436,8 @@ namespace TrenchBroom {
             for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt) {
                 Model::Brush& brush = **brushIt;
                 m_octree->removeObject(brush);
+                if (!m_validationIssues.empty())
+                    removeValidationIssues(brush);
             }
 
             m_octree->removeObject(entity);
@@ -350,11 +447,9 @@ namespace TrenchBroom {
 
         void MapDocument::addBrush(Entity& entity, Brush& brush) {
             if (!entity.worldspawn())
-                m_octree->removeObject(entity);
+                m_octree->objectWillChange(entity);
             entity.addBrush(brush);
             m_octree->addObject(brush);
-            if (!entity.worldspawn())
-                m_octree->addObject(entity);
 
             const FaceList& faces = brush.faces();
             FaceList::const_iterator faceIt, faceEnd;
@@ -366,13 +461,13 @@ namespace TrenchBroom {
 
         void MapDocument::removeBrush(Brush& brush) {
             m_octree->removeObject(brush);
+            if (!m_validationIssues.empty())
+                removeValidationIssues(brush);
             Entity* entity = brush.entity();
             if (entity != NULL) {
                 if (!entity->worldspawn())
-                    m_octree->removeObject(*entity);
+                    m_octree->objectWillChange(*entity);
                 entity->removeBrush(brush);
-                if (!entity->worldspawn())
-                    m_octree->addObject(*entity);
             }
             
             const FaceList& faces = brush.faces();
@@ -386,15 +481,11 @@ namespace TrenchBroom {
         void MapDocument::brushWillChange(Brush& brush) {
             Entity* entity = brush.entity();
             if (entity != NULL && !entity->worldspawn())
-                m_octree->removeObject(*entity);
-            m_octree->removeObject(brush);
+                m_octree->objectWillChange(*entity);
+            m_octree->objectWillChange(brush);
         }
 
         void MapDocument::brushDidChange(Brush& brush) {
-            Entity* entity = brush.entity();
-            m_octree->addObject(brush);
-            if (entity != NULL && !entity->worldspawn())
-                m_octree->addObject(*entity);
         }
 
         void MapDocument::brushesWillChange(const BrushList& brushes) {
@@ -409,22 +500,10 @@ namespace TrenchBroom {
                     objects.insert(entity);
             }
             
-            m_octree->removeObjects(Utility::makeList(objects));
+            m_octree->objectsWillChange(Utility::makeList(objects));
         }
 
         void MapDocument::brushesDidChange(const BrushList& brushes) {
-            MapObjectSet objects;
-            objects.insert(brushes.begin(), brushes.end());
-
-            BrushList::const_iterator it, end;
-            for (it = brushes.begin(), end = brushes.end(); it != end; ++it) {
-                Brush* brush = *it;
-                Entity* entity = brush->entity();
-                if (entity != NULL && !entity->worldspawn())
-                    objects.insert(entity);
-            }
-
-            m_octree->addObjects(Utility::makeList(objects));
         }
 
         void MapDocument::setForceIntegerCoordinates(bool forceIntegerCoordinates) {
@@ -471,6 +550,10 @@ namespace TrenchBroom {
             return *m_picker;
         }
 
+        Octree& MapDocument::octree() const {
+            return *m_octree;
+        }
+
         Utility::Grid& MapDocument::grid() const {
             return *m_grid;
         }
@@ -528,6 +611,63 @@ namespace TrenchBroom {
             return *m_pointFile;
         }
 
+        void MapDocument::validateMap() {
+            BrushList brushes;
+            const EntityList& entities = m_map->entities();
+            EntityList::const_iterator entityIt, entityEnd;
+            for (entityIt = entities.begin(), entityEnd = entities.end(); entityIt != entityEnd; ++entityIt) {
+                const Entity& entity = **entityIt;
+                brushes.insert(brushes.end(), entity.brushes().begin(), entity.brushes().end());
+            }
+
+            console().info("Validating %u brushes", static_cast<unsigned int>(brushes.size()));
+
+            wxStopWatch watch;
+            MapValidator validator(m_map->worldBounds());
+            ValidationIssueLogger logger(console());
+            m_validationIssues = validator.validate(brushes, &logger);
+            m_nextValidationIssue = 0;
+
+            if (m_validationIssues.empty())
+                console().info("Found no issues in %f seconds", watch.Time() / 1000.0f);
+            else
+                console().warn("Found %u issues in %f seconds", static_cast<unsigned int>(m_validationIssues.size()), watch.Time() / 1000.0f);
+        }
+
+        void MapDocument::clearValidationIssues() {
+            m_validationIssues.clear();
+            m_nextValidationIssue = 0;
+        }
+
+        bool MapDocument::hasValidationIssues() const {
+            return !m_validationIssues.empty();
+        }
+
+        bool MapDocument::hasRepairableValidationIssues() const {
+            MapValidator::IssueList::const_iterator it, end;
+            for (it = m_validationIssues.begin(), end = m_validationIssues.end(); it != end; ++it)
+                if (it->repairable())
+                    return true;
+            return false;
+        }
+
+        const MapValidator::Issue& MapDocument::nextValidationIssue() {
+            assert(hasValidationIssues());
+            const MapValidator::Issue& issue = m_validationIssues[m_nextValidationIssue];
+            m_nextValidationIssue = (m_nextValidationIssue + 1) % m_validationIssues.size();
+            return issue;
+        }
+
+        BrushList MapDocument::repairableBrushes() const {
+            // the issues are ordered by brush, so the issues of one brush are adjacent
+            BrushList brushes;
+            MapValidator::IssueList::const_iterator it, end;
+            for (it = m_validationIssues.begin(), end = m_validationIssues.end(); it != end; ++it)
+                if (it->repairable() && (brushes.empty() || brushes.back() != it->brush))
+                    brushes.push_back(it->brush);
+            return brushes;
+        }
+
         Model::Texture* MapDocument::mruTexture() const {
             return m_mruTexture;
         }
@@ -549,6 +689,7 @@ namespace TrenchBroom {
         }
 
         void MapDocument::loadEntityDefinitionFile() {
+            Utility::ProfileZone zone("MapDocument::loadEntityDefinitionFile");
             String definitionFile = "";
             Entity& worldspawnEntity = worldspawn();
             const PropertyValue* defValue = worldspawnEntity.propertyForKey(Entity::DefKey);
@@ -580,7 +721,8 @@ namespace TrenchBroom {
             m_octree->clear();
             
             m_definitionManager->clear();
-            m_definitionManager->load(definitionPath);
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            m_definitionManager->load(definitionPath, prefs.getColor(Preferences::EntityBoundsColor));
 
             for (unsigned int i = 0; i < entities.size(); i++) {
                 Entity& entity = *entities[i];
@@ -594,21 +736,67 @@ namespace TrenchBroom {
             m_octree->loadMap();
         }
 
-        void MapDocument::loadTextures() {
-            setAllTexturesToNull();
-            m_textureManager->clear();
+        FaceList MapDocument::loadTextures() {
+            Utility::ProfileZone zone("MapDocument::loadTextures");
             
+            StringList wadPaths;
             const String* wads = worldspawn().propertyForKey(Entity::WadKey);
             if (wads != NULL) {
-                StringList wadPaths = Utility::split(*wads, ';');
-                for (size_t i = 0; i < wadPaths.size(); i++) {
-                    const String wadPath = Utility::trim(wadPaths[i]);
+                const StringList paths = Utility::split(*wads, ';');
+                for (size_t i = 0; i < paths.size(); i++) {
+                    const String wadPath = Utility::trim(paths[i]);
                     if (!wadPath.empty())
-                        loadTextureWad(wadPath);
+                        wadPaths.push_back(wadPath);
                 }
             }
             
-            refreshAllTextures();
+            // keep the collections which are still referenced, their wads need not be read again
+            TextureCollectionList removedCollections = m_textureManager->collections();
+            TextureCollectionList collections;
+            TextureCollectionList keptCollections;
+            TextureCollectionList changedCollections;
+            for (size_t i = 0; i < wadPaths.size(); i++) {
+                TextureCollection* collection = NULL;
+                for (size_t j = 0; j < removedCollections.size() && collection == NULL; j++) {
+                    if (removedCollections[j]->name() == wadPaths[i]) {
+                        collection = removedCollections[j];
+                        removedCollections.erase(removedCollections.begin() + static_cast<TextureCollectionList::difference_type>(j));
+                        keptCollections.push_back(collection);
+                    }
+                }
+                if (collection == NULL) {
+                    collection = loadTextureWad(wadPaths[i]);
+                    if (collection != NULL)
+                        changedCollections.push_back(collection);
+                }
+                if (collection != NULL)
+                    collections.push_back(collection);
+            }
+            
+            // if the kept collections were reordered, their textures may override each other differently
+            TextureCollectionList previousOrder;
+            const TextureCollectionList& previousCollections = m_textureManager->collections();
+            for (size_t i = 0; i < previousCollections.size(); i++) {
+                if (std::find(keptCollections.begin(), keptCollections.end(), previousCollections[i]) != keptCollections.end())
+                    previousOrder.push_back(previousCollections[i]);
+            }
+            if (previousOrder != keptCollections)
+                changedCollections.insert(changedCollections.end(), keptCollections.begin(), keptCollections.end());
+            changedCollections.insert(changedCollections.end(), removedCollections.begin(), removedCollections.end());
+            
+            // the faces must be rebound before the removed collections and their textures are deleted
+            m_textureManager->setCollections(collections);
+            const FaceList changedFaces = rebindTextures(changedCollections);
+            if (m_mruTexture != NULL && m_mruTexture != m_textureManager->texture(m_mruTextureName))
+                setMruTexture(NULL);
+            
+            TextureCollectionList::const_iterator it, end;
+            for (it = removedCollections.begin(), end = removedCollections.end(); it != end; ++it) {
+                m_sharedResources->textureRendererManager().invalidate(**it);
+                delete *it;
+            }
+            
+            return changedFaces;
         }
 
         void MapDocument::incModificationCount() {
@@ -634,8 +822,9 @@ namespace TrenchBroom {
             m_definitionManager = new EntityDefinitionManager(*m_console);
             m_modificationCount = 0;
             m_autosaver = new Controller::Autosaver(*this);
-            m_autosaveTimer = new wxTimer(this);
+            m_autosaveTimer = new wxTimer(this, AutosaveTimerId);
             m_autosaveTimer->Start(1000);
+            m_loadTimer = new wxTimer(this, LoadTimerId);
 
             loadPalette();
 
@@ -679,5 +868,10 @@ namespace TrenchBroom {
         void MapDocument::OnAutosaveTimer(wxTimerEvent& event) {
             m_autosaver->triggerAutosave();
         }
+
+        void MapDocument::OnLoadTimer(wxTimerEvent& event) {
+            if (m_mapLoader != NULL)
+                loadBatches();
+        }
 	}
 }
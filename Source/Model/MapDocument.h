@@ -20,11 +20,16 @@
 #ifndef __TrenchBroom__MapDocument__
 #define __TrenchBroom__MapDocument__
 
+#include "IO/AbstractFileManager.h"
 #include "Model/BrushTypes.h"
 #include "Model/EntityTypes.h"
+#include "Model/FaceTypes.h"
+#include "Model/MapValidator.h"
+#include "Model/TextureTypes.h"
 #include "Utility/String.h"
 
 #include <wx/docview.h>
+#include <wx/stopwatch.h>
 #include <wx/timer.h>
 
 namespace TrenchBroom {
@@ -39,7 +44,6 @@ namespace TrenchBroom {
     namespace Utility {
         class Console;
         class Grid;
-        class ProgressIndicator;
     }
     
     namespace Model {
@@ -49,6 +53,7 @@ namespace TrenchBroom {
         class EntityDefinitionManager;
         class Face;
         class Map;
+        class MapLoader;
         class Octree;
         class Palette;
         class PointFile;
@@ -59,8 +64,15 @@ namespace TrenchBroom {
         class MapDocument : public wxDocument {
             DECLARE_DYNAMIC_CLASS(MapDocument)
         protected:
+            static const int AutosaveTimerId = 1;
+            static const int LoadTimerId = 2;
+            static const int LoadInterval = 50; // milliseconds between two batches of a loading map
+
             Controller::Autosaver* m_autosaver;
             wxTimer* m_autosaveTimer;
+            MapLoader* m_mapLoader;
+            wxTimer* m_loadTimer;
+            wxStopWatch m_loadWatch;
             Utility::Console* m_console;
             Renderer::SharedResources* m_sharedResources;
             Map* m_map;
@@ -79,18 +91,22 @@ namespace TrenchBroom {
             mutable bool m_searchPathsValid;
             
             PointFile* m_pointFile;
+            MapValidator::IssueList m_validationIssues;
+            size_t m_nextValidationIssue;
+            IO::MappedFile::Ptr m_mapFile;
             
             virtual bool DoOpenDocument(const wxString& file);
             virtual bool DoSaveDocument(const wxString& file);
             
             void clear();
+            void removeValidationIssues(const Brush& brush);
 
             void loadPalette();
-            void loadMap(char* begin, char* end, Utility::ProgressIndicator& progressIndicator);
+            void loadMap(IO::MappedFile::Ptr file);
+            void loadBatches();
 
-            void setAllTexturesToNull();
-            void refreshAllTextures();
-            void loadTextureWad(const String& path);
+            FaceList rebindTextures(const TextureCollectionList& collections);
+            TextureCollection* loadTextureWad(const String& path);
         public:
             MapDocument();
             virtual ~MapDocument();
@@ -100,6 +116,13 @@ namespace TrenchBroom {
             
             void Modify(bool modify);
             
+            /*
+             While a map is loading, its objects are added in batches and editing is disabled.
+             */
+            inline bool loading() const {
+                return m_mapLoader != NULL;
+            }
+
             Entity& worldspawn();
             void addEntity(Entity& entity);
             void removeEntity(Entity& entity);
@@ -122,8 +145,16 @@ namespace TrenchBroom {
             EditStateManager& editStateManager() const;
             TextureManager& textureManager() const;
             Picker& picker() const;
+            Octree& octree() const;
             Utility::Grid& grid() const;
             
+            /*
+             The map file as it was read or last saved. Saving copies the text of unchanged entities from it.
+             */
+            inline const IO::MappedFile::Ptr& mapFile() const {
+                return m_mapFile;
+            }
+            
             const StringList& searchPaths() const;
             void invalidateSearchPaths();
             
@@ -132,6 +163,13 @@ namespace TrenchBroom {
             void unloadPointFile();
             bool pointFileLoaded();
             PointFile& pointFile();
+
+            void validateMap();
+            void clearValidationIssues();
+            bool hasValidationIssues() const;
+            bool hasRepairableValidationIssues() const;
+            const MapValidator::Issue& nextValidationIssue();
+            BrushList repairableBrushes() const;
             
             Model::Texture* mruTexture() const;
             void setMruTexture(Model::Texture* texture);
@@ -140,7 +178,13 @@ namespace TrenchBroom {
             void setTextureLock(bool textureLock);
 
             void loadEntityDefinitionFile();
-            void loadTextures();
+            
+            /*
+             Loads the texture wads named by the worldspawn's wad property. Wads which are already loaded are kept,
+             and only the faces whose texture names occur in an added, removed or reordered wad are rebound. Returns
+             the faces whose texture has changed.
+             */
+            FaceList loadTextures();
             
             void incModificationCount();
             void decModificationCount();
@@ -149,6 +193,7 @@ namespace TrenchBroom {
 			bool OnNewDocument();
             bool OnOpenDocument(const wxString& path);
             void OnAutosaveTimer(wxTimerEvent& event);
+            void OnLoadTimer(wxTimerEvent& event);
 
             DECLARE_EVENT_TABLE();
         };
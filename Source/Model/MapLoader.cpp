@@ -0,0 +1,207 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "MapLoader.h"
+
+#include "Model/Brush.h"
+#include "Model/Entity.h"
+#include "Model/Face.h"
+#include "Utility/Console.h"
+#include "Utility/List.h"
+#include "Utility/Profiler.h"
+
+#include <wx/thread.h>
+
+namespace TrenchBroom {
+    namespace Model {
+        class MapLoaderWorker : public wxThread {
+        private:
+            MapLoader& m_loader;
+        public:
+            MapLoaderWorker(MapLoader& loader) :
+            wxThread(wxTHREAD_JOINABLE),
+            m_loader(loader) {}
+
+            ExitCode Entry() {
+                m_loader.run();
+                Utility::Profiler::profiler().threadFinished();
+                return (wxThread::ExitCode)0;
+            }
+        };
+
+        void MapLoader::pushCurrent() {
+            if (m_current.entity == NULL)
+                return;
+
+            if (m_current.newEntity || m_current.finished || !m_current.brushes.empty()) {
+                wxMutexLocker lock(*m_mutex);
+                m_batches.push_back(m_current);
+            }
+            m_current = Batch();
+        }
+
+        void MapLoader::deleteBatches(BatchList& batches) {
+            BatchList::iterator it, end;
+            for (it = batches.begin(), end = batches.end(); it != end; ++it) {
+                Batch& batch = *it;
+                Utility::deleteAll(batch.brushes);
+                // the brushes are not added to their entity before the batch is collected
+                if (batch.newEntity)
+                    delete batch.entity;
+            }
+            batches.clear();
+        }
+
+        MapLoader::MapLoader(IO::MappedFile::Ptr file, const BBoxf& worldBounds) :
+        m_file(file),
+        m_worldBounds(worldBounds),
+        m_console(new Utility::Console(true)),
+        m_worker(NULL),
+        m_mutex(new wxMutex()),
+        m_parsed(false),
+        m_cancelled(false),
+        m_worldspawnParsed(false) {}
+
+        MapLoader::~MapLoader() {
+            {
+                wxMutexLocker lock(*m_mutex);
+                m_cancelled = true;
+            }
+            if (m_worker != NULL) {
+                m_worker->Wait();
+                delete m_worker;
+                m_worker = NULL;
+                Utility::AllocatorLock::endThreadedAllocation();
+            }
+
+            deleteBatches(m_batches);
+            BatchList current(1, m_current);
+            deleteBatches(current);
+            m_current = Batch();
+
+            delete m_mutex;
+            m_mutex = NULL;
+            delete m_console;
+            m_console = NULL;
+        }
+
+        void MapLoader::start() {
+            assert(m_worker == NULL);
+            Utility::AllocatorLock::beginThreadedAllocation();
+            m_worker = new MapLoaderWorker(*this);
+            if (m_worker->Create() != wxTHREAD_NO_ERROR || m_worker->Run() != wxTHREAD_NO_ERROR) {
+                delete m_worker;
+                m_worker = NULL;
+                Utility::AllocatorLock::endThreadedAllocation();
+            }
+        }
+
+        bool MapLoader::collect(BatchList& batches) {
+            if (m_worker == NULL) {
+                bool parsed;
+                {
+                    wxMutexLocker lock(*m_mutex);
+                    parsed = m_parsed;
+                }
+                if (!parsed)
+                    run();
+            }
+
+            bool parsed;
+            {
+                wxMutexLocker lock(*m_mutex);
+                batches.insert(batches.end(), m_batches.begin(), m_batches.end());
+                m_batches.clear();
+                parsed = m_parsed;
+            }
+
+            if (parsed && m_worker != NULL) {
+                m_worker->Wait();
+                delete m_worker;
+                m_worker = NULL;
+                Utility::AllocatorLock::endThreadedAllocation();
+            }
+            return parsed;
+        }
+
+        void MapLoader::forwardMessages(Utility::Console& console) {
+            m_console->forward(console);
+        }
+
+        void MapLoader::run() {
+            Utility::ProfileZone zone("MapLoader::run");
+            ThreadFindFacePoints findFacePoints;
+            IO::MapParser parser(m_file->begin(), m_file->end(), *m_console);
+            parser.parseMap(*this, m_worldBounds, NULL);
+            pushCurrent();
+
+            wxMutexLocker lock(*m_mutex);
+            m_parsed = true;
+        }
+
+        bool MapLoader::cancelled() {
+            wxMutexLocker lock(*m_mutex);
+            return m_cancelled;
+        }
+
+        void MapLoader::entityParsed(Entity* entity) {
+            pushCurrent();
+
+            // the map ignores a second worldspawn, so it is dropped here together with its brushes
+            if (entity->worldspawn()) {
+                if (m_worldspawnParsed) {
+                    delete entity;
+                    return;
+                }
+                m_worldspawnParsed = true;
+            }
+
+            m_current.entity = entity;
+            m_current.newEntity = true;
+        }
+
+        void MapLoader::brushParsed(Brush* brush) {
+            if (m_current.entity == NULL) {
+                delete brush;
+                return;
+            }
+
+            m_current.brushes.push_back(brush);
+            if (m_current.brushes.size() >= BatchSize) {
+                // the remaining brushes of the entity follow in the next batch
+                Entity* entity = m_current.entity;
+                pushCurrent();
+                m_current.entity = entity;
+            }
+        }
+
+        void MapLoader::entityFinished(size_t firstLine, size_t lineCount, size_t fileOffset, size_t fileLength) {
+            if (m_current.entity == NULL)
+                return;
+
+            m_current.finished = true;
+            m_current.firstLine = firstLine;
+            m_current.lineCount = lineCount;
+            m_current.fileOffset = fileOffset;
+            m_current.fileLength = fileLength;
+            pushCurrent();
+        }
+    }
+}
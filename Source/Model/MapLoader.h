@@ -0,0 +1,127 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __TrenchBroom__MapLoader__
+#define __TrenchBroom__MapLoader__
+
+#include "IO/AbstractFileManager.h"
+#include "IO/MapParser.h"
+#include "Model/BrushTypes.h"
+#include "Utility/VecMath.h"
+
+#include <vector>
+
+using namespace TrenchBroom::VecMath;
+
+class wxMutex;
+
+namespace TrenchBroom {
+    namespace Utility {
+        class Console;
+    }
+
+    namespace Model {
+        class Brush;
+        class Entity;
+        class MapLoaderWorker;
+
+        /*
+         Parses a map file on a worker thread and hands the parsed objects to the main thread in batches, so that a
+         large map can be shown and navigated while it is still being read. An entity is handed over together with
+         its first brushes, and its remaining brushes follow in later batches. The parser's messages are kept until
+         they are forwarded to the document's console. The object pools and id counters are shared with the main thread
+         and with other documents. The pools are locked while the worker runs, and the worker has its own plane point
+         cache.
+         */
+        class MapLoader : public IO::MapParserListener {
+        public:
+            class Batch {
+            public:
+                Entity* entity;
+                bool newEntity;     // the entity must be added to the map before the brushes
+                BrushList brushes;
+                bool finished;      // the entity is complete, its file position is known
+                size_t firstLine;
+                size_t lineCount;
+                size_t fileOffset;
+                size_t fileLength;
+
+                Batch() :
+                entity(NULL),
+                newEntity(false),
+                finished(false),
+                firstLine(0),
+                lineCount(0),
+                fileOffset(0),
+                fileLength(0) {}
+            };
+
+            typedef std::vector<Batch> BatchList;
+        private:
+            static const size_t BatchSize = 512;
+
+            IO::MappedFile::Ptr m_file;
+            BBoxf m_worldBounds;
+            Utility::Console* m_console;
+            MapLoaderWorker* m_worker;
+
+            // shared with the worker thread, guarded by m_mutex
+            wxMutex* m_mutex;
+            BatchList m_batches;
+            bool m_parsed;
+            bool m_cancelled;
+
+            // only used by the worker thread
+            Batch m_current;
+            bool m_worldspawnParsed;
+
+            void pushCurrent();
+            static void deleteBatches(BatchList& batches);
+        public:
+            MapLoader(IO::MappedFile::Ptr file, const BBoxf& worldBounds);
+            ~MapLoader();
+
+            /*
+             Starts parsing on a worker thread. If the thread cannot be started, the file is parsed by the first call
+             to collect instead.
+             */
+            void start();
+
+            /*
+             Appends the batches parsed so far to the given list; the caller takes ownership of their objects.
+             Returns true once the entire file has been parsed and all batches have been collected.
+             */
+            bool collect(BatchList& batches);
+
+            // passes the parser's messages on, call this after loading has finished
+            void forwardMessages(Utility::Console& console);
+
+            // called by the worker thread
+            void run();
+
+            bool cancelled();
+            void entityParsed(Entity* entity);
+            void brushParsed(Brush* brush);
+            void entityFinished(size_t firstLine, size_t lineCount, size_t fileOffset, size_t fileLength);
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__MapLoader__) */
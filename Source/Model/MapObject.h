@@ -22,6 +22,7 @@
 
 #include "Model/EditState.h"
 #include "Model/MapObjectTypes.h"
+#include "Utility/Atomic.h"
 #include "Utility/VecMath.h"
 
 #include <vector>
@@ -38,6 +39,7 @@ namespace TrenchBroom {
             unsigned int m_uniqueId;
             EditState::Type m_editState;
             bool m_previouslyLocked;
+            size_t m_editStateIndex;
             
             size_t m_fileFirstLine;
             size_t m_fileLineCount;
@@ -50,10 +52,12 @@ namespace TrenchBroom {
             MapObject() :
             m_editState(EditState::Default),
             m_previouslyLocked(false),
+            m_editStateIndex(0),
             m_fileFirstLine(0),
             m_fileLineCount(0) {
-                static unsigned int currentId = 1;
-                m_uniqueId = currentId++;
+                // map objects are also created on the map loader thread
+                static volatile long long currentId = 0;
+                m_uniqueId = static_cast<unsigned int>(Utility::atomicAdd(&currentId, 1));
             }
             
             virtual ~MapObject() {
@@ -112,6 +116,18 @@ namespace TrenchBroom {
                 return previous;
             }
             
+            /*
+             Position of this object in the edit state manager's list for its current edit state. Only
+             meaningful while the object is selected, hidden or locked.
+             */
+            inline size_t editStateIndex() const {
+                return m_editStateIndex;
+            }
+            
+            inline void setEditStateIndex(size_t editStateIndex) {
+                m_editStateIndex = editStateIndex;
+            }
+            
             inline bool selected() const {
                 return m_editState == EditState::Selected;
             }
@@ -143,6 +159,10 @@ namespace TrenchBroom {
             inline size_t fileLine() const {
                 return m_fileFirstLine;
             }
+
+            inline size_t fileLineCount() const {
+                return m_fileLineCount;
+            }
             
             inline bool occupiesFileLine(size_t line) const {
                 return line >= m_fileFirstLine && line < m_fileFirstLine + m_fileLineCount;
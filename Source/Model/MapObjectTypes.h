@@ -32,6 +32,8 @@ namespace TrenchBroom {
         
         typedef std::set<MapObject*> MapObjectSet;
         static const MapObjectSet EmptyMapObjectSet;
+
+        typedef std::vector<MapObjectList> MapObjectGroupList;
     }
 }
 
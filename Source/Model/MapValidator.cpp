@@ -0,0 +1,214 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MapValidator.h"
+
+#include "Model/Brush.h"
+#include "Model/BrushGeometryTypes.h"
+#include "Model/Face.h"
+#include "Utility/Profiler.h"
+
+#include <wx/thread.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace TrenchBroom {
+    namespace Model {
+        class MapValidatorWorker : public wxThread {
+        private:
+            MapValidator& m_validator;
+        public:
+            MapValidatorWorker(MapValidator& validator) :
+            wxThread(wxTHREAD_JOINABLE),
+            m_validator(validator) {}
+
+            ExitCode Entry() {
+                size_t first, last;
+                while (m_validator.nextChunk(first, last))
+                    m_validator.checkChunk(first, last);
+                Utility::Profiler::profiler().threadFinished();
+                return (wxThread::ExitCode)0;
+            }
+        };
+
+        static const float FacePointEpsilon = 0.01f;
+        static const float OverlapCosine = 0.995f; // about 5.7 degrees
+        static const float OverlapDistance = 1.0f;
+
+        static bool liesOnPlane(const Face& face, const Planef& plane) {
+            const VertexList& vertices = face.vertices();
+            VertexList::const_iterator it, end;
+            for (it = vertices.begin(), end = vertices.end(); it != end; ++it)
+                if (std::abs(plane.pointDistance((*it)->position)) > OverlapDistance)
+                    return false;
+            return true;
+        }
+
+        /*
+         Planes closer than the point status epsilon are already dropped when the geometry is built, but planes which
+         are only slightly tilted against each other leave a sliver face that lies almost entirely on the other plane.
+         */
+        static bool overlappingPlanes(const Face& face, const Face& other) {
+            if (face.boundary().normal.dot(other.boundary().normal) < OverlapCosine)
+                return false;
+            return liesOnPlane(face, other.boundary()) || liesOnPlane(other, face.boundary());
+        }
+
+        static bool compareIssueIndex(const MapValidator::Issue& lhs, const MapValidator::Issue& rhs) {
+            return lhs.index < rhs.index;
+        }
+
+        void MapValidator::collectIssues(IssueList& issues, IssueListener* listener) {
+            IssueList finished;
+            {
+                wxMutexLocker lock(*m_mutex);
+                finished.swap(m_finished);
+            }
+
+            if (listener != NULL && !finished.empty())
+                listener->issuesFound(finished);
+            issues.insert(issues.end(), finished.begin(), finished.end());
+        }
+
+        MapValidator::MapValidator(const BBoxf& worldBounds) :
+        m_worldBounds(worldBounds),
+        m_brushes(NULL),
+        m_mutex(new wxMutex()),
+        m_nextChunk(0) {}
+
+        MapValidator::~MapValidator() {
+            delete m_mutex;
+            m_mutex = NULL;
+        }
+
+        void MapValidator::checkBrush(Brush& brush, size_t index, const BBoxf& worldBounds, IssueList& issues) {
+            const FaceList& faces = brush.faces();
+            if (faces.size() < 4 || brush.vertices().size() < 4 || !brush.closed() || !brush.sanityCheck(false))
+                issues.push_back(Issue(&brush, index, ITDegenerateBrush, "degenerate geometry"));
+
+            for (size_t i = 0; i < faces.size(); i++) {
+                const Face& face = *faces[i];
+
+                Planef plane;
+                bool validPoints = plane.setPoints(face.point(0), face.point(1), face.point(2));
+                for (size_t j = 0; j < 3 && validPoints; j++) {
+                    const Vec3f& point = face.point(j);
+                    validPoints = std::abs(face.boundary().pointDistance(point)) <= FacePointEpsilon &&
+                                  (!brush.forceIntegerFacePoints() || point.isInteger());
+                }
+
+                if (!validPoints) {
+                    StringStream description;
+                    description << "face at line " << face.filePosition() << " has invalid points";
+                    issues.push_back(Issue(&brush, index, ITInvalidFacePoints, description.str()));
+                }
+
+                for (size_t j = i + 1; j < faces.size(); j++) {
+                    const Face& other = *faces[j];
+                    if (overlappingPlanes(face, other)) {
+                        StringStream description;
+                        description << "faces at lines " << face.filePosition() << " and " << other.filePosition() << " have overlapping planes";
+                        issues.push_back(Issue(&brush, index, ITOverlappingPlanes, description.str()));
+                    }
+                }
+            }
+
+            if (!worldBounds.contains(brush.bounds()))
+                issues.push_back(Issue(&brush, index, ITOutsideWorldBounds, "outside of the world bounds"));
+        }
+
+        String MapValidator::formatIssue(const Issue& issue) {
+            StringStream str;
+            if (issue.brush->fileLine() > 0) {
+                str << "Brush at line " << issue.brush->fileLine();
+            } else {
+                const Vec3f& center = issue.brush->center();
+                str << "Brush at " << center.x() << " " << center.y() << " " << center.z();
+            }
+            str << ": " << issue.description;
+            return str.str();
+        }
+
+        MapValidator::IssueList MapValidator::validate(const BrushList& brushes, IssueListener* listener) {
+            Utility::ProfileZone zone("MapValidator::validate");
+
+            m_brushes = &brushes;
+            m_nextChunk = 0;
+            m_finished.clear();
+
+            // the calling thread checks chunks too, so no workers are needed for small maps
+            const int chunkCount = static_cast<int>((brushes.size() + ChunkSize - 1) / ChunkSize);
+            const int workerCount = std::max(0, std::min(chunkCount - 1, std::min(4, wxThread::GetCPUCount() - 1)));
+
+            std::vector<MapValidatorWorker*> workers;
+            for (int i = 0; i < workerCount; i++) {
+                MapValidatorWorker* worker = new MapValidatorWorker(*this);
+                if (worker->Create() != wxTHREAD_NO_ERROR || worker->Run() != wxTHREAD_NO_ERROR) {
+                    delete worker;
+                    continue;
+                }
+                workers.push_back(worker);
+            }
+
+            IssueList issues;
+            size_t first, last;
+            while (nextChunk(first, last)) {
+                checkChunk(first, last);
+                collectIssues(issues, listener);
+            }
+
+            for (size_t i = 0; i < workers.size(); i++) {
+                workers[i]->Wait();
+                delete workers[i];
+            }
+            collectIssues(issues, listener);
+
+            // the chunks finish in any order, but the issues of one brush are always in the same chunk
+            std::stable_sort(issues.begin(), issues.end(), compareIssueIndex);
+            m_brushes = NULL;
+            return issues;
+        }
+
+        bool MapValidator::nextChunk(size_t& first, size_t& last) {
+            wxMutexLocker lock(*m_mutex);
+            assert(m_brushes != NULL);
+            if (m_nextChunk >= m_brushes->size())
+                return false;
+            first = m_nextChunk;
+            last = std::min(first + ChunkSize, m_brushes->size());
+            m_nextChunk = last;
+            return true;
+        }
+
+        void MapValidator::checkChunk(size_t first, size_t last) {
+            Utility::ProfileZone zone("MapValidator::checkChunk");
+
+            IssueList issues;
+            for (size_t i = first; i < last; i++)
+                checkBrush(*(*m_brushes)[i], i, m_worldBounds, issues);
+
+            if (!issues.empty()) {
+                wxMutexLocker lock(*m_mutex);
+                m_finished.insert(m_finished.end(), issues.begin(), issues.end());
+            }
+        }
+    }
+}
@@ -0,0 +1,110 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__MapValidator__
+#define __TrenchBroom__MapValidator__
+
+#include "Model/BrushTypes.h"
+#include "Utility/String.h"
+#include "Utility/VecMath.h"
+
+#include <vector>
+
+using namespace TrenchBroom::VecMath;
+
+class wxMutex;
+
+namespace TrenchBroom {
+    namespace Model {
+        class Brush;
+
+        /*
+         Checks brushes for the problems which maps imported from other editors tend to have. The brushes are split
+         into chunks which are checked by worker threads; the calling thread checks chunks as well and reports the
+         issues of finished chunks in between, so that findings appear while the check is still running. The brushes
+         must not be changed until validate returns.
+         */
+        class MapValidator {
+        public:
+            typedef enum {
+                ITDegenerateBrush,
+                ITInvalidFacePoints,
+                ITOverlappingPlanes,
+                ITOutsideWorldBounds
+            } IssueType;
+
+            class Issue {
+            public:
+                Brush* brush;
+                size_t index;
+                IssueType type;
+                String description;
+
+                Issue(Brush* i_brush, size_t i_index, IssueType i_type, const String& i_description) :
+                brush(i_brush),
+                index(i_index),
+                type(i_type),
+                description(i_description) {}
+
+                // the other issues can not be fixed by correcting and snapping the vertices
+                inline bool repairable() const {
+                    return type == ITDegenerateBrush || type == ITInvalidFacePoints;
+                }
+            };
+
+            typedef std::vector<Issue> IssueList;
+
+            class IssueListener {
+            public:
+                virtual ~IssueListener() {}
+                virtual void issuesFound(const IssueList& issues) = 0;
+            };
+        private:
+            static const size_t ChunkSize = 256;
+
+            BBoxf m_worldBounds;
+            const BrushList* m_brushes;
+
+            // shared with the worker threads, guarded by m_mutex
+            wxMutex* m_mutex;
+            size_t m_nextChunk;
+            IssueList m_finished;
+
+            void collectIssues(IssueList& issues, IssueListener* listener);
+        public:
+            MapValidator(const BBoxf& worldBounds);
+            ~MapValidator();
+
+            static void checkBrush(Brush& brush, size_t index, const BBoxf& worldBounds, IssueList& issues);
+            static String formatIssue(const Issue& issue);
+
+            /*
+             Returns the issues ordered by the position of their brushes in the given list. If a listener is given, it
+             is notified on the calling thread whenever chunks with issues have finished.
+             */
+            IssueList validate(const BrushList& brushes, IssueListener* listener = NULL);
+
+            // called by the worker threads
+            bool nextChunk(size_t& first, size_t& last);
+            void checkChunk(size_t first, size_t last);
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__MapValidator__) */
@@ -31,72 +31,102 @@
 
 namespace TrenchBroom {
     namespace Model {
-        bool OctreeNode::addObject(MapObject& object, unsigned int childIndex) {
-            if (m_children[childIndex] == NULL) {
-                BBoxf childBounds;
-                switch (childIndex) {
-                    case WSB:
-                        childBounds.min[0] = m_bounds.min[0];
-                        childBounds.min[1] = m_bounds.min[1];
-                        childBounds.min[2] = m_bounds.min[2];
-                        childBounds.max[0] = (m_bounds.min[0] + m_bounds.max[0]) / 2.0f;
-                        childBounds.max[1] = (m_bounds.min[1] + m_bounds.max[1]) / 2.0f;
-                        childBounds.max[2] = (m_bounds.min[2] + m_bounds.max[2]) / 2.0f;
-                        break;
-                    case WST:
-                        childBounds.min[0] = m_bounds.min[0];
-                        childBounds.min[1] = m_bounds.min[1];
-                        childBounds.min[2] = (m_bounds.min[2] + m_bounds.max[2]) / 2.0f;
-                        childBounds.max[0] = (m_bounds.min[0] + m_bounds.max[0]) / 2.0f;
-                        childBounds.max[1] = (m_bounds.min[1] + m_bounds.max[1]) / 2.0f;
-                        childBounds.max[2] = m_bounds.max[2];
-                        break;
-                    case WNB:
-                        childBounds.min[0] = m_bounds.min[0];
-                        childBounds.min[1] = (m_bounds.min[1] + m_bounds.max[1]) / 2.0f;
-                        childBounds.min[2] = m_bounds.min[2];
-                        childBounds.max[0] = (m_bounds.min[0] + m_bounds.max[0]) / 2.0f;
-                        childBounds.max[1] = m_bounds.max[1];
-                        childBounds.max[2] = (m_bounds.min[2] + m_bounds.max[2]) / 2.0f;
-                        break;
-                    case ESB:
-                        childBounds.min[0] = (m_bounds.min[0] + m_bounds.max[0]) / 2.0f;
-                        childBounds.min[1] = m_bounds.min[1];
-                        childBounds.min[2] = m_bounds.min[2];
-                        childBounds.max[0] = m_bounds.max[0];
-                        childBounds.max[1] = (m_bounds.min[1] + m_bounds.max[1]) / 2.0f;
-                        childBounds.max[2] = (m_bounds.min[2] + m_bounds.max[2]) / 2.0f;
-                        break;
-                    case EST:
-                        childBounds.min[0] = (m_bounds.min[0] + m_bounds.max[0]) / 2.0f;
-                        childBounds.min[1] = m_bounds.min[1];
-                        childBounds.min[2] = (m_bounds.min[2] + m_bounds.max[2]) / 2.0f;
-                        childBounds.max[0] = m_bounds.max[0];
-                        childBounds.max[1] = (m_bounds.min[1] + m_bounds.max[1]) / 2.0f;
-                        childBounds.max[2] = m_bounds.max[2];
-                        break;
-                    case ENB:
-                        childBounds.min[0] = (m_bounds.min[0] + m_bounds.max[0]) / 2.0f;
-                        childBounds.min[1] = (m_bounds.min[1] + m_bounds.max[1]) / 2.0f;
-                        childBounds.min[2] = m_bounds.min[2];
-                        childBounds.max[0] = m_bounds.max[0];
-                        childBounds.max[1] = m_bounds.max[1];
-                        childBounds.max[2] = (m_bounds.min[2] + m_bounds.max[2]) / 2.0f;
-                        break;
-                    case ENT:
-                        childBounds.min[0] = (m_bounds.min[0] + m_bounds.max[0]) / 2.0f;
-                        childBounds.min[1] = (m_bounds.min[1] + m_bounds.max[1]) / 2.0f;
-                        childBounds.min[2] = (m_bounds.min[2] + m_bounds.max[2]) / 2.0f;
-                        childBounds.max[0] = m_bounds.max[0];
-                        childBounds.max[1] = m_bounds.max[1];
-                        childBounds.max[2] = m_bounds.max[2];
-                        break;
-                }
-                m_children[childIndex] = new OctreeNode(childBounds, m_minSize);
+        BBoxf OctreeNode::childBounds(const BBoxf& bounds, unsigned int childIndex) {
+            BBoxf childBounds;
+            switch (childIndex) {
+                case WSB:
+                    childBounds.min[0] = bounds.min[0];
+                    childBounds.min[1] = bounds.min[1];
+                    childBounds.min[2] = bounds.min[2];
+                    childBounds.max[0] = (bounds.min[0] + bounds.max[0]) / 2.0f;
+                    childBounds.max[1] = (bounds.min[1] + bounds.max[1]) / 2.0f;
+                    childBounds.max[2] = (bounds.min[2] + bounds.max[2]) / 2.0f;
+                    break;
+                case WST:
+                    childBounds.min[0] = bounds.min[0];
+                    childBounds.min[1] = bounds.min[1];
+                    childBounds.min[2] = (bounds.min[2] + bounds.max[2]) / 2.0f;
+                    childBounds.max[0] = (bounds.min[0] + bounds.max[0]) / 2.0f;
+                    childBounds.max[1] = (bounds.min[1] + bounds.max[1]) / 2.0f;
+                    childBounds.max[2] = bounds.max[2];
+                    break;
+                case WNB:
+                    childBounds.min[0] = bounds.min[0];
+                    childBounds.min[1] = (bounds.min[1] + bounds.max[1]) / 2.0f;
+                    childBounds.min[2] = bounds.min[2];
+                    childBounds.max[0] = (bounds.min[0] + bounds.max[0]) / 2.0f;
+                    childBounds.max[1] = bounds.max[1];
+                    childBounds.max[2] = (bounds.min[2] + bounds.max[2]) / 2.0f;
+                    break;
+                case WNT:
+                    childBounds.min[0] = bounds.min[0];
+                    childBounds.min[1] = (bounds.min[1] + bounds.max[1]) / 2.0f;
+                    childBounds.min[2] = (bounds.min[2] + bounds.max[2]) / 2.0f;
+                    childBounds.max[0] = (bounds.min[0] + bounds.max[0]) / 2.0f;
+                    childBounds.max[1] = bounds.max[1];
+                    childBounds.max[2] = bounds.max[2];
+                    break;
+                case ESB:
+                    childBounds.min[0] = (bounds.min[0] + bounds.max[0]) / 2.0f;
+                    childBounds.min[1] = bounds.min[1];
+                    childBounds.min[2] = bounds.min[2];
+                    childBounds.max[0] = bounds.max[0];
+                    childBounds.max[1] = (bounds.min[1] + bounds.max[1]) / 2.0f;
+                    childBounds.max[2] = (bounds.min[2] + bounds.max[2]) / 2.0f;
+                    break;
+                case EST:
+                    childBounds.min[0] = (bounds.min[0] + bounds.max[0]) / 2.0f;
+                    childBounds.min[1] = bounds.min[1];
+                    childBounds.min[2] = (bounds.min[2] + bounds.max[2]) / 2.0f;
+                    childBounds.max[0] = bounds.max[0];
+                    childBounds.max[1] = (bounds.min[1] + bounds.max[1]) / 2.0f;
+                    childBounds.max[2] = bounds.max[2];
+                    break;
+                case ENB:
+                    childBounds.min[0] = (bounds.min[0] + bounds.max[0]) / 2.0f;
+                    childBounds.min[1] = (bounds.min[1] + bounds.max[1]) / 2.0f;
+                    childBounds.min[2] = bounds.min[2];
+                    childBounds.max[0] = bounds.max[0];
+                    childBounds.max[1] = bounds.max[1];
+                    childBounds.max[2] = (bounds.min[2] + bounds.max[2]) / 2.0f;
+                    break;
+                case ENT:
+                    childBounds.min[0] = (bounds.min[0] + bounds.max[0]) / 2.0f;
+                    childBounds.min[1] = (bounds.min[1] + bounds.max[1]) / 2.0f;
+                    childBounds.min[2] = (bounds.min[2] + bounds.max[2]) / 2.0f;
+                    childBounds.max[0] = bounds.max[0];
+                    childBounds.max[1] = bounds.max[1];
+                    childBounds.max[2] = bounds.max[2];
+                    break;
             }
+            return childBounds;
+        }
+
+        bool OctreeNode::addObject(MapObject& object, unsigned int childIndex) {
+            if (m_children[childIndex] == NULL)
+                m_children[childIndex] = new OctreeNode(childBounds(m_bounds, childIndex), m_minSize);
             return m_children[childIndex]->addObject(object);
         }
 
+        unsigned int OctreeNode::childIndex(const BBoxf& bounds, const Vec3f& point) {
+            const Vec3f center = bounds.center();
+            unsigned int index = 0;
+            if (point[0] >= center[0])
+                index += 4;
+            if (point[1] >= center[1])
+                index += 2;
+            if (point[2] >= center[2])
+                index += 1;
+            return index;
+        }
+
+        void OctreeNode::collectObjects(MapObjectList& objects) const {
+            objects.insert(objects.end(), m_objects.begin(), m_objects.end());
+            for (unsigned int i = 0; i < 8; i++)
+                if (m_children[i] != NULL)
+                    m_children[i]->collectObjects(objects);
+        }
+
         OctreeNode::OctreeNode(const BBoxf& bounds, unsigned int minSize) :
         m_minSize(minSize),
         m_bounds(bounds) {
@@ -123,11 +153,11 @@ namespace TrenchBroom {
             return true;
         }
         
-        bool OctreeNode::removeObject(MapObject& object) {
-            if (!m_bounds.contains(object.bounds()))
+        bool OctreeNode::removeObject(MapObject& object, const BBoxf& bounds) {
+            if (!m_bounds.contains(bounds))
                 return false;
             for (unsigned int i = 0; i < 8; i++) {
-                if (m_children[i] != NULL && m_children[i]->removeObject(object)) {
+                if (m_children[i] != NULL && m_children[i]->removeObject(object, bounds)) {
                     if (m_children[i]->empty()) {
                         delete m_children[i];
                         m_children[i] = NULL;
@@ -144,6 +174,49 @@ namespace TrenchBroom {
             return true;
         }
         
+        OctreeNode::UpdateResult OctreeNode::updateObject(MapObject& object, const BBoxf& oldBounds, const BBoxf& newBounds) {
+            if (!m_bounds.contains(oldBounds))
+                return NotFound;
+            
+            // only the child which contains the center of the old bounds can hold the object
+            const unsigned int i = childIndex(m_bounds, oldBounds.center());
+            if (m_children[i] != NULL) {
+                const UpdateResult result = m_children[i]->updateObject(object, oldBounds, newBounds);
+                if (result != NotFound) {
+                    if (m_children[i]->empty()) {
+                        delete m_children[i];
+                        m_children[i] = NULL;
+                    }
+                    if (result == Escaped && m_bounds.contains(newBounds)) {
+                        addObject(object);
+                        return Updated;
+                    }
+                    return result;
+                }
+            }
+            
+            MapObjectList::iterator it = find(m_objects.begin(), m_objects.end(), &object);
+            if (it == m_objects.end())
+                return NotFound;
+            
+            if (!m_bounds.contains(newBounds)) {
+                m_objects.erase(it);
+                return Escaped;
+            }
+            
+            // the object may fit into a child now
+            if (m_bounds.max[0] - m_bounds.min[0] > m_minSize) {
+                for (unsigned int i = 0; i < 8; i++) {
+                    if (childBounds(m_bounds, i).contains(newBounds)) {
+                        m_objects.erase(it);
+                        addObject(object, i);
+                        return Updated;
+                    }
+                }
+            }
+            return Updated;
+        }
+        
         bool OctreeNode::empty() const {
             if (!m_objects.empty())
                 return false;
@@ -171,6 +244,31 @@ namespace TrenchBroom {
             }
         }
         
+        void OctreeNode::groupObjects(const OctreeNode* node, const BBoxf& bounds, float maxGroupSize, MapObjectList& objects, MapObjectGroupList& groups) {
+            if (bounds.max[0] - bounds.min[0] <= maxGroupSize) {
+                if (node != NULL)
+                    node->collectObjects(objects);
+                if (!objects.empty())
+                    groups.push_back(objects);
+                return;
+            }
+
+            if (node != NULL)
+                objects.insert(objects.end(), node->m_objects.begin(), node->m_objects.end());
+
+            MapObjectList childObjects[8];
+            for (unsigned int i = 0; i < objects.size(); i++) {
+                MapObject* object = objects[i];
+                childObjects[childIndex(bounds, object->bounds().center())].push_back(object);
+            }
+
+            for (unsigned int i = 0; i < 8; i++) {
+                const OctreeNode* child = node != NULL ? node->m_children[i] : NULL;
+                if (child != NULL || !childObjects[i].empty())
+                    groupObjects(child, childBounds(bounds, i), maxGroupSize, childObjects[i], groups);
+            }
+        }
+
         Octree::Octree(Map& map, unsigned int minSize) :
         m_minSize(minSize),
         m_map(map),
@@ -194,7 +292,18 @@ namespace TrenchBroom {
             }
         }
         
+        void Octree::applyPendingUpdates() {
+            ObjectBoundsMap::const_iterator it, end;
+            for (it = m_pendingUpdates.begin(), end = m_pendingUpdates.end(); it != end; ++it) {
+                MapObject& object = *it->first;
+                const OctreeNode::UpdateResult result = m_root->updateObject(object, it->second, object.bounds());
+                assert(result == OctreeNode::Updated);
+            }
+            m_pendingUpdates.clear();
+        }
+        
         void Octree::clear() {
+            m_pendingUpdates.clear();
             delete m_root;
             m_root = new OctreeNode(m_map.worldBounds(), m_minSize);
         }
@@ -214,17 +323,30 @@ namespace TrenchBroom {
         }
         
         void Octree::removeObject(MapObject& object) {
-            bool result = m_root->removeObject(object);
+            bool result;
+            ObjectBoundsMap::iterator it = m_pendingUpdates.find(&object);
+            if (it != m_pendingUpdates.end()) {
+                result = m_root->removeObject(object, it->second);
+                m_pendingUpdates.erase(it);
+            } else {
+                result = m_root->removeObject(object, object.bounds());
+            }
             assert(result);
         }
         
         void Octree::removeObjects(const MapObjectList& objects) {
-            bool result;
-            for (unsigned int i = 0; i < objects.size(); i++) {
-                MapObject* object = objects[i];
-                result = m_root->removeObject(*object);
-                assert(result);
-            }
+            for (unsigned int i = 0; i < objects.size(); i++)
+                removeObject(*objects[i]);
+        }
+        
+        void Octree::objectWillChange(MapObject& object) {
+            // keep the bounds the object is stored under if it changes more than once before the next query
+            m_pendingUpdates.insert(ObjectBoundsMap::value_type(&object, object.bounds()));
+        }
+        
+        void Octree::objectsWillChange(const MapObjectList& objects) {
+            for (unsigned int i = 0; i < objects.size(); i++)
+                objectWillChange(*objects[i]);
         }
         
         size_t Octree::count() const {
@@ -232,9 +354,18 @@ namespace TrenchBroom {
         }
 
         MapObjectList Octree::intersect(const Rayf& ray) {
+            applyPendingUpdates();
             MapObjectList result;
             m_root->intersect(ray, result);
             return result;
         }
+
+        MapObjectGroupList Octree::groupObjects(float maxGroupSize) {
+            applyPendingUpdates();
+            MapObjectGroupList result;
+            MapObjectList objects;
+            OctreeNode::groupObjects(m_root, m_root->bounds(), maxGroupSize, objects, result);
+            return result;
+        }
     }
 }
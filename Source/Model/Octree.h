@@ -20,6 +20,7 @@
 #ifndef TrenchBroom_Octree_h
 #define TrenchBroom_Octree_h
 
+#include <map>
 #include <vector>
 #include "Model/BrushTypes.h"
 #include "Model/EntityTypes.h"
@@ -33,6 +34,12 @@ namespace TrenchBroom {
         class Map;
         
         class OctreeNode {
+        public:
+            typedef enum {
+                NotFound,
+                Updated,
+                Escaped
+            } UpdateResult;
         private:
             typedef enum {
                 WSB,
@@ -49,22 +56,44 @@ namespace TrenchBroom {
             BBoxf m_bounds;
             MapObjectList m_objects;
             OctreeNode* m_children[8];
+            static BBoxf childBounds(const BBoxf& bounds, unsigned int childIndex);
+            static unsigned int childIndex(const BBoxf& bounds, const Vec3f& point);
+
             bool addObject(MapObject& object, unsigned int childIndex);
+            void collectObjects(MapObjectList& objects) const;
         public:
             OctreeNode(const BBoxf& bounds, unsigned int minSize);
             ~OctreeNode();
             bool addObject(MapObject& object);
-            bool removeObject(MapObject& object);
+            bool removeObject(MapObject& object, const BBoxf& bounds);
+            
+            /*
+             Moves an object that was stored according to its old bounds. If its node still contains the new
+             bounds, the object stays in that subtree, otherwise it is handed up to the nearest ancestor which
+             contains it. Nodes which become empty are deleted on the way back up.
+             */
+            UpdateResult updateObject(MapObject& object, const BBoxf& oldBounds, const BBoxf& newBounds);
             bool empty() const;
             size_t count() const;
             void intersect(const Rayf& ray, MapObjectList& objects);
+
+            inline const BBoxf& bounds() const {
+                return m_bounds;
+            }
+
+            static void groupObjects(const OctreeNode* node, const BBoxf& bounds, float maxGroupSize, MapObjectList& objects, MapObjectGroupList& groups);
         };
         
         class Octree {
         private:
+            typedef std::map<MapObject*, BBoxf> ObjectBoundsMap;
+            
             unsigned int m_minSize;
             Map& m_map;
             OctreeNode* m_root;
+            ObjectBoundsMap m_pendingUpdates;
+            
+            void applyPendingUpdates();
         public:
             Octree(Map& map, unsigned int minSize = 64);
             ~Octree();
@@ -76,9 +105,23 @@ namespace TrenchBroom {
             void removeObject(MapObject& object);
             void removeObjects(const MapObjectList& objects);
             
+            /*
+             Records the current bounds of objects which are about to change. The objects are moved to their new
+             place in the tree in one batch before the tree is queried again.
+             */
+            void objectWillChange(MapObject& object);
+            void objectsWillChange(const MapObjectList& objects);
+            
             size_t count() const;
 
             MapObjectList intersect(const Rayf& ray);
+
+            /*
+             Partitions the objects into groups of neighbouring objects. Every node which is not larger than the given
+             size becomes one group together with its descendants. Objects which are stored in larger nodes because
+             they straddle a split plane are pushed down to the child which contains their center.
+             */
+            MapObjectGroupList groupObjects(float maxGroupSize);
         };
     }
 }
@@ -21,6 +21,7 @@
 #include "Model/Face.h"
 #include "Model/MapObject.h"
 #include "Model/Octree.h"
+#include "Utility/Profiler.h"
 
 #include <algorithm>
 
@@ -68,6 +69,16 @@ namespace TrenchBroom {
             m_hits.push_back(hit);
         }
 
+        void PickResult::addTransformed(PickResult& other, const Mat4f& pointTransform, const Vec3f& rayOrigin) {
+            for (unsigned int i = 0; i < other.m_hits.size(); i++) {
+                Hit* hit = other.m_hits[i];
+                hit->transform(pointTransform, rayOrigin);
+                m_hits.push_back(hit);
+            }
+            other.m_hits.clear();
+            m_sorted = false;
+        }
+
         Hit* PickResult::first(HitType::Type typeMask, bool ignoreOccluders, Filter& filter) {
             if (!m_hits.empty()) {
                 if (!m_sorted)
@@ -111,17 +122,50 @@ namespace TrenchBroom {
             return hits(HitType::Any, filter);
         }
 
-        Picker::Picker(Octree& octree) : m_octree(octree) {}
+        Picker::Picker(Octree& octree) :
+        m_octree(octree),
+        m_hasSelectionTransform(false) {}
 
         PickResult* Picker::pick(const Rayf& ray) {
+            Utility::ProfileZone zone("Picker::pick");
             PickResult* pickResults = new PickResult();
 
             MapObjectList objects = m_octree.intersect(ray);
             for (unsigned int i = 0; i < objects.size(); i++)
-                objects[i]->pick(ray, *pickResults);
-
+                if (!m_hasSelectionTransform || !objects[i]->selected())
+                    objects[i]->pick(ray, *pickResults);
+
+            if (m_hasSelectionTransform) {
+                const Vec3f origin = m_inverseSelectionTransform * ray.origin;
+                Vec3f direction = m_inverseSelectionTransform * (ray.origin + ray.direction) - origin;
+                direction.normalize();
+                const Rayf selectionRay(origin, direction);
+                
+                PickResult selectionResults;
+                objects = m_octree.intersect(selectionRay);
+                for (unsigned int i = 0; i < objects.size(); i++)
+                    if (objects[i]->selected())
+                        objects[i]->pick(selectionRay, selectionResults);
+                pickResults->addTransformed(selectionResults, m_selectionTransform, ray.origin);
+            }
+            
             return pickResults;
         }
 
+        void Picker::setSelectionTransform(const Mat4f& transform) {
+            bool invertible;
+            const Mat4f inverse = invertedMatrix(transform, invertible);
+            if (!invertible)
+                return;
+            
+            m_selectionTransform = transform;
+            m_inverseSelectionTransform = inverse;
+            m_hasSelectionTransform = true;
+        }
+        
+        void Picker::clearSelectionTransform() {
+            m_hasSelectionTransform = false;
+        }
+
     }
 }
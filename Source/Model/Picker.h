@@ -68,6 +68,11 @@ namespace TrenchBroom {
                 return m_distance;
             }
             
+            inline void transform(const Mat4f& pointTransform, const Vec3f& rayOrigin) {
+                m_hitPoint = pointTransform * m_hitPoint;
+                m_distance = (m_hitPoint - rayOrigin).length();
+            }
+            
             virtual bool pickable(Filter& filter) const = 0;
         };
         
@@ -128,17 +133,28 @@ namespace TrenchBroom {
             ~PickResult();
             
             void add(Hit* hit);
+            void addTransformed(PickResult& other, const Mat4f& pointTransform, const Vec3f& rayOrigin);
             Hit* first(HitType::Type typeMask, bool ignoreOccluders, Filter& filter);
             HitList hits(HitType::Type typeMask, Filter& filter);
             HitList hits(Filter& filter);
         };
         
+        /*
+         While the selection is being dragged, it is only displayed at its new position, so it must be picked
+         there, too: the selected objects are hit with the ray transformed into their untransformed space.
+         */
         class Picker {
         private:
             Octree& m_octree;
+            bool m_hasSelectionTransform;
+            Mat4f m_selectionTransform;
+            Mat4f m_inverseSelectionTransform;
         public:
             Picker(Octree& octree);
             PickResult* pick(const Rayf& ray);
+            
+            void setSelectionTransform(const Mat4f& transform);
+            void clearSelectionTransform();
         };
     }
 }
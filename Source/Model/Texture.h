@@ -20,7 +20,6 @@
 #ifndef __TrenchBroom__Texture__
 #define __TrenchBroom__Texture__
 
-#include <GL/glew.h>
 #include "Utility/String.h"
 
 namespace TrenchBroom {
@@ -28,9 +28,13 @@ namespace TrenchBroom {
         m_wad(path) {}
 
         unsigned char* TextureCollectionLoader::load(const Texture& texture, const Renderer::Palette& palette, Color& averageColor) throw (IO::IOException) {
+            return load(texture.name(), texture.width(), texture.height(), palette, averageColor);
+        }
+
+        unsigned char* TextureCollectionLoader::load(const String& name, unsigned int width, unsigned int height, const Renderer::Palette& palette, Color& averageColor) throw (IO::IOException) {
             IO::Mip* mip = NULL;
             try {
-                mip = m_wad.loadMip(texture.name(), 1);
+                mip = m_wad.loadMip(name, 1);
             } catch (IO::IOException&) {
                  delete mip;
                 return NULL;
@@ -38,7 +42,7 @@ namespace TrenchBroom {
 
             assert(mip != NULL);
 
-            size_t pixelCount = texture.width() * texture.height();
+            size_t pixelCount = width * height;
             unsigned char* rgbImage = new unsigned char[pixelCount * 3];
             palette.indexedToRgb(mip->mip0(), rgbImage, pixelCount, averageColor);
             delete mip;
@@ -144,6 +148,11 @@ namespace TrenchBroom {
             return collection;
         }
 
+        void TextureManager::setCollections(const TextureCollectionList& collections) {
+            m_collections = collections;
+            reloadTextures();
+        }
+
         size_t TextureManager::indexOfTextureCollection(const String& name) {
             size_t index = m_collections.size();
             size_t i = 0;
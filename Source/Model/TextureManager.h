@@ -69,6 +69,7 @@ namespace TrenchBroom {
         public:
             TextureCollectionLoader(const String& path) throw (IO::IOException);
             unsigned char* load(const Texture& texture, const Renderer::Palette& palette, Color& averageColor) throw (IO::IOException);
+            unsigned char* load(const String& name, unsigned int width, unsigned int height, const Renderer::Palette& palette, Color& averageColor) throw (IO::IOException);
         };
         
         class TextureCollection {
@@ -99,6 +100,10 @@ namespace TrenchBroom {
                 return m_name;
             }
             
+            inline const String& path() const {
+                return m_path;
+            }
+            
             inline void update(const String& name, const String& path) {
                 m_name = name;
                 m_path = path;
@@ -123,6 +128,12 @@ namespace TrenchBroom {
             
             void addCollection(TextureCollection* collection, size_t index);
             TextureCollection* removeCollection(size_t index);
+            
+            /*
+             Replaces all collections at once and rebuilds the lookup maps only once. Collections that are not
+             contained in the given list are not deleted, they are owned by the caller from now on.
+             */
+            void setCollections(const TextureCollectionList& collections);
             size_t indexOfTextureCollection(const String& name);
             void clear();
             
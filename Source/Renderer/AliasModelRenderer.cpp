@@ -22,6 +22,7 @@
 #include <GL/glew.h>
 #include "Model/Alias.h"
 #include "Model/Entity.h"
+#include "Renderer/GLState.h"
 #include "Renderer/MapRenderer.h"
 #include "Renderer/Palette.h"
 #include "Renderer/RenderContext.h"
@@ -78,7 +79,7 @@ namespace TrenchBroom {
 
             assert(m_vertexArray != NULL);
             
-            glActiveTexture(GL_TEXTURE0);
+            GLState::state().activeTexture(GL_TEXTURE0);
             m_texture->activate();
             shaderProgram.setUniformVariable("Texture", 0);
             m_vertexArray->render();
@@ -93,6 +93,16 @@ namespace TrenchBroom {
                 return attr;
             }
             
+            static const Attribute& texCoord14f() {
+                static const Attribute attr = Attribute(4, GL_FLOAT, TexCoord1);
+                return attr;
+            }
+            
+            static const Attribute& texCoord24f() {
+                static const Attribute attr = Attribute(4, GL_FLOAT, TexCoord2);
+                return attr;
+            }
+            
             inline GLint size() const {
                 return m_size;
             }
@@ -460,21 +470,42 @@ namespace TrenchBroom {
                 attributesAdded();
             }
             
-            inline void addAttributes(const FaceVertex::List& cachedVertices) {
+            inline void addAttributes(const FaceVertex::List& vertices) {
                 assert(m_attributes[0].attributeType() == Attribute::Position);
                 assert(m_attributes[0].valueType() == GL_FLOAT);
                 assert(m_attributes[0].size() == 3);
                 assert(m_attributes[1].attributeType() == Attribute::Normal);
                 assert(m_attributes[1].valueType() == GL_FLOAT);
                 assert(m_attributes[1].size() == 3);
-                assert(m_attributes[2].attributeType() == Attribute::TexCoord0);
+                assert(m_attributes[2].attributeType() == Attribute::TexCoord1);
                 assert(m_attributes[2].valueType() == GL_FLOAT);
-                assert(m_attributes[2].size() == 2);
+                assert(m_attributes[2].size() == 4);
+                assert(m_attributes[3].attributeType() == Attribute::TexCoord2);
+                assert(m_attributes[3].valueType() == GL_FLOAT);
+                assert(m_attributes[3].size() == 4);
                 assert(m_padBy == 0);
-                assert(m_vertexCount + cachedVertices.size() <= m_vertexCapacity);
+                assert(m_vertexCount + vertices.size() <= m_vertexCapacity);
                 
-                m_writeOffset = m_block->writeBuffer(reinterpret_cast<const unsigned char*>(&cachedVertices.front()), m_writeOffset, static_cast<size_t>(cachedVertices.size() * sizeof(FaceVertex)));
-                attributesAdded(static_cast<size_t>(cachedVertices.size()));
+                m_writeOffset = m_block->writeBuffer(reinterpret_cast<const unsigned char*>(&vertices.front()), m_writeOffset, static_cast<size_t>(vertices.size() * sizeof(FaceVertex)));
+                attributesAdded(static_cast<size_t>(vertices.size()));
+            }
+            
+            /*
+             Overwrites a single attribute of vertices that have already been added. The VBO must be mapped.
+             */
+            inline void updateAttribute(size_t vertexIndex, size_t vertexCount, size_t attributeIndex, const Vec4f& value) {
+                assert(vertexIndex + vertexCount <= m_vertexCount);
+                assert(attributeIndex < m_attributes.size());
+                assert(m_attributes[attributeIndex].valueType() == GL_FLOAT);
+                assert(m_attributes[attributeIndex].size() == 4);
+                
+                size_t offset = vertexIndex * (m_vertexSize + m_padBy);
+                for (size_t i = 0; i < attributeIndex; i++)
+                    offset += m_attributes[i].sizeInBytes();
+                for (size_t i = 0; i < vertexCount; i++) {
+                    m_block->writeVec(value, offset);
+                    offset += m_vertexSize + m_padBy;
+                }
             }
             
             inline void bindAttributes(const ShaderProgram& program) {
@@ -45,6 +45,10 @@ namespace TrenchBroom {
             const Text::Alignment::Type alignment() const;
         public:
             BoxInfoSizeTextAnchor(const BBoxf& bounds, Axis::Type axis, Renderer::Camera& camera);
+
+            inline bool cameraDependent() const {
+                return true;
+            }
         };
         
         class BoxInfoMinMaxTextAnchor : public Text::TextAnchor {
@@ -21,6 +21,7 @@
 
 #include "Model/Bsp.h"
 #include "Model/Entity.h"
+#include "Renderer/GLState.h"
 #include "Renderer/MapRenderer.h"
 #include "Renderer/RenderContext.h"
 #include "Renderer/Shader/Shader.h"
@@ -109,7 +110,7 @@ namespace TrenchBroom {
             if (m_vertexArrays.empty())
                 buildVertexArrays();
             
-            glActiveTexture(GL_TEXTURE0);
+            GLState::state().activeTexture(GL_TEXTURE0);
             for (unsigned int i = 0; i < m_vertexArrays.size(); i++) {
                 TextureVertexArray& textureVertexArray = m_vertexArrays[i];
                 textureVertexArray.texture->activate();
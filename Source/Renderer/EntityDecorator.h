@@ -20,8 +20,13 @@
 #ifndef TrenchBroom_EntityDecorator_h
 #define TrenchBroom_EntityDecorator_h
 
+#include "Model/EntityTypes.h"
+#include "Utility/VecMath.h"
+
 #include <vector>
 
+using namespace TrenchBroom::VecMath;
+
 namespace TrenchBroom {
     namespace Model {
         class MapDocument;
@@ -45,7 +50,12 @@ namespace TrenchBroom {
             virtual ~EntityDecorator() {}
 
             virtual void invalidate() = 0;
-            virtual void render(Vbo& vbo, RenderContext& context) = 0;
+            virtual void invalidateEntities(const Model::EntityList& entities) = 0;
+            
+            /*
+             The selection transform is the preview transform of the selected objects while they are being dragged.
+             */
+            virtual void render(Vbo& vbo, RenderContext& context, const Mat4f& selectionTransform) = 0;
         };
     }
 }
@@ -24,145 +24,277 @@
 #include "Model/Filter.h"
 #include "Model/Map.h"
 #include "Model/MapDocument.h"
+#include "Renderer/AttributeArray.h"
 #include "Renderer/RenderContext.h"
 #include "Renderer/Shader/Shader.h"
 #include "Renderer/Shader/ShaderManager.h"
 #include "Renderer/Vbo.h"
-#include "Renderer/VertexArray.h"
-#include "Utility/Console.h"
-#include "Utility/List.h"
 #include "Utility/Preferences.h"
+#include "Utility/Profiler.h"
 #include "Utility/VecMath.h"
 
 using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
     namespace Renderer {
+        static const size_t VertexSize = 3 * sizeof(GLfloat);
+        
         void EntityLinkDecorator::clear() {
-            delete m_selectedLinkArray;
-            m_selectedLinkArray = NULL;
-            delete m_unselectedLinkArray;
-            m_unselectedLinkArray = NULL;
-            delete m_selectedKillLinkArray;
-            m_selectedKillLinkArray = NULL;
-            delete m_unselectedKillLinkArray;
-            m_unselectedKillLinkArray = NULL;
+            m_sourceLinks.clear();
+            m_invalidSources.clear();
+            if (m_vbo != NULL)
+                m_vbo->freeAllBlocks();
+            m_rangesValid = false;
         }
         
-        void EntityLinkDecorator::makeLink(Model::Entity& source, Model::Entity& target, Vec3f::List& vertices) const {
-            vertices.push_back(source.center());
-            vertices.push_back(target.center());
-        }
-
-        void EntityLinkDecorator::buildLinks(RenderContext& context, Model::Entity& entity, size_t depth, Model::EntitySet& visitedEntities, Vec3f::List& selectedLinks, Vec3f::List& unselectedLinks, Vec3f::List& selectedKillLinks, Vec3f::List& unselectedKillLinks) const {
-            if (context.viewOptions().linkDisplayMode() == View::ViewOptions::LinkDisplayLocal && depth > 1)
+        void EntityLinkDecorator::removeSourceLinks(Model::Entity* entity) {
+            SourceLinksMap::iterator it = m_sourceLinks.find(entity);
+            if (it == m_sourceLinks.end())
                 return;
+            
+            SourceLinks& sourceLinks = it->second;
+            if (sourceLinks.block != NULL)
+                sourceLinks.block->freeBlock();
+            m_sourceLinks.erase(it);
+        }
 
-            Model::EntitySet::iterator visitedIt = visitedEntities.lower_bound(&entity);
-            if (visitedIt != visitedEntities.end() && *visitedIt == &entity)
-                return;
+        Vec3f EntityLinkDecorator::linkPosition(const Model::Entity& entity) const {
+            if (entity.selected() || entity.partiallySelected())
+                return m_selectionTransform * entity.center();
+            return entity.center();
+        }
 
-            visitedEntities.insert(visitedIt, &entity);
-            const bool entityVisible = context.filter().entityVisible(entity);
+        void EntityLinkDecorator::writeLinks(Model::Entity& source, Model::Entity& target, Vec3f::List& vertices) const {
+            vertices.push_back(linkPosition(target));
+            vertices.push_back(linkPosition(source));
+        }
 
-            Model::EntityList::const_iterator entityIt, entityEnd;
+        void EntityLinkDecorator::validateSourceLinks(RenderContext& context, Model::Entity& source) {
+            removeSourceLinks(&source);
+            if (source.map() == NULL || !context.filter().entityVisible(source))
+                return;
             
-            const Model::EntityList& linkTargets = entity.linkTargets();
-            for (entityIt = linkTargets.begin(), entityEnd = linkTargets.end(); entityIt != entityEnd; ++entityIt) {
-                Model::Entity& target = **entityIt;
-                if (entityVisible && context.filter().entityVisible(target) &&
-                    (context.viewOptions().linkDisplayMode() != View::ViewOptions::LinkDisplayLocal || entity.selected() || entity.partiallySelected() || target.selected() || target.partiallySelected()))
-                    makeLink(target, entity, entity.selected() || entity.partiallySelected() || target.selected() || target.partiallySelected() ? selectedLinks : unselectedLinks);
-                if (context.viewOptions().linkDisplayMode() != View::ViewOptions::LinkDisplayLocal || depth == 0)
-                    buildLinks(context, target, depth + 1, visitedEntities, selectedLinks, unselectedLinks, selectedKillLinks, unselectedKillLinks);
-            }
+            const bool sourceSelected = source.selected() || source.partiallySelected();
+            Vec3f::List vertices[LinkCategoryCount];
+            Model::EntityList::const_iterator it, end;
             
-            const Model::EntityList& linkSources = entity.linkSources();
-            for (entityIt = linkSources.begin(), entityEnd = linkSources.end(); entityIt != entityEnd; ++entityIt) {
-                Model::Entity& source = **entityIt;
-                if (context.viewOptions().linkDisplayMode() != View::ViewOptions::LinkDisplayLocal || depth <= 1)
-                    buildLinks(context, source, depth + 1, visitedEntities, selectedLinks, unselectedLinks, selectedKillLinks, unselectedKillLinks);
+            const Model::EntityList& linkTargets = source.linkTargets();
+            for (it = linkTargets.begin(), end = linkTargets.end(); it != end; ++it) {
+                Model::Entity& target = **it;
+                if (context.filter().entityVisible(target))
+                    writeLinks(source, target, vertices[sourceSelected || target.selected() || target.partiallySelected() ? SelectedLinks : UnselectedLinks]);
             }
             
-            const Model::EntityList& killTargets = entity.killTargets();
-            for (entityIt = killTargets.begin(), entityEnd = killTargets.end(); entityIt != entityEnd; ++entityIt) {
-                Model::Entity& target = **entityIt;
-                if (entityVisible && context.filter().entityVisible(target) &&
-                    (context.viewOptions().linkDisplayMode() != View::ViewOptions::LinkDisplayLocal || entity.selected() || entity.partiallySelected() || target.selected() || target.partiallySelected()))
-                    makeLink(target, entity, entity.selected() || entity.partiallySelected() || target.selected() || target.partiallySelected() ? selectedKillLinks : unselectedKillLinks);
-                if (context.viewOptions().linkDisplayMode() != View::ViewOptions::LinkDisplayLocal || depth == 0)
-                    buildLinks(context, target, depth + 1, visitedEntities, selectedLinks, unselectedLinks, selectedKillLinks, unselectedKillLinks);
+            const Model::EntityList& killTargets = source.killTargets();
+            for (it = killTargets.begin(), end = killTargets.end(); it != end; ++it) {
+                Model::Entity& target = **it;
+                if (context.filter().entityVisible(target))
+                    writeLinks(source, target, vertices[sourceSelected || target.selected() || target.partiallySelected() ? SelectedKillLinks : UnselectedKillLinks]);
             }
             
-            const Model::EntityList& killSources = entity.killSources();
-            for (entityIt = killSources.begin(), entityEnd = killSources.end(); entityIt != entityEnd; ++entityIt) {
-                Model::Entity& source = **entityIt;
-                if (context.viewOptions().linkDisplayMode() != View::ViewOptions::LinkDisplayLocal || depth <= 1)
-                    buildLinks(context, source, depth + 1, visitedEntities, selectedLinks, unselectedLinks, selectedKillLinks, unselectedKillLinks);
+            size_t vertexCount = 0;
+            for (size_t i = 0; i < LinkCategoryCount; i++)
+                vertexCount += vertices[i].size();
+            if (vertexCount == 0)
+                return;
+            
+            SourceLinks& sourceLinks = m_sourceLinks[&source];
+            sourceLinks.block = m_vbo->allocBlock(vertexCount * VertexSize);
+            
+            size_t offset = 0;
+            for (size_t i = 0; i < LinkCategoryCount; i++) {
+                sourceLinks.vertexCounts[i] = vertices[i].size();
+                if (!vertices[i].empty())
+                    offset = sourceLinks.block->writeVecs(vertices[i], offset);
             }
         }
-
-        EntityLinkDecorator::EntityLinkDecorator(const Model::MapDocument& document, const Color& color) :
-        EntityDecorator(document),
-        m_color(color),
-        m_selectedLinkArray(NULL),
-        m_unselectedLinkArray(NULL),
-        m_selectedKillLinkArray(NULL),
-        m_unselectedKillLinkArray(NULL),
-        m_valid(false) {}
-
-        EntityLinkDecorator::~EntityLinkDecorator() {
-            clear();
-        }
-
-        void EntityLinkDecorator::render(Vbo& vbo, RenderContext& context) {
-            if (context.viewOptions().linkDisplayMode() == View::ViewOptions::LinkDisplayNone)
-                return;
-
-            SetVboState activateVbo(vbo, Vbo::VboActive);
+        
+        void EntityLinkDecorator::validateLinks(RenderContext& context) {
+            Model::Map& map = document().map();
             
             if (!m_valid) {
                 clear();
                 
-                Vec3f::List selectedLinks, unselectedLinks, selectedKillLinks, unselectedKillLinks;
-                Model::EntitySet visitedEntities;
-
-                const Model::EntityList& entities = context.viewOptions().linkDisplayMode() == View::ViewOptions::LinkDisplayAll ? document().map().entities() : document().editStateManager().allSelectedEntities();
+                SetVboState mapVbo(*m_vbo, Vbo::VboMapped);
+                const Model::EntityList& entities = map.entities();
                 Model::EntityList::const_iterator it, end;
                 for (it = entities.begin(), end = entities.end(); it != end; ++it) {
                     Model::Entity& entity = **it;
-                    buildLinks(context, entity, 0, visitedEntities, selectedLinks, unselectedLinks, selectedKillLinks, unselectedKillLinks);
+                    if (!entity.linkTargets().empty() || !entity.killTargets().empty())
+                        validateSourceLinks(context, entity);
                 }
                 
-                SetVboState mapVbo(vbo, Vbo::VboMapped);
-                if (!selectedLinks.empty()) {
-                    m_selectedLinkArray = new VertexArray(vbo, GL_LINES, static_cast<unsigned int>(selectedLinks.size()), Attribute::position3f(), 0);
-                    m_selectedLinkArray->addAttributes(selectedLinks);
+                map.clearLinkChanges();
+                m_valid = true;
+                m_rangesValid = false;
+                return;
+            }
+            
+            Model::EntitySet::const_iterator it, end;
+            const Model::EntitySet& removedSources = map.removedLinkSources();
+            for (it = removedSources.begin(), end = removedSources.end(); it != end; ++it) {
+                Model::Entity* entity = *it;
+                removeSourceLinks(entity);
+                m_invalidSources.erase(entity);
+                m_rangesValid = false;
+            }
+            
+            const Model::EntitySet& changedSources = map.changedLinkSources();
+            m_invalidSources.insert(changedSources.begin(), changedSources.end());
+            map.clearLinkChanges();
+            
+            if (m_invalidSources.empty())
+                return;
+            
+            SetVboState mapVbo(*m_vbo, Vbo::VboMapped);
+            for (it = m_invalidSources.begin(), end = m_invalidSources.end(); it != end; ++it)
+                validateSourceLinks(context, **it);
+            m_invalidSources.clear();
+            m_rangesValid = false;
+        }
+        
+        void EntityLinkDecorator::addRanges(const SourceLinks& sourceLinks, bool selectedOnly) {
+            GLint first = static_cast<GLint>(sourceLinks.block->address() / VertexSize);
+            for (size_t i = 0; i < LinkCategoryCount; i++) {
+                const GLsizei count = static_cast<GLsizei>(sourceLinks.vertexCounts[i]);
+                if (count > 0 && (!selectedOnly || i == SelectedLinks || i == SelectedKillLinks)) {
+                    m_firstIndices[i].push_back(first);
+                    m_vertexCounts[i].push_back(count);
                 }
-                
-                if (!unselectedLinks.empty()) {
-                    m_unselectedLinkArray = new VertexArray(vbo, GL_LINES, static_cast<unsigned int>(unselectedLinks.size()), Attribute::position3f(), 0);
-                    m_unselectedLinkArray->addAttributes(unselectedLinks);
+                first += count;
+            }
+        }
+        
+        void EntityLinkDecorator::validateRanges(RenderContext& context) {
+            for (size_t i = 0; i < LinkCategoryCount; i++) {
+                m_firstIndices[i].clear();
+                m_vertexCounts[i].clear();
+            }
+            
+            m_linkDisplayMode = context.viewOptions().linkDisplayMode();
+            switch (m_linkDisplayMode) {
+                case View::ViewOptions::LinkDisplayAll: {
+                    SourceLinksMap::const_iterator it, end;
+                    for (it = m_sourceLinks.begin(), end = m_sourceLinks.end(); it != end; ++it)
+                        addRanges(it->second, false);
+                    break;
                 }
-
-                if (!selectedKillLinks.empty()) {
-                    m_selectedKillLinkArray = new VertexArray(vbo, GL_LINES, static_cast<unsigned int>(selectedKillLinks.size()), Attribute::position3f(), 0);
-                    m_selectedKillLinkArray->addAttributes(selectedKillLinks);
+                case View::ViewOptions::LinkDisplayLocal: {
+                    // only the links that touch a selected entity, these are stored with the selected entities
+                    // themselves or with their sources
+                    Model::EntitySet sources;
+                    const Model::EntityList selectedEntities = document().editStateManager().allSelectedEntities();
+                    Model::EntityList::const_iterator it, end;
+                    for (it = selectedEntities.begin(), end = selectedEntities.end(); it != end; ++it) {
+                        Model::Entity& entity = **it;
+                        sources.insert(&entity);
+                        sources.insert(entity.linkSources().begin(), entity.linkSources().end());
+                        sources.insert(entity.killSources().begin(), entity.killSources().end());
+                    }
+                    
+                    Model::EntitySet::const_iterator sourceIt, sourceEnd;
+                    for (sourceIt = sources.begin(), sourceEnd = sources.end(); sourceIt != sourceEnd; ++sourceIt) {
+                        SourceLinksMap::const_iterator linksIt = m_sourceLinks.find(*sourceIt);
+                        if (linksIt != m_sourceLinks.end())
+                            addRanges(linksIt->second, true);
+                    }
+                    break;
                 }
-                
-                if (!unselectedKillLinks.empty()) {
-                    m_unselectedKillLinkArray = new VertexArray(vbo, GL_LINES, static_cast<unsigned int>(unselectedKillLinks.size()), Attribute::position3f(), 0);
-                    m_unselectedKillLinkArray->addAttributes(unselectedKillLinks);
+                case View::ViewOptions::LinkDisplayContext: {
+                    // all links in the link components that contain a selected entity
+                    Model::EntitySet visited;
+                    Model::EntityList stack = document().editStateManager().allSelectedEntities();
+                    while (!stack.empty()) {
+                        Model::Entity* entity = stack.back();
+                        stack.pop_back();
+                        if (!visited.insert(entity).second)
+                            continue;
+                        
+                        SourceLinksMap::const_iterator linksIt = m_sourceLinks.find(entity);
+                        if (linksIt != m_sourceLinks.end())
+                            addRanges(linksIt->second, false);
+                        
+                        stack.insert(stack.end(), entity->linkTargets().begin(), entity->linkTargets().end());
+                        stack.insert(stack.end(), entity->linkSources().begin(), entity->linkSources().end());
+                        stack.insert(stack.end(), entity->killTargets().begin(), entity->killTargets().end());
+                        stack.insert(stack.end(), entity->killSources().begin(), entity->killSources().end());
+                    }
+                    break;
                 }
+                default:
+                    break;
+            }
+            
+            m_rangesValid = true;
+        }
+        
+        void EntityLinkDecorator::renderLinks(LinkCategory category) {
+            const IndexList& firstIndices = m_firstIndices[category];
+            if (firstIndices.empty())
+                return;
+            
+            const CountList& vertexCounts = m_vertexCounts[category];
+            glMultiDrawArrays(GL_LINES, &firstIndices[0], &vertexCounts[0], static_cast<GLsizei>(firstIndices.size()));
+            Utility::Profiler::profiler().countDrawCalls();
+        }
 
-                m_valid = true;
+        EntityLinkDecorator::EntityLinkDecorator(const Model::MapDocument& document, const Color& color) :
+        EntityDecorator(document),
+        m_color(color),
+        m_vbo(NULL),
+        m_linkDisplayMode(View::ViewOptions::LinkDisplayNone),
+        m_selectionTransform(Mat4f::Identity),
+        m_valid(false),
+        m_rangesValid(false) {}
+
+        EntityLinkDecorator::~EntityLinkDecorator() {
+            clear();
+            delete m_vbo;
+            m_vbo = NULL;
+        }
+
+        void EntityLinkDecorator::invalidateEntities(const Model::EntityList& entities) {
+            Model::EntityList::const_iterator it, end;
+            for (it = entities.begin(), end = entities.end(); it != end; ++it) {
+                Model::Entity& entity = **it;
+                
+                // the incoming links of an entity are stored with their sources
+                m_invalidSources.insert(&entity);
+                m_invalidSources.insert(entity.linkSources().begin(), entity.linkSources().end());
+                m_invalidSources.insert(entity.killSources().begin(), entity.killSources().end());
             }
+            m_rangesValid = false;
+        }
 
-            if (m_selectedLinkArray == NULL && m_unselectedLinkArray == NULL)
+        void EntityLinkDecorator::render(Vbo& vbo, RenderContext& context, const Mat4f& selectionTransform) {
+            if (context.viewOptions().linkDisplayMode() == View::ViewOptions::LinkDisplayNone)
+                return;
+
+            // the links of the selected entities follow the selection while it is being dragged
+            if (!(selectionTransform == m_selectionTransform)) {
+                m_selectionTransform = selectionTransform;
+                invalidateEntities(document().editStateManager().allSelectedEntities());
+            }
+
+            if (m_vbo == NULL)
+                m_vbo = new Vbo(GL_ARRAY_BUFFER, 0xFFF * VertexSize);
+            
+            validateLinks(context);
+            if (!m_rangesValid || m_linkDisplayMode != context.viewOptions().linkDisplayMode())
+                validateRanges(context);
+
+            bool empty = true;
+            for (size_t i = 0; i < LinkCategoryCount && empty; i++)
+                empty = m_firstIndices[i].empty();
+            if (empty)
                 return;
 
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
 
+            SetVboState activateVbo(*m_vbo, Vbo::VboActive);
+            Attribute position(Attribute::position3f());
+            position.setGLState(0, VertexSize, 0);
+            
             ActivateShader shader(context.shaderManager(), Shaders::EntityLinkShader);
             shader.setUniformVariable("CameraPosition", context.camera().position());
             shader.setUniformVariable("MaxDistance", 512.0f);
@@ -172,50 +304,29 @@ namespace TrenchBroom {
             glDepthMask(GL_FALSE);
             glDisable(GL_DEPTH_TEST);
 
-            if (m_unselectedLinkArray != NULL) {
-                shader.setUniformVariable("Color", prefs.getColor(Preferences::OccludedEntityLinkColor));
-                m_unselectedLinkArray->render();
-            }
-            
-            if (m_selectedLinkArray != NULL) {
-                shader.setUniformVariable("Color", prefs.getColor(Preferences::OccludedSelectedEntityLinkColor));
-                m_selectedLinkArray->render();
-            }
-            
-            if (m_unselectedKillLinkArray != NULL) {
-                shader.setUniformVariable("Color", prefs.getColor(Preferences::OccludedEntityKillLinkColor));
-                m_unselectedKillLinkArray->render();
-            }
-            
-            if (m_selectedKillLinkArray != NULL) {
-                shader.setUniformVariable("Color", prefs.getColor(Preferences::OccludedSelectedEntityKillLinkColor));
-                m_selectedKillLinkArray->render();
-            }
+            shader.setUniformVariable("Color", prefs.getColor(Preferences::OccludedEntityLinkColor));
+            renderLinks(UnselectedLinks);
+            shader.setUniformVariable("Color", prefs.getColor(Preferences::OccludedSelectedEntityLinkColor));
+            renderLinks(SelectedLinks);
+            shader.setUniformVariable("Color", prefs.getColor(Preferences::OccludedEntityKillLinkColor));
+            renderLinks(UnselectedKillLinks);
+            shader.setUniformVariable("Color", prefs.getColor(Preferences::OccludedSelectedEntityKillLinkColor));
+            renderLinks(SelectedKillLinks);
             
             glEnable(GL_DEPTH_TEST);
 
-            if (m_unselectedLinkArray != NULL) {
-                shader.setUniformVariable("Color", prefs.getColor(Preferences::EntityLinkColor));
-                m_unselectedLinkArray->render();
-            }
-
-            if (m_selectedLinkArray != NULL) {
-                shader.setUniformVariable("Color", prefs.getColor(Preferences::SelectedEntityLinkColor));
-                m_selectedLinkArray->render();
-            }
-            
-            if (m_unselectedKillLinkArray != NULL) {
-                shader.setUniformVariable("Color", prefs.getColor(Preferences::EntityKillLinkColor));
-                m_unselectedKillLinkArray->render();
-            }
-            
-            if (m_selectedKillLinkArray != NULL) {
-                shader.setUniformVariable("Color", prefs.getColor(Preferences::SelectedEntityKillLinkColor));
-                m_selectedKillLinkArray->render();
-            }
+            shader.setUniformVariable("Color", prefs.getColor(Preferences::EntityLinkColor));
+            renderLinks(UnselectedLinks);
+            shader.setUniformVariable("Color", prefs.getColor(Preferences::SelectedEntityLinkColor));
+            renderLinks(SelectedLinks);
+            shader.setUniformVariable("Color", prefs.getColor(Preferences::EntityKillLinkColor));
+            renderLinks(UnselectedKillLinks);
+            shader.setUniformVariable("Color", prefs.getColor(Preferences::SelectedEntityKillLinkColor));
+            renderLinks(SelectedKillLinks);
 
             glDepthMask(GL_TRUE);
             glLineWidth(1.0f);
+            position.clearGLState(0);
         }
     }
 }
@@ -20,32 +20,77 @@
 #ifndef __TrenchBroom__EntityLinkDecorator__
 #define __TrenchBroom__EntityLinkDecorator__
 
+#include <GL/glew.h>
 #include "Renderer/EntityDecorator.h"
 
 #include "Model/Entity.h"
 #include "Utility/Color.h"
 #include "View/ViewOptions.h"
 
+#include <map>
+#include <vector>
+
 namespace TrenchBroom {
     namespace Model {
         class MapDocument;
     }
     
     namespace Renderer {
-        class VertexArray;
+        class Vbo;
+        class VboBlock;
         
+        /*
+         Keeps the link segments of every entity in a persistent VBO. Each entity that has targets or killtargets owns
+         a block with its outgoing segments, sorted by link category. When entities change, only the blocks of the
+         affected link sources are rewritten, and the draw ranges for the current link display mode are gathered from
+         the existing blocks.
+         */
         class EntityLinkDecorator : public EntityDecorator {
         private:
+            typedef enum {
+                SelectedLinks = 0,
+                UnselectedLinks = 1,
+                SelectedKillLinks = 2,
+                UnselectedKillLinks = 3,
+                LinkCategoryCount = 4
+            } LinkCategory;
+            
+            class SourceLinks {
+            public:
+                VboBlock* block;
+                size_t vertexCounts[LinkCategoryCount];
+                
+                SourceLinks() : block(NULL) {
+                    for (size_t i = 0; i < LinkCategoryCount; i++)
+                        vertexCounts[i] = 0;
+                }
+            };
+            
+            typedef std::map<Model::Entity*, SourceLinks> SourceLinksMap;
+            typedef std::vector<GLint> IndexList;
+            typedef std::vector<GLsizei> CountList;
+            
             Color m_color;
-            VertexArray* m_selectedLinkArray;
-            VertexArray* m_unselectedLinkArray;
-            VertexArray* m_selectedKillLinkArray;
-            VertexArray* m_unselectedKillLinkArray;
+            Vbo* m_vbo;
+            SourceLinksMap m_sourceLinks;
+            Model::EntitySet m_invalidSources;
+            View::ViewOptions::LinkDisplayMode m_linkDisplayMode;
+            Mat4f m_selectionTransform;
             bool m_valid;
             
+            IndexList m_firstIndices[LinkCategoryCount];
+            CountList m_vertexCounts[LinkCategoryCount];
+            bool m_rangesValid;
+            
             void clear();
-            void makeLink(Model::Entity& source, Model::Entity& target, Vec3f::List& vertices) const;
-            void buildLinks(RenderContext& context, Model::Entity& entity, size_t depth, Model::EntitySet& visitedEntities, Vec3f::List& selectedLinks, Vec3f::List& unselectedLinks, Vec3f::List& selectedKillLinks, Vec3f::List& unselectedKillLinks) const;
+            void removeSourceLinks(Model::Entity* entity);
+            Vec3f linkPosition(const Model::Entity& entity) const;
+            void writeLinks(Model::Entity& source, Model::Entity& target, Vec3f::List& vertices) const;
+            void validateSourceLinks(RenderContext& context, Model::Entity& source);
+            void validateLinks(RenderContext& context);
+            void addRanges(const SourceLinks& sourceLinks, bool selectedOnly);
+            void validateRanges(RenderContext& context);
+            void renderLinks(LinkCategory category);
         public:
             EntityLinkDecorator(const Model::MapDocument& document, const Color& color);
             ~EntityLinkDecorator();
@@ -53,8 +98,10 @@ namespace TrenchBroom {
             inline void invalidate() {
                 m_valid = false;
             }
+            
+            void invalidateEntities(const Model::EntityList& entities);
 
-            void render(Vbo& vbo, RenderContext& context);
+            void render(Vbo& vbo, RenderContext& context, const Mat4f& selectionTransform);
         };
     }
 }
@@ -33,11 +33,49 @@
 #include "Utility/Console.h"
 #include "Utility/Map.h"
 #include "Utility/Preferences.h"
+#include "Utility/Profiler.h"
+
+#include <wx/app.h>
+#include <wx/thread.h>
 
 #include <cassert>
 
 namespace TrenchBroom {
     namespace Renderer {
+        static EntityModelRendererManager::LoadResult loadModel(const EntityModelRendererManager::LoadRequest& request) {
+            Utility::ProfileZone zone("EntityModelRendererManager::loadModel");
+
+            EntityModelRendererManager::LoadResult result;
+            result.request = request;
+            result.alias = NULL;
+            result.bsp = NULL;
+            if (request.bsp)
+                result.bsp = Model::BspManager::loadBsp(request.modelName, request.searchPaths);
+            else
+                result.alias = Model::AliasManager::loadAlias(request.modelName, request.searchPaths);
+            return result;
+        }
+
+        class EntityModelLoader : public wxThread {
+        private:
+            EntityModelRendererManager& m_manager;
+        public:
+            EntityModelLoader(EntityModelRendererManager& manager) :
+            wxThread(wxTHREAD_JOINABLE),
+            m_manager(manager) {}
+
+            ExitCode Entry() {
+                EntityModelRendererManager::LoadRequest request;
+                while (m_manager.nextRequest(request)) {
+                    m_manager.addResult(loadModel(request));
+                    wxWakeUpIdle();
+                }
+
+                Utility::Profiler::profiler().threadFinished();
+                return (wxThread::ExitCode)0;
+            }
+        };
+
         const String EntityModelRendererManager::modelRendererKey(const Model::ModelDefinition& modelDefinition, const StringList& searchPaths) {
             StringStream key;
             for (size_t i = 0; i < searchPaths.size(); i++)
@@ -64,28 +102,23 @@ namespace TrenchBroom {
             if (rendererIt != m_modelRenderers.end())
                 return rendererIt->second;
 
+            if (m_pendingRenderers.count(key) > 0)
+                return NULL;
+
             String modelName = Utility::toLower(modelDefinition.name().substr(1));
             String ext = Utility::toLower(fileManager.pathExtension(modelName));
             if (ext == "mdl") {
-                unsigned int skinIndex = modelDefinition.skinIndex();
-                unsigned int frameIndex = modelDefinition.frameIndex();
-
-                Model::AliasManager& aliasManager = *Model::AliasManager::sharedManager;
-                const Model::Alias* alias = aliasManager.alias(modelName, searchPaths, m_console);
-
-                if (alias != NULL && skinIndex < alias->skins().size() && frameIndex < alias->frames().size()) {
-                    Renderer::EntityModelRenderer* renderer = new AliasModelRenderer(*alias, frameIndex, skinIndex, *m_vbo, *m_palette);
-                    m_modelRenderers[key] = renderer;
-                    return renderer;
-                }
+                const Model::Alias* alias = Model::AliasManager::sharedManager->cachedAlias(modelName, searchPaths);
+                if (alias != NULL)
+                    return createRenderer(key, *alias, modelDefinition.skinIndex(), modelDefinition.frameIndex());
+                requestModel(key, modelName, false, searchPaths, modelDefinition.skinIndex(), modelDefinition.frameIndex());
+                return NULL;
             } else if (ext == "bsp") {
-                Model::BspManager& bspManager = *Model::BspManager::sharedManager;
-                const Model::Bsp* bsp = bspManager.bsp(modelName, searchPaths, m_console);
-                if (bsp != NULL) {
-                    Renderer::EntityModelRenderer* renderer = new BspModelRenderer(*bsp, *m_vbo, *m_palette);
-                    m_modelRenderers[key] = renderer;
-                    return renderer;
-                }
+                const Model::Bsp* bsp = Model::BspManager::sharedManager->cachedBsp(modelName, searchPaths);
+                if (bsp != NULL)
+                    return createRenderer(key, *bsp);
+                requestModel(key, modelName, true, searchPaths, modelDefinition.skinIndex(), modelDefinition.frameIndex());
+                return NULL;
             } else {
                 m_console.warn("Unknown model type '%s'", ext.c_str());
             }
@@ -94,17 +127,112 @@ namespace TrenchBroom {
             return NULL;
         }
 
+        EntityModelRenderer* EntityModelRendererManager::createRenderer(const String& key, const Model::Alias& alias, unsigned int skinIndex, unsigned int frameIndex) {
+            if (skinIndex < alias.skins().size() && frameIndex < alias.frames().size()) {
+                Renderer::EntityModelRenderer* renderer = new AliasModelRenderer(alias, frameIndex, skinIndex, *m_vbo, *m_palette);
+                m_modelRenderers[key] = renderer;
+                return renderer;
+            }
+
+            m_mismatches.insert(key);
+            return NULL;
+        }
+
+        EntityModelRenderer* EntityModelRendererManager::createRenderer(const String& key, const Model::Bsp& bsp) {
+            Renderer::EntityModelRenderer* renderer = new BspModelRenderer(bsp, *m_vbo, *m_palette);
+            m_modelRenderers[key] = renderer;
+            return renderer;
+        }
+
+        void EntityModelRendererManager::requestModel(const String& key, const String& modelName, bool bsp, const StringList& searchPaths, unsigned int skinIndex, unsigned int frameIndex) {
+            m_pendingRenderers.insert(key);
+
+            // several renderers can wait for the same file, e.g. for different skins of a model
+            const String fileKey = Utility::join(searchPaths, " ") + " " + modelName;
+            PendingFileMap::iterator it = m_pendingFiles.find(fileKey);
+            if (it != m_pendingFiles.end()) {
+                it->second.push_back(PendingRenderer(key, skinIndex, frameIndex));
+                return;
+            }
+            m_pendingFiles[fileKey].push_back(PendingRenderer(key, skinIndex, frameIndex));
+
+            m_console.info("Loading '%s' (searching %s)", modelName.c_str(), Utility::join(searchPaths, ", ").c_str());
+
+            if (m_loader == NULL) {
+                m_loader = new EntityModelLoader(*this);
+                if (m_loader->Create() != wxTHREAD_NO_ERROR || m_loader->Run() != wxTHREAD_NO_ERROR) {
+                    delete m_loader;
+                    m_loader = NULL;
+                }
+            }
+
+            LoadRequest request;
+            request.fileKey = fileKey;
+            request.modelName = modelName;
+            request.searchPaths = searchPaths;
+            request.bsp = bsp;
+
+            // if no loader thread could be started, the model is loaded right away and collected as usual
+            if (m_loader == NULL) {
+                request.generation = m_generation;
+                addResult(loadModel(request));
+                return;
+            }
+
+            wxMutexLocker lock(*m_mutex);
+            request.generation = m_generation;
+            m_requests.push_back(request);
+            m_condition->Signal();
+        }
+
+        void EntityModelRendererManager::clearPending() {
+            wxMutexLocker lock(*m_mutex);
+            m_requests.clear();
+            m_generation++;
+            m_pendingFiles.clear();
+            m_pendingRenderers.clear();
+        }
+
         EntityModelRendererManager::EntityModelRendererManager(Utility::Console& console) :
         m_palette(NULL),
         m_console(console),
-        m_valid(true) {
+        m_valid(true),
+        m_revision(0),
+        m_mutex(new wxMutex()),
+        m_condition(new wxCondition(*m_mutex)),
+        m_generation(0),
+        m_shutdown(false),
+        m_loader(NULL) {
             m_vbo = new Renderer::Vbo(GL_ARRAY_BUFFER, 0xFFFF);
         }
 
         EntityModelRendererManager::~EntityModelRendererManager() {
+            if (m_loader != NULL) {
+                m_mutex->Lock();
+                m_shutdown = true;
+                m_condition->Broadcast();
+                m_mutex->Unlock();
+                
+                m_loader->Wait();
+                delete m_loader;
+                m_loader = NULL;
+            }
+            
+            // results which were never collected
+            LoadResultList::iterator it, end;
+            for (it = m_results.begin(), end = m_results.end(); it != end; ++it) {
+                delete it->alias;
+                delete it->bsp;
+            }
+            m_results.clear();
+            
             clear();
             delete m_vbo;
             m_vbo = NULL;
+            delete m_condition;
+            m_condition = NULL;
+            delete m_mutex;
+            m_mutex = NULL;
         }
 
         EntityModelRenderer* EntityModelRendererManager::modelRenderer(const Model::PointEntityDefinition& entityDefinition, const StringList& searchPaths) {
@@ -127,6 +255,7 @@ namespace TrenchBroom {
 
         void EntityModelRendererManager::clear() {
             clearMismatches();
+            clearPending();
             Utility::deleteAll(m_modelRenderers);
         }
         
@@ -134,6 +263,59 @@ namespace TrenchBroom {
             m_mismatches.clear();
         }
 
+        bool EntityModelRendererManager::collectModels() {
+            LoadResultList results;
+            m_mutex->Lock();
+            results.swap(m_results);
+            m_mutex->Unlock();
+            
+            if (results.empty())
+                return false;
+
+            Model::AliasManager& aliasManager = *Model::AliasManager::sharedManager;
+            Model::BspManager& bspManager = *Model::BspManager::sharedManager;
+            bool changed = false;
+
+            LoadResultList::const_iterator resultIt, resultEnd;
+            for (resultIt = results.begin(), resultEnd = results.end(); resultIt != resultEnd; ++resultIt) {
+                const LoadResult& result = *resultIt;
+                const LoadRequest& request = result.request;
+
+                // parsed models don't depend on the palette, so they are cached even if the request is stale
+                const Model::Alias* alias = result.alias != NULL ? aliasManager.addAlias(request.modelName, request.searchPaths, result.alias) : NULL;
+                const Model::Bsp* bsp = result.bsp != NULL ? bspManager.addBsp(request.modelName, request.searchPaths, result.bsp) : NULL;
+                if (request.generation != m_generation)
+                    continue;
+
+                PendingFileMap::iterator fileIt = m_pendingFiles.find(request.fileKey);
+                if (fileIt == m_pendingFiles.end())
+                    continue;
+                
+                if (alias == NULL && bsp == NULL)
+                    m_console.warn("Unable to find %s '%s'", request.bsp ? "BSP" : "MDL", request.modelName.c_str());
+
+                const PendingRendererList& pendingRenderers = fileIt->second;
+                PendingRendererList::const_iterator it, end;
+                for (it = pendingRenderers.begin(), end = pendingRenderers.end(); it != end; ++it) {
+                    const PendingRenderer& pending = *it;
+                    if (alias != NULL)
+                        createRenderer(pending.key, *alias, pending.skinIndex, pending.frameIndex);
+                    else if (bsp != NULL)
+                        createRenderer(pending.key, *bsp);
+                    else
+                        m_mismatches.insert(pending.key);
+                    m_pendingRenderers.erase(pending.key);
+                }
+
+                m_pendingFiles.erase(fileIt);
+                changed = true;
+            }
+
+            if (changed)
+                m_revision++;
+            return changed;
+        }
+
         void EntityModelRendererManager::setPalette(const Palette& palette) {
             if (&palette == m_palette)
                 return;
@@ -148,5 +330,22 @@ namespace TrenchBroom {
         void EntityModelRendererManager::deactivate() {
             m_vbo->deactivate();
         }
+
+        bool EntityModelRendererManager::nextRequest(LoadRequest& request) {
+            wxMutexLocker lock(*m_mutex);
+            while (m_requests.empty() && !m_shutdown)
+                m_condition->Wait();
+            if (m_shutdown)
+                return false;
+
+            request = m_requests.front();
+            m_requests.pop_front();
+            return true;
+        }
+
+        void EntityModelRendererManager::addResult(const LoadResult& result) {
+            wxMutexLocker lock(*m_mutex);
+            m_results.push_back(result);
+        }
     }
 }
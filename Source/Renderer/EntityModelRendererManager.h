@@ -22,12 +22,18 @@
 
 #include "Utility/String.h"
 
+#include <deque>
 #include <map>
 #include <vector>
 #include <set>
 
+class wxCondition;
+class wxMutex;
+
 namespace TrenchBroom {
     namespace Model {
+        class Alias;
+        class Bsp;
         class Entity;
         class PointEntityDefinition;
         class ModelDefinition;
@@ -38,15 +44,56 @@ namespace TrenchBroom {
     }
     
     namespace Renderer {
+        class EntityModelLoader;
         class EntityModelRenderer;
         class Palette;
         class Vbo;
         
+        /*
+         Models are resolved and parsed by a background thread. Until a model is ready, modelRenderer returns NULL
+         and the entity is drawn as its bounding box. The parsed models are picked up on the main thread by
+         collectModels, which also increments the revision so that cached renderer lookups can be refreshed. The
+         renderers upload their geometry when they are first rendered, which happens on the main thread as well.
+         */
         class EntityModelRendererManager {
+        public:
+            class LoadRequest {
+            public:
+                String fileKey;
+                String modelName;
+                StringList searchPaths;
+                bool bsp;
+                unsigned int generation;
+            };
+            
+            class LoadResult {
+            public:
+                LoadRequest request;
+                Model::Alias* alias;
+                Model::Bsp* bsp;
+            };
         private:
             typedef std::map<String, EntityModelRenderer*> EntityModelRendererCache;
             typedef std::set<String> MismatchCache;
             
+            class PendingRenderer {
+            public:
+                String key;
+                unsigned int skinIndex;
+                unsigned int frameIndex;
+                
+                PendingRenderer(const String& i_key, unsigned int i_skinIndex, unsigned int i_frameIndex) :
+                key(i_key),
+                skinIndex(i_skinIndex),
+                frameIndex(i_frameIndex) {}
+            };
+            
+            typedef std::vector<PendingRenderer> PendingRendererList;
+            typedef std::map<String, PendingRendererList> PendingFileMap;
+            typedef std::set<String> PendingRendererSet;
+            typedef std::deque<LoadRequest> LoadRequestQueue;
+            typedef std::vector<LoadResult> LoadResultList;
+            
             const Palette* m_palette;
             Utility::Console& m_console;
             
@@ -54,9 +101,26 @@ namespace TrenchBroom {
             EntityModelRendererCache m_modelRenderers;
             MismatchCache m_mismatches;
             bool m_valid;
+            
+            PendingFileMap m_pendingFiles;
+            PendingRendererSet m_pendingRenderers;
+            unsigned int m_revision;
+            
+            // shared with the loader thread, guarded by m_mutex
+            wxMutex* m_mutex;
+            wxCondition* m_condition;
+            LoadRequestQueue m_requests;
+            LoadResultList m_results;
+            unsigned int m_generation;
+            bool m_shutdown;
+            EntityModelLoader* m_loader;
 
             const String modelRendererKey(const Model::ModelDefinition& modelDefinition, const StringList& searchPaths);
             EntityModelRenderer* modelRenderer(const Model::ModelDefinition& modelDefinition, const StringList& searchPaths);
+            EntityModelRenderer* createRenderer(const String& key, const Model::Alias& alias, unsigned int skinIndex, unsigned int frameIndex);
+            EntityModelRenderer* createRenderer(const String& key, const Model::Bsp& bsp);
+            void requestModel(const String& key, const String& modelName, bool bsp, const StringList& searchPaths, unsigned int skinIndex, unsigned int frameIndex);
+            void clearPending();
 
             // prevent copying
             EntityModelRendererManager(const EntityModelRendererManager& other);
@@ -70,10 +134,20 @@ namespace TrenchBroom {
             void clear();
             void clearMismatches();
             
+            bool collectModels();
+            
+            inline unsigned int revision() const {
+                return m_revision;
+            }
+            
             void setPalette(const Palette& palette);
             
             void activate();
             void deactivate();
+
+            // called by the loader thread
+            bool nextRequest(LoadRequest& request);
+            void addResult(const LoadResult& result);
         };
     }
 }
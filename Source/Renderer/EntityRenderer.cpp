@@ -236,6 +236,7 @@ namespace TrenchBroom {
         m_boundsVertexArray(NULL),
         m_boundsValid(true),
         m_modelRendererCacheValid(true),
+        m_modelRevision(document.sharedResources().modelRendererManager().revision()),
         m_classnameRenderer(NULL),
         m_classnameColor(1.0f, 1.0f, 1.0f, 1.0f),
         m_classnameBackgroundColor(0.0f, 0.0f, 0.0f, 0.6f),
@@ -316,6 +317,7 @@ namespace TrenchBroom {
 
         void EntityRenderer::invalidateBounds() {
             m_boundsValid = false;
+            m_classnameRenderer->invalidatePositions();
         }
 
         void EntityRenderer::invalidateModels() {
@@ -353,6 +355,12 @@ namespace TrenchBroom {
         void EntityRenderer::render(RenderContext& context) {
             if (!m_boundsValid)
                 validateBounds(context);
+            // pick up the models which were loaded in the background since the last frame
+            const unsigned int modelRevision = m_document.sharedResources().modelRendererManager().revision();
+            if (modelRevision != m_modelRevision) {
+                m_modelRevision = modelRevision;
+                m_modelRendererCacheValid = false;
+            }
             if (!m_modelRendererCacheValid)
                 validateModels(context);
 
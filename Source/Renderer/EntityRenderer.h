@@ -84,6 +84,7 @@ namespace TrenchBroom {
             bool m_boundsValid;
             EntityModelRenderers m_modelRenderers;
             bool m_modelRendererCacheValid;
+            unsigned int m_modelRevision;
             EntityClassnameRenderer* m_classnameRenderer;
             
             Color m_classnameColor;
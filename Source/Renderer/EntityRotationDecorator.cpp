@@ -24,6 +24,7 @@
 #include "Model/Filter.h"
 #include "Model/Map.h"
 #include "Model/MapDocument.h"
+#include "Renderer/ApplyMatrix.h"
 #include "Renderer/RenderContext.h"
 #include "Renderer/RenderUtils.h"
 #include "Renderer/Shader/Shader.h"
@@ -44,7 +45,7 @@ namespace TrenchBroom {
         m_fillColor(fillColor),
         m_outlineColor(outlineColor) {}
         
-        void EntityRotationDecorator::render(Vbo& vbo, RenderContext& context) {
+        void EntityRotationDecorator::render(Vbo& vbo, RenderContext& context, const Mat4f& selectionTransform) {
             if (!context.viewOptions().showEntities() || !context.viewOptions().showEntityBounds())
                 return;
             
@@ -98,6 +99,7 @@ namespace TrenchBroom {
             
             SetVboState activateVbo(vbo, Vbo::VboActive);
             ActivateShader shader(context.shaderManager(), Shaders::HandleShader);
+            ApplyModelMatrix applySelectionTransform(context.transformation(), selectionTransform);
             
             glDepthMask(GL_FALSE);
             glDisable(GL_DEPTH_TEST);
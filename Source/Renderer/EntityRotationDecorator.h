@@ -40,8 +40,9 @@ namespace TrenchBroom {
             EntityRotationDecorator(const Model::MapDocument& document, const Color& fillColor, const Color& outlineColor);
             
             inline void invalidate() {}
+            inline void invalidateEntities(const Model::EntityList& entities) {}
             
-            void render(Vbo& vbo, RenderContext& context);
+            void render(Vbo& vbo, RenderContext& context, const Mat4f& selectionTransform);
         };
     }
 }
@@ -20,6 +20,7 @@
 #include "FaceRenderer.h"
 
 #include "Model/Face.h"
+#include "Renderer/GLState.h"
 #include "Renderer/RenderContext.h"
 #include "Renderer/Shader/ShaderManager.h"
 #include "Renderer/Shader/ShaderProgram.h"
@@ -36,11 +37,37 @@ namespace TrenchBroom {
     namespace Renderer {
         String FaceRenderer::AlphaBlendedTextures[] = {"clip", "hint", /*"skip",*/ "hintskip", "trigger"};
 
+        size_t FaceRenderer::faceVertexCount(const Model::Face& face) {
+            return 3 * (face.vertices().size() - 2);
+        }
+
+        void FaceRenderer::writeFace(const Model::Face& face, VertexArray& vertexArray, FaceVertex::List& vertices) {
+            const Model::VertexList& faceVertices = face.vertices();
+            const Vec3f& normal = face.boundary().normal;
+            const Vec4f texAxisX(face.scaledTexAxisX(), face.xOffset());
+            const Vec4f texAxisY(face.scaledTexAxisY(), face.yOffset());
+
+            vertices.clear();
+            for (size_t i = 1; i < faceVertices.size() - 1; i++) {
+                vertices.push_back(FaceVertex(faceVertices[0]->position, normal, texAxisX, texAxisY));
+                vertices.push_back(FaceVertex(faceVertices[i]->position, normal, texAxisX, texAxisY));
+                vertices.push_back(FaceVertex(faceVertices[i+1]->position, normal, texAxisX, texAxisY));
+            }
+            vertexArray.addAttributes(vertices);
+        }
+
+        void FaceRenderer::updateFace(const Model::Face& face, VertexArray& vertexArray, size_t firstVertex) {
+            const size_t vertexCount = faceVertexCount(face);
+            vertexArray.updateAttribute(firstVertex, vertexCount, 2, Vec4f(face.scaledTexAxisX(), face.xOffset()));
+            vertexArray.updateAttribute(firstVertex, vertexCount, 3, Vec4f(face.scaledTexAxisY(), face.yOffset()));
+        }
+
         void FaceRenderer::writeFaceData(Vbo& vbo, TextureRendererManager& textureRendererManager, const Sorter& faceSorter) {
             const FaceCollectionMap& faceCollectionMap = faceSorter.collections();
             if (faceCollectionMap.empty())
                 return;
             
+            FaceVertex::List vertices;
             FaceCollectionMap::const_iterator it, end;
             for (it = faceCollectionMap.begin(), end = faceCollectionMap.end(); it != end; ++it) {
                 Model::Texture* texture = it->first;
@@ -51,13 +78,13 @@ namespace TrenchBroom {
                 VertexArray* vertexArray = new VertexArray(vbo, GL_TRIANGLES, vertexCount,
                                                            Attribute::position3f(),
                                                            Attribute::normal3f(),
-                                                           Attribute::texCoord02f(),
+                                                           Attribute::texCoord14f(),
+                                                           Attribute::texCoord24f(),
                                                            0);
                 
-                for (size_t i = 0; i < faces.size(); i++) {
-                    Model::Face* face = faces[i];
-                    vertexArray->addAttributes(face->cachedVertices());
-                }
+                for (size_t i = 0; i < faces.size(); i++)
+                    writeFace(*faces[i], *vertexArray, vertices);
+                m_faceArrays.push_back(FaceArray(texture, vertexArray, faces));
                 
                 if (texture != NULL && alphaBlend(texture->name()))
                     m_transparentVertexArrays.push_back(TextureVertexArray(textureRenderer, vertexArray));
@@ -66,8 +93,43 @@ namespace TrenchBroom {
             }
         }
 
-        void FaceRenderer::render(RenderContext& context, bool grayScale, const Color* tintColor) {
-            if (m_vertexArrays.empty() && m_transparentVertexArrays.empty())
+        void FaceRenderer::validateFaceLocations() {
+            if (!m_faceLocations.empty())
+                return;
+            
+            for (size_t i = 0; i < m_faceArrays.size(); i++) {
+                const FaceArray& faceArray = m_faceArrays[i];
+                size_t firstVertex = 0;
+                for (size_t j = 0; j < faceArray.faces.size(); j++) {
+                    const Model::Face* face = faceArray.faces[j];
+                    m_faceLocations.insert(FaceLocationMap::value_type(face, FaceLocation(faceArray.texture, faceArray.vertexArray, firstVertex)));
+                    firstVertex += faceVertexCount(*face);
+                }
+            }
+        }
+
+        bool FaceRenderer::updateTextureAttributes(Vbo& vbo, const Model::FaceList& faces) {
+            validateFaceLocations();
+            
+            Model::FaceList::const_iterator faceIt, faceEnd;
+            for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt) {
+                const Model::Face* face = *faceIt;
+                FaceLocationMap::const_iterator locationIt = m_faceLocations.find(face);
+                if (locationIt == m_faceLocations.end() || locationIt->second.texture != face->texture())
+                    return false;
+            }
+            
+            SetVboState mapVbo(vbo, Vbo::VboMapped);
+            for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt) {
+                const Model::Face* face = *faceIt;
+                const FaceLocation& location = m_faceLocations.find(face)->second;
+                updateFace(*face, *location.vertexArray, location.firstVertex);
+            }
+            return true;
+        }
+
+        void FaceRenderer::render(RenderContext& context, bool grayScale, const Color* tintColor, bool opaque, bool transparent) {
+            if ((!opaque || m_vertexArrays.empty()) && (!transparent || m_transparentVertexArrays.empty()))
                 return;
             
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
@@ -77,7 +139,7 @@ namespace TrenchBroom {
             ShaderProgram& faceProgram = shaderManager.shaderProgram(Shaders::FaceShader);
             
             if (faceProgram.activate()) {
-                glActiveTexture(GL_TEXTURE0);
+                GLState::state().activeTexture(GL_TEXTURE0);
                 
                 const bool applyTexture = context.viewOptions().faceRenderMode() == View::ViewOptions::Textured;
                 faceProgram.setUniformVariable("Brightness", prefs.getFloat(Preferences::RendererBrightness));
@@ -95,11 +157,14 @@ namespace TrenchBroom {
                 faceProgram.setUniformVariable("ShadeFaces", context.viewOptions().shadeFaces() );
                 faceProgram.setUniformVariable("UseFog", context.viewOptions().useFog() );
                 
-                renderOpaqueFaces(faceProgram, applyTexture);
-                glDepthMask(GL_FALSE);
-                faceProgram.setUniformVariable("Alpha", prefs.getFloat(Preferences::TransparentFaceAlpha));
-                renderTransparentFaces(faceProgram, applyTexture);
-                glDepthMask(GL_TRUE);
+                if (opaque)
+                    renderOpaqueFaces(faceProgram, applyTexture);
+                if (transparent) {
+                    glDepthMask(GL_FALSE);
+                    faceProgram.setUniformVariable("Alpha", prefs.getFloat(Preferences::TransparentFaceAlpha));
+                    renderTransparentFaces(faceProgram, applyTexture);
+                    glDepthMask(GL_TRUE);
+                }
 
                 faceProgram.deactivate();
             }
@@ -114,23 +179,36 @@ namespace TrenchBroom {
         }
 
         void FaceRenderer::renderFaces(const TextureVertexArrayList& vertexArrays, ShaderProgram& shader, const bool applyTexture) {
+            if (vertexArrays.empty())
+                return;
+
+            const GLint applyTextureLocation = shader.uniformLocation("ApplyTexture");
+            const GLint textureSizeLocation = shader.uniformLocation("TextureSize");
+            const GLint colorLocation = shader.uniformLocation("Color");
+            shader.setUniformVariable("FaceTexture", 0);
+
+            // binding the next texture replaces the previous one, so the texture is only unbound once at the end
+            bool textureBound = false;
             for (size_t i = 0; i < vertexArrays.size(); i++) {
                 const TextureVertexArray& textureVertexArray = vertexArrays[i];
                 if (textureVertexArray.texture != NULL) {
                     textureVertexArray.texture->activate();
-                    shader.setUniformVariable("ApplyTexture", applyTexture);
-                    shader.setUniformVariable("FaceTexture", 0);
-                    shader.setUniformVariable("Color", textureVertexArray.texture->averageColor());
+                    textureBound = true;
+                    shader.setUniformVariable(applyTextureLocation, applyTexture);
+                    shader.setUniformVariable(textureSizeLocation, Vec2f(static_cast<float>(textureVertexArray.texture->width()),
+                                                                         static_cast<float>(textureVertexArray.texture->height())));
+                    shader.setUniformVariable(colorLocation, textureVertexArray.texture->averageColor());
                 } else {
-                    shader.setUniformVariable("ApplyTexture", false);
-                    shader.setUniformVariable("Color", m_faceColor);
+                    shader.setUniformVariable(applyTextureLocation, false);
+                    shader.setUniformVariable(textureSizeLocation, Vec2f(1.0f, 1.0f));
+                    shader.setUniformVariable(colorLocation, m_faceColor);
                 }
                 
                 textureVertexArray.vertexArray->render();
-                
-                if (textureVertexArray.texture != NULL)
-                    textureVertexArray.texture->deactivate();
             }
+
+            if (textureBound)
+                GLState::state().bindTexture(0);
         }
 
         FaceRenderer::FaceRenderer(Vbo& vbo, TextureRendererManager& textureRendererManager, const Sorter& faceSorter, const Color& faceColor) :
@@ -139,11 +217,19 @@ namespace TrenchBroom {
         }
         
         void FaceRenderer::render(RenderContext& context, bool grayScale) {
-            render(context, grayScale, NULL);
+            render(context, grayScale, NULL, true, true);
         }
         
         void FaceRenderer::render(RenderContext& context, bool grayScale, const Color& tintColor) {
-            render(context, grayScale, &tintColor);
+            render(context, grayScale, &tintColor, true, true);
+        }
+
+        void FaceRenderer::renderOpaque(RenderContext& context) {
+            render(context, false, NULL, true, false);
+        }
+
+        void FaceRenderer::renderTransparent(RenderContext& context) {
+            render(context, false, NULL, false, true);
         }
     }
 }
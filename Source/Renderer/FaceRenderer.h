@@ -20,10 +20,14 @@
 #ifndef __TrenchBroom__FaceRenderer__
 #define __TrenchBroom__FaceRenderer__
 
+#include "Model/FaceTypes.h"
+#include "Renderer/FaceVertex.h"
 #include "Renderer/TexturedPolygonSorter.h"
 #include "Renderer/TextureVertexArray.h"
 #include "Utility/Color.h"
 
+#include <map>
+
 namespace TrenchBroom {
     namespace Model {
         class Face;
@@ -42,12 +46,52 @@ namespace TrenchBroom {
             typedef Sorter::PolygonCollection FaceCollection;
             typedef Sorter::PolygonCollectionMap FaceCollectionMap;
 
+            class FaceArray {
+            public:
+                Model::Texture* texture;
+                VertexArray* vertexArray;
+                Model::FaceList faces;
+
+                FaceArray(Model::Texture* i_texture, VertexArray* i_vertexArray, const Model::FaceList& i_faces) :
+                texture(i_texture),
+                vertexArray(i_vertexArray),
+                faces(i_faces) {}
+            };
+
+            class FaceLocation {
+            public:
+                Model::Texture* texture;
+                VertexArray* vertexArray;
+                size_t firstVertex;
+
+                FaceLocation(Model::Texture* i_texture, VertexArray* i_vertexArray, size_t i_firstVertex) :
+                texture(i_texture),
+                vertexArray(i_vertexArray),
+                firstVertex(i_firstVertex) {}
+            };
+
+            typedef std::vector<FaceArray> FaceArrayList;
+            typedef std::map<const Model::Face*, FaceLocation> FaceLocationMap;
+
             Color m_faceColor;
             TextureVertexArrayList m_vertexArrays;
             TextureVertexArrayList m_transparentVertexArrays;
+            FaceArrayList m_faceArrays;
+            FaceLocationMap m_faceLocations;
             
             static String AlphaBlendedTextures[];
             
+            static size_t faceVertexCount(const Model::Face& face);
+            static void writeFace(const Model::Face& face, VertexArray& vertexArray, FaceVertex::List& vertices);
+            static void updateFace(const Model::Face& face, VertexArray& vertexArray, size_t firstVertex);
+
+            void writeFaceData(Vbo& vbo, TextureRendererManager& textureRendererManager, const Sorter& faceSorter);
+            void validateFaceLocations();
+            void render(RenderContext& context, bool grayScale, const Color* tintColor, bool opaque, bool transparent);
+            void renderOpaqueFaces(ShaderProgram& shader, const bool applyTexture);
+            void renderTransparentFaces(ShaderProgram& shader, const bool applyTexture);
+            void renderFaces(const TextureVertexArrayList& vertexArrays, ShaderProgram& shader, const bool applyTexture);
+        public:
             inline static bool alphaBlend(const String& textureName) {
                 if (textureName.empty())
                     return false;
@@ -59,16 +103,23 @@ namespace TrenchBroom {
                 return false;
             }
             
-            void writeFaceData(Vbo& vbo, TextureRendererManager& textureRendererManager, const Sorter& faceSorter);
-            void render(RenderContext& context, bool grayScale, const Color* tintColor);
-            void renderOpaqueFaces(ShaderProgram& shader, const bool applyTexture);
-            void renderTransparentFaces(ShaderProgram& shader, const bool applyTexture);
-            void renderFaces(const TextureVertexArrayList& vertexArrays, ShaderProgram& shader, const bool applyTexture);
-        public:
             FaceRenderer(Vbo& vbo, TextureRendererManager& textureRendererManager, const Sorter& faceSorter, const Color& faceColor);
             
+            /*
+             Rewrites the texture axes and offsets of the given faces in place. Returns false if any of the faces is
+             not rendered by this renderer or if its texture has changed, in which case the renderer must be rebuilt.
+             */
+            bool updateTextureAttributes(Vbo& vbo, const Model::FaceList& faces);
+
             void render(RenderContext& context, bool grayScale);
             void render(RenderContext& context, bool grayScale, const Color& tintColor);
+
+            /*
+             Render only the opaque or only the transparent faces. When several renderers are drawn, all opaque faces
+             must be drawn first because the transparent faces do not write to the depth buffer.
+             */
+            void renderOpaque(RenderContext& context);
+            void renderTransparent(RenderContext& context);
         };
     }
 }
@@ -31,22 +31,33 @@ namespace TrenchBroom {
 #if defined _WIN32
 #pragma pack(push,1)
 #endif
+        /*
+         The texture coordinates of face vertices are computed in the face shader from the texture axes and offsets,
+         so changing the texture attributes of a face only needs the two texture axis attributes to be rewritten.
+         */
         struct FaceVertex {
             typedef std::vector<FaceVertex> List;
             
             float px, py, pz;
             float nx, ny, nz;
-            float ts, tt;
+            float sx, sy, sz, so;
+            float tx, ty, tz, to;
             
-            FaceVertex(const Vec3f& position, const Vec3f& normal, const Vec2f& texCoord) :
+            FaceVertex(const Vec3f& position, const Vec3f& normal, const Vec4f& texAxisX, const Vec4f& texAxisY) :
             px(position.x()),
             py(position.y()),
             pz(position.z()),
             nx(normal.x()),
             ny(normal.y()),
             nz(normal.z()),
-            ts(texCoord.x()),
-            tt(texCoord.y()) {}
+            sx(texAxisX.x()),
+            sy(texAxisX.y()),
+            sz(texAxisX.z()),
+            so(texAxisX.w()),
+            tx(texAxisY.x()),
+            ty(texAxisY.y()),
+            tz(texAxisY.z()),
+            to(texAxisY.w()) {}
             
             FaceVertex() {}
             
@@ -0,0 +1,146 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GLState.h"
+
+#include "Utility/Profiler.h"
+
+namespace TrenchBroom {
+    namespace Renderer {
+        GLState::GLState() {
+            reset();
+        }
+
+        size_t GLState::bufferIndex(const GLenum target) {
+            switch (target) {
+                case GL_ARRAY_BUFFER:
+                    return 0;
+                case GL_ELEMENT_ARRAY_BUFFER:
+                    return 1;
+                default:
+                    return BufferTargetCount;
+            }
+        }
+
+        void GLState::countChange(const bool issued) {
+            if (issued)
+                Utility::Profiler::profiler().countStateChanges();
+            else
+                Utility::Profiler::profiler().countSkippedStateChanges();
+        }
+
+        GLState& GLState::state() {
+            static GLState instance;
+            return instance;
+        }
+
+        void GLState::reset() {
+            m_program = Unknown;
+            m_activeTexture = Unknown;
+            for (size_t i = 0; i < TextureUnitCount; i++)
+                m_textures[i] = Unknown;
+            for (size_t i = 0; i < BufferTargetCount; i++)
+                m_buffers[i] = Unknown;
+            m_blend = Unknown;
+            m_blendSrc = Unknown;
+            m_blendDest = Unknown;
+        }
+
+        void GLState::useProgram(const GLuint programId) {
+            const bool issue = m_program != programId;
+            if (issue) {
+                glUseProgram(programId);
+                m_program = programId;
+            }
+            countChange(issue);
+        }
+
+        void GLState::activeTexture(const GLenum unit) {
+            const bool issue = m_activeTexture != unit;
+            if (issue) {
+                glActiveTexture(unit);
+                m_activeTexture = unit;
+            }
+            countChange(issue);
+        }
+
+        void GLState::bindTexture(const GLuint textureId) {
+            const size_t index = m_activeTexture != Unknown ? static_cast<size_t>(m_activeTexture - GL_TEXTURE0) : TextureUnitCount;
+            const bool issue = index >= TextureUnitCount || m_textures[index] != textureId;
+            if (issue) {
+                glBindTexture(GL_TEXTURE_2D, textureId);
+                if (index < TextureUnitCount)
+                    m_textures[index] = textureId;
+            }
+            countChange(issue);
+        }
+
+        void GLState::bindBuffer(const GLenum target, const GLuint bufferId) {
+            const size_t index = bufferIndex(target);
+            const bool issue = index >= BufferTargetCount || m_buffers[index] != bufferId;
+            if (issue) {
+                glBindBuffer(target, bufferId);
+                if (index < BufferTargetCount)
+                    m_buffers[index] = bufferId;
+            }
+            countChange(issue);
+        }
+
+        void GLState::enableBlend(const bool enable) {
+            const GLuint blend = enable ? 1 : 0;
+            const bool issue = m_blend != blend;
+            if (issue) {
+                if (enable)
+                    glEnable(GL_BLEND);
+                else
+                    glDisable(GL_BLEND);
+                m_blend = blend;
+            }
+            countChange(issue);
+        }
+
+        void GLState::blendFunc(const GLenum src, const GLenum dest) {
+            const bool issue = m_blendSrc != src || m_blendDest != dest;
+            if (issue) {
+                glBlendFunc(src, dest);
+                m_blendSrc = src;
+                m_blendDest = dest;
+            }
+            countChange(issue);
+        }
+
+        void GLState::programDeleted(const GLuint programId) {
+            // a deleted program stays in use until another one is installed, but its name may be reused
+            if (m_program == programId)
+                m_program = Unknown;
+        }
+
+        void GLState::textureDeleted(const GLuint textureId) {
+            for (size_t i = 0; i < TextureUnitCount; i++)
+                if (m_textures[i] == textureId)
+                    m_textures[i] = 0;
+        }
+
+        void GLState::bufferDeleted(const GLuint bufferId) {
+            for (size_t i = 0; i < BufferTargetCount; i++)
+                if (m_buffers[i] == bufferId)
+                    m_buffers[i] = 0;
+        }
+    }
+}
@@ -0,0 +1,75 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__GLState__
+#define __TrenchBroom__GLState__
+
+#include <GL/glew.h>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        /*
+         Shadows the program, texture, buffer and blend bindings of the current GL context so that redundant state
+         changes can be skipped. Every canvas has its own context, so the shadow state must be reset whenever a
+         context is made current. Issued and skipped changes are counted per frame by the profiler.
+         */
+        class GLState {
+        private:
+            static const GLuint Unknown = 0xFFFFFFFF;
+            static const size_t TextureUnitCount = 8;
+            static const size_t BufferTargetCount = 2;
+
+            GLuint m_program;
+            GLenum m_activeTexture;
+            GLuint m_textures[TextureUnitCount];
+            GLuint m_buffers[BufferTargetCount];
+            GLuint m_blend;
+            GLenum m_blendSrc;
+            GLenum m_blendDest;
+
+            GLState();
+
+            static size_t bufferIndex(GLenum target);
+            void countChange(bool issued);
+        public:
+            static GLState& state();
+
+            /* Forget the shadowed state. Call after making a context current or after raw GL state changes. */
+            void reset();
+
+            inline GLuint program() const {
+                return m_program;
+            }
+
+            void useProgram(GLuint programId);
+            void activeTexture(GLenum unit);
+            void bindTexture(GLuint textureId);
+            void bindBuffer(GLenum target, GLuint bufferId);
+            void enableBlend(bool enable);
+            void blendFunc(GLenum src, GLenum dest);
+
+            /* Deleting a bound object resets its binding to 0, so GL may reuse the name. */
+            void programDeleted(GLuint programId);
+            void textureDeleted(GLuint textureId);
+            void bufferDeleted(GLuint bufferId);
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__GLState__) */
@@ -25,6 +25,7 @@
 #include <GL/glew.h>
 #include "Renderer/Vbo.h"
 #include "Renderer/Shader/Shader.h"
+#include "Utility/Profiler.h"
 #include "Utility/String.h"
 
 #include <cassert>
@@ -97,6 +98,7 @@ namespace TrenchBroom {
                 
                 setup();
                 glMultiDrawArrays(m_primType, indexArray, countArray, static_cast<GLint>(m_primCount));
+                Utility::Profiler::profiler().countDrawCalls();
                 cleanup();
             }
         };
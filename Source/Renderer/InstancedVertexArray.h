@@ -21,7 +21,9 @@
 #define TrenchBroom_InstancedVertexArray_h
 
 #include "Renderer/AttributeArray.h"
+#include "Renderer/GLState.h"
 #include "Utility/List.h"
+#include "Utility/Profiler.h"
 #include "Utility/String.h"
 
 #include <cassert>
@@ -53,6 +55,7 @@ namespace TrenchBroom {
             virtual ~InstanceAttributes() {
                 if (m_textureId > 0) {
                     glDeleteTextures(1, &m_textureId);
+                    GLState::state().textureDeleted(m_textureId);
                     m_textureId = 0;
                 }
             }
@@ -73,15 +76,15 @@ namespace TrenchBroom {
                 if (m_textureId == 0) {
                     glGenTextures(1, &m_textureId);
                     assert(m_textureId > 0);
-                    glBindTexture(GL_TEXTURE_2D, m_textureId);
+                    GLState::state().bindTexture(m_textureId);
                     m_textureSize = createTexture(m_textureId);
                 } else {
-                    glBindTexture(GL_TEXTURE_2D, m_textureId);
+                    GLState::state().bindTexture(m_textureId);
                 }
             }
             
             inline void cleanup() {
-                glBindTexture(GL_TEXTURE_2D, 0);
+                GLState::state().bindTexture(0);
             }
         };
         
@@ -164,7 +167,7 @@ namespace TrenchBroom {
                 InstanceAttributesList::const_iterator it, end;
                 for (it = m_instanceAttributes.begin(), end = m_instanceAttributes.end(); it != end; ++it) {
                     InstanceAttributes& attributes = **it;
-                    glActiveTexture(GL_TEXTURE0 + textureNum);
+                    GLState::state().activeTexture(GL_TEXTURE0 + textureNum);
                     attributes.setup();
                     program.setUniformVariable(attributes.name(), static_cast<int>(textureNum));
                     program.setUniformVariable(attributes.textureSizeName(), attributes.textureSize());
@@ -172,11 +175,12 @@ namespace TrenchBroom {
                 }
                 
                 glDrawArraysInstancedARB(m_primType, 0, static_cast<GLsizei>(m_vertexCount), static_cast<GLsizei>(m_instanceCount));
+                Utility::Profiler::profiler().countDrawCalls();
                 
                 textureNum = GL_TEXTURE0;
                 for (it = m_instanceAttributes.begin(), end = m_instanceAttributes.end(); it != end; ++it) {
                     InstanceAttributes& attributes = **it;
-                    glActiveTexture(textureNum++);
+                    GLState::state().activeTexture(textureNum++);
                     attributes.cleanup();
                 }
                 
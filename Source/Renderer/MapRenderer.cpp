@@ -23,8 +23,13 @@
 #include "Controller/Command.h"
 #include "Controller/ChangeEditStateCommand.h"
 #include "Controller/EntityPropertyCommand.h"
+#include "Controller/LoadObjectsCommand.h"
+#include "Controller/MoveTexturesCommand.h"
 #include "Controller/PreferenceChangeEvent.h"
+#include "Controller/RebindTexturesCommand.h"
 #include "Controller/RemoveObjectsCommand.h"
+#include "Controller/RotateTexturesCommand.h"
+#include "Controller/SetFaceAttributesCommand.h"
 #include "IO/FileManager.h"
 #include "Model/Brush.h"
 #include "Model/BrushGeometry.h"
@@ -34,11 +39,16 @@
 #include "Model/Filter.h"
 #include "Model/Map.h"
 #include "Model/MapDocument.h"
+#include "Model/Octree.h"
+#include "Renderer/ApplyMatrix.h"
+#include "Renderer/Camera.h"
 #include "Renderer/EdgeRenderer.h"
 #include "Renderer/EntityRenderer.h"
+#include "Renderer/GLState.h"
 #include "Renderer/EntityRotationDecorator.h"
 #include "Renderer/EntityLinkDecorator.h"
 #include "Renderer/FaceRenderer.h"
+#include "Renderer/OcclusionCuller.h"
 #include "Renderer/PointHandleRenderer.h"
 #include "Renderer/PointTraceRenderer.h"
 #include "Renderer/RenderContext.h"
@@ -54,6 +64,7 @@
 #include "Utility/Grid.h"
 #include "Utility/List.h"
 #include "Utility/Preferences.h"
+#include "Utility/Profiler.h"
 
 namespace TrenchBroom {
     namespace Renderer {
@@ -61,17 +72,146 @@ namespace TrenchBroom {
         static const int VertexSize = 3 * sizeof(GLfloat);
         static const int NormalSize = 3 * sizeof(GLfloat);
         static const int ColorSize = 4;
-        static const int TexCoordSize = 2 * sizeof(GLfloat);
-        static const int FaceVertexSize = VertexSize + NormalSize + TexCoordSize;
+        static const int TexAxisSize = 4 * sizeof(GLfloat);
+        static const int FaceVertexSize = VertexSize + NormalSize + 2 * TexAxisSize;
         static const int EdgeVertexSize = VertexSize;
         static const int EntityBoundsVertexSize = ColorSize + VertexSize;
 
+        void MapRenderer::clearFaceBatches() {
+            FaceBatchList::const_iterator it, end;
+            for (it = m_faceBatches.begin(), end = m_faceBatches.end(); it != end; ++it)
+                delete it->renderer;
+            m_faceBatches.clear();
+            m_visibleFaceBatches.clear();
+            m_occlusionCuller->setOccluders(Model::EmptyBrushList);
+        }
+        
+        void MapRenderer::clearEdgeRenderers() {
+            EdgeRendererMap::const_iterator it, end;
+            for (it = m_edgeRenderers.begin(), end = m_edgeRenderers.end(); it != end; ++it)
+                delete it->second;
+            m_edgeRenderers.clear();
+        }
+        
+        void MapRenderer::rebuildFaceBatches(RenderContext& context) {
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            TextureRendererManager& textureRendererManager = m_document.sharedResources().textureRendererManager();
+            const Color& faceColor = prefs.getColor(Preferences::FaceColor);
+            
+            // the unselected faces of neighbouring brushes of the same visibility classes are rendered together so that
+            // occluded batches and batches of hidden classes can be skipped
+            Model::BrushList occluders;
+            const Model::MapObjectGroupList groups = m_document.octree().groupObjects(static_cast<float>(FaceBatchSize));
+            Model::MapObjectGroupList::const_iterator groupIt, groupEnd;
+            for (groupIt = groups.begin(), groupEnd = groups.end(); groupIt != groupEnd; ++groupIt) {
+                const Model::MapObjectList& objects = *groupIt;
+                ClassBrushesMap classBrushes;
+                
+                Model::MapObjectList::const_iterator objectIt, objectEnd;
+                for (objectIt = objects.begin(), objectEnd = objects.end(); objectIt != objectEnd; ++objectIt) {
+                    Model::MapObject* object = *objectIt;
+                    if (object->objectType() != Model::MapObject::BrushObject)
+                        continue;
+                    
+                    Model::Brush* brush = static_cast<Model::Brush*>(object);
+                    Model::Entity* entity = brush->entity();
+                    if (!context.filter().brushMatches(*brush) ||
+                        entity->selected() || brush->selected() ||
+                        entity->locked() || brush->locked())
+                        continue;
+                    
+                    classBrushes[brush->visibilityClasses()].push_back(brush);
+                }
+                
+                ClassBrushesMap::const_iterator classIt, classEnd;
+                for (classIt = classBrushes.begin(), classEnd = classBrushes.end(); classIt != classEnd; ++classIt) {
+                    const Model::VisibilityClass::Type visibilityClasses = classIt->first;
+                    const Model::BrushList& brushes = classIt->second;
+                    FaceSorter faceSorter;
+                    BBoxf bounds = brushes.front()->bounds();
+                    
+                    Model::BrushList::const_iterator brushIt, brushEnd;
+                    for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt) {
+                        Model::Brush* brush = *brushIt;
+                        bounds.mergeWith(brush->bounds());
+                        
+                        // decided by texture name so that rebinding the textures does not change the occluders, and
+                        // brushes which can be hidden must not occlude anything
+                        bool opaque = visibilityClasses == Model::VisibilityClass::None && !brush->partiallySelected();
+                        const Model::FaceList& faces = brush->faces();
+                        for (size_t i = 0; i < faces.size(); i++) {
+                            Model::Face* face = faces[i];
+                            if (!face->selected())
+                                faceSorter.addPolygon(face->texture(), face, face->vertices().size());
+                            if (FaceRenderer::alphaBlend(face->textureName()))
+                                opaque = false;
+                        }
+                        
+                        if (opaque)
+                            occluders.push_back(brush);
+                    }
+                    
+                    if (!faceSorter.empty())
+                        m_faceBatches.push_back(FaceBatch(bounds, brushes, visibilityClasses, new FaceRenderer(*m_faceVbo, textureRendererManager, faceSorter, faceColor)));
+                }
+            }
+            
+            m_occlusionCuller->setOccluders(occluders);
+        }
+        
+        void MapRenderer::rebuildInvalidFaceBatches() {
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            TextureRendererManager& textureRendererManager = m_document.sharedResources().textureRendererManager();
+            const Color& faceColor = prefs.getColor(Preferences::FaceColor);
+            
+            FaceBatchList::iterator batchIt, batchEnd;
+            for (batchIt = m_faceBatches.begin(), batchEnd = m_faceBatches.end(); batchIt != batchEnd; ++batchIt) {
+                FaceBatch& batch = *batchIt;
+                if (batch.valid)
+                    continue;
+                
+                assert(batch.renderer == NULL);
+                FaceSorter faceSorter;
+                Model::BrushList::const_iterator brushIt, brushEnd;
+                for (brushIt = batch.brushes.begin(), brushEnd = batch.brushes.end(); brushIt != brushEnd; ++brushIt) {
+                    const Model::FaceList& faces = (*brushIt)->faces();
+                    for (size_t i = 0; i < faces.size(); i++) {
+                        Model::Face* face = faces[i];
+                        if (!face->selected())
+                            faceSorter.addPolygon(face->texture(), face, face->vertices().size());
+                    }
+                }
+                
+                batch.renderer = new FaceRenderer(*m_faceVbo, textureRendererManager, faceSorter, faceColor);
+                batch.valid = true;
+            }
+        }
+        
         void MapRenderer::rebuildGeometryData(RenderContext& context) {
+            Utility::ProfileZone zone("MapRenderer::rebuildGeometryData");
+            size_t invalidBatchFaceVertexCount = 0;
+            size_t invalidBatchPolygonCount = 0;
             if (!m_geometryDataValid) {
-                delete m_faceRenderer;
-                m_faceRenderer = NULL;
-                delete m_edgeRenderer;
-                m_edgeRenderer = NULL;
+                clearFaceBatches();
+                clearEdgeRenderers();
+            } else if (!m_faceBatchesValid) {
+                FaceBatchList::iterator batchIt, batchEnd;
+                for (batchIt = m_faceBatches.begin(), batchEnd = m_faceBatches.end(); batchIt != batchEnd; ++batchIt) {
+                    FaceBatch& batch = *batchIt;
+                    if (batch.valid)
+                        continue;
+                    
+                    delete batch.renderer;
+                    batch.renderer = NULL;
+                    Model::BrushList::const_iterator brushIt, brushEnd;
+                    for (brushIt = batch.brushes.begin(), brushEnd = batch.brushes.end(); brushIt != brushEnd; ++brushIt) {
+                        const Model::FaceList& faces = (*brushIt)->faces();
+                        for (size_t i = 0; i < faces.size(); i++) {
+                            invalidBatchFaceVertexCount += faces[i]->vertices().size();
+                            invalidBatchPolygonCount++;
+                        }
+                    }
+                }
             }
             if (!m_selectedGeometryDataValid) {
                 delete m_selectedFaceRenderer;
@@ -86,70 +226,94 @@ namespace TrenchBroom {
                 m_lockedEdgeRenderer = NULL;
             }
             
-            FaceSorter unselectedFaceSorter;
+            size_t unselectedFaceVertexCount = 0;
+            size_t unselectedPolygonCount = 0;
             FaceSorter selectedFaceSorter;
             FaceSorter lockedFaceSorter;
             
-            Model::BrushList unselectedWorldBrushes;
-            Model::BrushList unselectedEntityBrushes;
+            ClassBrushesMap unselectedWorldBrushes;
+            ClassBrushesMap unselectedEntityBrushes;
             Model::BrushList selectedBrushes;
             Model::BrushList lockedBrushes;
             Model::FaceList partiallySelectedBrushFaces;
             
-            // collect all visible faces and brushes
+            // collect all visible faces and brushes; the unselected brushes are collected regardless of their classes
+            const Model::Filter& filter = context.filter();
             const Model::EntityList& entities = m_document.map().entities();
             for (size_t i = 0; i < entities.size(); i++) {
                 Model::Entity* entity = entities[i];
                 const Model::BrushList& brushes = entity->brushes();
                 for (size_t j = 0; j < brushes.size(); j++) {
                     Model::Brush* brush = brushes[j];
-                    if (context.filter().brushVisible(*brush)) {
-                        if (entity->selected() || brush->selected()) {
+                    if (!filter.brushMatches(*brush))
+                        continue;
+                    
+                    const Model::VisibilityClass::Type visibilityClasses = brush->visibilityClasses();
+                    const bool classVisible = (visibilityClasses & m_hiddenBrushClasses) == 0;
+                    const bool selected = entity->selected() || brush->selected();
+                    const bool locked = !selected && (entity->locked() || brush->locked());
+                    if (selected) {
+                        if (classVisible)
                             selectedBrushes.push_back(brush);
-                        } else if (entity->locked() || brush->locked()) {
+                    } else if (locked) {
+                        if (classVisible)
                             lockedBrushes.push_back(brush);
-                        } else {
-                            if (entity->worldspawn())
-                                unselectedWorldBrushes.push_back(brush);
-                            else
-                                unselectedEntityBrushes.push_back(brush);
-                            if (brush->partiallySelected()) {
-                                const Model::FaceList& faces = brush->faces();
-                                for (size_t k = 0; k < faces.size(); k++) {
-                                    Model::Face* face = faces[k];
-                                    if (face->selected()) {
-                                        partiallySelectedBrushFaces.push_back(face);
-                                    }
+                    } else {
+                        if (entity->worldspawn())
+                            unselectedWorldBrushes[visibilityClasses].push_back(brush);
+                        else
+                            unselectedEntityBrushes[visibilityClasses].push_back(brush);
+                        if (classVisible && brush->partiallySelected()) {
+                            const Model::FaceList& faces = brush->faces();
+                            for (size_t k = 0; k < faces.size(); k++) {
+                                Model::Face* face = faces[k];
+                                if (face->selected()) {
+                                    partiallySelectedBrushFaces.push_back(face);
                                 }
                             }
                         }
-                        
-                        const Model::FaceList& faces = brush->faces();
-                        for (size_t k = 0; k < faces.size(); k++) {
-                            Model::Face* face = faces[k];
-                            Model::Texture* texture = face->texture();
-                            if (entity->selected() || brush->selected() || face->selected())
+                    }
+                    
+                    const Model::FaceList& faces = brush->faces();
+                    for (size_t k = 0; k < faces.size(); k++) {
+                        Model::Face* face = faces[k];
+                        Model::Texture* texture = face->texture();
+                        if (selected || face->selected()) {
+                            if (classVisible)
                                 selectedFaceSorter.addPolygon(texture, face, face->vertices().size());
-                            else if (entity->locked() || brush->locked())
+                        } else if (locked) {
+                            if (classVisible)
                                 lockedFaceSorter.addPolygon(texture, face, face->vertices().size());
-                            else
-                                unselectedFaceSorter.addPolygon(texture, face, face->vertices().size());
+                        } else {
+                            unselectedFaceVertexCount += face->vertices().size();
+                            unselectedPolygonCount++;
                         }
                     }
                 }
             }
             
             // merge the collected brushes
-            Model::BrushList unselectedBrushes(unselectedWorldBrushes);
-            unselectedBrushes.insert(unselectedBrushes.end(), unselectedEntityBrushes.begin(), unselectedEntityBrushes.end());
+            ClassBrushesMap unselectedBrushes(unselectedWorldBrushes);
+            ClassBrushesMap::const_iterator classIt, classEnd;
+            for (classIt = unselectedEntityBrushes.begin(), classEnd = unselectedEntityBrushes.end(); classIt != classEnd; ++classIt) {
+                Model::BrushList& brushes = unselectedBrushes[classIt->first];
+                brushes.insert(brushes.end(), classIt->second.begin(), classIt->second.end());
+            }
 
             // write face triangles
             m_faceVbo->activate();
             m_faceVbo->map();
             
             // make sure that the VBO is sufficiently large
-            size_t totalFaceVertexCount = unselectedFaceSorter.vertexCount() + selectedFaceSorter.vertexCount() + lockedFaceSorter.vertexCount();
-            size_t totalPolygonCount = unselectedFaceSorter.polygonCount() + selectedFaceSorter.polygonCount() + lockedFaceSorter.polygonCount();
+            size_t totalFaceVertexCount = selectedFaceSorter.vertexCount() + lockedFaceSorter.vertexCount();
+            size_t totalPolygonCount = selectedFaceSorter.polygonCount() + lockedFaceSorter.polygonCount();
+            if (!m_geometryDataValid) {
+                totalFaceVertexCount += unselectedFaceVertexCount;
+                totalPolygonCount += unselectedPolygonCount;
+            } else {
+                totalFaceVertexCount += invalidBatchFaceVertexCount;
+                totalPolygonCount += invalidBatchPolygonCount;
+            }
             size_t totalTriangleVertexCount = 3 * totalFaceVertexCount - 6 * totalPolygonCount;
             m_faceVbo->ensureFreeCapacity(static_cast<unsigned int>(totalTriangleVertexCount) * FaceVertexSize);
             
@@ -157,9 +321,11 @@ namespace TrenchBroom {
             TextureRendererManager& textureRendererManager = m_document.sharedResources().textureRendererManager();
             const Color& faceColor = prefs.getColor(Preferences::FaceColor);
 
-            if (!m_geometryDataValid && !unselectedFaceSorter.empty()) {
-                assert(m_faceRenderer == NULL);
-                m_faceRenderer = new FaceRenderer(*m_faceVbo, textureRendererManager, unselectedFaceSorter, faceColor);
+            if (!m_geometryDataValid) {
+                assert(m_faceBatches.empty());
+                rebuildFaceBatches(context);
+            } else if (!m_faceBatchesValid) {
+                rebuildInvalidFaceBatches();
             }
             
             if (!m_selectedGeometryDataValid && !selectedFaceSorter.empty()) {
@@ -181,9 +347,10 @@ namespace TrenchBroom {
             
             const Color& edgeColor = prefs.getColor(Preferences::EdgeColor);
 
-            if (!m_geometryDataValid && !unselectedBrushes.empty()) {
-                assert(m_edgeRenderer == NULL);
-                m_edgeRenderer = new EdgeRenderer(*m_edgeVbo, unselectedBrushes, Model::EmptyFaceList, edgeColor);
+            if (!m_geometryDataValid) {
+                assert(m_edgeRenderers.empty());
+                for (classIt = unselectedBrushes.begin(), classEnd = unselectedBrushes.end(); classIt != classEnd; ++classIt)
+                    m_edgeRenderers.insert(EdgeRendererMap::value_type(classIt->first, new EdgeRenderer(*m_edgeVbo, classIt->second, Model::EmptyFaceList, edgeColor)));
             }
             
             if (!m_selectedGeometryDataValid && (!selectedBrushes.empty() || !partiallySelectedBrushFaces.empty())) {
@@ -200,13 +367,121 @@ namespace TrenchBroom {
             m_edgeVbo->deactivate();
             
             m_geometryDataValid = true;
+            m_faceBatchesValid = true;
             m_selectedGeometryDataValid = true;
             m_lockedGeometryDataValid = true;
         }
         
+        void MapRenderer::addLoadedBrushes(RenderContext& context) {
+            Utility::ProfileZone zone("MapRenderer::addLoadedBrushes");
+            
+            // nothing can be selected or locked while the map is loading
+            size_t faceVertexCount = 0;
+            size_t polygonCount = 0;
+            ClassBrushesMap classBrushes;
+            const Model::Filter& filter = context.filter();
+            Model::BrushList::const_iterator brushIt, brushEnd;
+            for (brushIt = m_loadedBrushes.begin(), brushEnd = m_loadedBrushes.end(); brushIt != brushEnd; ++brushIt) {
+                Model::Brush* brush = *brushIt;
+                if (!filter.brushMatches(*brush))
+                    continue;
+                
+                classBrushes[brush->visibilityClasses()].push_back(brush);
+                const Model::FaceList& faces = brush->faces();
+                for (size_t i = 0; i < faces.size(); i++) {
+                    faceVertexCount += faces[i]->vertices().size();
+                    polygonCount++;
+                }
+            }
+            
+            if (classBrushes.empty())
+                return;
+            
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            TextureRendererManager& textureRendererManager = m_document.sharedResources().textureRendererManager();
+            const Color& faceColor = prefs.getColor(Preferences::FaceColor);
+            const Color& edgeColor = prefs.getColor(Preferences::EdgeColor);
+            
+            m_faceVbo->activate();
+            m_faceVbo->map();
+            m_faceVbo->ensureFreeCapacity(static_cast<unsigned int>(3 * faceVertexCount - 6 * polygonCount) * FaceVertexSize);
+            
+            // the batches are not grouped by location and do not occlude anything, the complete map is rebuilt once
+            // it has been loaded
+            ClassBrushesMap::const_iterator classIt, classEnd;
+            for (classIt = classBrushes.begin(), classEnd = classBrushes.end(); classIt != classEnd; ++classIt) {
+                const Model::BrushList& brushes = classIt->second;
+                FaceSorter faceSorter;
+                BBoxf bounds = brushes.front()->bounds();
+                for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt) {
+                    Model::Brush* brush = *brushIt;
+                    bounds.mergeWith(brush->bounds());
+                    
+                    const Model::FaceList& faces = brush->faces();
+                    for (size_t i = 0; i < faces.size(); i++) {
+                        Model::Face* face = faces[i];
+                        faceSorter.addPolygon(face->texture(), face, face->vertices().size());
+                    }
+                }
+                
+                if (!faceSorter.empty())
+                    m_faceBatches.push_back(FaceBatch(bounds, brushes, classIt->first, new FaceRenderer(*m_faceVbo, textureRendererManager, faceSorter, faceColor)));
+            }
+            
+            m_faceVbo->unmap();
+            m_faceVbo->deactivate();
+            
+            m_edgeVbo->activate();
+            m_edgeVbo->map();
+            for (classIt = classBrushes.begin(), classEnd = classBrushes.end(); classIt != classEnd; ++classIt)
+                m_edgeRenderers.insert(EdgeRendererMap::value_type(classIt->first, new EdgeRenderer(*m_edgeVbo, classIt->second, Model::EmptyFaceList, edgeColor)));
+            m_edgeVbo->unmap();
+            m_edgeVbo->deactivate();
+        }
+        
+        void MapRenderer::updateTextureAttributes() {
+            if (m_textureChangedFaces.empty())
+                return;
+            
+            if (m_selectedGeometryDataValid) {
+                if (m_selectedFaceRenderer == NULL || !m_selectedFaceRenderer->updateTextureAttributes(*m_faceVbo, m_textureChangedFaces))
+                    invalidateSelectedBrushes();
+            }
+            m_textureChangedFaces.clear();
+        }
+        
+        void MapRenderer::validateFilter(RenderContext& context) {
+            const String& filterPattern = context.viewOptions().filterPattern();
+            if (filterPattern != m_filterPattern) {
+                m_filterPattern = filterPattern;
+                invalidateBrushes();
+            }
+            
+            const Model::VisibilityClass::Type hiddenBrushClasses = context.filter().hiddenBrushClasses();
+            if (hiddenBrushClasses != m_hiddenBrushClasses) {
+                m_hiddenBrushClasses = hiddenBrushClasses;
+                m_selectedGeometryDataValid = false;
+                m_lockedGeometryDataValid = false;
+            }
+        }
+        
         void MapRenderer::validate(RenderContext& context) {
-            if (!m_geometryDataValid || !m_selectedGeometryDataValid || !m_lockedGeometryDataValid)
+            Utility::ProfileZone zone("MapRenderer::validate");
+            validateFilter(context);
+            updateTextureAttributes();
+            
+            // a complete rebuild includes the brushes which were loaded since the last validation
+            if (!m_loadedBrushes.empty()) {
+                if (m_geometryDataValid)
+                    addLoadedBrushes(context);
+                m_loadedBrushes.clear();
+            }
+            if (!m_geometryDataValid || !m_faceBatchesValid || !m_selectedGeometryDataValid || !m_lockedGeometryDataValid)
                 rebuildGeometryData(context);
+
+            m_faceVbo->compact(VboCompactionBudget);
+            m_edgeVbo->compact(VboCompactionBudget);
+            m_entityVbo->compact(VboCompactionBudget);
         }
         
         void MapRenderer::invalidateDecorators() {
@@ -216,15 +491,56 @@ namespace TrenchBroom {
                 decorator.invalidate();
             }
         }
+        
+        void MapRenderer::invalidateDecorators(const Model::EntityList& entities) {
+            if (entities.empty())
+                return;
+            
+            EntityDecorator::List::const_iterator decoratorIt, decoratorEnd;
+            for (decoratorIt = m_entityDecorators.begin(), decoratorEnd = m_entityDecorators.end(); decoratorIt != decoratorEnd; ++decoratorIt) {
+                EntityDecorator& decorator = **decoratorIt;
+                decorator.invalidateEntities(entities);
+            }
+        }
 
+        void MapRenderer::cullFaceBatches(RenderContext& context) {
+            Utility::ProfileZone zone("MapRenderer::cullFaceBatches");
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            const bool cull = prefs.getBool(Preferences::RendererOcclusionCulling);
+            
+            if (cull) {
+                const Camera& camera = context.camera();
+                m_occlusionCuller->update(camera.projectionMatrix() * camera.viewMatrix(), camera.position());
+            }
+            
+            m_visibleFaceBatches.clear();
+            FaceBatchList::const_iterator it, end;
+            for (it = m_faceBatches.begin(), end = m_faceBatches.end(); it != end; ++it) {
+                const FaceBatch& batch = *it;
+                if ((batch.visibilityClasses & m_hiddenBrushClasses) != 0)
+                    continue;
+                if (!cull || m_occlusionCuller->visible(batch.bounds))
+                    m_visibleFaceBatches.push_back(batch.renderer);
+            }
+        }
+        
         void MapRenderer::renderFaces(RenderContext& context) {
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
             
             m_faceVbo->activate();
-            if (m_faceRenderer != NULL)
-                m_faceRenderer->render(context, false);
+            if (!m_faceBatches.empty()) {
+                cullFaceBatches(context);
+                
+                // the transparent faces of a batch must not be covered by the opaque faces of later batches
+                FaceRendererList::const_iterator it, end;
+                for (it = m_visibleFaceBatches.begin(), end = m_visibleFaceBatches.end(); it != end; ++it)
+                    (*it)->renderOpaque(context);
+                for (it = m_visibleFaceBatches.begin(), end = m_visibleFaceBatches.end(); it != end; ++it)
+                    (*it)->renderTransparent(context);
+            }
             if (context.viewOptions().renderSelection() && m_selectedFaceRenderer != NULL) {
                 const Color& color = m_overrideSelectionColors ? m_selectedFaceColor : prefs.getColor(Preferences::SelectedFaceColor);
+                ApplyModelMatrix applySelectionTransform(context.transformation(), m_selectionTransform);
                 m_selectedFaceRenderer->render(context, false, color);
             }
             if (m_lockedFaceRenderer != NULL)
@@ -237,10 +553,11 @@ namespace TrenchBroom {
             
             m_edgeVbo->activate();
             if (context.viewOptions().renderEdges()) {
-                if (m_edgeRenderer != NULL) {
-                    glSetEdgeOffset(0.02f);
-                    m_edgeRenderer->render(context);
-                }
+                glSetEdgeOffset(0.02f);
+                EdgeRendererMap::const_iterator it, end;
+                for (it = m_edgeRenderers.begin(), end = m_edgeRenderers.end(); it != end; ++it)
+                    if ((it->first & m_hiddenBrushClasses) == 0)
+                        it->second->render(context);
                 if (m_lockedEdgeRenderer != NULL) {
                     glSetEdgeOffset(0.02f);
                     m_lockedEdgeRenderer->render(context, prefs.getColor(Preferences::LockedEdgeColor));
@@ -249,7 +566,7 @@ namespace TrenchBroom {
             if (context.viewOptions().renderSelection() && m_selectedEdgeRenderer != NULL) {
                 const Color& edgeColor = m_overrideSelectionColors ? m_selectedEdgeColor : prefs.getColor(Preferences::SelectedEdgeColor);
                 const Color& occludedEdgeColor = m_overrideSelectionColors ? m_occludedSelectedEdgeColor : prefs.getColor(Preferences::OccludedSelectedEdgeColor);
-                
+                ApplyModelMatrix applySelectionTransform(context.transformation(), m_selectionTransform);
                 
                 glDisable(GL_DEPTH_TEST);
                 glSetEdgeOffset(0.02f);
@@ -266,7 +583,7 @@ namespace TrenchBroom {
             EntityDecorator::List::const_iterator decoratorIt, decoratorEnd;
             for (decoratorIt = m_entityDecorators.begin(), decoratorEnd = m_entityDecorators.end(); decoratorIt != decoratorEnd; ++decoratorIt) {
                 EntityDecorator& decorator = **decoratorIt;
-                decorator.render(*m_utilityVbo, context);
+                decorator.render(*m_utilityVbo, context, m_selectionTransform);
             }
         }
 
@@ -282,7 +599,6 @@ namespace TrenchBroom {
                 changeSet.brushStateChangedTo(Model::EditState::Default) ||
                 changeSet.faceSelectionChanged()) {
                 m_geometryDataValid = false;
-                invalidateDecorators();
             }
             
             if (changeSet.brushStateChangedFrom(Model::EditState::Selected) ||
@@ -311,11 +627,6 @@ namespace TrenchBroom {
                 }
             }
             
-            if (changeSet.entityStateChangedFrom(Model::EditState::Hidden) ||
-                changeSet.entityStateChangedTo(Model::EditState::Hidden)) {
-                invalidateDecorators();
-            }
-            
             if (changeSet.brushStateChangedFrom(Model::EditState::Hidden) ||
                 changeSet.brushStateChangedTo(Model::EditState::Hidden)) {
                 
@@ -334,26 +645,43 @@ namespace TrenchBroom {
                     if (!entity->worldspawn())
                         m_entityRenderer->addEntity(*entity);
                 }
-                
-                invalidateDecorators();
             }
             
             if (changeSet.brushStateChangedFrom(Model::EditState::Locked) ||
                 changeSet.brushStateChangedTo(Model::EditState::Locked)) {
                 m_lockedGeometryDataValid = false;
             }
+            
+            // the decorators only need to update the entities whose own state or whose brushes' states changed
+            Model::EntitySet changedEntities;
+            for (Model::EditState::Type state = 0; state < Model::EditState::Count; state++) {
+                const Model::EntityList& entities = changeSet.entitiesFrom(state);
+                changedEntities.insert(entities.begin(), entities.end());
+                
+                const Model::BrushList& brushes = changeSet.brushesFrom(state);
+                Model::BrushList::const_iterator brushIt, brushEnd;
+                for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt) {
+                    Model::Brush& brush = **brushIt;
+                    changedEntities.insert(brush.entity());
+                }
+            }
+            invalidateDecorators(Utility::makeList(changedEntities));
         }
         
-        void MapRenderer::invalidateEntities() {
+        void MapRenderer::invalidateEntityBounds() {
             m_entityRenderer->invalidateBounds();
             m_selectedEntityRenderer->invalidateBounds();
             m_lockedEntityRenderer->invalidateBounds();
+        }
+        
+        void MapRenderer::invalidateEntities() {
+            invalidateEntityBounds();
             invalidateDecorators();
         }
         
         void MapRenderer::invalidateSelectedEntities() {
             m_selectedEntityRenderer->invalidateBounds();
-            invalidateDecorators();
+            invalidateDecorators(m_document.editStateManager().allSelectedEntities());
         }
         
         void MapRenderer::invalidateBrushes() {
@@ -366,6 +694,44 @@ namespace TrenchBroom {
             m_selectedGeometryDataValid = false;
         }
         
+        void MapRenderer::invalidateTextureAttributes(const Model::FaceList& faces) {
+            // the faces are patched in the selected face renderer on the next validation
+            if (m_selectedGeometryDataValid)
+                m_textureChangedFaces.insert(m_textureChangedFaces.end(), faces.begin(), faces.end());
+        }
+        
+        void MapRenderer::invalidateFaceTextures(const Model::FaceList& faces) {
+            Model::BrushSet unselectedBrushes;
+            Model::FaceList::const_iterator faceIt, faceEnd;
+            for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt) {
+                Model::Face* face = *faceIt;
+                Model::Brush* brush = face->brush();
+                Model::Entity* entity = brush->entity();
+                if (entity->selected() || brush->selected() || face->selected())
+                    m_selectedGeometryDataValid = false;
+                else if (entity->locked() || brush->locked())
+                    m_lockedGeometryDataValid = false;
+                else
+                    unselectedBrushes.insert(brush);
+            }
+            
+            if (!m_geometryDataValid || unselectedBrushes.empty())
+                return;
+            
+            // only the batches which contain one of the brushes are rebuilt on the next validation
+            FaceBatchList::iterator batchIt, batchEnd;
+            for (batchIt = m_faceBatches.begin(), batchEnd = m_faceBatches.end(); batchIt != batchEnd; ++batchIt) {
+                FaceBatch& batch = *batchIt;
+                Model::BrushList::const_iterator brushIt, brushEnd;
+                for (brushIt = batch.brushes.begin(), brushEnd = batch.brushes.end(); brushIt != brushEnd && batch.valid; ++brushIt) {
+                    if (unselectedBrushes.count(*brushIt) > 0) {
+                        batch.valid = false;
+                        m_faceBatchesValid = false;
+                    }
+                }
+            }
+        }
+        
         void MapRenderer::invalidateAll() {
             invalidateEntities();
             invalidateBrushes();
@@ -382,15 +748,15 @@ namespace TrenchBroom {
         }
         
         void MapRenderer::clear() {
-            delete m_faceRenderer;
-            m_faceRenderer = NULL;
+            m_textureChangedFaces.clear();
+            m_loadedBrushes.clear();
+            clearFaceBatches();
             delete m_selectedFaceRenderer;
             m_selectedFaceRenderer = NULL;
             delete m_lockedFaceRenderer;
             m_lockedFaceRenderer = NULL;
             
-            delete m_edgeRenderer;
-            m_edgeRenderer = NULL;
+            clearEdgeRenderers();
             delete m_selectedEdgeRenderer;
             m_selectedEdgeRenderer = NULL;
             delete m_lockedEdgeRenderer;
@@ -407,11 +773,10 @@ namespace TrenchBroom {
         MapRenderer::MapRenderer(Model::MapDocument& document) :
         m_document(document),
         m_faceVbo(NULL),
-        m_faceRenderer(NULL),
+        m_occlusionCuller(NULL),
         m_selectedFaceRenderer(NULL),
         m_lockedFaceRenderer(NULL),
         m_edgeVbo(NULL),
-        m_edgeRenderer(NULL),
         m_selectedEdgeRenderer(NULL),
         m_lockedEdgeRenderer(NULL),
         m_entityVbo(NULL),
@@ -421,13 +786,17 @@ namespace TrenchBroom {
         m_utilityVbo(NULL),
         m_pointTraceRenderer(NULL),
         m_overrideSelectionColors(false),
+        m_selectionTransform(Mat4f::Identity),
         m_rendering(false),
         m_geometryDataValid(false),
+        m_faceBatchesValid(true),
         m_selectedGeometryDataValid(false),
-        m_lockedGeometryDataValid(false) {
+        m_lockedGeometryDataValid(false),
+        m_hiddenBrushClasses(Model::VisibilityClass::None) {
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
 
             m_faceVbo = new Vbo(GL_ARRAY_BUFFER, 0xFFFF);
+            m_occlusionCuller = new OcclusionCuller();
             m_edgeVbo = new Vbo(GL_ARRAY_BUFFER, 0xFFFF);
             m_entityVbo = new Vbo(GL_ARRAY_BUFFER, 0xFFFF);
             m_utilityVbo = new Vbo(GL_ARRAY_BUFFER, 0xFFFF);
@@ -472,16 +841,16 @@ namespace TrenchBroom {
             m_lockedEdgeRenderer = NULL;
             delete m_selectedEdgeRenderer;
             m_selectedEdgeRenderer = NULL;
-            delete m_edgeRenderer;
-            m_edgeRenderer = NULL;
+            clearEdgeRenderers();
             delete m_edgeVbo;
             m_edgeVbo = NULL;
             delete m_lockedFaceRenderer;
             m_lockedFaceRenderer = NULL;
             delete m_selectedFaceRenderer;
             m_selectedFaceRenderer = NULL;
-            delete m_faceRenderer;
-            m_faceRenderer = NULL;
+            clearFaceBatches();
+            delete m_occlusionCuller;
+            m_occlusionCuller = NULL;
             delete m_faceVbo;
             m_faceVbo = NULL;
             delete m_utilityVbo;
@@ -499,15 +868,28 @@ namespace TrenchBroom {
                     clear();
                     break;
                 }
+                case Controller::Command::LoadObjects: {
+                    const Controller::LoadObjectsCommand& loadObjectsCommand = static_cast<const Controller::LoadObjectsCommand&>(command);
+                    if (loadObjectsCommand.finished()) {
+                        // rebuild everything so that the brushes are batched by location and occlude each other
+                        clear();
+                        m_entityRenderer->addEntities(m_document.map().entities());
+                    } else {
+                        m_entityRenderer->addEntities(loadObjectsCommand.entities());
+                        m_loadedBrushes.insert(m_loadedBrushes.end(), loadObjectsCommand.brushes().begin(), loadObjectsCommand.brushes().end());
+                        if (!loadObjectsCommand.brushes().empty())
+                            invalidateEntityBounds();
+                    }
+                    break;
+                }
                 case Controller::Command::ChangeEditState: {
                     const Controller::ChangeEditStateCommand& changeEditStateCommand = static_cast<const Controller::ChangeEditStateCommand&>(command);
                     changeEditState(changeEditStateCommand.changeSet());
-                    invalidateDecorators();
                     break;
                 }
                 case Controller::Command::ViewFilterChange: {
+                    // the brushes are only invalidated if the filter pattern has changed, see validateFilter
                     invalidateEntities();
-                    invalidateBrushes();
                     break;
                 }
                 case Controller::Command::PreferenceChange: {
@@ -516,20 +898,32 @@ namespace TrenchBroom {
                         invalidateEntityModelRendererCache();
                     break;
                 }
-                case Controller::Command::SetFaceAttributes:
-                case Controller::Command::MoveTextures:
+                case Controller::Command::SetFaceAttributes: {
+                    const Controller::SetFaceAttributesCommand& setFaceAttributesCommand = static_cast<const Controller::SetFaceAttributesCommand&>(command);
+                    invalidateTextureAttributes(setFaceAttributesCommand.faces());
+                    break;
+                }
+                case Controller::Command::MoveTextures: {
+                    const Controller::MoveTexturesCommand& moveTexturesCommand = static_cast<const Controller::MoveTexturesCommand&>(command);
+                    invalidateTextureAttributes(moveTexturesCommand.faces());
+                    break;
+                }
                 case Controller::Command::RotateTextures: {
-                    invalidateSelectedBrushes();
+                    const Controller::RotateTexturesCommand& rotateTexturesCommand = static_cast<const Controller::RotateTexturesCommand&>(command);
+                    invalidateTextureAttributes(rotateTexturesCommand.faces());
+                    break;
+                }
+                case Controller::Command::RebindTextures: {
+                    const Controller::RebindTexturesCommand& rebindTexturesCommand = static_cast<const Controller::RebindTexturesCommand&>(command);
+                    invalidateFaceTextures(rebindTexturesCommand.faces());
                     break;
                 }
                 case Controller::Command::SetEntityPropertyKey:
                 case Controller::Command::SetEntityPropertyValue:
                 case Controller::Command::RemoveEntityProperty: {
                     const Controller::EntityPropertyCommand& entityPropertyCommand = static_cast<const Controller::EntityPropertyCommand&>(command);
-                    if (entityPropertyCommand.isEntityAffected(m_document.worldspawn()) &&
-                        entityPropertyCommand.isPropertyAffected(Model::Entity::WadKey))
-                            invalidateBrushes();
-                    invalidateEntities();
+                    invalidateEntityBounds();
+                    invalidateDecorators(entityPropertyCommand.entities());
                     invalidateSelectedEntityModelRendererCache();
                     break;
                 }
@@ -585,14 +979,15 @@ namespace TrenchBroom {
         }
 
         void MapRenderer::render(RenderContext& context) {
+            Utility::ProfileZone zone("MapRenderer::render");
             if (m_rendering)
                 return;
             m_rendering = true;
             
             validate(context);
             
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            GLState::state().enableBlend(true);
+            GLState::state().blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
             glFrontFace(GL_CW);
             glEnable(GL_CULL_FACE);
             glEnable(GL_DEPTH_TEST);
@@ -608,8 +1003,10 @@ namespace TrenchBroom {
             
             if (context.viewOptions().showEntities()) {
                 m_entityRenderer->render(context);
-                if (context.viewOptions().renderSelection())
+                if (context.viewOptions().renderSelection()) {
+                    ApplyModelMatrix applySelectionTransform(context.transformation(), m_selectionTransform);
                     m_selectedEntityRenderer->render(context);
+                }
                 m_lockedEntityRenderer->render(context);
                 renderDecorators(context);
             }
@@ -25,6 +25,7 @@
 #include "Model/EntityTypes.h"
 #include "Model/Face.h"
 #include "Model/TextureTypes.h"
+#include "Model/VisibilityClass.h"
 #include "Renderer/EntityDecorator.h"
 #include "Renderer/Figure.h"
 #include "Renderer/RenderUtils.h"
@@ -33,6 +34,7 @@
 #include "Renderer/VertexArray.h"
 #include "Renderer/Text/TextRenderer.h"
 #include "Utility/Color.h"
+#include "Utility/String.h"
 
 #include <map>
 #include <vector>
@@ -52,6 +54,7 @@ namespace TrenchBroom {
         class EntityRenderer;
         class FaceRenderer;
         class Figure;
+        class OcclusionCuller;
         class PointTraceRenderer;
         class RenderContext;
         class Shader;
@@ -65,20 +68,46 @@ namespace TrenchBroom {
         
         class MapRenderer {
         private:
+            static const size_t VboCompactionBudget = 0x40000; // bytes moved per VBO and frame
+            static const unsigned int FaceBatchSize = 1024; // size of the octree nodes whose unselected faces are rendered together
+            
             typedef TexturedPolygonSorter<Model::Texture, Model::Face*> FaceSorter;
             typedef FaceSorter::PolygonCollection FaceCollection;
             typedef FaceSorter::PolygonCollectionMap FaceCollectionMap;
+            
+            class FaceBatch {
+            public:
+                BBoxf bounds;
+                Model::BrushList brushes;
+                Model::VisibilityClass::Type visibilityClasses;
+                FaceRenderer* renderer;
+                bool valid;
+                
+                FaceBatch(const BBoxf& i_bounds, const Model::BrushList& i_brushes, Model::VisibilityClass::Type i_visibilityClasses, FaceRenderer* i_renderer) :
+                bounds(i_bounds),
+                brushes(i_brushes),
+                visibilityClasses(i_visibilityClasses),
+                renderer(i_renderer),
+                valid(true) {}
+            };
+            
+            typedef std::vector<FaceBatch> FaceBatchList;
+            typedef std::vector<FaceRenderer*> FaceRendererList;
+            typedef std::map<Model::VisibilityClass::Type, Model::BrushList> ClassBrushesMap;
+            typedef std::multimap<Model::VisibilityClass::Type, EdgeRenderer*> EdgeRendererMap;
         private:
             Model::MapDocument& m_document;
             
             // level geometry rendering
             Vbo* m_faceVbo;
-            FaceRenderer* m_faceRenderer;
+            FaceBatchList m_faceBatches;
+            FaceRendererList m_visibleFaceBatches;
+            OcclusionCuller* m_occlusionCuller;
             FaceRenderer* m_selectedFaceRenderer;
             FaceRenderer* m_lockedFaceRenderer;
             
             Vbo* m_edgeVbo;
-            EdgeRenderer* m_edgeRenderer;
+            EdgeRendererMap m_edgeRenderers;
             EdgeRenderer* m_selectedEdgeRenderer;
             EdgeRenderer* m_lockedEdgeRenderer;
             
@@ -95,30 +124,52 @@ namespace TrenchBroom {
             Color m_selectedFaceColor;
             Color m_selectedEdgeColor;
             Color m_occludedSelectedEdgeColor;
+            Mat4f m_selectionTransform;
             
             // state
             bool m_rendering;
             bool m_geometryDataValid;
+            bool m_faceBatchesValid;
             bool m_selectedGeometryDataValid;
             bool m_lockedGeometryDataValid;
+            Model::FaceList m_textureChangedFaces;
+            
+            // the brushes of a loading map get batches of their own until the map is complete
+            Model::BrushList m_loadedBrushes;
             
+            // the unselected brushes of hidden classes stay in their batches, which are skipped when rendering
+            Model::VisibilityClass::Type m_hiddenBrushClasses;
+            String m_filterPattern;
+            
+            void clearFaceBatches();
+            void clearEdgeRenderers();
+            void rebuildFaceBatches(RenderContext& context);
+            void rebuildInvalidFaceBatches();
             void rebuildGeometryData(RenderContext& context);
+            void addLoadedBrushes(RenderContext& context);
+            void updateTextureAttributes();
             
+            void validateFilter(RenderContext& context);
             void validate(RenderContext& context);
             
+            void cullFaceBatches(RenderContext& context);
             void renderFaces(RenderContext& context);
             void renderEdges(RenderContext& context);
             void renderDecorators(RenderContext& context);
 
             void changeEditState(const Model::EditStateChangeSet& changeSet);
+            void invalidateEntityBounds();
             void invalidateEntities();
             void invalidateSelectedEntities();
             void invalidateBrushes();
             void invalidateSelectedBrushes();
+            void invalidateTextureAttributes(const Model::FaceList& faces);
+            void invalidateFaceTextures(const Model::FaceList& faces);
             void invalidateAll();
             void invalidateEntityModelRendererCache();
             void invalidateSelectedEntityModelRendererCache();
             void invalidateDecorators();
+            void invalidateDecorators(const Model::EntityList& entities);
             void clear();
 
             // prevent copying
@@ -135,12 +186,32 @@ namespace TrenchBroom {
                 m_occludedSelectedEdgeColor = occludedEdgeColor;
             }
             
+            /*
+             Draws the selection as if it were transformed by the given matrix without touching its geometry. Tools
+             use this to preview a drag and apply the accumulated transformation once the drag ends.
+             */
+            inline void setSelectionTransform(const Mat4f& transform) {
+                m_selectionTransform = transform;
+            }
+            
+            inline const Mat4f& selectionTransform() const {
+                return m_selectionTransform;
+            }
+            
+            inline void clearSelectionTransform() {
+                m_selectionTransform = Mat4f::Identity;
+            }
+            
             void update(const Controller::Command& command);
 
             void setPointTrace(const Vec3f::List& points);
             void removePointTrace();
             
             void render(RenderContext& context);
+            
+            inline const Vbo& faceVbo() const {
+                return *m_faceVbo;
+            }
         };
     }
 }
@@ -0,0 +1,277 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "OcclusionCuller.h"
+
+#include "Model/Brush.h"
+#include "Model/BrushGeometry.h"
+#include "Model/Face.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        // brushes whose bounding sphere has a smaller radius relative to its distance are not used as occluders
+        static const float MinOccluderScore = 0.05f * 0.05f;
+        // shrinks the triangles by a fraction of a pixel to guard against rounding errors
+        static const float EdgeEpsilon = 0.001f;
+
+        bool OcclusionCuller::project(const Vec4f& clip, Vec3f& window) const {
+            if (clip[3] <= Math<float>::AlmostZero)
+                return false;
+            window[0] = (clip[0] / clip[3] * 0.5f + 0.5f) * static_cast<float>(m_width);
+            window[1] = (clip[1] / clip[3] * 0.5f + 0.5f) * static_cast<float>(m_height);
+            window[2] = clip[2] / clip[3] * 0.5f + 0.5f;
+            return true;
+        }
+
+        void OcclusionCuller::rasterizePolygon(const Vec3f::List& vertices) {
+            const size_t count = vertices.size();
+
+            // find the orientation of the polygon and the triangle of the fan which is best suited to compute the depth plane
+            float area = 0.0f;
+            float maxTriangleArea = 0.0f;
+            size_t best = 0;
+            for (size_t i = 1; i < count - 1; i++) {
+                const Vec3f& v0 = vertices[0];
+                const Vec3f& v1 = vertices[i];
+                const Vec3f& v2 = vertices[i + 1];
+                const float triangleArea = (v1[0] - v0[0]) * (v2[1] - v0[1]) - (v2[0] - v0[0]) * (v1[1] - v0[1]);
+                area += triangleArea;
+                if (std::abs(triangleArea) > maxTriangleArea) {
+                    maxTriangleArea = std::abs(triangleArea);
+                    best = i;
+                }
+            }
+            if (std::abs(area) <= Math<float>::AlmostZero || maxTriangleArea <= Math<float>::AlmostZero)
+                return;
+
+            // the edge functions are positive inside of the polygon; they are offset so that they are only positive at
+            // pixel centers whose pixel lies completely inside of the polygon
+            const float orientation = area > 0.0f ? 1.0f : -1.0f;
+            m_edges.resize(count);
+            for (size_t i = 0; i < count; i++) {
+                const Vec3f& s = vertices[i];
+                const Vec3f& e = vertices[(i + 1) % count];
+                Edge& edge = m_edges[i];
+                edge.a = (s[1] - e[1]) * orientation;
+                edge.b = (e[0] - s[0]) * orientation;
+                edge.c = -edge.a * s[0] - edge.b * s[1] - 0.5f * (std::abs(edge.a) + std::abs(edge.b)) - EdgeEpsilon;
+            }
+
+            // the depth is linear in window space, its farthest value within a pixel is at one of the pixel's corners
+            const Vec3f& p0 = vertices[0];
+            const Vec3f& p1 = vertices[best];
+            const Vec3f& p2 = vertices[best + 1];
+            const float triangleArea = (p1[0] - p0[0]) * (p2[1] - p0[1]) - (p2[0] - p0[0]) * (p1[1] - p0[1]);
+            const float zx = ((p1[2] - p0[2]) * (p2[1] - p0[1]) - (p2[2] - p0[2]) * (p1[1] - p0[1])) / triangleArea;
+            const float zy = ((p1[0] - p0[0]) * (p2[2] - p0[2]) - (p2[0] - p0[0]) * (p1[2] - p0[2])) / triangleArea;
+            const float zSlack = 0.5f * (std::abs(zx) + std::abs(zy));
+
+            float zMax = vertices[0][2];
+            float minY = vertices[0][1];
+            float maxY = vertices[0][1];
+            for (size_t i = 1; i < count; i++) {
+                zMax = std::max(zMax, vertices[i][2]);
+                minY = std::min(minY, vertices[i][1]);
+                maxY = std::max(maxY, vertices[i][1]);
+            }
+
+            minY = std::max(minY, 0.0f);
+            maxY = std::min(maxY, static_cast<float>(m_height) - 0.5f);
+            if (minY > maxY)
+                return;
+
+            const size_t firstRow = static_cast<size_t>(minY);
+            const size_t lastRow = static_cast<size_t>(maxY);
+            for (size_t y = firstRow; y <= lastRow; y++) {
+                const float yc = static_cast<float>(y) + 0.5f;
+                float minX = 0.5f;
+                float maxX = static_cast<float>(m_width) - 0.5f;
+                bool empty = false;
+                for (size_t i = 0; i < count && !empty; i++) {
+                    const Edge& edge = m_edges[i];
+                    const float k = edge.b * yc + edge.c;
+                    if (edge.a > 0.0f)
+                        minX = std::max(minX, -k / edge.a);
+                    else if (edge.a < 0.0f)
+                        maxX = std::min(maxX, -k / edge.a);
+                    else
+                        empty = k < 0.0f;
+                }
+                if (empty || minX > maxX)
+                    continue;
+
+                const int first = static_cast<int>(std::ceil(minX - 0.5f));
+                const int last = static_cast<int>(std::floor(maxX - 0.5f));
+                const float z = p0[2] + zx * (0.5f - p0[0]) + zy * (yc - p0[1]) + zSlack;
+
+                // kept free of branches so that the compiler can vectorize it
+                float* row = &m_depth[y * m_width];
+                for (int x = first; x <= last; x++) {
+                    const float pixelZ = std::min(z + zx * static_cast<float>(x), zMax);
+                    row[x] = std::min(row[x], pixelZ);
+                }
+            }
+        }
+
+        OcclusionCuller::OcclusionCuller(size_t width, size_t height, size_t maxOccluders) :
+        m_width(width),
+        m_height(height),
+        m_maxOccluders(maxOccluders),
+        m_depth(width * height, 1.0f),
+        m_occluderCount(0) {
+            assert(m_width > 0 && m_height > 0);
+        }
+
+        void OcclusionCuller::setOccluders(const Model::BrushList& occluders) {
+            m_occluders = occluders;
+        }
+
+        void OcclusionCuller::clear(const Mat4f& matrix) {
+            m_matrix = matrix;
+            std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+            m_occluderCount = 0;
+        }
+
+        void OcclusionCuller::addOccluder(const Vec3f::List& polygon) {
+            if (polygon.size() < 3)
+                return;
+
+            // clip against the near plane, in clip space a point is in front of it if z + w >= 0
+            Vec4f::List& clipped = m_clipped;
+            clipped.clear();
+            Vec4f previous = m_matrix * Vec4f(polygon.back(), 1.0f);
+            float previousDistance = previous[2] + previous[3];
+            for (size_t i = 0; i < polygon.size(); i++) {
+                const Vec4f current = m_matrix * Vec4f(polygon[i], 1.0f);
+                const float currentDistance = current[2] + current[3];
+                if ((previousDistance >= 0.0f) != (currentDistance >= 0.0f)) {
+                    const float t = previousDistance / (previousDistance - currentDistance);
+                    clipped.push_back(previous + (current - previous) * t);
+                }
+                if (currentDistance >= 0.0f)
+                    clipped.push_back(current);
+                previous = current;
+                previousDistance = currentDistance;
+            }
+
+            if (clipped.size() < 3)
+                return;
+
+            m_window.resize(clipped.size());
+            for (size_t i = 0; i < clipped.size(); i++)
+                if (!project(clipped[i], m_window[i]))
+                    return;
+            rasterizePolygon(m_window);
+        }
+
+        void OcclusionCuller::update(const Mat4f& matrix, const Vec3f& cameraPosition) {
+            clear(matrix);
+
+            m_candidates.clear();
+            Model::BrushList::const_iterator brushIt, brushEnd;
+            for (brushIt = m_occluders.begin(), brushEnd = m_occluders.end(); brushIt != brushEnd; ++brushIt) {
+                Model::Brush* brush = *brushIt;
+                const BBoxf& bounds = brush->bounds();
+                const float radiusSquared = bounds.size().lengthSquared() / 4.0f;
+                const float distanceSquared = std::max((bounds.center() - cameraPosition).lengthSquared(), 1.0f);
+                const float score = radiusSquared / distanceSquared;
+                if (score >= MinOccluderScore)
+                    m_candidates.push_back(Candidate(brush, score));
+            }
+
+            const size_t count = std::min(m_candidates.size(), m_maxOccluders);
+            std::partial_sort(m_candidates.begin(), m_candidates.begin() + static_cast<CandidateList::difference_type>(count), m_candidates.end());
+
+            Vec3f::List& polygon = m_polygon;
+            for (size_t i = 0; i < count; i++) {
+                const Model::FaceList& faces = m_candidates[i].brush->faces();
+                Model::FaceList::const_iterator faceIt, faceEnd;
+                for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt) {
+                    const Model::Face& face = **faceIt;
+                    // the back faces are covered by the front faces
+                    if (face.boundary().pointStatus(cameraPosition) != PointStatus::PSAbove)
+                        continue;
+
+                    const Model::VertexList& vertices = face.vertices();
+                    polygon.resize(vertices.size());
+                    for (size_t j = 0; j < vertices.size(); j++)
+                        polygon[j] = vertices[j]->position;
+                    addOccluder(polygon);
+                }
+            }
+            m_occluderCount = count;
+        }
+
+        bool OcclusionCuller::visible(const BBoxf& bounds) const {
+            float minX = std::numeric_limits<float>::max();
+            float minY = std::numeric_limits<float>::max();
+            float minZ = std::numeric_limits<float>::max();
+            float maxX = -std::numeric_limits<float>::max();
+            float maxY = -std::numeric_limits<float>::max();
+
+            unsigned int behind = 0;
+            for (unsigned int i = 0; i < 8; i++) {
+                const Vec3f corner((i & 4) != 0 ? bounds.max[0] : bounds.min[0],
+                                   (i & 2) != 0 ? bounds.max[1] : bounds.min[1],
+                                   (i & 1) != 0 ? bounds.max[2] : bounds.min[2]);
+                const Vec4f clip = m_matrix * Vec4f(corner, 1.0f);
+                Vec3f window;
+                if (clip[2] + clip[3] < 0.0f || !project(clip, window)) {
+                    behind++;
+                    continue;
+                }
+
+                minX = std::min(minX, window[0]);
+                minY = std::min(minY, window[1]);
+                minZ = std::min(minZ, window[2]);
+                maxX = std::max(maxX, window[0]);
+                maxY = std::max(maxY, window[1]);
+            }
+
+            // boxes which reach through the near plane cannot be projected, so treat them as visible
+            if (behind == 8)
+                return false;
+            if (behind > 0)
+                return true;
+
+            const float width = static_cast<float>(m_width);
+            const float height = static_cast<float>(m_height);
+            if (maxX < 0.0f || maxY < 0.0f || minX >= width || minY >= height || minZ > 1.0f)
+                return false;
+
+            const size_t firstX = static_cast<size_t>(std::max(minX, 0.0f));
+            const size_t firstY = static_cast<size_t>(std::max(minY, 0.0f));
+            const size_t lastX = static_cast<size_t>(std::min(maxX, width - 0.5f));
+            const size_t lastY = static_cast<size_t>(std::min(maxY, height - 0.5f));
+
+            for (size_t y = firstY; y <= lastY; y++) {
+                const float* row = &m_depth[y * m_width];
+                for (size_t x = firstX; x <= lastX; x++)
+                    if (minZ <= row[x])
+                        return true;
+            }
+            return false;
+        }
+    }
+}
@@ -0,0 +1,140 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__OcclusionCuller__
+#define __TrenchBroom__OcclusionCuller__
+
+#include "Model/BrushTypes.h"
+#include "Utility/VecMath.h"
+
+#include <vector>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Renderer {
+        /*
+         Conservative occlusion culling on the CPU. Every frame, the brushes which cover the largest part of the view
+         are rasterized into a small depth buffer, and the bounds of other geometry can then be tested against it.
+         A pixel only receives an occluder's depth if the occluder covers it completely, and that depth is the
+         farthest depth of the occluder within the pixel, so a box is never reported hidden if any part of it could
+         be visible. Does not depend on OpenGL, so it can be tested and benchmarked without a context.
+         */
+        class OcclusionCuller {
+        public:
+            static const size_t DefaultWidth = 160;
+            static const size_t DefaultHeight = 90;
+            static const size_t DefaultMaxOccluders = 32;
+        private:
+            class Candidate {
+            public:
+                Model::Brush* brush;
+                float score;
+
+                Candidate(Model::Brush* i_brush, float i_score) :
+                brush(i_brush),
+                score(i_score) {}
+
+                inline bool operator< (const Candidate& other) const {
+                    return score > other.score;
+                }
+            };
+
+            typedef std::vector<Candidate> CandidateList;
+
+            class Edge {
+            public:
+                float a;
+                float b;
+                float c;
+            };
+
+            typedef std::vector<Edge> EdgeList;
+
+            size_t m_width;
+            size_t m_height;
+            size_t m_maxOccluders;
+            std::vector<float> m_depth;
+            Mat4f m_matrix;
+            Model::BrushList m_occluders;
+            CandidateList m_candidates;
+            size_t m_occluderCount;
+
+            // scratch buffers which are kept to avoid allocations while rasterizing
+            Vec3f::List m_polygon;
+            Vec4f::List m_clipped;
+            Vec3f::List m_window;
+            EdgeList m_edges;
+
+            bool project(const Vec4f& clip, Vec3f& window) const;
+            void rasterizePolygon(const Vec3f::List& vertices);
+        public:
+            OcclusionCuller(size_t width = DefaultWidth, size_t height = DefaultHeight, size_t maxOccluders = DefaultMaxOccluders);
+
+            inline size_t width() const {
+                return m_width;
+            }
+
+            inline size_t height() const {
+                return m_height;
+            }
+
+            /*
+             Returns the depth of the given pixel in the range [0, 1], 1 being the far plane.
+             */
+            inline float depth(size_t x, size_t y) const {
+                return m_depth[y * m_width + x];
+            }
+
+            /*
+             The number of brushes rasterized by the last call to update.
+             */
+            inline size_t occluderCount() const {
+                return m_occluderCount;
+            }
+
+            /*
+             Sets the brushes which may be used as occluders. All of their faces must be opaque.
+             */
+            void setOccluders(const Model::BrushList& occluders);
+
+            /*
+             Clears the depth buffer and sets the combined projection and view matrix.
+             */
+            void clear(const Mat4f& matrix);
+
+            /*
+             Rasterizes the given convex polygon. The winding of the polygon does not matter.
+             */
+            void addOccluder(const Vec3f::List& polygon);
+
+            /*
+             Clears the depth buffer and rasterizes the front faces of the occluders with the largest apparent size.
+             */
+            void update(const Mat4f& matrix, const Vec3f& cameraPosition);
+
+            /*
+             Returns false if the given box is hidden behind the rasterized occluders or lies outside of the view.
+             */
+            bool visible(const BBoxf& bounds) const;
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__OcclusionCuller__) */
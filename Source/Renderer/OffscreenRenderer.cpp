@@ -19,6 +19,8 @@
 
 #include "OffscreenRenderer.h"
 
+#include "Renderer/GLState.h"
+
 #include <cassert>
 #include <cstring>
 
@@ -108,24 +110,31 @@ namespace TrenchBroom {
             glBindFramebuffer(GL_FRAMEBUFFER, 0);
         }
 
-        wxImage* OffscreenRenderer::getImage() {
-            assert(m_valid);
+        OffscreenRenderer& OffscreenRenderer::resolve() {
+            if (!m_multisample || m_samples <= 0)
+                return *this;
 
-            if (m_multisample && m_samples > 0) {
-                if (m_readBuffers == NULL)
-                    m_readBuffers = new OffscreenRenderer(false);
+            if (m_readBuffers == NULL)
+                m_readBuffers = new OffscreenRenderer(false);
 
-                m_readBuffers->setDimensions(m_width, m_height);
-                m_readBuffers->preRender();
+            m_readBuffers->setDimensions(m_width, m_height);
+            m_readBuffers->preRender();
 
-                glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebufferId);
-                glBlitFramebuffer(0, 0, static_cast<GLint>(m_width), static_cast<GLint>(m_height),
-                                  0, 0, static_cast<GLint>(m_width), static_cast<GLint>(m_height),
-                                  GL_COLOR_BUFFER_BIT, GL_LINEAR);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebufferId);
+            glBlitFramebuffer(0, 0, static_cast<GLint>(m_width), static_cast<GLint>(m_height),
+                              0, 0, static_cast<GLint>(m_width), static_cast<GLint>(m_height),
+                              GL_COLOR_BUFFER_BIT, GL_LINEAR);
 
-                m_readBuffers->postRender();
-                return m_readBuffers->getImage();
-            }
+            m_readBuffers->postRender();
+            return *m_readBuffers;
+        }
+
+        wxImage* OffscreenRenderer::getImage() {
+            assert(m_valid);
+
+            OffscreenRenderer& buffers = resolve();
+            if (&buffers != this)
+                return buffers.getImage();
 
             glBindFramebufferEXT(GL_READ_FRAMEBUFFER_EXT, m_framebufferId);
 
@@ -164,5 +173,21 @@ namespace TrenchBroom {
 
             return new wxImage(static_cast<int>(m_width), static_cast<int>(m_height), imageData, alphaData);
         }
+
+        void OffscreenRenderer::copyToTexture(GLuint textureId, GLint x, GLint y) {
+            assert(m_valid);
+
+            OffscreenRenderer& buffers = resolve();
+            if (&buffers != this) {
+                buffers.copyToTexture(textureId, x, y);
+                return;
+            }
+
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebufferId);
+            GLState::state().bindTexture(textureId);
+            glCopyTexSubImage2D(GL_TEXTURE_2D, 0, x, y, 0, 0, static_cast<GLsizei>(m_width), static_cast<GLsizei>(m_height));
+            GLState::state().bindTexture(0);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        }
     }
 }
@@ -44,6 +44,8 @@ namespace TrenchBroom {
             GLint m_samples;
 
             OffscreenRenderer* m_readBuffers;
+
+            OffscreenRenderer& resolve();
         public:
             OffscreenRenderer(bool multisample, GLint samples = 0);
             ~OffscreenRenderer();
@@ -60,6 +62,9 @@ namespace TrenchBroom {
             void postRender();
 
             wxImage* getImage();
+
+            // copies the rendered image into the given texture with its lower left corner at x, y
+            void copyToTexture(GLuint textureId, GLint x, GLint y);
         };
     }
 }
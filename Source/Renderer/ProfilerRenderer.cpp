@@ -0,0 +1,124 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ProfilerRenderer.h"
+
+#include "Renderer/ApplyMatrix.h"
+#include "Renderer/GLState.h"
+#include "Renderer/RenderContext.h"
+#include "Renderer/Vbo.h"
+#include "Renderer/VertexArray.h"
+#include "Renderer/Shader/ShaderManager.h"
+#include "Renderer/Text/FontManager.h"
+#include "Renderer/Text/TexturedFont.h"
+#include "Utility/Preferences.h"
+#include "Utility/Profiler.h"
+#include "Utility/VecMath.h"
+
+#include <iomanip>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Renderer {
+        ProfilerRenderer::ProfilerRenderer() :
+        m_vbo(NULL) {}
+
+        ProfilerRenderer::~ProfilerRenderer() {
+            delete m_vbo;
+            m_vbo = NULL;
+        }
+
+        void ProfilerRenderer::render(RenderContext& context, Text::FontManager& fontManager, const VboAllocator::Stats& faceVboStats, const float viewWidth, const float viewHeight) {
+            if (m_vbo == NULL)
+                m_vbo = new Vbo(GL_ARRAY_BUFFER, 0xFFFF, true);
+            m_vbo->beginFrame();
+
+            const Utility::Profiler& profiler = Utility::Profiler::profiler();
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            Text::FontDescriptor descriptor(prefs.getString(Preferences::RendererFontName),
+                                            static_cast<unsigned int>(prefs.getInt(Preferences::RendererFontSize)));
+            Text::TexturedFont* font = fontManager.font(descriptor);
+
+            StringList lines;
+            StringStream frameTimes;
+            frameTimes << std::fixed << std::setprecision(2) <<
+            "Frame: " << profiler.lastFrameTime() / 1000.0f << "ms" <<
+            " (avg " << profiler.averageFrameTime() / 1000.0f << "ms" <<
+            ", max " << profiler.maxFrameTime() / 1000.0f << "ms)";
+            lines.push_back(frameTimes.str());
+
+            StringStream drawCalls;
+            drawCalls << "Draw calls: " << profiler.drawCalls() << ", streamed " << profiler.streamedBytes() / 1024 << "KB";
+            lines.push_back(drawCalls.str());
+
+            StringStream stateChanges;
+            stateChanges << "State changes: " << profiler.stateChanges() << ", " << profiler.skippedStateChanges() << " redundant skipped";
+            lines.push_back(stateChanges.str());
+
+            // the allocator counts are cumulative, show the changes since the last frame
+            StringStream faceVbo;
+            faceVbo << std::fixed << std::setprecision(1) <<
+            "Face VBO: " << (faceVboStats.totalCapacity - faceVboStats.freeCapacity) / 1024 << "/" << faceVboStats.totalCapacity / 1024 << "KB" <<
+            ", " << faceVboStats.freeBlockCount << " free blocks" <<
+            ", " << faceVboStats.fragmentation() * 100.0f << "% fragmented" <<
+            ", " << faceVboStats.allocations - m_lastFaceVboStats.allocations << " allocs" <<
+            ", " << faceVboStats.frees - m_lastFaceVboStats.frees << " frees" <<
+            ", " << (faceVboStats.bytesMoved - m_lastFaceVboStats.bytesMoved) / 1024 << "KB moved";
+            lines.push_back(faceVbo.str());
+            m_lastFaceVboStats = faceVboStats;
+
+            const float lineHeight = static_cast<float>(descriptor.size()) + 4.0f;
+            Vec2f::List vertices;
+            for (size_t i = 0; i < lines.size(); i++) {
+                const Vec2f offset(8.0f, viewHeight - 8.0f - static_cast<float>(i + 1) * lineHeight);
+                const Vec2f::List lineVertices = font->quads(lines[i], false, offset);
+                vertices.insert(vertices.end(), lineVertices.begin(), lineVertices.end());
+            }
+
+            const Mat4f projection = orthoMatrix(-1.0f, 1.0f, 0.0f, viewHeight, viewWidth, 0.0f);
+            const Mat4f view = viewMatrix(Vec3f::NegZ, Vec3f::PosY) * translationMatrix(Vec3f(0.0f, 0.0f, 0.1f));
+            ApplyTransformation ortho(context.transformation(), projection, view);
+
+            glDisable(GL_DEPTH_TEST);
+            GLState::state().enableBlend(true);
+            GLState::state().blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+            const unsigned int vertexCount = static_cast<unsigned int>(vertices.size() / 2);
+            VertexArray vertexArray(*m_vbo, GL_QUADS, vertexCount,
+                                    Attribute::position2f(),
+                                    Attribute::texCoord02f(), 0);
+
+            SetVboState mapVbo(*m_vbo, Vbo::VboMapped);
+            vertexArray.addAttributes(vertices);
+
+            SetVboState activateVbo(*m_vbo, Vbo::VboActive);
+            ActivateShader shader(context.shaderManager(), Shaders::TextShader);
+            shader.setUniformVariable("Color", prefs.getColor(Preferences::InfoOverlayTextColor));
+            shader.setUniformVariable("Texture", 0);
+
+            font->activate();
+            vertexArray.render();
+            font->deactivate();
+            m_vbo->endFrame();
+
+            glEnable(GL_DEPTH_TEST);
+        }
+    }
+}
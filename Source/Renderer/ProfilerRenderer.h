@@ -0,0 +1,51 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__ProfilerRenderer__
+#define __TrenchBroom__ProfilerRenderer__
+
+#include "Renderer/VboAllocator.h"
+
+namespace TrenchBroom {
+    namespace Renderer {
+        class RenderContext;
+        class Vbo;
+
+        namespace Text {
+            class FontManager;
+        }
+
+        /*
+         Renders the frame times and draw call count recorded by the profiler and the state of the face VBO in the
+         top left corner of the view.
+         */
+        class ProfilerRenderer {
+        private:
+            Vbo* m_vbo;
+            VboAllocator::Stats m_lastFaceVboStats;
+        public:
+            ProfilerRenderer();
+            ~ProfilerRenderer();
+
+            void render(RenderContext& context, Text::FontManager& fontManager, const VboAllocator::Stats& faceVboStats, const float viewWidth, const float viewHeight);
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__ProfilerRenderer__) */
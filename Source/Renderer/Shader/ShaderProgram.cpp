@@ -21,6 +21,7 @@
 
 #include "IO/FileManager.h"
 #include "Model/Texture.h"
+#include "Renderer/GLState.h"
 #include "Renderer/Shader/Shader.h"
 #include "Utility/Console.h"
 
@@ -29,17 +30,35 @@
 
 namespace TrenchBroom {
     namespace Renderer {
-        GLint ShaderProgram::uniformLocation(const String& name) {
-            UniformVariableMap::iterator it = m_uniformVariables.find(name);
-            if (it == m_uniformVariables.end()) {
-                GLint index = glGetUniformLocation(m_programId, name.c_str());
-                if (index == -1)
-                    m_console.warn("Location of uniform variable '%s' could not be found in %s", name.c_str(), m_name.c_str());
-                m_uniformVariables[name] = index;
-                return index;
+        void ShaderProgram::cacheUniformLocations() {
+            m_uniformVariables.clear();
+
+            GLint uniformCount = 0;
+            GLint maxNameLength = 0;
+            glGetProgramiv(m_programId, GL_ACTIVE_UNIFORMS, &uniformCount);
+            glGetProgramiv(m_programId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+            if (uniformCount <= 0 || maxNameLength <= 0)
+                return;
+
+            char* nameBuffer = new char[maxNameLength];
+            for (GLint i = 0; i < uniformCount; i++) {
+                GLsizei nameLength = 0;
+                GLint size = 0;
+                GLenum type = 0;
+                glGetActiveUniform(m_programId, static_cast<GLuint>(i), maxNameLength, &nameLength, &size, &type, nameBuffer);
+
+                String name(nameBuffer, static_cast<size_t>(nameLength));
+                const GLint location = glGetUniformLocation(m_programId, name.c_str());
+                if (location == -1)
+                    continue; // built in variables have no location
+
+                // arrays are reported as "name[0]" but may be addressed by their plain name, too
+                const size_t bracket = name.find('[');
+                if (bracket != String::npos)
+                    name = name.substr(0, bracket);
+                m_uniformVariables[name] = location;
             }
-
-            return it->second;
+            delete [] nameBuffer;
         }
 
         bool ShaderProgram::checkActive() {
@@ -65,6 +84,7 @@ namespace TrenchBroom {
         ShaderProgram::~ShaderProgram() {
             if (m_programId != 0) {
                 glDeleteProgram(m_programId);
+                GLState::state().programDeleted(m_programId);
                 m_programId = 0;
             }
         }
@@ -86,8 +106,6 @@ namespace TrenchBroom {
                 return false;
 
             if (m_needsLinking) {
-                m_uniformVariables.clear();
-
                 glLinkProgram(m_programId);
 
                 GLint linkStatus = 0;
@@ -109,88 +127,131 @@ namespace TrenchBroom {
 					delete [] infoLog;
 				}
 
+                cacheUniformLocations();
+
                 // always set to false to prevent console spam
                 m_needsLinking = false;
             }
 
-            glUseProgram(m_programId);
+            GLState::state().useProgram(m_programId);
             return true;
         }
 
         void ShaderProgram::deactivate() {
-            glUseProgram(0);
+            GLState::state().useProgram(0);
+        }
+
+        GLint ShaderProgram::uniformLocation(const String& name) {
+            assert(!m_needsLinking);
+            UniformVariableMap::iterator it = m_uniformVariables.find(name);
+            if (it == m_uniformVariables.end()) {
+                // remember the miss so that the warning is only printed once
+                m_console.warn("Location of uniform variable '%s' could not be found in %s", name.c_str(), m_name.c_str());
+                m_uniformVariables[name] = -1;
+                return -1;
+            }
+
+            return it->second;
         }
 
         bool ShaderProgram::setUniformVariable(const String& name, const bool value) {
-            return setUniformVariable(name, static_cast<int>(value));
+            return setUniformVariable(uniformLocation(name), value);
         }
 
         bool ShaderProgram::setUniformVariable(const String& name, const int value) {
+            return setUniformVariable(uniformLocation(name), value);
+        }
+
+        bool ShaderProgram::setUniformVariable(const String& name, const float value) {
+            return setUniformVariable(uniformLocation(name), value);
+        }
+
+        bool ShaderProgram::setUniformVariable(const String& name, const Vec2f& value) {
+            return setUniformVariable(uniformLocation(name), value);
+        }
+
+        bool ShaderProgram::setUniformVariable(const String& name, const Vec3f& value) {
+            return setUniformVariable(uniformLocation(name), value);
+        }
+
+        bool ShaderProgram::setUniformVariable(const String& name, const Vec4f& value) {
+            return setUniformVariable(uniformLocation(name), value);
+        }
+
+        bool ShaderProgram::setUniformVariable(const String& name, const Mat2f& value) {
+            return setUniformVariable(uniformLocation(name), value);
+        }
+
+        bool ShaderProgram::setUniformVariable(const String& name, const Mat3f& value) {
+            return setUniformVariable(uniformLocation(name), value);
+        }
+
+        bool ShaderProgram::setUniformVariable(const String& name, const Mat4f& value) {
+            return setUniformVariable(uniformLocation(name), value);
+        }
+
+        bool ShaderProgram::setUniformVariable(const GLint location, const bool value) {
+            return setUniformVariable(location, static_cast<int>(value));
+        }
+
+        bool ShaderProgram::setUniformVariable(const GLint location, const int value) {
             assert(checkActive());
-            GLint location = uniformLocation(name);
             if (location == -1)
                 return false;
             glUniform1i(location, value);
             return true;
         }
 
-        bool ShaderProgram::setUniformVariable(const String& name, const float value) {
+        bool ShaderProgram::setUniformVariable(const GLint location, const float value) {
             assert(checkActive());
-            GLint location = uniformLocation(name);
             if (location == -1)
                 return false;
             glUniform1f(location, value);
             return true;
         }
 
-        bool ShaderProgram::setUniformVariable(const String& name, const Vec2f& value) {
-            GLint location = uniformLocation(name);
+        bool ShaderProgram::setUniformVariable(const GLint location, const Vec2f& value) {
+            assert(checkActive());
             if (location == -1)
                 return false;
             glUniform2f(location, value.x(), value.y());
             return true;
         }
 
-        bool ShaderProgram::setUniformVariable(const String& name, const Vec3f& value) {
+        bool ShaderProgram::setUniformVariable(const GLint location, const Vec3f& value) {
             assert(checkActive());
-            GLint location = uniformLocation(name);
             if (location == -1)
                 return false;
             glUniform3f(location, value.x(), value.y(), value.z());
             return true;
         }
 
-        bool ShaderProgram::setUniformVariable(const String& name, const Vec4f& value) {
+        bool ShaderProgram::setUniformVariable(const GLint location, const Vec4f& value) {
             assert(checkActive());
-            checkActive();
-            GLint location = uniformLocation(name);
             if (location == -1)
                 return false;
             glUniform4f(location, value.x(), value.y(), value.z(), value.w());
             return true;
         }
 
-        bool ShaderProgram::setUniformVariable(const String& name, const Mat2f& value) {
+        bool ShaderProgram::setUniformVariable(const GLint location, const Mat2f& value) {
             assert(checkActive());
-            GLint location = uniformLocation(name);
             if (location == -1)
                 return false;
             glUniformMatrix2fv(location, 1, false, reinterpret_cast<const float*>(value.v));
             return true;
         }
 
-        bool ShaderProgram::setUniformVariable(const String& name, const Mat3f& value) {
+        bool ShaderProgram::setUniformVariable(const GLint location, const Mat3f& value) {
             assert(checkActive());
-            GLint location = uniformLocation(name);
             if (location == -1)
                 return false;
             glUniformMatrix3fv(location, 1, false, reinterpret_cast<const float*>(value.v));
             return true;
         }
 
-        bool ShaderProgram::setUniformVariable(const String& name, const Mat4f& value) {
+        bool ShaderProgram::setUniformVariable(const GLint location, const Mat4f& value) {
             assert(checkActive());
-            GLint location = uniformLocation(name);
             if (location == -1)
                 return false;
             glUniformMatrix4fv(location, 1, false, reinterpret_cast<const float*>(value.v));
@@ -50,7 +50,7 @@ namespace TrenchBroom {
             bool m_needsLinking;
             Utility::Console& m_console;
             
-            GLint uniformLocation(const String& name);
+            void cacheUniformLocations();
             bool checkActive();
         public:
             ShaderProgram(const String& name, Utility::Console& console);
@@ -67,6 +67,23 @@ namespace TrenchBroom {
             bool activate();
             void deactivate();
             
+            /*
+             The locations of all active uniform variables are cached when the program is linked. Renderers which set
+             the same variables many times per frame should look up the locations once and use the setters below which
+             take a location. Returns -1 if the program has no such active variable.
+             */
+            GLint uniformLocation(const String& name);
+
+            bool setUniformVariable(GLint location, bool value);
+            bool setUniformVariable(GLint location, int value);
+            bool setUniformVariable(GLint location, float value);
+            bool setUniformVariable(GLint location, const Vec2f& value);
+            bool setUniformVariable(GLint location, const Vec3f& value);
+            bool setUniformVariable(GLint location, const Vec4f& value);
+            bool setUniformVariable(GLint location, const Mat2f& value);
+            bool setUniformVariable(GLint location, const Mat3f& value);
+            bool setUniformVariable(GLint location, const Mat4f& value);
+
             bool setUniformVariable(const String& name, bool value);
             bool setUniformVariable(const String& name, int value);
             bool setUniformVariable(const String& name, float value);
@@ -20,6 +20,7 @@
 #include "SharedResources.h"
 
 #include "Renderer/EntityModelRendererManager.h"
+#include "Renderer/GLState.h"
 #include "Renderer/Palette.h"
 #include "Renderer/PointHandleRenderer.h"
 #include "Renderer/TextureRendererManager.h"
@@ -163,6 +164,7 @@ namespace TrenchBroom {
             m_sharedContext = new wxGLContext(m_glCanvas);
             
             m_sharedContext->SetCurrent(*m_glCanvas);
+            GLState::state().reset();
             const char* vendor = reinterpret_cast<const char*>(glGetString(GL_VENDOR));
             const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
             const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
@@ -194,8 +196,10 @@ namespace TrenchBroom {
         }
 
         SharedResources::~SharedResources() {
-            if (m_sharedContext != NULL && m_glCanvas != NULL)
+            if (m_sharedContext != NULL && m_glCanvas != NULL) {
                 m_sharedContext->SetCurrent(*m_glCanvas);
+                GLState::state().reset();
+            }
 
             delete [] m_attribs;
             m_attribs = NULL;
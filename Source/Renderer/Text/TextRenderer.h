@@ -33,6 +33,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <map>
 
 using namespace TrenchBroom::VecMath;
@@ -74,10 +75,10 @@ namespace TrenchBroom {
             public:
                 virtual ~TextAnchor() {}
 
-                inline const Vec3f offset(const Camera& camera, const Vec2f& size) const {
+                inline const Vec3f offset(const Camera& camera, const Vec2f& size, const Mat4f& transformation) const {
                     const Vec2f halfSize = size / 2.0f;
                     const Vec2f factors = alignmentFactors();
-                    Vec3f offset = camera.project(basePosition());
+                    Vec3f offset = camera.project(transformation * basePosition());
                     for (size_t i = 0; i < 2; i++) {
                         offset[i] += factors[i] * size[i];
                         offset[i] -= halfSize[i];
@@ -89,6 +90,14 @@ namespace TrenchBroom {
                 inline const Vec3f position() const {
                     return basePosition();
                 }
+
+                /*
+                 Anchors whose position depends on the camera are not kept in the spatial index because they would
+                 have to be moved whenever the camera moves. Their positions are recomputed in every frame instead.
+                 */
+                virtual bool cameraDependent() const {
+                    return false;
+                }
             };
 
             class SimpleTextAnchor : public TextAnchor {
@@ -138,13 +147,17 @@ namespace TrenchBroom {
                 class TextEntry {
                 private:
                     Vec2f::List m_vertices;
+                    Vec2f::List m_rectVertices;
+                    Vec2f m_rectInset;
                     Vec2f m_size;
                     TextAnchor::Ptr m_textAnchor;
+                    Vec3f m_position;
                 public:
                     TextEntry(const Vec2f::List& vertices, const Vec2f& size, TextAnchor::Ptr textAnchor) :
                     m_vertices(vertices),
                     m_size(size),
-                    m_textAnchor(textAnchor) {}
+                    m_textAnchor(textAnchor),
+                    m_position(textAnchor->position()) {}
                     
                     inline const Vec2f::List& vertices() const {
                         return m_vertices;
@@ -153,6 +166,7 @@ namespace TrenchBroom {
                     inline void update(const Vec2f::List& vertices, const Vec2f& size) {
                         m_vertices = vertices;
                         m_size = size;
+                        m_rectVertices.clear();
                     }
 
                     inline const Vec2f& size() const {
@@ -162,11 +176,55 @@ namespace TrenchBroom {
                     inline const TextAnchor& textAnchor() const {
                         return *m_textAnchor.get();
                     }
+
+                    inline const Vec3f& position() const {
+                        return m_position;
+                    }
+                    
+                    inline void updatePosition() {
+                        m_position = m_textAnchor->position();
+                    }
+                    
+                    /*
+                     The background rectangle only depends on the size of the string and the insets, so we build it
+                     once and keep it around instead of recomputing the rounded corners in every frame.
+                     */
+                    inline const Vec2f::List& rectVertices(float hInset, float vInset) {
+                        const Vec2f inset(hInset, vInset);
+                        if (m_rectVertices.empty() || m_rectInset != inset) {
+                            const Vec2f size = m_size.rounded();
+                            m_rectVertices.clear();
+                            m_rectVertices.reserve(3 * 16);
+                            roundedRect(size.x() + 2.0f * hInset, size.y() + 2.0f * vInset, 3.0f, 3, m_rectVertices);
+                            m_rectInset = inset;
+                        }
+                        return m_rectVertices;
+                    }
                 };
 
+                /*
+                 The entries are kept in a uniform grid whose cells are as large as the cutoff distance. A query
+                 therefore only needs to visit the 3x3x3 cells around the camera instead of every entry.
+                 */
+                class GridCell {
+                public:
+                    int x, y, z;
+                    
+                    GridCell() : x(0), y(0), z(0) {}
+                    GridCell(int i_x, int i_y, int i_z) : x(i_x), y(i_y), z(i_z) {}
+                    
+                    inline bool operator<(const GridCell& other) const {
+                        if (x != other.x) return x < other.x;
+                        if (y != other.y) return y < other.y;
+                        return z < other.z;
+                    }
+                };
+                
                 typedef std::map<Key, TextEntry, Comparator> TextMap;
                 typedef std::pair<Key, TextEntry> TextMapItem;
-                typedef std::vector<TextEntry> EntryList;
+                typedef std::vector<TextEntry*> EntryList;
+                typedef std::vector<typename TextMap::iterator> CellEntryList;
+                typedef std::map<GridCell, CellEntryList> Grid;
 
                 TexturedFont& m_font;
                 float m_fadeDistance;
@@ -174,31 +232,151 @@ namespace TrenchBroom {
                 float m_vInset;
 
                 TextMap m_entries;
+                Grid m_grid;
+                CellEntryList m_cameraDependentEntries;
+                bool m_gridValid;
                 Vbo* m_vbo;
 
+                inline float cutoffDistance() const {
+                    return m_fadeDistance + 100.0f;
+                }
+                
+                inline int gridCoordinate(float value) const {
+                    return static_cast<int>(std::floor(value / cutoffDistance()));
+                }
+                
+                inline const GridCell gridCell(const Vec3f& position) const {
+                    return GridCell(gridCoordinate(position.x()), gridCoordinate(position.y()), gridCoordinate(position.z()));
+                }
+                
+                inline void addToGrid(typename TextMap::iterator entryIt) {
+                    if (entryIt->second.textAnchor().cameraDependent())
+                        m_cameraDependentEntries.push_back(entryIt);
+                    else
+                        m_grid[gridCell(entryIt->second.position())].push_back(entryIt);
+                }
+                
+                inline bool removeFromList(CellEntryList& entries, typename TextMap::iterator textIt) {
+                    typename CellEntryList::iterator entryIt = std::find(entries.begin(), entries.end(), textIt);
+                    if (entryIt == entries.end())
+                        return false;
+                    *entryIt = entries.back();
+                    entries.pop_back();
+                    return true;
+                }
+                
+                inline void removeFromGrid(typename TextMap::iterator textIt) {
+                    if (textIt->second.textAnchor().cameraDependent()) {
+                        removeFromList(m_cameraDependentEntries, textIt);
+                        return;
+                    }
+                    
+                    typename Grid::iterator cellIt = m_grid.find(gridCell(textIt->second.position()));
+                    if (cellIt == m_grid.end())
+                        return;
+                    
+                    CellEntryList& cellEntries = cellIt->second;
+                    removeFromList(cellEntries, textIt);
+                    if (cellEntries.empty())
+                        m_grid.erase(cellIt);
+                }
+                
+                void validateGrid() {
+                    m_grid.clear();
+                    m_cameraDependentEntries.clear();
+                    
+                    typename TextMap::iterator it, end;
+                    for (it = m_entries.begin(), end = m_entries.end(); it != end; ++it) {
+                        it->second.updatePosition();
+                        addToGrid(it);
+                    }
+                    
+                    m_gridValid = true;
+                }
+                
                 inline void addString(Key key, const Vec2f::List& vertices, const Vec2f& size, TextAnchor::Ptr anchor) {
                     removeString(key);
-                    m_entries.insert(TextMapItem(key, TextEntry(vertices, size, anchor)));
+                    typename TextMap::iterator it = m_entries.insert(TextMapItem(key, TextEntry(vertices, size, anchor))).first;
+                    if (m_gridValid)
+                        addToGrid(it);
                 }
 
-                EntryList visibleEntries(RenderContext& context, const TextRendererFilter& filter) {
-                    float cutoff = (m_fadeDistance + 100) * (m_fadeDistance + 100);
+                inline bool inFrustum(const Camera& camera, const Planef* frustumPlanes, const TextEntry& entry, const Vec3f& position, float distance) const {
+                    if (camera.ortho())
+                        return true;
+                    
+                    // the label is drawn in screen space, so grow the frustum by the label's extents at this distance
+                    const Camera::Viewport& viewport = camera.viewport();
+                    const float pixelSize = 2.0f * distance * std::tan(Math<float>::radians(camera.fieldOfVision()) / 2.0f) / std::max(1, viewport.height);
+                    const float margin = pixelSize * (entry.size().length() + 2.0f * std::max(m_hInset, m_vInset));
+                    
+                    for (size_t i = 0; i < 4; i++)
+                        if (frustumPlanes[i].pointDistance(position) > margin)
+                            return false;
+                    return true;
+                }
+                
+                inline void collectVisibleEntries(RenderContext& context, const TextRendererFilter& filter, const Planef* frustumPlanes, const Mat4f* transformation, const CellEntryList& entries, EntryList& result) {
+                    const Camera& camera = context.camera();
+                    const float cutoff = cutoffDistance();
+                    const float cutoff2 = cutoff * cutoff;
+                    
+                    for (size_t i = 0; i < entries.size(); i++) {
+                        typename TextMap::iterator textIt = entries[i];
+                        TextEntry& entry = textIt->second;
+                        const Vec3f position = transformation != NULL ? *transformation * entry.position() : entry.position();
+                        const float dist2 = camera.squaredDistanceTo(position);
+                        if (dist2 <= cutoff2 &&
+                            inFrustum(camera, frustumPlanes, entry, position, std::sqrt(dist2)) &&
+                            filter.stringVisible(context, textIt->first))
+                            result.push_back(&entry);
+                    }
+                }
+                
+                EntryList visibleEntries(RenderContext& context, const TextRendererFilter& filter, const Mat4f& transformation) {
+                    if (!m_gridValid)
+                        validateGrid();
+                    
+                    const Camera& camera = context.camera();
+                    const Vec3f& cameraPosition = camera.position();
+                    const float cutoff = cutoffDistance();
+                    
+                    Planef frustumPlanes[4];
+                    camera.frustumPlanes(frustumPlanes[0], frustumPlanes[1], frustumPlanes[2], frustumPlanes[3]);
+                    
+                    for (size_t i = 0; i < m_cameraDependentEntries.size(); i++)
+                        m_cameraDependentEntries[i]->second.updatePosition();
+                    
                     EntryList result;
-
-                    typename TextMap::iterator it, end;
-                    for (it = m_entries.begin(), end = m_entries.end(); it != end; ++it) {
-                        Key key = it->first;
-                        if (filter.stringVisible(context, key)) {
-                            const TextEntry& entry = it->second;
-                            const TextAnchor& anchor = entry.textAnchor();
-                            const Vec3f position = anchor.position();
-
-                            float dist2 = context.camera().squaredDistanceTo(position);
-                            if (dist2 <= cutoff)
-                                result.push_back(entry);
+                    
+                    // the grid holds the untransformed positions, so transformed strings (e.g. the selection while it
+                    // is being dragged) are all tested individually
+                    if (!(transformation == Mat4f::Identity)) {
+                        CellEntryList entries;
+                        entries.reserve(m_entries.size());
+                        typename TextMap::iterator it, end;
+                        for (it = m_entries.begin(), end = m_entries.end(); it != end; ++it)
+                            entries.push_back(it);
+                        collectVisibleEntries(context, filter, frustumPlanes, &transformation, entries, result);
+                        return result;
+                    }
+                    
+                    const GridCell minCell = gridCell(cameraPosition - Vec3f(cutoff, cutoff, cutoff));
+                    const GridCell maxCell = gridCell(cameraPosition + Vec3f(cutoff, cutoff, cutoff));
+                    
+                    GridCell cell;
+                    for (cell.x = minCell.x; cell.x <= maxCell.x; cell.x++) {
+                        for (cell.y = minCell.y; cell.y <= maxCell.y; cell.y++) {
+                            for (cell.z = minCell.z; cell.z <= maxCell.z; cell.z++) {
+                                typename Grid::iterator cellIt = m_grid.find(cell);
+                                if (cellIt != m_grid.end())
+                                    collectVisibleEntries(context, filter, frustumPlanes, NULL, cellIt->second, result);
+                            }
                         }
                     }
-
+                    
+                    collectVisibleEntries(context, filter, frustumPlanes, NULL, m_cameraDependentEntries, result);
+                    
                     return result;
                 }
             public:
@@ -207,6 +385,7 @@ namespace TrenchBroom {
                 m_fadeDistance(100.0f),
                 m_hInset(4.0f),
                 m_vInset(4.0f),
+                m_gridValid(true),
                 m_vbo(NULL) {}
 
                 ~TextRenderer() {
@@ -224,6 +403,8 @@ namespace TrenchBroom {
                 inline void removeString(Key key)  {
                     typename TextMap::iterator it = m_entries.find(key);
                     if (it != m_entries.end()) {
+                        if (m_gridValid)
+                            removeFromGrid(it);
                         m_entries.erase(it);
                     }
                 }
@@ -241,6 +422,8 @@ namespace TrenchBroom {
                     if (it != m_entries.end()) {
                         TextEntry& entry = it->second;
                         destination.addString(key, entry.vertices(), entry.textAnchor());
+                        if (m_gridValid)
+                            removeFromGrid(it);
                         m_entries.erase(it);
                     }
                 }
@@ -251,17 +434,34 @@ namespace TrenchBroom {
 
                 inline void clear()  {
                     m_entries.clear();
+                    m_grid.clear();
+                    m_cameraDependentEntries.clear();
+                    m_gridValid = true;
                 }
 
                 inline void setFadeDistance(float fadeDistance)  {
+                    if (fadeDistance == m_fadeDistance)
+                        return;
                     m_fadeDistance = fadeDistance;
+                    m_gridValid = false;
+                }
+                
+                /*
+                 Must be called when the anchors of the strings may have moved so that the spatial index is rebuilt
+                 before the next frame. Camera dependent anchors are updated in every frame and need not be
+                 invalidated.
+                 */
+                inline void invalidatePositions() {
+                    m_gridValid = false;
                 }
 
                 void render(RenderContext& context, const TextRendererFilter& filter, ShaderProgram& textProgram, const Color& textColor, ShaderProgram& backgroundProgram, const Color& backgroundColor) {
                     if (m_entries.empty())
                         return;
 
-                    EntryList entries = visibleEntries(context, filter);
+                    // the strings are drawn in screen space, so the current model matrix is applied to their anchors
+                    const Mat4f transformation = context.transformation().modelMatrix();
+                    EntryList entries = visibleEntries(context, filter, transformation);
                     if (entries.empty())
                         return;
 
@@ -270,7 +470,7 @@ namespace TrenchBroom {
 
                     size_t textVertexCount = 0;
                     for (size_t i = 0; i < entries.size(); i++) {
-                        const TextEntry& entry = entries[i];
+                        const TextEntry& entry = *entries[i];
                         textVertexCount += entry.vertices().size() / 2;
                     }
 
@@ -284,10 +484,10 @@ namespace TrenchBroom {
 
                     SetVboState mapVbo(*m_vbo, Vbo::VboMapped);
                     for (size_t i = 0; i < entries.size(); i++) {
-                        const TextEntry& entry = entries[i];
+                        TextEntry& entry = *entries[i];
                         const Vec2f& size = entry.size().rounded();
                         const TextAnchor& anchor = entry.textAnchor();
-                        const Vec3f offset = anchor.offset(context.camera(), size);
+                        const Vec3f offset = anchor.offset(context.camera(), size, transformation);
 
                         const Vec2f::List& textVertices = entry.vertices();
                         for (size_t j = 0; j < textVertices.size() / 2; j++) {
@@ -298,9 +498,7 @@ namespace TrenchBroom {
                             textArray.addAttribute(texCoords);
                         }
 
-                        Vec2f::List rectVertices;
-                        rectVertices.reserve(3 * 16);
-                        roundedRect(size.x() + 2.0f * m_hInset, size.y() + 2.0f * m_vInset, 3.0f, 3, rectVertices);
+                        const Vec2f::List& rectVertices = entry.rectVertices(m_hInset, m_vInset);
                         for (size_t j = 0; j < rectVertices.size(); j++) {
                             const Vec2f& vertex = rectVertices[j];
                             rectArray.addAttribute(Vec3f(vertex.x() + offset.x() + size.x() / 2.0f, vertex.y() + offset.y() + size.y() / 2.0f, -offset.z()));
@@ -19,6 +19,7 @@
 
 #include "TexturedFont.h"
 
+#include "Renderer/GLState.h"
 #include "Renderer/Text/TextureBitmap.h"
 
 #include <cassert>
@@ -90,6 +91,7 @@ namespace TrenchBroom {
             TexturedFont::~TexturedFont() {
                 if (m_textureId > 0) {
                     glDeleteTextures(1, &m_textureId);
+                    GLState::state().textureDeleted(m_textureId);
                     m_textureId = 0;
                 }
 
@@ -153,7 +155,7 @@ namespace TrenchBroom {
                 if (m_textureId == 0) {
                     assert(m_bitmap != NULL);
                     glGenTextures(1, &m_textureId);
-                    glBindTexture(GL_TEXTURE_2D, m_textureId);
+                    GLState::state().bindTexture(m_textureId);
                     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
                     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
                     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -164,11 +166,11 @@ namespace TrenchBroom {
                 }
 
                 assert(m_textureId > 0);
-                glBindTexture(GL_TEXTURE_2D, m_textureId);
+                GLState::state().bindTexture(m_textureId);
             }
 
             void TexturedFont::deactivate() {
-                glBindTexture(GL_TEXTURE_2D, 0);
+                GLState::state().bindTexture(0);
             }
         }
     }
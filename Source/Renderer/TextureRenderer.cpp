@@ -22,7 +22,11 @@
 #include "IO/Wad.h"
 #include "Model/Bsp.h"
 #include "Model/Alias.h"
+#include "Renderer/GLState.h"
 #include "Renderer/Palette.h"
+#include "Utility/MemoryStats.h"
+
+#include <cassert>
 
 namespace TrenchBroom {
     namespace Renderer {
@@ -30,12 +34,31 @@ namespace TrenchBroom {
             m_width = width;
             m_height = height;
             m_textureBuffer = NULL;
+            m_textureBufferSize = 0;
 			m_textureId = 0;
         }
         
         void TextureRenderer::init(unsigned char* rgbImage, unsigned int width, unsigned int height) {
             init(width, height);
-            m_textureBuffer = rgbImage;
+            setTextureBuffer(rgbImage, m_width * m_height * 3);
+        }
+        
+        void TextureRenderer::setTextureBuffer(unsigned char* buffer, size_t size) {
+            assert(m_textureBuffer == NULL);
+            m_textureBuffer = buffer;
+            if (m_textureBuffer != NULL) {
+                m_textureBufferSize = size;
+                Utility::MemoryStats::stats().add(Utility::MemoryCategory::TextureBuffers, m_textureBufferSize);
+            }
+        }
+        
+        void TextureRenderer::deleteTextureBuffer() {
+            if (m_textureBuffer != NULL) {
+                Utility::MemoryStats::stats().remove(Utility::MemoryCategory::TextureBuffers, m_textureBufferSize);
+                delete [] m_textureBuffer;
+                m_textureBuffer = NULL;
+                m_textureBufferSize = 0;
+            }
         }
         
         TextureRenderer::TextureRenderer(unsigned char* rgbImage, const Color& averageColor, unsigned int width, unsigned int height) :
@@ -45,50 +68,50 @@ namespace TrenchBroom {
         
         TextureRenderer::TextureRenderer(const Model::AliasSkin& skin, unsigned int skinIndex, const Palette& palette) {
             init(skin.width(), skin.height());
-            m_textureBuffer = new unsigned char[m_width * m_height * 3];
+            setTextureBuffer(new unsigned char[m_width * m_height * 3], m_width * m_height * 3);
             palette.indexedToRgb(skin.pictures()[skinIndex], m_textureBuffer, m_width * m_height, m_averageColor);
         }
         
         TextureRenderer::TextureRenderer(const Model::BspTexture& texture, const Palette& palette) {
             init(texture.width(), texture.height());
-            m_textureBuffer = new unsigned char[m_width * m_height * 3];
+            setTextureBuffer(new unsigned char[m_width * m_height * 3], m_width * m_height * 3);
             palette.indexedToRgb(texture.image(), m_textureBuffer, m_width * m_height, m_averageColor);
         }
         
         TextureRenderer::TextureRenderer() {
             init(1, 1);
-            m_textureBuffer = new unsigned char[4];
+            setTextureBuffer(new unsigned char[4], 4);
             for (int i = 0; i < 4; i++)
                 m_textureBuffer[i] = 0;
         }
         
         TextureRenderer::~TextureRenderer() {
-            if (m_textureId > 0)
+            if (m_textureId > 0) {
                 glDeleteTextures(1, &m_textureId);
-            if (m_textureBuffer != NULL)
-                delete [] m_textureBuffer;
+                GLState::state().textureDeleted(m_textureId);
+            }
+            deleteTextureBuffer();
         }
 
         void TextureRenderer::activate() {
             if (m_textureId == 0) {
                 if (m_textureBuffer != NULL) {
                     glGenTextures(1, &m_textureId);
-                    glBindTexture(GL_TEXTURE_2D, m_textureId);
+                    GLState::state().bindTexture(m_textureId);
                     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
                     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
                     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
                     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
                     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, static_cast<GLsizei>(m_width), static_cast<GLsizei>(m_height), 0, GL_RGB, GL_UNSIGNED_BYTE, m_textureBuffer);
-                    delete [] m_textureBuffer;
-                    m_textureBuffer = NULL;
+                    deleteTextureBuffer();
                 }
             }
             
-            glBindTexture(GL_TEXTURE_2D, m_textureId);
+            GLState::state().bindTexture(m_textureId);
         }
         
         void TextureRenderer::deactivate() {
-            glBindTexture(GL_TEXTURE_2D, 0);
+            GLState::state().bindTexture(0);
         }
     }
 }
@@ -42,10 +42,13 @@ namespace TrenchBroom {
             unsigned int m_width;
             unsigned int m_height;
             unsigned char* m_textureBuffer;
+            size_t m_textureBufferSize;
             Color m_averageColor;
             
             void init(unsigned int width, unsigned int height);
             void init(unsigned char* rgbImage, unsigned int width, unsigned int height);
+            void setTextureBuffer(unsigned char* buffer, size_t size);
+            void deleteTextureBuffer();
 
             // prevent copying
             TextureRenderer(const TextureRenderer& other);
@@ -61,6 +64,14 @@ namespace TrenchBroom {
                 return m_averageColor;
             }
             
+            inline unsigned int width() const {
+                return m_width;
+            }
+            
+            inline unsigned int height() const {
+                return m_height;
+            }
+            
             void activate();
             void deactivate();
         };
@@ -22,6 +22,7 @@
 #include "Model/Texture.h"
 #include "Model/TextureManager.h"
 #include "Renderer/TextureRenderer.h"
+#include "Utility/List.h"
 #include "Utility/Map.h"
 
 #include <cassert>
@@ -63,6 +64,15 @@ namespace TrenchBroom {
 
         void TextureRendererManager::clear() {
             Utility::deleteAll(m_textureCollections);
+            Utility::deleteAll(m_invalidCollections);
+        }
+
+        void TextureRendererManager::invalidate(Model::TextureCollection& collection) {
+            TextureRendererCollectionMap::iterator it = m_textureCollections.find(&collection);
+            if (it != m_textureCollections.end()) {
+                m_invalidCollections.push_back(it->second);
+                m_textureCollections.erase(it);
+            }
         }
 
         TextureRendererManager::TextureRendererManager(Model::TextureManager& textureManager) :
@@ -83,6 +93,8 @@ namespace TrenchBroom {
             if (!m_valid) {
                 clear();
                 m_valid = true;
+            } else if (!m_invalidCollections.empty()) {
+                Utility::deleteAll(m_invalidCollections);
             }
             
             if (texture == NULL)
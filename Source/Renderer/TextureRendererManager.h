@@ -23,6 +23,7 @@
 #include "Model/Texture.h"
 
 #include <map>
+#include <vector>
 
 namespace TrenchBroom {
     namespace Model {
@@ -52,11 +53,13 @@ namespace TrenchBroom {
         protected:
             typedef std::map<Model::TextureCollection*, TextureRendererCollection*> TextureRendererCollectionMap;
             typedef std::pair<Model::TextureCollection*, TextureRendererCollection*> TextureRendererCollectionEntry;
+            typedef std::vector<TextureRendererCollection*> TextureRendererCollectionList;
             
             Model::TextureManager& m_textureManager;
             TextureRenderer* m_dummyTexture;
             Palette* m_palette;
             TextureRendererCollectionMap m_textureCollections;
+            TextureRendererCollectionList m_invalidCollections;
             bool m_valid;
 
             void clear();
@@ -76,6 +79,12 @@ namespace TrenchBroom {
             inline void invalidate() {
                 m_valid = false;
             }
+            
+            /*
+             Drops the renderers of a collection that is about to be deleted. The textures are deleted on the next
+             call to renderer so that this can be called without a current GL context.
+             */
+            void invalidate(Model::TextureCollection& collection);
         };
     }
 }
@@ -0,0 +1,291 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "TextureThumbnailManager.h"
+
+#include "Model/Texture.h"
+#include "Model/TextureManager.h"
+#include "Renderer/Palette.h"
+#include "Renderer/TextureRenderer.h"
+#include "Utility/Profiler.h"
+
+#include <wx/thread.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        class TextureThumbnailWorker : public wxThread {
+        private:
+            TextureThumbnailManager& m_manager;
+            Model::TextureCollectionLoader* m_loader;
+            String m_loaderPath;
+
+            unsigned char* load(const TextureThumbnailManager::Request& request, Color& averageColor) {
+                // requests usually arrive in runs from the same collection, so keeping the last wad open is enough
+                if (m_loader == NULL || m_loaderPath != request.collectionPath) {
+                    delete m_loader;
+                    m_loader = NULL;
+                    try {
+                        m_loader = new Model::TextureCollectionLoader(request.collectionPath);
+                        m_loaderPath = request.collectionPath;
+                    } catch (IO::IOException&) {
+                        return NULL;
+                    }
+                }
+
+                try {
+                    return m_loader->load(request.name, request.width, request.height, *request.palette, averageColor);
+                } catch (IO::IOException&) {
+                    return NULL;
+                }
+            }
+        public:
+            TextureThumbnailWorker(TextureThumbnailManager& manager) :
+            wxThread(wxTHREAD_JOINABLE),
+            m_manager(manager),
+            m_loader(NULL) {}
+
+            ExitCode Entry() {
+                TextureThumbnailManager::Request request;
+                while (m_manager.nextRequest(request)) {
+                    Utility::ProfileZone zone("TextureThumbnailWorker::Entry");
+
+                    TextureThumbnailManager::Thumbnail thumbnail;
+                    thumbnail.texture = request.texture;
+                    thumbnail.generation = request.generation;
+                    thumbnail.width = request.width;
+                    thumbnail.height = request.height;
+                    thumbnail.image = load(request, thumbnail.averageColor);
+
+                    if (thumbnail.image != NULL) {
+                        // halve the image while it is still at least as large as it will be displayed
+                        const float scale = std::min(static_cast<float>(request.maxWidth) / static_cast<float>(thumbnail.width),
+                                                     static_cast<float>(request.maxHeight) / static_cast<float>(thumbnail.height));
+                        unsigned int factor = 1;
+                        while (2.0f * static_cast<float>(factor) * scale <= 1.0f && thumbnail.width / factor > 1 && thumbnail.height / factor > 1)
+                            factor *= 2;
+
+                        if (factor > 1) {
+                            unsigned char* image = TextureThumbnailManager::downscale(thumbnail.image, thumbnail.width, thumbnail.height, factor);
+                            delete [] thumbnail.image;
+                            thumbnail.image = image;
+                            thumbnail.width /= factor;
+                            thumbnail.height /= factor;
+                        }
+                    }
+
+                    m_manager.addThumbnail(thumbnail);
+                }
+
+                delete m_loader;
+                m_loader = NULL;
+                return (wxThread::ExitCode)0;
+            }
+        };
+
+        void TextureThumbnailManager::startWorkers() {
+            const int workerCount = std::max(1, std::min(4, wxThread::GetCPUCount() - 1));
+            for (int i = 0; i < workerCount; i++) {
+                TextureThumbnailWorker* worker = new TextureThumbnailWorker(*this);
+                if (worker->Create() != wxTHREAD_NO_ERROR || worker->Run() != wxTHREAD_NO_ERROR) {
+                    delete worker;
+                    continue;
+                }
+                m_workers.push_back(worker);
+            }
+        }
+
+        void TextureThumbnailManager::collectThumbnails() {
+            ThumbnailList finished;
+            {
+                wxMutexLocker lock(*m_mutex);
+                if (m_finished.empty())
+                    return;
+                finished.swap(m_finished);
+            }
+
+            ThumbnailList::const_iterator it, end;
+            for (it = finished.begin(), end = finished.end(); it != end; ++it) {
+                const Thumbnail& thumbnail = *it;
+                assert(thumbnail.generation == m_generation);
+
+                TextureRenderer* renderer = NULL;
+                if (thumbnail.image != NULL)
+                    renderer = new TextureRenderer(thumbnail.image, thumbnail.averageColor, thumbnail.width, thumbnail.height);
+                m_thumbnails[thumbnail.texture] = renderer;
+                m_requested.erase(thumbnail.texture);
+            }
+        }
+
+        void TextureThumbnailManager::deleteThumbnails(ThumbnailList& thumbnails) {
+            ThumbnailList::iterator it, end;
+            for (it = thumbnails.begin(), end = thumbnails.end(); it != end; ++it)
+                delete [] it->image;
+            thumbnails.clear();
+        }
+
+        TextureThumbnailManager::TextureThumbnailManager() :
+        m_palette(NULL),
+        m_maxWidth(64),
+        m_maxHeight(64),
+        m_mutex(new wxMutex()),
+        m_condition(new wxCondition(*m_mutex)),
+        m_generation(0),
+        m_shutdown(false) {}
+
+        TextureThumbnailManager::~TextureThumbnailManager() {
+            {
+                wxMutexLocker lock(*m_mutex);
+                m_shutdown = true;
+                m_condition->Broadcast();
+            }
+
+            WorkerList::iterator it, end;
+            for (it = m_workers.begin(), end = m_workers.end(); it != end; ++it) {
+                TextureThumbnailWorker* worker = *it;
+                worker->Wait();
+                delete worker;
+            }
+            m_workers.clear();
+
+            clear();
+            delete m_condition;
+            m_condition = NULL;
+            delete m_mutex;
+            m_mutex = NULL;
+        }
+
+        void TextureThumbnailManager::setPalette(const Palette& palette) {
+            if (&palette == m_palette)
+                return;
+            clear();
+            m_palette = &palette;
+            m_paletteCopy = PalettePtr(new Palette(palette));
+        }
+
+        void TextureThumbnailManager::setMaxSize(unsigned int maxWidth, unsigned int maxHeight) {
+            if (maxWidth == m_maxWidth && maxHeight == m_maxHeight)
+                return;
+            clear();
+            m_maxWidth = maxWidth;
+            m_maxHeight = maxHeight;
+        }
+
+        TextureRenderer* TextureThumbnailManager::thumbnail(Model::Texture& texture) {
+            assert(m_palette != NULL);
+
+            collectThumbnails();
+            ThumbnailMap::const_iterator it = m_thumbnails.find(&texture);
+            if (it != m_thumbnails.end())
+                return it->second;
+
+            if (m_requested.insert(&texture).second) {
+                if (m_workers.empty())
+                    startWorkers();
+
+                Request request;
+                request.texture = &texture;
+                request.collectionPath = texture.collection().path();
+                request.name = texture.name();
+                request.width = texture.width();
+                request.height = texture.height();
+                request.maxWidth = m_maxWidth;
+                request.maxHeight = m_maxHeight;
+                request.palette = m_paletteCopy;
+
+                wxMutexLocker lock(*m_mutex);
+                request.generation = m_generation;
+                m_requests.push_back(request);
+                m_condition->Signal();
+            }
+
+            return NULL;
+        }
+
+        bool TextureThumbnailManager::pending() const {
+            return !m_requested.empty();
+        }
+
+        void TextureThumbnailManager::clear() {
+            {
+                wxMutexLocker lock(*m_mutex);
+                m_requests.clear();
+                deleteThumbnails(m_finished);
+                m_generation++;
+            }
+
+            ThumbnailMap::iterator it, end;
+            for (it = m_thumbnails.begin(), end = m_thumbnails.end(); it != end; ++it)
+                delete it->second;
+            m_thumbnails.clear();
+            m_requested.clear();
+        }
+
+        bool TextureThumbnailManager::nextRequest(Request& request) {
+            wxMutexLocker lock(*m_mutex);
+            while (m_requests.empty() && !m_shutdown)
+                m_condition->Wait();
+            if (m_shutdown)
+                return false;
+
+            // serve the most recent request first, it belongs to a cell that is most likely still visible
+            request = m_requests.back();
+            m_requests.pop_back();
+            return true;
+        }
+
+        void TextureThumbnailManager::addThumbnail(const Thumbnail& thumbnail) {
+            wxMutexLocker lock(*m_mutex);
+            if (thumbnail.generation != m_generation) {
+                delete [] thumbnail.image;
+                return;
+            }
+            m_finished.push_back(thumbnail);
+        }
+
+        unsigned char* TextureThumbnailManager::downscale(const unsigned char* rgbImage, unsigned int width, unsigned int height, unsigned int factor) {
+            assert(factor > 0);
+            const unsigned int scaledWidth = width / factor;
+            const unsigned int scaledHeight = height / factor;
+            const unsigned int sampleCount = factor * factor;
+
+            unsigned char* scaledImage = new unsigned char[scaledWidth * scaledHeight * 3];
+            for (unsigned int y = 0; y < scaledHeight; y++) {
+                for (unsigned int x = 0; x < scaledWidth; x++) {
+                    unsigned int sum[3] = { 0, 0, 0 };
+                    for (unsigned int sy = y * factor; sy < (y + 1) * factor; sy++) {
+                        const unsigned char* row = rgbImage + (sy * width + x * factor) * 3;
+                        for (unsigned int sx = 0; sx < factor; sx++)
+                            for (unsigned int c = 0; c < 3; c++)
+                                sum[c] += row[sx * 3 + c];
+                    }
+
+                    unsigned char* pixel = scaledImage + (y * scaledWidth + x) * 3;
+                    for (unsigned int c = 0; c < 3; c++)
+                        pixel[c] = static_cast<unsigned char>(sum[c] / sampleCount);
+                }
+            }
+
+            return scaledImage;
+        }
+    }
+}
@@ -0,0 +1,124 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __TrenchBroom__TextureThumbnailManager__
+#define __TrenchBroom__TextureThumbnailManager__
+
+#include "Utility/Color.h"
+#include "Utility/SharedPointer.h"
+#include "Utility/String.h"
+
+#include <deque>
+#include <map>
+#include <set>
+#include <vector>
+
+class wxCondition;
+class wxMutex;
+
+namespace TrenchBroom {
+    namespace Model {
+        class Texture;
+    }
+
+    namespace Renderer {
+        class Palette;
+        class TextureRenderer;
+        class TextureThumbnailWorker;
+
+        /*
+         Creates small versions of textures for the texture browser. Decoding and downscaling happens on worker
+         threads; the resulting images are handed to TextureRenderers on the main thread, which upload them when they
+         are first activated. Until a texture's thumbnail is ready, thumbnail() returns NULL.
+         */
+        class TextureThumbnailManager {
+        public:
+            typedef std::tr1::shared_ptr<Palette> PalettePtr;
+
+            class Request {
+            public:
+                Model::Texture* texture;
+                String collectionPath;
+                String name;
+                unsigned int width;
+                unsigned int height;
+                unsigned int maxWidth;
+                unsigned int maxHeight;
+                PalettePtr palette;
+                unsigned int generation;
+            };
+
+            class Thumbnail {
+            public:
+                Model::Texture* texture;
+                unsigned char* image;
+                unsigned int width;
+                unsigned int height;
+                Color averageColor;
+                unsigned int generation;
+            };
+        private:
+            typedef std::map<Model::Texture*, TextureRenderer*> ThumbnailMap;
+            typedef std::set<Model::Texture*> TextureSet;
+            typedef std::deque<Request> RequestQueue;
+            typedef std::vector<Thumbnail> ThumbnailList;
+            typedef std::vector<TextureThumbnailWorker*> WorkerList;
+
+            ThumbnailMap m_thumbnails;
+            TextureSet m_requested;
+            const Palette* m_palette;
+            PalettePtr m_paletteCopy;
+            unsigned int m_maxWidth;
+            unsigned int m_maxHeight;
+
+            // shared with the worker threads, guarded by m_mutex
+            wxMutex* m_mutex;
+            wxCondition* m_condition;
+            RequestQueue m_requests;
+            ThumbnailList m_finished;
+            unsigned int m_generation;
+            bool m_shutdown;
+
+            WorkerList m_workers;
+
+            void startWorkers();
+            void collectThumbnails();
+            static void deleteThumbnails(ThumbnailList& thumbnails);
+        public:
+            TextureThumbnailManager();
+            ~TextureThumbnailManager();
+
+            void setPalette(const Palette& palette);
+            void setMaxSize(unsigned int maxWidth, unsigned int maxHeight);
+
+            TextureRenderer* thumbnail(Model::Texture& texture);
+            bool pending() const;
+            void clear();
+
+            // called by the worker threads
+            bool nextRequest(Request& request);
+            void addThumbnail(const Thumbnail& thumbnail);
+
+            static unsigned char* downscale(const unsigned char* rgbImage, unsigned int width, unsigned int height, unsigned int factor);
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__TextureThumbnailManager__) */
@@ -0,0 +1,85 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ThumbnailAtlas.h"
+
+#include "Renderer/GLState.h"
+
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        ThumbnailAtlas::ThumbnailAtlas(unsigned int slotSize, unsigned int pageSize) :
+        m_slotSize(slotSize),
+        m_pageSize(pageSize),
+        m_slotsPerRow(pageSize / slotSize),
+        m_slotCount(0) {
+            assert(m_slotsPerRow > 0);
+        }
+
+        ThumbnailAtlas::~ThumbnailAtlas() {
+            for (size_t i = 0; i < m_pages.size(); i++) {
+                GLState::state().textureDeleted(m_pages[i]);
+                glDeleteTextures(1, &m_pages[i]);
+            }
+            m_pages.clear();
+        }
+
+        ThumbnailAtlas::Slot ThumbnailAtlas::allocate() {
+            const size_t slotsPerPage = m_slotsPerRow * m_slotsPerRow;
+            const size_t page = m_slotCount / slotsPerPage;
+            const size_t index = m_slotCount % slotsPerPage;
+            m_slotCount++;
+
+            if (page == m_pages.size()) {
+                GLuint textureId;
+                glGenTextures(1, &textureId);
+                GLState::state().bindTexture(textureId);
+                glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+                glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, static_cast<GLsizei>(m_pageSize), static_cast<GLsizei>(m_pageSize), 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+                GLState::state().bindTexture(0);
+                m_pages.push_back(textureId);
+            }
+
+            const unsigned int x = static_cast<unsigned int>(index % m_slotsPerRow) * m_slotSize;
+            const unsigned int y = static_cast<unsigned int>(index / m_slotsPerRow) * m_slotSize;
+            return Slot(page, x, y);
+        }
+
+        GLuint ThumbnailAtlas::pageTexture(size_t page) const {
+            assert(page < m_pages.size());
+            return m_pages[page];
+        }
+
+        void ThumbnailAtlas::activatePage(size_t page) {
+            GLState::state().bindTexture(pageTexture(page));
+        }
+
+        void ThumbnailAtlas::deactivatePage() {
+            GLState::state().bindTexture(0);
+        }
+
+        void ThumbnailAtlas::clear() {
+            m_slotCount = 0;
+        }
+    }
+}
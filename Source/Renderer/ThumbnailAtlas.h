@@ -0,0 +1,88 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__ThumbnailAtlas__
+#define __TrenchBroom__ThumbnailAtlas__
+
+#include <GL/glew.h>
+
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        /*
+         Hands out square slots of equal size in a number of large page textures. The owner renders its thumbnails
+         into the slots (see OffscreenRenderer::copyToTexture) and remembers which slot belongs to which item, so that
+         all visible thumbnails on a page can be drawn with a single texture bind and a single draw call.
+         */
+        class ThumbnailAtlas {
+        public:
+            class Slot {
+            public:
+                size_t page;
+                unsigned int x;
+                unsigned int y;
+
+                Slot() :
+                page(0),
+                x(0),
+                y(0) {}
+
+                Slot(size_t i_page, unsigned int i_x, unsigned int i_y) :
+                page(i_page),
+                x(i_x),
+                y(i_y) {}
+            };
+        private:
+            typedef std::vector<GLuint> PageList;
+
+            unsigned int m_slotSize;
+            unsigned int m_pageSize;
+            unsigned int m_slotsPerRow;
+            PageList m_pages;
+            size_t m_slotCount;
+        public:
+            ThumbnailAtlas(unsigned int slotSize, unsigned int pageSize);
+            ~ThumbnailAtlas();
+
+            inline unsigned int slotSize() const {
+                return m_slotSize;
+            }
+
+            inline unsigned int pageSize() const {
+                return m_pageSize;
+            }
+
+            inline size_t pageCount() const {
+                return m_pages.size();
+            }
+
+            Slot allocate();
+            GLuint pageTexture(size_t page) const;
+
+            void activatePage(size_t page);
+            void deactivatePage();
+
+            // releases all slots, but keeps the page textures for reuse
+            void clear();
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__ThumbnailAtlas__) */
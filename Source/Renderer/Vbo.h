@@ -21,6 +21,7 @@
 #define TrenchBroom_Vbo_h
 
 #include <GL/glew.h>
+#include "Renderer/VboAllocator.h"
 #include "Utility/Color.h"
 #include "Utility/VecMath.h"
 
@@ -30,15 +31,25 @@
 #include <sstream>
 #include <vector>
 
-//#define _DEBUG_VBO 1
-
 using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
     namespace Renderer {
         class VboBlock;
 
-        class Vbo {
+        /*
+         The allocation policy is implemented by VboAllocator; this class owns the OpenGL buffer and moves its
+         contents when the allocator relocates blocks.
+         
+         A streaming VBO is meant for geometry that is rewritten while the GPU may still be drawing from the buffer,
+         e.g. tool overlays during a drag. It is mapped without synchronization, so blocks must not be overwritten
+         while a pending frame reads them: freed blocks are kept in one of StreamFrameCount ring sections and only
+         returned to the allocator when the section comes around again and the fence inserted at the end of its
+         frame has been passed. The owner brackets each frame with beginFrame and endFrame. Blocks are never moved,
+         the buffer grows instead. Without fences, the ring relies on the driver not queueing more frames than
+         there are sections, and without glMapBufferRange the buffer is mapped synchronously as usual.
+         */
+        class Vbo : public VboAllocator::Delegate {
         public:
             typedef enum {
                 VboInactive = 0,
@@ -61,33 +72,40 @@ namespace TrenchBroom {
                 length(0) {}
             };
 
+            static const size_t StreamFrameCount = 3;
+            
+            class StreamSection {
+            public:
+                GLsync fence;
+                std::vector<VboBlock*> freedBlocks;
+                
+                StreamSection() :
+                fence(NULL) {}
+            };
+
             GLenum m_type;
-            size_t m_totalCapacity;
-            size_t m_freeCapacity;
-            std::vector<VboBlock*> m_freeBlocks;
-            VboBlock* m_first;
-            VboBlock* m_last;
+            VboAllocator* m_allocator;
             unsigned char* m_buffer;
             GLuint m_vboId;
+            size_t m_vboSize;
             VboState m_state;
-            size_t findFreeBlockInRange(size_t address, size_t capacity, size_t start, size_t length);
-            size_t findFreeBlock(size_t address, size_t capacity);
-            void insertFreeBlock(VboBlock& block);
-            void removeFreeBlock(VboBlock& block);
+            
+            bool m_streaming;
+            StreamSection m_streamSections[StreamFrameCount];
+            size_t m_streamSection;
+            
             void resizeVbo(size_t newCapacity);
-            void resizeBlock(VboBlock& block, size_t newCapacity);
-            VboBlock* packBlock(VboBlock& block);
-#ifdef _DEBUG_VBO
-            void checkBlockChain();
-            void checkFreeBlocks();
-#endif
+            void releaseStreamSection(StreamSection& section);
+            
+            VboAllocator::Block* createBlock(size_t address, size_t capacity);
+            void moveMemory(size_t to, size_t from, size_t length);
             friend class VboBlock;
 
             // prevent copying
             Vbo(const Vbo& other);
             void operator= (const Vbo& other);
         public:
-            Vbo(GLenum type, size_t capacity);
+            Vbo(GLenum type, size_t capacity, bool streaming = false);
             ~Vbo();
             void activate();
             void deactivate();
@@ -98,11 +116,33 @@ namespace TrenchBroom {
                 return m_state;
             }
             
+            inline bool streaming() const {
+                return m_streaming;
+            }
+            
+            void beginFrame();
+            void endFrame();
+            
             void ensureFreeCapacity(size_t capacity);
             VboBlock* allocBlock(size_t capacity);
             VboBlock* freeBlock(VboBlock& block);
             void freeAllBlocks();
             void pack();
+            
+            /*
+             Moves roughly maxBytes bytes of used blocks to reduce fragmentation, mapping the buffer if necessary.
+             Called once per frame so that the cost of compaction is spread out.
+             */
+            void compact(size_t maxBytes);
+            
+            inline bool fragmented() const {
+                return m_allocator->fragmented();
+            }
+            
+            inline VboAllocator::Stats stats() const {
+                return m_allocator->stats();
+            }
+            
             bool ownsBlock(VboBlock& block);
         };
 
@@ -160,95 +200,64 @@ namespace TrenchBroom {
             }
         };
         
-        class VboBlock {
+        class VboBlock : public VboAllocator::Block {
         private:
             Vbo& m_vbo;
-            void insertBetween(VboBlock* previousBlock, VboBlock* nextBlock);
             friend class Vbo;
-
-            size_t m_address;
-            size_t m_capacity;
-            bool m_free;
-            VboBlock* m_previous;
-            VboBlock* m_next;
         public:
             inline VboBlock(Vbo& vbo, size_t address, size_t capacity) :
-            m_vbo(vbo),
-            m_address(address),
-            m_capacity(capacity),
-            m_free(true),
-            m_previous(NULL),
-            m_next(NULL) {}
-
-            inline size_t address() const {
-                return m_address;
-            }
-
-            inline size_t capacity() const {
-                return m_capacity;
-            }
-
-            inline bool free() const {
-                return m_free;
-            }
+            Block(address, capacity),
+            m_vbo(vbo) {}
 
             inline size_t writeBuffer(const unsigned char* buffer, size_t offset, size_t length) {
-                assert(offset + length <= m_capacity);
-                memcpy(m_vbo.m_buffer + m_address + offset, buffer, length);
+                assert(offset + length <= capacity());
+                memcpy(m_vbo.m_buffer + address() + offset, buffer, length);
                 return offset + length;
             }
 
             inline size_t writeByte(unsigned char b, size_t offset) {
-                assert(offset < m_capacity);
-                m_vbo.m_buffer[m_address + offset] = b;
+                assert(offset < capacity());
+                m_vbo.m_buffer[address() + offset] = b;
                 return offset + 1;
             }
 
             inline size_t writeFloat(float f, size_t offset) {
-                assert(offset + sizeof(float) <= m_capacity);
-                memcpy(m_vbo.m_buffer + m_address + offset, &f, sizeof(float));
+                assert(offset + sizeof(float) <= capacity());
+                memcpy(m_vbo.m_buffer + address() + offset, &f, sizeof(float));
                 return offset + sizeof(float);
             }
 
             inline size_t writeUInt32(size_t i, size_t offset) {
-                assert(offset + sizeof(size_t) <= m_capacity);
-                memcpy(m_vbo.m_buffer + m_address + offset, &i, sizeof(size_t));
+                assert(offset + sizeof(size_t) <= capacity());
+                memcpy(m_vbo.m_buffer + address() + offset, &i, sizeof(size_t));
                 return offset + sizeof(size_t);
             }
 
             inline size_t writeColor(const Color& color, size_t offset) {
-                assert(offset + 4 <= m_capacity);
-                m_vbo.m_buffer[m_address + offset + 0] = static_cast<unsigned char>(color.r() * 0xFF);
-                m_vbo.m_buffer[m_address + offset + 1] = static_cast<unsigned char>(color.g() * 0xFF);
-                m_vbo.m_buffer[m_address + offset + 2] = static_cast<unsigned char>(color.b() * 0xFF);
-                m_vbo.m_buffer[m_address + offset + 3] = static_cast<unsigned char>(color.a() * 0xFF);
+                assert(offset + 4 <= capacity());
+                m_vbo.m_buffer[address() + offset + 0] = static_cast<unsigned char>(color.r() * 0xFF);
+                m_vbo.m_buffer[address() + offset + 1] = static_cast<unsigned char>(color.g() * 0xFF);
+                m_vbo.m_buffer[address() + offset + 2] = static_cast<unsigned char>(color.b() * 0xFF);
+                m_vbo.m_buffer[address() + offset + 3] = static_cast<unsigned char>(color.a() * 0xFF);
                 return offset + 4;
             }
 
             template<class T>
             inline size_t writeVec(const T& vec, size_t offset) {
-                assert(offset + sizeof(T) <= m_capacity);
-                memcpy(m_vbo.m_buffer + m_address + offset, &vec, sizeof(T));
+                assert(offset + sizeof(T) <= capacity());
+                memcpy(m_vbo.m_buffer + address() + offset, &vec, sizeof(T));
                 return offset + sizeof(T);
             }
 
             template<class T>
             inline size_t writeVecs(const std::vector<T>& vecs, size_t offset) {
                 size_t size = static_cast<size_t>(vecs.size() * sizeof(T));
-                assert(offset + size <= m_capacity);
-                memcpy(m_vbo.m_buffer + m_address + offset, &(vecs[0]), size);
+                assert(offset + size <= capacity());
+                memcpy(m_vbo.m_buffer + address() + offset, &(vecs[0]), size);
                 return offset + size;
             }
 
             void freeBlock();
-
-            inline int compare(size_t address, size_t capacity) {
-                if (m_capacity < capacity) return -1;
-                if (m_capacity > capacity) return 1;
-                if (m_address < address) return -1;
-                if (m_address > address) return 1;
-                return 0;
-            }
         };
 
 		class VboException : public std::exception {
@@ -0,0 +1,294 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "VboAllocator.h"
+
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        VboAllocator::Block* VboAllocator::findFreeBlock(size_t capacity) const {
+            Block query(0, capacity);
+            FreeBlocksByCapacity::const_iterator it = m_freeBlocksByCapacity.lower_bound(&query);
+            if (it == m_freeBlocksByCapacity.end())
+                return NULL;
+            return *it;
+        }
+        
+        void VboAllocator::insertFreeBlock(Block& block) {
+            assert(block.free());
+            m_freeBlocksByCapacity.insert(&block);
+            m_freeBlocksByAddress.insert(&block);
+        }
+        
+        void VboAllocator::removeFreeBlock(Block& block) {
+            assert(block.free());
+            m_freeBlocksByCapacity.erase(&block);
+            m_freeBlocksByAddress.erase(&block);
+        }
+        
+        void VboAllocator::link(Block& block, Block* previous, Block* next) {
+            block.m_previous = previous;
+            block.m_next = next;
+            if (previous != NULL)
+                previous->m_next = &block;
+            else
+                m_first = &block;
+            if (next != NULL)
+                next->m_previous = &block;
+            else
+                m_last = &block;
+        }
+        
+        void VboAllocator::unlink(Block& block) {
+            if (block.m_previous != NULL)
+                block.m_previous->m_next = block.m_next;
+            else
+                m_first = block.m_next;
+            if (block.m_next != NULL)
+                block.m_next->m_previous = block.m_previous;
+            else
+                m_last = block.m_previous;
+            block.m_previous = NULL;
+            block.m_next = NULL;
+        }
+        
+        void VboAllocator::deleteBlocks() {
+            m_freeBlocksByCapacity.clear();
+            m_freeBlocksByAddress.clear();
+            Block* block = m_first;
+            while (block != NULL) {
+                Block* next = block->m_next;
+                delete block;
+                block = next;
+            }
+            m_first = m_last = NULL;
+        }
+        
+        size_t VboAllocator::compactStep() {
+            if (m_freeBlocksByAddress.empty())
+                return 0;
+            
+            Block* hole = *m_freeBlocksByAddress.begin();
+            Block* first = hole->m_next;
+            if (first == NULL)
+                return 0;
+            
+            // adjacent free blocks are always merged, so the hole is followed by a run of used blocks
+            assert(!first->free());
+            removeFreeBlock(*hole);
+            
+            const size_t from = first->m_address;
+            size_t length = 0;
+            Block* previous = NULL;
+            Block* block = first;
+            while (block != NULL && !block->free()) {
+                block->m_address -= hole->m_capacity;
+                length += block->m_capacity;
+                previous = block;
+                block = block->m_next;
+            }
+            m_delegate.moveMemory(hole->m_address, from, length);
+            
+            unlink(*hole);
+            if (block != NULL) {
+                removeFreeBlock(*block);
+                block->m_address -= hole->m_capacity;
+                block->m_capacity += hole->m_capacity;
+                insertFreeBlock(*block);
+                delete hole;
+            } else {
+                hole->m_address = previous->m_address + previous->m_capacity;
+                link(*hole, previous, NULL);
+                insertFreeBlock(*hole);
+            }
+            
+            m_bytesMoved += length;
+            return length;
+        }
+        
+#ifdef _DEBUG_VBO
+        void VboAllocator::checkBlocks() {
+            size_t address = 0;
+            size_t freeCapacity = 0;
+            size_t freeBlockCount = 0;
+            Block* previous = NULL;
+            Block* block = m_first;
+            while (block != NULL) {
+                assert(block->m_previous == previous);
+                assert(block->m_address == address);
+                assert(!block->free() || previous == NULL || !previous->free());
+                if (block->free()) {
+                    assert(m_freeBlocksByAddress.count(block) == 1);
+                    freeCapacity += block->m_capacity;
+                    freeBlockCount++;
+                }
+                address += block->m_capacity;
+                previous = block;
+                block = block->m_next;
+            }
+            assert(previous == m_last);
+            assert(address == m_totalCapacity);
+            assert(freeCapacity == m_freeCapacity);
+            assert(freeBlockCount == m_freeBlocksByAddress.size());
+            assert(freeBlockCount == m_freeBlocksByCapacity.size());
+        }
+#endif
+
+        VboAllocator::VboAllocator(Delegate& delegate, size_t capacity) :
+        m_delegate(delegate),
+        m_totalCapacity(capacity),
+        m_freeCapacity(capacity),
+        m_first(NULL),
+        m_last(NULL),
+        m_allocations(0),
+        m_frees(0),
+        m_bytesMoved(0) {
+            Block* block = m_delegate.createBlock(0, m_totalCapacity);
+            link(*block, NULL, NULL);
+            insertFreeBlock(*block);
+        }
+        
+        VboAllocator::~VboAllocator() {
+            deleteBlocks();
+        }
+        
+        VboAllocator::Block* VboAllocator::allocate(size_t capacity) {
+            assert(capacity > 0);
+            
+            Block* block = findFreeBlock(capacity);
+            if (block == NULL) {
+                if (capacity > m_freeCapacity)
+                    return NULL;
+                // compacting merges the first hole into the next free block, so eventually the request will fit
+                while (block == NULL && compactStep() > 0)
+                    block = findFreeBlock(capacity);
+                assert(block != NULL);
+            }
+            
+            removeFreeBlock(*block);
+            if (capacity < block->m_capacity) {
+                Block* remainder = m_delegate.createBlock(block->m_address + capacity, block->m_capacity - capacity);
+                link(*remainder, block, block->m_next);
+                block->m_capacity = capacity;
+                insertFreeBlock(*remainder);
+            }
+            
+            block->m_free = false;
+            m_freeCapacity -= capacity;
+            m_allocations++;
+
+#ifdef _DEBUG_VBO
+            checkBlocks();
+#endif
+            return block;
+        }
+        
+        VboAllocator::Block* VboAllocator::free(Block& block) {
+            assert(!block.free());
+            
+            block.m_free = true;
+            m_freeCapacity += block.m_capacity;
+            m_frees++;
+            
+            Block* result = &block;
+            Block* next = block.m_next;
+            if (next != NULL && next->free()) {
+                removeFreeBlock(*next);
+                block.m_capacity += next->m_capacity;
+                unlink(*next);
+                delete next;
+            }
+            
+            Block* previous = block.m_previous;
+            if (previous != NULL && previous->free()) {
+                removeFreeBlock(*previous);
+                previous->m_capacity += block.m_capacity;
+                unlink(block);
+                delete &block;
+                result = previous;
+            }
+            
+            insertFreeBlock(*result);
+
+#ifdef _DEBUG_VBO
+            checkBlocks();
+#endif
+            return result;
+        }
+        
+        void VboAllocator::freeAll() {
+            deleteBlocks();
+            Block* block = m_delegate.createBlock(0, m_totalCapacity);
+            link(*block, NULL, NULL);
+            insertFreeBlock(*block);
+            m_freeCapacity = m_totalCapacity;
+        }
+        
+        void VboAllocator::grow(size_t newCapacity) {
+            assert(newCapacity > m_totalCapacity);
+            
+            const size_t addedCapacity = newCapacity - m_totalCapacity;
+            if (m_last->free()) {
+                removeFreeBlock(*m_last);
+                m_last->m_capacity += addedCapacity;
+                insertFreeBlock(*m_last);
+            } else {
+                Block* block = m_delegate.createBlock(m_totalCapacity, addedCapacity);
+                link(*block, m_last, NULL);
+                insertFreeBlock(*block);
+            }
+            
+            m_totalCapacity = newCapacity;
+            m_freeCapacity += addedCapacity;
+
+#ifdef _DEBUG_VBO
+            checkBlocks();
+#endif
+        }
+        
+        size_t VboAllocator::compact(size_t maxBytes) {
+            size_t bytesMoved = 0;
+            while (bytesMoved < maxBytes) {
+                const size_t length = compactStep();
+                if (length == 0)
+                    break;
+                bytesMoved += length;
+            }
+
+#ifdef _DEBUG_VBO
+            checkBlocks();
+#endif
+            return bytesMoved;
+        }
+        
+        VboAllocator::Stats VboAllocator::stats() const {
+            Stats stats;
+            stats.totalCapacity = m_totalCapacity;
+            stats.freeCapacity = m_freeCapacity;
+            stats.freeBlockCount = m_freeBlocksByCapacity.size();
+            if (!m_freeBlocksByCapacity.empty())
+                stats.largestFreeBlock = (*m_freeBlocksByCapacity.rbegin())->capacity();
+            stats.allocations = m_allocations;
+            stats.frees = m_frees;
+            stats.bytesMoved = m_bytesMoved;
+            return stats;
+        }
+    }
+}
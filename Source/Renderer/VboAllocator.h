@@ -0,0 +1,213 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__VboAllocator__
+#define __TrenchBroom__VboAllocator__
+
+#include <cstddef>
+#include <set>
+
+//#define _DEBUG_VBO 1
+
+namespace TrenchBroom {
+    namespace Renderer {
+        /*
+         Manages the address space of a buffer without touching the buffer itself, so it can be used (and tested)
+         without an OpenGL context. The free blocks are kept in two trees, one ordered by capacity for best fit
+         allocation and one ordered by address for compaction, so that allocating and freeing a block takes
+         logarithmic time. The delegate creates the block objects and moves the memory when compaction relocates
+         blocks. Compaction can be done incrementally by passing a budget of bytes to move.
+         */
+        class VboAllocator {
+        public:
+            class Block {
+            private:
+                size_t m_address;
+                size_t m_capacity;
+                bool m_free;
+                Block* m_previous;
+                Block* m_next;
+                friend class VboAllocator;
+            public:
+                Block(size_t address, size_t capacity) :
+                m_address(address),
+                m_capacity(capacity),
+                m_free(true),
+                m_previous(NULL),
+                m_next(NULL) {}
+                
+                virtual ~Block() {}
+                
+                inline size_t address() const {
+                    return m_address;
+                }
+                
+                inline size_t capacity() const {
+                    return m_capacity;
+                }
+                
+                inline bool free() const {
+                    return m_free;
+                }
+                
+                inline Block* previous() const {
+                    return m_previous;
+                }
+                
+                inline Block* next() const {
+                    return m_next;
+                }
+            };
+            
+            class Delegate {
+            public:
+                virtual ~Delegate() {}
+                virtual Block* createBlock(size_t address, size_t capacity) = 0;
+                virtual void moveMemory(size_t to, size_t from, size_t length) = 0;
+            };
+            
+            class Stats {
+            public:
+                size_t totalCapacity;
+                size_t freeCapacity;
+                size_t freeBlockCount;
+                size_t largestFreeBlock;
+                size_t allocations;
+                size_t frees;
+                size_t bytesMoved;
+                
+                Stats() :
+                totalCapacity(0),
+                freeCapacity(0),
+                freeBlockCount(0),
+                largestFreeBlock(0),
+                allocations(0),
+                frees(0),
+                bytesMoved(0) {}
+                
+                /*
+                 Returns the share of the free capacity which is not part of the largest free block, 0 if all free
+                 capacity is contiguous.
+                 */
+                inline float fragmentation() const {
+                    if (freeCapacity == 0)
+                        return 0.0f;
+                    return 1.0f - static_cast<float>(largestFreeBlock) / static_cast<float>(freeCapacity);
+                }
+            };
+        private:
+            class CompareCapacity {
+            public:
+                inline bool operator()(const Block* lhs, const Block* rhs) const {
+                    if (lhs->capacity() < rhs->capacity())
+                        return true;
+                    if (lhs->capacity() > rhs->capacity())
+                        return false;
+                    return lhs->address() < rhs->address();
+                }
+            };
+            
+            class CompareAddress {
+            public:
+                inline bool operator()(const Block* lhs, const Block* rhs) const {
+                    return lhs->address() < rhs->address();
+                }
+            };
+            
+            typedef std::set<Block*, CompareCapacity> FreeBlocksByCapacity;
+            typedef std::set<Block*, CompareAddress> FreeBlocksByAddress;
+            
+            Delegate& m_delegate;
+            size_t m_totalCapacity;
+            size_t m_freeCapacity;
+            Block* m_first;
+            Block* m_last;
+            FreeBlocksByCapacity m_freeBlocksByCapacity;
+            FreeBlocksByAddress m_freeBlocksByAddress;
+            
+            size_t m_allocations;
+            size_t m_frees;
+            size_t m_bytesMoved;
+            
+            Block* findFreeBlock(size_t capacity) const;
+            void insertFreeBlock(Block& block);
+            void removeFreeBlock(Block& block);
+            void link(Block& block, Block* previous, Block* next);
+            void unlink(Block& block);
+            void deleteBlocks();
+            size_t compactStep();
+#ifdef _DEBUG_VBO
+            void checkBlocks();
+#endif
+
+            // prevent copying
+            VboAllocator(const VboAllocator& other);
+            void operator= (const VboAllocator& other);
+        public:
+            VboAllocator(Delegate& delegate, size_t capacity);
+            ~VboAllocator();
+            
+            inline size_t totalCapacity() const {
+                return m_totalCapacity;
+            }
+            
+            inline size_t freeCapacity() const {
+                return m_freeCapacity;
+            }
+            
+            inline Block* first() const {
+                return m_first;
+            }
+            
+            /*
+             Returns true if a block of the given capacity can be allocated without moving any memory.
+             */
+            inline bool fits(size_t capacity) const {
+                return findFreeBlock(capacity) != NULL;
+            }
+            
+            /*
+             Returns true if the free capacity is split into several blocks or is not at the end of the buffer.
+             */
+            inline bool fragmented() const {
+                return m_freeBlocksByAddress.size() > 1 || (!m_freeBlocksByAddress.empty() && !m_last->free());
+            }
+            
+            /*
+             Returns the smallest free block that can hold the given capacity. If there is no such block, the buffer
+             is compacted until one is available. Returns NULL if the free capacity is too small, in which case the
+             buffer must be grown first.
+             */
+            Block* allocate(size_t capacity);
+            Block* free(Block& block);
+            void freeAll();
+            void grow(size_t newCapacity);
+            
+            /*
+             Moves used blocks towards the start of the buffer until the free capacity is contiguous or until at
+             least maxBytes bytes have been moved. Returns the number of bytes moved.
+             */
+            size_t compact(size_t maxBytes);
+            
+            Stats stats() const;
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__VboAllocator__) */
@@ -25,6 +25,7 @@
 #include <GL/glew.h>
 #include "Renderer/Vbo.h"
 #include "Renderer/Shader/Shader.h"
+#include "Utility/Profiler.h"
 #include "Utility/String.h"
 
 #include <cassert>
@@ -55,11 +56,13 @@ namespace TrenchBroom {
             
             inline void renderPrimitives(size_t index, size_t vertexCount) {
                 glDrawArrays(m_primType, static_cast<GLint>(index), static_cast<GLsizei>(vertexCount));
+                Utility::Profiler::profiler().countDrawCalls();
             }
 
             inline void render() {
                 setup();
                 glDrawArrays(m_primType, 0, static_cast<GLsizei>(m_vertexCount));
+                Utility::Profiler::profiler().countDrawCalls();
                 cleanup();
             }
         };
@@ -0,0 +1,61 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "Allocator.h"
+
+#include "Utility/Atomic.h"
+
+#if defined _WIN32
+#include <windows.h>
+#else
+#include <sched.h>
+#endif
+
+namespace TrenchBroom {
+    namespace Utility {
+        volatile long long AllocatorLock::ThreadCount = 0;
+
+        static volatile long long LockState = 0;
+
+        void AllocatorLock::lock() {
+            // the pools are only held for a few list operations, so waiting threads just give up their time slice
+            while (atomicCompareAndSwap(&LockState, 0, 1) != 0) {
+#if defined _WIN32
+                SwitchToThread();
+#else
+                sched_yield();
+#endif
+            }
+        }
+
+        void AllocatorLock::unlock() {
+            atomicCompareAndSwap(&LockState, 1, 0);
+        }
+
+        void AllocatorLock::beginThreadedAllocation() {
+            atomicAdd(&ThreadCount, 1);
+        }
+
+        void AllocatorLock::endThreadedAllocation() {
+            assert(ThreadCount > 0);
+            atomicAdd(&ThreadCount, -1);
+        }
+    }
+}
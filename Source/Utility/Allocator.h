@@ -20,6 +20,8 @@
 #ifndef TrenchBroom_Allocator_h
 #define TrenchBroom_Allocator_h
 
+#include "Utility/MemoryStats.h"
+
 #include <cassert>
 #include <iostream>
 #include <limits>
@@ -31,7 +33,42 @@
 
 namespace TrenchBroom {
     namespace Utility {
-        template <class T, size_t PoolSize = 64, size_t BlocksPerChunk = 256>
+        /*
+         Held while an allocator accesses its pools. The pools are shared by all documents and are normally only used
+         by the main thread, in which case no lock is taken. While a worker thread creates map objects, e.g. a map
+         loader, all allocators take a spin lock.
+         */
+        class AllocatorLock {
+        private:
+            static volatile long long ThreadCount;
+            bool m_locked;
+
+            static void lock();
+            static void unlock();
+        public:
+            /*
+             Must be called on the main thread before a worker thread that creates map objects is started, and again
+             after it has been joined.
+             */
+            static void beginThreadedAllocation();
+            static void endThreadedAllocation();
+
+            AllocatorLock() :
+            m_locked(ThreadCount > 0) {
+                if (m_locked)
+                    lock();
+            }
+
+            ~AllocatorLock() {
+                if (m_locked)
+                    unlock();
+            }
+        };
+
+        /*
+         Pools the instances of T. Every live instance is counted in the given memory category.
+         */
+        template <class T, int Category = MemoryCategory::Untracked, size_t PoolSize = 64, size_t BlocksPerChunk = 256>
         class Allocator {
         private:
             class Chunk {
@@ -109,7 +146,7 @@ namespace TrenchBroom {
                 return chunks;
             }
 
-            static inline ChunkList emptyChunks() {
+            static inline ChunkList& emptyChunks() {
                 static ChunkList chunks;
                 return chunks;
             }
@@ -118,6 +155,10 @@ namespace TrenchBroom {
             inline void* operator new(size_t size) {
                 assert(size == sizeof(T));
 
+                if (Category != MemoryCategory::Untracked)
+                    MemoryStats::stats().add(static_cast<MemoryCategory::Type>(Category), sizeof(T));
+
+                AllocatorLock lock;
                 if (!pool().empty()) {
                     T* t = pool().top();
                     pool().pop();
@@ -150,6 +191,10 @@ namespace TrenchBroom {
             inline void operator delete(void* block) {
                 T* t = reinterpret_cast<T*>(block);
 
+                if (Category != MemoryCategory::Untracked)
+                    MemoryStats::stats().remove(static_cast<MemoryCategory::Type>(Category), sizeof(T));
+
+                AllocatorLock lock;
                 size_t poolSize = PoolSize;
                 if (poolSize > 0 && pool().size() < poolSize) {
                     pool().push(t);
@@ -0,0 +1,67 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_Atomic_h
+#define TrenchBroom_Atomic_h
+
+#if defined _MSC_VER
+#include <intrin.h>
+#pragma intrinsic(_InterlockedCompareExchange64)
+#endif
+
+// declares a variable with a separate instance per thread, only for plain data with a constant initializer
+#if defined _MSC_VER
+#define TB_THREAD_LOCAL __declspec(thread)
+#else
+#define TB_THREAD_LOCAL __thread
+#endif
+
+namespace TrenchBroom {
+    namespace Utility {
+        /*
+         Atomically sets the value to desired if it equals expected. Returns the value before the operation.
+         */
+        inline long long atomicCompareAndSwap(volatile long long* value, long long expected, long long desired) {
+#if defined _MSC_VER
+            return _InterlockedCompareExchange64(value, desired, expected);
+#else
+            return __sync_val_compare_and_swap(value, expected, desired);
+#endif
+        }
+
+        /*
+         Atomically adds delta to the value. Returns the new value.
+         */
+        inline long long atomicAdd(volatile long long* value, long long delta) {
+#if defined _MSC_VER
+            long long current = *value;
+            while (true) {
+                const long long previous = atomicCompareAndSwap(value, current, current + delta);
+                if (previous == current)
+                    return current + delta;
+                current = previous;
+            }
+#else
+            return __sync_add_and_fetch(value, delta);
+#endif
+        }
+    }
+}
+
+#endif
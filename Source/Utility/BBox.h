@@ -338,13 +338,13 @@ namespace TrenchBroom {
             const BBox<T> transformed(const Mat4f& transformation) const {
                 BBox<T> result;
                 result.min = result.max = transformation * vertex(false, false, false);
-                mergeWith(transformation * vertex(false, false, true ));
-                mergeWith(transformation * vertex(false, true , false));
-                mergeWith(transformation * vertex(false, true , true ));
-                mergeWith(transformation * vertex(true , false, false));
-                mergeWith(transformation * vertex(true , false, true ));
-                mergeWith(transformation * vertex(true , true , false));
-                mergeWith(transformation * vertex(true , true , true ));
+                result.mergeWith(transformation * vertex(false, false, true ));
+                result.mergeWith(transformation * vertex(false, true , false));
+                result.mergeWith(transformation * vertex(false, true , true ));
+                result.mergeWith(transformation * vertex(true , false, false));
+                result.mergeWith(transformation * vertex(true , false, true ));
+                result.mergeWith(transformation * vertex(true , true , false));
+                result.mergeWith(transformation * vertex(true , true , true ));
                 return result;
             }
             
@@ -19,77 +19,17 @@
 
 #include "Console.h"
 
-#include "IO/FileManager.h"
-
-#if defined __APPLE__
-#include "NSLog.h"
-#endif
-
 #include <cstdarg>
-#include <fstream>
-#include <wx/datetime.h>
-#include <wx/wx.h>
 
 namespace TrenchBroom {
     namespace Utility {
-        void Console::logToDebug(const LogMessage& message) {
-            // wxLogDebug(message.string().c_str());
-        }
-
-        void Console::logToConsole(const LogMessage& message) {
-            long start = m_textCtrl->GetLastPosition();
-            m_textCtrl->AppendText(message.string());
-            m_textCtrl->AppendText("\n");
-            long end = m_textCtrl->GetLastPosition();
-            switch (message.level()) {
-                case LLDebug:
-                    m_textCtrl->SetStyle(start, end, wxTextAttr(*wxLIGHT_GREY, *wxBLACK)); // SetDefaultStyle doesn't work on OS X / Cocoa
-                    break;
-                case LLInfo:
-                    m_textCtrl->SetStyle(start, end, wxTextAttr(*wxWHITE, *wxBLACK)); // SetDefaultStyle doesn't work on OS X / Cocoa
-                    break;
-                case LLWarn:
-                    m_textCtrl->SetStyle(start, end, wxTextAttr(*wxYELLOW, *wxBLACK)); // SetDefaultStyle doesn't work on OS X / Cocoa
-                    break;
-                case LLError:
-                    m_textCtrl->SetStyle(start, end, wxTextAttr(*wxRED, *wxBLACK)); // SetDefaultStyle doesn't work on OS X / Cocoa
-                    break;
-            }
-        }
-
-        void Console::logToFile(const LogMessage& message) {
-#if defined __APPLE__
-            NSLogWrapper(message.string());
-#else
-            IO::FileManager fileManager;
-            const String logDirectory = fileManager.logDirectory();
-            if (logDirectory.empty())
-                return;
-            if (!fileManager.exists(logDirectory))
-                fileManager.makeDirectory(logDirectory);
-            const String logFilePath = fileManager.appendPath(logDirectory, "TrenchBroom.log");
-            std::fstream logStream(logFilePath.c_str(), std::ios::out | std::ios::app);
-            if (logStream.is_open()) {
-                wxDateTime now = wxDateTime::Now();
-                logStream << wxGetProcessId() << " " << now.FormatISOCombined(' ') << ": " << message.string() << std::endl;
-            }
-#endif
-        }
-
-        void Console::setTextCtrl(wxTextCtrl* textCtrl) {
-            m_textCtrl = textCtrl;
-            if (m_textCtrl != NULL) {
-                for (unsigned int i = 0; i < m_buffer.size(); i++) {
-                    const LogMessage& message = m_buffer[i];
-                    logToConsole(message);
-                }
-                m_buffer.clear();
-            }
-        }
-
         void Console::log(const LogMessage& message) {
             if (message.string().empty())
                 return;
+            if (m_deferred) {
+                m_buffer.push_back(message);
+                return;
+            }
 
             logToDebug(message);
             logToFile(message);
@@ -99,6 +39,12 @@ namespace TrenchBroom {
                 m_buffer.push_back(message);
         }
 
+        void Console::forward(Console& console) {
+            for (unsigned int i = 0; i < m_buffer.size(); i++)
+                console.log(m_buffer[i]);
+            m_buffer.clear();
+        }
+
         void Console::debug(const String& message) {
             log(LogMessage(LLDebug, message));
         }
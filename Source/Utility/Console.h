@@ -22,10 +22,10 @@
 
 #include "Utility/String.h"
 
-#include <wx/textctrl.h>
-
 #include <vector>
 
+class wxTextCtrl;
+
 namespace TrenchBroom {
     namespace Utility {
         class Console {
@@ -77,16 +77,24 @@ namespace TrenchBroom {
             LogMessageList m_buffer;
             
             wxTextCtrl* m_textCtrl;
+            bool m_deferred;
             
             void logToDebug(const LogMessage& message);
             void logToConsole(const LogMessage& message);
             void logToFile(const LogMessage& message);
         public:
-            Console() : m_textCtrl(NULL) {}
+            /*
+             A deferred console only buffers its messages until they are forwarded to another console. Worker threads
+             log to a deferred console because they must not write to the log window or the log file.
+             */
+            Console(bool deferred = false) :
+            m_textCtrl(NULL),
+            m_deferred(deferred) {}
             
             void setTextCtrl(wxTextCtrl* textCtrl);
             
             void log(const LogMessage& message);
+            void forward(Console& console);
             
             void debug(const String& message);
             void debug(const char* format, ...);
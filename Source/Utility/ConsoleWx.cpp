@@ -0,0 +1,89 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Console.h"
+
+#include "IO/FileManager.h"
+
+#if defined __APPLE__
+#include "NSLog.h"
+#endif
+
+#include <fstream>
+#include <wx/datetime.h>
+#include <wx/wx.h>
+
+namespace TrenchBroom {
+    namespace Utility {
+        void Console::logToDebug(const LogMessage& message) {
+            // wxLogDebug(message.string().c_str());
+        }
+
+        void Console::logToConsole(const LogMessage& message) {
+            long start = m_textCtrl->GetLastPosition();
+            m_textCtrl->AppendText(message.string());
+            m_textCtrl->AppendText("\n");
+            long end = m_textCtrl->GetLastPosition();
+            switch (message.level()) {
+                case LLDebug:
+                    m_textCtrl->SetStyle(start, end, wxTextAttr(*wxLIGHT_GREY, *wxBLACK)); // SetDefaultStyle doesn't work on OS X / Cocoa
+                    break;
+                case LLInfo:
+                    m_textCtrl->SetStyle(start, end, wxTextAttr(*wxWHITE, *wxBLACK)); // SetDefaultStyle doesn't work on OS X / Cocoa
+                    break;
+                case LLWarn:
+                    m_textCtrl->SetStyle(start, end, wxTextAttr(*wxYELLOW, *wxBLACK)); // SetDefaultStyle doesn't work on OS X / Cocoa
+                    break;
+                case LLError:
+                    m_textCtrl->SetStyle(start, end, wxTextAttr(*wxRED, *wxBLACK)); // SetDefaultStyle doesn't work on OS X / Cocoa
+                    break;
+            }
+        }
+
+        void Console::logToFile(const LogMessage& message) {
+#if defined __APPLE__
+            NSLogWrapper(message.string());
+#else
+            IO::FileManager fileManager;
+            const String logDirectory = fileManager.logDirectory();
+            if (logDirectory.empty())
+                return;
+            if (!fileManager.exists(logDirectory))
+                fileManager.makeDirectory(logDirectory);
+            const String logFilePath = fileManager.appendPath(logDirectory, "TrenchBroom.log");
+            std::fstream logStream(logFilePath.c_str(), std::ios::out | std::ios::app);
+            if (logStream.is_open()) {
+                wxDateTime now = wxDateTime::Now();
+                logStream << wxGetProcessId() << " " << now.FormatISOCombined(' ') << ": " << message.string() << std::endl;
+            }
+#endif
+        }
+
+        void Console::setTextCtrl(wxTextCtrl* textCtrl) {
+            m_textCtrl = textCtrl;
+            if (m_textCtrl != NULL) {
+                for (unsigned int i = 0; i < m_buffer.size(); i++) {
+                    const LogMessage& message = m_buffer[i];
+                    logToConsole(message);
+                }
+                m_buffer.clear();
+            }
+        }
+    }
+}
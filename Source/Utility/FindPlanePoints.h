@@ -25,6 +25,7 @@
 
 #include <algorithm>
 #include <limits>
+#include <map>
 
 namespace TrenchBroom {
     namespace VecMath {
@@ -325,6 +326,40 @@ namespace TrenchBroom {
          */
         class FindIntegerPlanePoints : public FindPlanePoints {
         private:
+            class PlaneOrder {
+            public:
+                inline bool operator()(const Planef& lhs, const Planef& rhs) const {
+                    for (size_t i = 0; i < 3; i++) {
+                        if (lhs.normal[i] < rhs.normal[i])
+                            return true;
+                        if (lhs.normal[i] > rhs.normal[i])
+                            return false;
+                    }
+                    return lhs.distance < rhs.distance;
+                }
+            };
+
+            class CachedPlanePoints {
+            public:
+                Vec3f points[3];
+
+                CachedPlanePoints(const PlanePoints& i_points) {
+                    for (size_t i = 0; i < 3; i++)
+                        points[i] = i_points[i];
+                }
+            };
+
+            typedef std::map<Planef, CachedPlanePoints, PlaneOrder> PlanePointsCache;
+
+            static const size_t LineSearchSteps = 32;
+            static const size_t CacheCapacity = 0x4000;
+
+            /*
+             Results are memoized by the exact plane because tiled geometry contains many identical planes. The cache
+             is not synchronized, so a finder must not be used by several threads at once.
+             */
+            mutable PlanePointsCache m_cache;
+
             inline float planeFrequency(const Planef& plane) const {
                 static const float c = 1.0f - std::sin(Math<float>::Pi / 4.0f);
 
@@ -368,42 +403,105 @@ namespace TrenchBroom {
                         break;
                 }
             }
+            /*
+             Planes which contain a coordinate axis (in the swizzled coordinate system) are extrusions of a line, so
+             two of the points can be found by a short search along that line and the third point is offset along the
+             axis. This covers the very common case of walls rotated about the Z axis.
+             */
+            inline Vec3f findLinePoint(const Planef& plane, const Vec2f& origin, const Vec2f& direction) const {
+                // z changes by a constant amount per step along the line
+                const float step = -(plane.normal.x() * direction.x() + plane.normal.y() * direction.y()) / plane.normal.z();
+                float z = plane.z(origin.x(), origin.y());
+
+                size_t bestIndex = 0;
+                float bestError = std::numeric_limits<float>::max();
+                for (size_t i = 0; i < LineSearchSteps && !Math<float>::zero(bestError); i++) {
+                    const float error = std::abs(z - Math<float>::round(z));
+                    if (error < bestError) {
+                        bestIndex = i;
+                        bestError = error;
+                    }
+                    z += step;
+                }
+
+                const Vec2f position = origin + static_cast<float>(bestIndex) * direction;
+                return Vec3f(position.x(), position.y(), Math<float>::round(plane.z(position.x(), position.y())));
+            }
+
+            inline bool findDirectPlanePoints(const Planef& swizzledPlane, PlanePoints& points) const {
+                Vec2f direction;
+                Vec3f extrusion;
+                if (Math<float>::zero(swizzledPlane.normal.y())) {
+                    direction = Vec2f(1.0f, 0.0f);
+                    extrusion = Vec3f::PosY;
+                } else if (Math<float>::zero(swizzledPlane.normal.x())) {
+                    direction = Vec2f(0.0f, 1.0f);
+                    extrusion = Vec3f::PosX;
+                } else {
+                    return false;
+                }
+
+                const Vec3f anchor = swizzledPlane.anchor();
+                const Vec2f origin(Math<float>::round(anchor.x()), Math<float>::round(anchor.y()));
+                points[0] = findLinePoint(swizzledPlane, origin, direction);
+                points[1] = points[0] + 64.0f * extrusion;
+                points[2] = findLinePoint(swizzledPlane, Vec2f(points[0].x(), points[0].y()) + 64.0f * direction, direction);
+                return true;
+            }
+
+            inline void searchPlanePoints(const Planef& swizzledPlane, const float frequency, PlanePoints& points, size_t numPoints) const {
+                const float waveLength = 1.0f / frequency;
+                const float pointDistance = std::max(64.0f, waveLength);
+
+                float multiplier = 10.0f;
+                SearchCursor cursor(swizzledPlane, frequency);
+
+                if (numPoints == 0)
+                    points[0] = cursor.findMinimum(swizzledPlane.anchor());
+                else if (!points[0].isInteger())
+                    points[0] = cursor.findMinimum(points[0]);
+
+                Vec3f v1, v2;
+                float cos;
+                size_t count = 0;
+                do {
+                    if (numPoints < 2 || !points[1].isInteger())
+                        points[1] = cursor.findMinimum(points[0] + 0.33f * multiplier * pointDistance * Vec3f::PosX);
+                    points[2] = cursor.findMinimum(points[0] + multiplier * (pointDistance * Vec3f::PosY - 0.5f * pointDistance * Vec3f::PosX));
+                    v1 = points[2] - points[0];
+                    v2 = points[1] - points[0];
+                    cos = v1.normalized().dot(v2.normalized());
+                    multiplier *= 1.5f;
+                    count++;
+                } while (Math<float>::isnan(cos) || std::abs(cos) > 0.9f);
+            }
         protected:
             inline void doFindPlanePoints(const Planef& plane, PlanePoints& points, size_t numPoints) const {
                 if (numPoints == 3 && points[0].isInteger() && points[1].isInteger() && points[2].isInteger())
                     return;
 
+                // the result only depends on the plane if no initial points are given
+                if (numPoints == 0) {
+                    PlanePointsCache::const_iterator it = m_cache.find(plane);
+                    if (it != m_cache.end()) {
+                        for (size_t i = 0; i < 3; i++)
+                            points[i] = it->second.points[i];
+                        return;
+                    }
+                }
+
                 const float frequency = planeFrequency(plane);
                 if (Math<float>::zero(frequency, 1.0f / 7084.0f)) {
                     setDefaultPlanePoints(plane, points);
                 } else {
                     const CoordinatePlanef& coordPlane = CoordinatePlanef::plane(plane.normal);
                     const Planef swizzledPlane(coordPlane.swizzle(plane.normal), plane.distance);
-                    const float waveLength = 1.0f / frequency;
-                    const float pointDistance = std::max(64.0f, waveLength);
-
-                    float multiplier = 10.0f;
-                    SearchCursor cursor(swizzledPlane, frequency);
-
-                    if (numPoints == 0)
-                        points[0] = cursor.findMinimum(swizzledPlane.anchor());
-                    else if (!points[0].isInteger())
-                        points[0] = cursor.findMinimum(points[0]);
-
-                    Vec3f v1, v2;
-                    float cos;
-                    size_t count = 0;
-                    do {
-                        if (numPoints < 2 || !points[1].isInteger())
-                            points[1] = cursor.findMinimum(points[0] + 0.33f * multiplier * pointDistance * Vec3f::PosX);
-                        points[2] = cursor.findMinimum(points[0] + multiplier * (pointDistance * Vec3f::PosY - 0.5f * pointDistance * Vec3f::PosX));
-                        v1 = points[2] - points[0];
-                        v2 = points[1] - points[0];
-                        cos = v1.normalized().dot(v2.normalized());
-                        multiplier *= 1.5f;
-                        count++;
-                    } while (Math<float>::isnan(cos) || std::abs(cos) > 0.9f);
 
+                    if (numPoints > 0 || !findDirectPlanePoints(swizzledPlane, points))
+                        searchPlanePoints(swizzledPlane, frequency, points, numPoints);
+
+                    Vec3f v1 = points[2] - points[0];
+                    const Vec3f v2 = points[1] - points[0];
                     cross(v1, v2);
                     if ((v1.z() > 0.0f) != (swizzledPlane.normal.z() > 0.0f))
                         std::swap(points[0], points[2]);
@@ -411,6 +509,12 @@ namespace TrenchBroom {
                     for (unsigned int i = 0; i < 3; i++)
                         points[i] = coordPlane.unswizzle(points[i]);
                 }
+
+                if (numPoints == 0) {
+                    if (m_cache.size() >= CacheCapacity)
+                        m_cache.clear();
+                    m_cache.insert(PlanePointsCache::value_type(plane, CachedPlanePoints(points)));
+                }
             }
         };
     }
@@ -0,0 +1,138 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MemoryStats.h"
+
+#include "Utility/Atomic.h"
+
+#include <cstdio>
+
+namespace TrenchBroom {
+    namespace Utility {
+        static inline void updatePeak(volatile long long* peak, long long value) {
+            long long current = *peak;
+            while (value > current) {
+                const long long previous = atomicCompareAndSwap(peak, current, value);
+                if (previous == current)
+                    break;
+                current = previous;
+            }
+        }
+
+        static String formatBytes(size_t bytes) {
+            char buffer[32];
+            if (bytes >= 1024 * 1024)
+                std::sprintf(buffer, "%.1f MB", static_cast<double>(bytes) / (1024.0 * 1024.0));
+            else if (bytes >= 1024)
+                std::sprintf(buffer, "%.1f KB", static_cast<double>(bytes) / 1024.0);
+            else
+                std::sprintf(buffer, "%lu B", static_cast<unsigned long>(bytes));
+            return buffer;
+        }
+
+        MemoryStats::MemoryStats() :
+        m_totalBytes(0),
+        m_peakTotalBytes(0) {
+            for (size_t i = 0; i < MemoryCategory::Count; i++) {
+                m_bytes[i] = 0;
+                m_peakBytes[i] = 0;
+                m_objects[i] = 0;
+            }
+        }
+
+        MemoryStats& MemoryStats::stats() {
+            static MemoryStats instance;
+            return instance;
+        }
+
+        const char* MemoryStats::name(MemoryCategory::Type category) {
+            switch (category) {
+                case MemoryCategory::BrushGeometry:
+                    return "Brush geometry";
+                case MemoryCategory::Brushes:
+                    return "Brushes and faces";
+                case MemoryCategory::Entities:
+                    return "Entities";
+                case MemoryCategory::EntityProperties:
+                    return "Entity properties";
+                case MemoryCategory::UndoSnapshots:
+                    return "Undo snapshots";
+                case MemoryCategory::TextureBuffers:
+                    return "Texture buffers";
+                case MemoryCategory::ModelCaches:
+                    return "Model caches";
+                case MemoryCategory::VertexBuffers:
+                    return "Vertex buffers";
+                default:
+                    return "Untracked";
+            }
+        }
+
+        void MemoryStats::add(MemoryCategory::Type category, size_t bytes, size_t objects) {
+            if (category >= MemoryCategory::Count)
+                return;
+
+            const long long delta = static_cast<long long>(bytes);
+            updatePeak(&m_peakBytes[category], atomicAdd(&m_bytes[category], delta));
+            updatePeak(&m_peakTotalBytes, atomicAdd(&m_totalBytes, delta));
+            if (objects > 0)
+                atomicAdd(&m_objects[category], static_cast<long long>(objects));
+        }
+
+        void MemoryStats::remove(MemoryCategory::Type category, size_t bytes, size_t objects) {
+            if (category >= MemoryCategory::Count)
+                return;
+
+            const long long delta = static_cast<long long>(bytes);
+            atomicAdd(&m_bytes[category], -delta);
+            atomicAdd(&m_totalBytes, -delta);
+            if (objects > 0)
+                atomicAdd(&m_objects[category], -static_cast<long long>(objects));
+        }
+
+        void MemoryStats::resize(MemoryCategory::Type category, size_t oldBytes, size_t newBytes) {
+            if (newBytes > oldBytes)
+                add(category, newBytes - oldBytes, 0);
+            else if (newBytes < oldBytes)
+                remove(category, oldBytes - newBytes, 0);
+        }
+
+        void MemoryStats::resetPeaks() {
+            for (size_t i = 0; i < MemoryCategory::Count; i++)
+                m_peakBytes[i] = m_bytes[i];
+            m_peakTotalBytes = m_totalBytes;
+        }
+
+        String MemoryStats::report() const {
+            StringStream result;
+            char line[128];
+
+            std::sprintf(line, "%-20s %12s %12s %10s", "Category", "Current", "Peak", "Objects");
+            result << line;
+            for (size_t i = 0; i < MemoryCategory::Count; i++) {
+                const MemoryCategory::Type category = static_cast<MemoryCategory::Type>(i);
+                std::sprintf(line, "\n%-20s %12s %12s %10lu", name(category), formatBytes(bytes(category)).c_str(), formatBytes(peakBytes(category)).c_str(), static_cast<unsigned long>(objects(category)));
+                result << line;
+            }
+            std::sprintf(line, "\n%-20s %12s %12s", "Total", formatBytes(totalBytes()).c_str(), formatBytes(peakTotalBytes()).c_str());
+            result << line;
+            return result.str();
+        }
+    }
+}
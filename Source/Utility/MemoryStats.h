@@ -0,0 +1,102 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__MemoryStats__
+#define __TrenchBroom__MemoryStats__
+
+#include "Utility/String.h"
+
+namespace TrenchBroom {
+    namespace Utility {
+        namespace MemoryCategory {
+            typedef enum {
+                BrushGeometry,      // pooled vertices, edges and sides
+                Brushes,            // pooled brushes and faces, including the face copies kept by undo snapshots
+                Entities,           // pooled entities
+                EntityProperties,   // property keys and values
+                UndoSnapshots,      // entity, brush and face snapshots
+                TextureBuffers,     // decoded texture images waiting to be uploaded
+                ModelCaches,        // loaded alias and bsp models
+                VertexBuffers,      // VBO storage and the copies made while resizing a VBO
+                Count,
+                Untracked = Count
+            } Type;
+        }
+
+        /*
+         Counts the bytes and objects that the subsystems keep in their larger data structures, per category, along
+         with the highest byte count each category has reached. The subsystems update the counters themselves; the
+         pooled model objects are counted by their allocator. Textures and models are loaded on background threads,
+         so the counters are updated atomically.
+         */
+        class MemoryStats {
+        private:
+            volatile long long m_bytes[MemoryCategory::Count];
+            volatile long long m_peakBytes[MemoryCategory::Count];
+            volatile long long m_objects[MemoryCategory::Count];
+            volatile long long m_totalBytes;
+            volatile long long m_peakTotalBytes;
+
+            MemoryStats();
+        public:
+            static MemoryStats& stats();
+            static const char* name(MemoryCategory::Type category);
+
+            void add(MemoryCategory::Type category, size_t bytes, size_t objects = 1);
+            void remove(MemoryCategory::Type category, size_t bytes, size_t objects = 1);
+
+            /*
+             Adds the difference between the given old and new sizes without changing the object count.
+             */
+            void resize(MemoryCategory::Type category, size_t oldBytes, size_t newBytes);
+
+            inline size_t bytes(MemoryCategory::Type category) const {
+                return m_bytes[category] > 0 ? static_cast<size_t>(m_bytes[category]) : 0;
+            }
+
+            inline size_t peakBytes(MemoryCategory::Type category) const {
+                return static_cast<size_t>(m_peakBytes[category]);
+            }
+
+            inline size_t objects(MemoryCategory::Type category) const {
+                return m_objects[category] > 0 ? static_cast<size_t>(m_objects[category]) : 0;
+            }
+
+            inline size_t totalBytes() const {
+                return m_totalBytes > 0 ? static_cast<size_t>(m_totalBytes) : 0;
+            }
+
+            inline size_t peakTotalBytes() const {
+                return static_cast<size_t>(m_peakTotalBytes);
+            }
+
+            /*
+             Sets the high-water marks to the current values, e.g. before running a benchmark.
+             */
+            void resetPeaks();
+
+            /*
+             Returns a table with one line per category and a line for the total.
+             */
+            String report() const;
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__MemoryStats__) */
@@ -44,6 +44,7 @@ namespace TrenchBroom {
         const Preference<float> RendererBrightness = Preference<float>(                         "Renderer/Brightness",                                          1.0f);
         const Preference<float> GridAlpha = Preference<float>(                                  "Renderer/Grid Alpha",                                          0.25f);
         const Preference<bool>  GridCheckerboard = Preference<bool>(                            "Renderer/Grid Checkerboard",                                   false);
+        const Preference<bool>  RendererOcclusionCulling = Preference<bool>(                    "Renderer/Occlusion culling",                                   true);
 
         const Preference<Color> EntityRotationDecoratorFillColor = Preference<Color>(           "Renderer/Colors/Decorators/Entity rotation fill color",        Color(1.0f,  0.0f,  0.0f,  0.3f ));
         const Preference<Color> EntityRotationDecoratorOutlineColor = Preference<Color>(        "Renderer/Colors/Decorators/Entity rotation outline color",     Color(1.0f,  1.0f,  1.0f,  0.7f ));
@@ -158,6 +159,7 @@ namespace TrenchBroom {
         const int               RendererInstancingModeAutodetect    = 0;
         const int               RendererInstancingModeForceOn       = 1;
         const int               RendererInstancingModeForceOff      = 2;
+        const Preference<int>   ProfilerTraceDuration = Preference<int>(                        "Profiler/Trace duration",                                      10);
 
         const Preference<KeyboardShortcut>  CameraMoveForward = Preference<KeyboardShortcut>(   "Controls/Camera/Move Forward",     KeyboardShortcut(View::CommandIds::Menu::ViewMoveCameraForward, 'W', KeyboardShortcut::SCAny, "Move Camera Forward"));
         const Preference<KeyboardShortcut>  CameraMoveBackward = Preference<KeyboardShortcut>(  "Controls/Camera/Move Backward",    KeyboardShortcut(View::CommandIds::Menu::ViewMoveCameraForward, 'S', KeyboardShortcut::SCAny, "Move Camera Backward"));
@@ -419,6 +421,10 @@ namespace TrenchBroom {
             editMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditNavigateUp, WXK_ESCAPE, KeyboardShortcut::SCAny, "Navigate Up"));
 #endif
             editMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditShowMapProperties, KeyboardShortcut::SCAny, "Map Properties..."));
+            editMenu->addSeparator();
+            editMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditValidateMap, KeyboardShortcut::SCAny, "Validate Map"));
+            editMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditSelectNextIssue, KeyboardShortcut::SCAny, "Select Next Issue"));
+            editMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::EditRepairIssues, KeyboardShortcut::SCAny, "Repair Issues"));
 
             Menu* viewMenu = new Menu("View");
             menus[ViewMenu] = Menu::Ptr(viewMenu);
@@ -447,6 +453,10 @@ namespace TrenchBroom {
             viewMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::ViewSwitchToEntityTab, '1', KeyboardShortcut::SCAny, "Switch to Entity Inspector"));
             viewMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::ViewSwitchToFaceTab, '2', KeyboardShortcut::SCAny, "Switch to Face Inspector"));
             viewMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::ViewSwitchToViewTab, '3', KeyboardShortcut::SCAny, "Switch to View Inspector"));
+            viewMenu->addSeparator();
+            viewMenu->addCheckItem(KeyboardShortcut(View::CommandIds::Menu::ViewToggleShowProfiler, KeyboardShortcut::SCAny, "Show Profiler"));
+            viewMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::ViewSaveProfilerTrace, KeyboardShortcut::SCAny, "Save Profiler Trace..."));
+            viewMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::ViewPrintMemoryUsage, KeyboardShortcut::SCAny, "Print Memory Usage"));
             return menus;
         }
 
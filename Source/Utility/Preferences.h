@@ -261,6 +261,7 @@ namespace TrenchBroom {
         extern const Preference<float>  RendererBrightness;
         extern const Preference<float>  GridAlpha;
         extern const Preference<bool>   GridCheckerboard;
+        extern const Preference<bool>   RendererOcclusionCulling;
 
         extern const Preference<Color>  EntityRotationDecoratorFillColor;
         extern const Preference<Color>  EntityRotationDecoratorOutlineColor;
@@ -363,6 +364,7 @@ namespace TrenchBroom {
         extern const int                RendererInstancingModeAutodetect;
         extern const int                RendererInstancingModeForceOn;
         extern const int                RendererInstancingModeForceOff;
+        extern const Preference<int>    ProfilerTraceDuration;
 
         extern const Preference<KeyboardShortcut>   CameraMoveForward;
         extern const Preference<KeyboardShortcut>   CameraMoveBackward;
@@ -0,0 +1,218 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Profiler.h"
+
+#include "Utility/Atomic.h"
+
+#include <wx/stopwatch.h>
+#include <wx/thread.h>
+
+#include <fstream>
+
+namespace TrenchBroom {
+    namespace Utility {
+        class ThreadProfile {
+        public:
+            static const size_t Capacity = 0x10000;
+
+            unsigned int index;
+            bool mainThread;
+            bool active;
+            std::vector<Profiler::Zone> zones;
+            size_t count;
+
+            ThreadProfile(unsigned int i_index, bool i_mainThread) :
+            index(i_index),
+            mainThread(i_mainThread),
+            active(true),
+            zones(Capacity),
+            count(0) {}
+
+            inline void add(const Profiler::Zone& zone) {
+                zones[count % Capacity] = zone;
+                ++count;
+            }
+        };
+
+        // each thread only ever writes into its own profile, so recording a zone needs no locking
+        static TB_THREAD_LOCAL ThreadProfile* CurrentThreadProfile = NULL;
+
+        Profiler::Profiler() :
+        m_stopWatch(new wxStopWatch()),
+        m_mutex(new wxMutex()),
+        m_enabled(true),
+        m_drawCalls(0),
+        m_lastDrawCalls(0),
+        m_streamedBytes(0),
+        m_lastStreamedBytes(0),
+        m_stateChanges(0),
+        m_lastStateChanges(0),
+        m_skippedStateChanges(0),
+        m_lastSkippedStateChanges(0),
+        m_frameCount(0) {
+            m_frameTimes.reserve(FrameHistorySize);
+        }
+
+        Profiler::~Profiler() {
+            ThreadProfileList::iterator it, end;
+            for (it = m_threadProfiles.begin(), end = m_threadProfiles.end(); it != end; ++it)
+                delete *it;
+            m_threadProfiles.clear();
+            m_freeThreadProfiles.clear();
+            delete m_mutex;
+            m_mutex = NULL;
+            delete m_stopWatch;
+            m_stopWatch = NULL;
+        }
+
+        ThreadProfile& Profiler::threadProfile() {
+            if (CurrentThreadProfile == NULL) {
+                wxMutexLocker lock(*m_mutex);
+                if (!m_freeThreadProfiles.empty()) {
+                    CurrentThreadProfile = m_freeThreadProfiles.back();
+                    CurrentThreadProfile->mainThread = wxThread::IsMain();
+                    CurrentThreadProfile->active = true;
+                    m_freeThreadProfiles.pop_back();
+                } else {
+                    CurrentThreadProfile = new ThreadProfile(static_cast<unsigned int>(m_threadProfiles.size()), wxThread::IsMain());
+                    m_threadProfiles.push_back(CurrentThreadProfile);
+                }
+            }
+            return *CurrentThreadProfile;
+        }
+
+        void Profiler::threadFinished() {
+            if (CurrentThreadProfile == NULL)
+                return;
+
+            wxMutexLocker lock(*m_mutex);
+            CurrentThreadProfile->active = false;
+            m_freeThreadProfiles.push_back(CurrentThreadProfile);
+            CurrentThreadProfile = NULL;
+        }
+
+        size_t Profiler::threadProfileCount() const {
+            wxMutexLocker lock(*m_mutex);
+            return m_threadProfiles.size();
+        }
+
+        Profiler& Profiler::profiler() {
+            static Profiler instance;
+            return instance;
+        }
+
+        Profiler::Time Profiler::time() const {
+            return m_stopWatch->TimeInMicro().GetValue();
+        }
+
+        void Profiler::addZone(const char* name, Time start, Time end) {
+            threadProfile().add(Zone(name, start, end));
+        }
+
+        void Profiler::frameEnded(Time frameStart) {
+            const Time frameTime = time() - frameStart;
+            if (m_frameTimes.size() < FrameHistorySize)
+                m_frameTimes.push_back(frameTime);
+            else
+                m_frameTimes[m_frameCount % FrameHistorySize] = frameTime;
+            m_frameCount++;
+
+            m_lastDrawCalls = m_drawCalls;
+            m_drawCalls = 0;
+            m_lastStreamedBytes = m_streamedBytes;
+            m_streamedBytes = 0;
+            m_lastStateChanges = m_stateChanges;
+            m_stateChanges = 0;
+            m_lastSkippedStateChanges = m_skippedStateChanges;
+            m_skippedStateChanges = 0;
+        }
+
+        Profiler::Time Profiler::lastFrameTime() const {
+            if (m_frameCount == 0)
+                return 0;
+            return m_frameTimes[(m_frameCount - 1) % FrameHistorySize];
+        }
+
+        Profiler::Time Profiler::averageFrameTime() const {
+            if (m_frameTimes.empty())
+                return 0;
+
+            Time total = 0;
+            for (size_t i = 0; i < m_frameTimes.size(); i++)
+                total += m_frameTimes[i];
+            return total / static_cast<Time>(m_frameTimes.size());
+        }
+
+        Profiler::Time Profiler::maxFrameTime() const {
+            Time result = 0;
+            for (size_t i = 0; i < m_frameTimes.size(); i++)
+                if (m_frameTimes[i] > result)
+                    result = m_frameTimes[i];
+            return result;
+        }
+
+        bool Profiler::writeChromeTrace(const String& path, unsigned int seconds) {
+            std::ofstream stream(path.c_str());
+            if (!stream.is_open())
+                return false;
+
+            const Time from = time() - static_cast<Time>(seconds) * 1000000;
+            bool first = true;
+
+            stream << "{\"traceEvents\":[";
+
+            wxMutexLocker lock(*m_mutex);
+            ThreadProfileList::const_iterator it, end;
+            for (it = m_threadProfiles.begin(), end = m_threadProfiles.end(); it != end; ++it) {
+                const ThreadProfile& profile = **it;
+
+                // the buffers of running threads are written to without locking
+                if (profile.active && &profile != CurrentThreadProfile)
+                    continue;
+
+                if (!first)
+                    stream << ",";
+                stream << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << profile.index << ",\"args\":{\"name\":\"";
+                if (profile.mainThread)
+                    stream << "Main";
+                else
+                    stream << "Thread " << profile.index;
+                stream << "\"}}";
+                first = false;
+
+                // zones are recorded when they end, so the buffer is sorted by end time
+                const size_t count = profile.count;
+                const size_t available = count < ThreadProfile::Capacity ? count : static_cast<size_t>(ThreadProfile::Capacity);
+                for (size_t i = count - available; i < count; i++) {
+                    const Zone& zone = profile.zones[i % ThreadProfile::Capacity];
+                    if (zone.end < from)
+                        continue;
+
+                    stream << ",\n{\"name\":\"" << zone.name << "\",\"cat\":\"TrenchBroom\",\"ph\":\"X\",\"pid\":1,\"tid\":" << profile.index;
+                    stream << ",\"ts\":" << zone.start << ",\"dur\":" << (zone.end - zone.start) << "}";
+                }
+            }
+
+            stream << "\n]}\n";
+            stream.close();
+            return !stream.fail();
+        }
+    }
+}
@@ -0,0 +1,169 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__Profiler__
+#define __TrenchBroom__Profiler__
+
+#include "Utility/String.h"
+
+#include <vector>
+
+class wxMutex;
+class wxStopWatch;
+
+namespace TrenchBroom {
+    namespace Utility {
+        class ThreadProfile;
+
+        /*
+         Records timed zones into a fixed size ring buffer per thread. Recording a zone costs two timer reads and a
+         store, so zones can stay in place in release builds. The zones of the last few seconds can be written to a
+         file in the Chrome trace event format (load it with chrome://tracing). Only the buffers of the calling thread
+         and of threads that have finished are written, since the others may still be written to.
+         */
+        class Profiler {
+        public:
+            typedef long long Time; // microseconds since the profiler was created
+
+            class Zone {
+            public:
+                const char* name;
+                Time start;
+                Time end;
+
+                Zone() :
+                name(NULL),
+                start(0),
+                end(0) {}
+
+                Zone(const char* i_name, Time i_start, Time i_end) :
+                name(i_name),
+                start(i_start),
+                end(i_end) {}
+            };
+        private:
+            static const size_t FrameHistorySize = 60;
+
+            typedef std::vector<ThreadProfile*> ThreadProfileList;
+            wxStopWatch* m_stopWatch;
+            wxMutex* m_mutex;
+            ThreadProfileList m_threadProfiles;
+            ThreadProfileList m_freeThreadProfiles;
+            bool m_enabled;
+
+            unsigned int m_drawCalls;
+            unsigned int m_lastDrawCalls;
+            size_t m_streamedBytes;
+            size_t m_lastStreamedBytes;
+            unsigned int m_stateChanges;
+            unsigned int m_lastStateChanges;
+            unsigned int m_skippedStateChanges;
+            unsigned int m_lastSkippedStateChanges;
+            std::vector<Time> m_frameTimes;
+            size_t m_frameCount;
+
+            Profiler();
+            ~Profiler();
+
+            ThreadProfile& threadProfile();
+        public:
+            static Profiler& profiler();
+
+            inline bool enabled() const {
+                return m_enabled;
+            }
+
+            inline void setEnabled(bool enabled) {
+                m_enabled = enabled;
+            }
+
+            Time time() const;
+            void addZone(const char* name, Time start, Time end);
+
+            /*
+             Must be called by a worker thread before it exits. Its ring buffer is handed back to a pool and reused by
+             the next thread, so the number of buffers is bounded by the number of concurrently profiled threads.
+             */
+            void threadFinished();
+            size_t threadProfileCount() const;
+
+            inline void countDrawCalls(unsigned int count = 1) {
+                m_drawCalls += count;
+            }
+
+            inline void countStreamedBytes(size_t bytes) {
+                m_streamedBytes += bytes;
+            }
+
+            inline void countStateChanges(unsigned int count = 1) {
+                m_stateChanges += count;
+            }
+
+            inline void countSkippedStateChanges(unsigned int count = 1) {
+                m_skippedStateChanges += count;
+            }
+
+            void frameEnded(Time frameStart);
+
+            inline unsigned int drawCalls() const {
+                return m_lastDrawCalls;
+            }
+
+            inline size_t streamedBytes() const {
+                return m_lastStreamedBytes;
+            }
+
+            inline unsigned int stateChanges() const {
+                return m_lastStateChanges;
+            }
+
+            inline unsigned int skippedStateChanges() const {
+                return m_lastSkippedStateChanges;
+            }
+
+            Time lastFrameTime() const;
+            Time averageFrameTime() const;
+            Time maxFrameTime() const;
+
+            bool writeChromeTrace(const String& path, unsigned int seconds);
+        };
+
+        class ProfileZone {
+        private:
+            const char* m_name;
+            Profiler::Time m_start;
+        public:
+            ProfileZone(const char* name) :
+            m_name(name),
+            m_start(Profiler::profiler().time()) {}
+
+            ~ProfileZone() {
+                Profiler& profiler = Profiler::profiler();
+                if (profiler.enabled())
+                    profiler.addZone(m_name, m_start, profiler.time());
+            }
+
+            inline Profiler::Time start() const {
+                return m_start;
+            }
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__Profiler__) */
@@ -25,6 +25,7 @@
 #include "Renderer/ApplyMatrix.h"
 #include "Renderer/AxisFigure.h"
 #include "Renderer/Camera.h"
+#include "Renderer/GLState.h"
 #include "Renderer/RenderUtils.h"
 #include "Renderer/Shader/ShaderManager.h"
 #include "Renderer/Shader/ShaderProgram.h"
@@ -51,6 +52,7 @@ namespace TrenchBroom {
         void AngleEditorCanvas::OnPaint(wxPaintEvent& event) {
             wxPaintDC(this);
 			if (SetCurrent(*m_glContext)) {
+                Renderer::GLState::state().reset();
                 Vec3f mapCamDir = m_mapCamera.direction();
                 mapCamDir[2] = 0.0f;
                 mapCamDir.normalize();
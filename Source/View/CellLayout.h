@@ -88,7 +88,7 @@ namespace TrenchBroom {
             }
 
             inline bool intersectsY(float y, float height) const {
-                return bottom() >= y || top() <= y + height;
+                return bottom() >= y && top() <= y + height;
             }
         };
 
@@ -298,6 +298,20 @@ namespace TrenchBroom {
 
             RowList m_rows;
             float m_maxWidth;
+
+            class RowEndsAbove {
+            public:
+                inline bool operator() (const Row& row, float y) const {
+                    return row.bounds().bottom() <= y;
+                }
+            };
+
+            class RowStartsBelow {
+            public:
+                inline bool operator() (float y, const Row& row) const {
+                    return y < row.bounds().top();
+                }
+            };
         public:
             inline const Row& operator[] (const size_t index) const {
                 assert(index >= 0 && index < m_rows.size());
@@ -352,15 +366,16 @@ namespace TrenchBroom {
                 }
             }
 
+            /*
+             The rows are stacked from top to bottom, so they can be found by binary search. The rows in
+             [indexOfRowAt(y), indexOfRowAfter(y + height)) are exactly those that intersect the visible rect.
+             */
             size_t indexOfRowAt(float y) const {
-                for (size_t i = 0; i < m_rows.size(); i++) {
-                    const Row& row = m_rows[i];
-                    const LayoutBounds& rowBounds = row.bounds();
-                    if (y < rowBounds.bottom())
-                        return i;
-                }
-                
-                return m_rows.size();
+                return static_cast<size_t>(std::lower_bound(m_rows.begin(), m_rows.end(), y, RowEndsAbove()) - m_rows.begin());
+            }
+
+            size_t indexOfRowAfter(float y) const {
+                return static_cast<size_t>(std::upper_bound(m_rows.begin(), m_rows.end(), y, RowStartsBelow()) - m_rows.begin());
             }
             
             bool rowAt(float y, const Row** result) const {
@@ -373,18 +388,14 @@ namespace TrenchBroom {
             }
             
             bool cellAt(float x, float y, const typename Row::Cell** result) const {
-                for (unsigned int i = 0; i < m_rows.size(); i++) {
-                    const Row& row = m_rows[i];
-                    const LayoutBounds& rowBounds = row.bounds();
-                    if (y > rowBounds.bottom())
-                        continue;
-                    else if (y < rowBounds.top())
-                        break;
-                    if (row.cellAt(x, y, result))
-                        return true;
-                }
+                const size_t index = indexOfRowAt(y);
+                if (index == m_rows.size())
+                    return false;
 
-                return false;
+                const Row& row = m_rows[index];
+                if (y < row.bounds().top())
+                    return false;
+                return row.cellAt(x, y, result);
             }
 
             bool hitTest(float x, float y) const {
@@ -724,7 +735,7 @@ namespace TrenchBroom {
             }
             
             inline float outerMargin() const {
-                return m_outerMargin();
+                return m_outerMargin;
             }
             
             inline float groupMargin() const {
@@ -736,7 +747,7 @@ namespace TrenchBroom {
             }
             
             inline float cellMargin() const {
-                return m_cellMargin();
+                return m_cellMargin;
             }
         };
     }
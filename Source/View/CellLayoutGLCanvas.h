@@ -22,6 +22,7 @@
 
 #include "GL/glew.h"
 
+#include "Renderer/GLState.h"
 #include "Renderer/RenderUtils.h"
 #include "Renderer/Transformation.h"
 #include "Renderer/Text/FontDescriptor.h"
@@ -150,6 +151,7 @@ namespace TrenchBroom {
                 */
 
                 if (SetCurrent(*m_glContext)) {
+                    Renderer::GLState::state().reset();
                     glEnable(GL_MULTISAMPLE);
 
                     glClearColor(backgroundColor.x(), backgroundColor.y(), backgroundColor.z(), backgroundColor.w());
@@ -137,13 +137,13 @@ namespace TrenchBroom {
             
             YIQSet colorSet;
             
-            const Model::EntityList& entities = document().map().entities();
+            const Model::EntityList entities = document().map().entitiesWithProperty(property());
             Model::EntityList::const_iterator entityIt, entityEnd;
             for (entityIt = entities.begin(), entityEnd = entities.end(); entityIt != entityEnd; ++entityIt) {
                 const Model::Entity& entity = **entityIt;
                 const Model::PropertyValue* value = entity.propertyForKey(property());
-                if (value != NULL)
-                    colorSet.insert(Vec3f(*value));
+                assert(value != NULL);
+                colorSet.insert(Vec3f(*value));
             }
 
             m_colorHistory->setColors(Utility::makeList(colorSet));
@@ -126,6 +126,12 @@ namespace TrenchBroom {
                 static const int EditFaceActions                    = Lowest + 100;
                 static const int EditPrintFilePositions             = Lowest + 101;
                 static const int EditToggleAxisRestriction          = Lowest + 102;
+                static const int ViewToggleShowProfiler             = Lowest + 103;
+                static const int ViewSaveProfilerTrace              = Lowest + 104;
+                static const int ViewPrintMemoryUsage               = Lowest + 105;
+                static const int EditValidateMap                    = Lowest + 106;
+                static const int EditSelectNextIssue                = Lowest + 107;
+                static const int EditRepairIssues                   = Lowest + 108;
                 static const int Highest                            = Lowest + 199;
             }
             
@@ -21,16 +21,20 @@
 
 #include "Controller/Command.h"
 #include "Controller/EntityPropertyCommand.h"
+#include "Controller/LoadObjectsCommand.h"
 #include "Controller/PreferenceChangeEvent.h"
 #include "Controller/InputController.h"
 #include "Model/Brush.h"
 #include "Model/EditStateManager.h"
 #include "Model/Entity.h"
 #include "Model/MapDocument.h"
+#include "Renderer/EntityModelRendererManager.h"
+#include "Renderer/SharedResources.h"
 #include "Utility/Console.h"
 #include "Utility/List.h"
 #include "View/CommandIds.h"
 #include "View/EditorView.h"
+#include "View/EntityInspector.h"
 #include "View/Inspector.h"
 #include "View/MapGLCanvas.h"
 #include "View/NavBar.h"
@@ -209,6 +213,14 @@ namespace TrenchBroom {
                 case Controller::Command::SetEntityDefinitionFile:
                     updateNavBar();
                     break;
+                case Controller::Command::LoadObjects: {
+                    const Controller::LoadObjectsCommand& loadObjectsCommand = static_cast<const Controller::LoadObjectsCommand&>(command);
+                    if (loadObjectsCommand.finished()) {
+                        updateMenuBar();
+                        updateNavBar();
+                    }
+                    break;
+                }
                 case Controller::Command::SetEntityPropertyKey:
                 case Controller::Command::SetEntityPropertyValue:
                 case Controller::Command::RemoveEntityProperty: {
@@ -283,6 +295,14 @@ namespace TrenchBroom {
                 m_focusMapCanvasOnIdle--;
             }
 
+            if (m_documentViewHolder.valid()) {
+                Renderer::EntityModelRendererManager& modelRendererManager = m_documentViewHolder.document().sharedResources().modelRendererManager();
+                if (modelRendererManager.collectModels()) {
+                    m_mapCanvas->Refresh();
+                    m_inspector->entityInspector().modelsLoaded();
+                }
+            }
+
             // FIXME: Workaround for a bug in Ubuntu GTK where menus are not updated
             // This will be fixed in wxWidgets 2.9.5: http://trac.wxwidgets.org/ticket/14302
             // Unfortunately right now this leads to a crash after the "Navigate Up" item is invoked.
@@ -26,10 +26,12 @@
 #include "Controller/ControllerUtils.h"
 #include "Controller/EntityPropertyCommand.h"
 #include "Controller/InputController.h"
+#include "Controller/LoadObjectsCommand.h"
 #include "Controller/MoveTexturesCommand.h"
 #include "Controller/MoveVerticesTool.h"
 #include "Controller/ObjectsCommand.h"
 #include "Controller/PreferenceChangeEvent.h"
+#include "Controller/RebindTexturesCommand.h"
 #include "Controller/RebuildBrushGeometryCommand.h"
 #include "Controller/RemoveObjectsCommand.h"
 #include "Controller/RotateTexturesCommand.h"
@@ -59,7 +61,9 @@
 #include "Utility/Console.h"
 #include "Utility/Grid.h"
 #include "Utility/List.h"
+#include "Utility/MemoryStats.h"
 #include "Utility/Preferences.h"
+#include "Utility/Profiler.h"
 #include "View/AbstractApp.h"
 #include "View/CameraAnimation.h"
 #include "View/CommandIds.h"
@@ -74,6 +78,8 @@
 
 #include <wx/clipbrd.h>
 #include <wx/dataobj.h>
+#include <wx/filedlg.h>
+#include <wx/textctrl.h>
 #include <wx/tokenzr.h>
 
 namespace TrenchBroom {
@@ -174,6 +180,9 @@ namespace TrenchBroom {
         EVT_MENU(CommandIds::Menu::EditToggleTextureLock, EditorView::OnEditToggleTextureLock)
         EVT_MENU(CommandIds::Menu::EditNavigateUp, EditorView::OnEditNavigateUp)
         EVT_MENU(CommandIds::Menu::EditShowMapProperties, EditorView::OnEditShowMapProperties)
+        EVT_MENU(CommandIds::Menu::EditValidateMap, EditorView::OnEditValidateMap)
+        EVT_MENU(CommandIds::Menu::EditSelectNextIssue, EditorView::OnEditSelectNextIssue)
+        EVT_MENU(CommandIds::Menu::EditRepairIssues, EditorView::OnEditRepairIssues)
 
         EVT_MENU(CommandIds::Menu::ViewToggleShowGrid, EditorView::OnViewToggleShowGrid)
         EVT_MENU(CommandIds::Menu::ViewToggleSnapToGrid, EditorView::OnViewToggleSnapToGrid)
@@ -194,6 +203,9 @@ namespace TrenchBroom {
         EVT_MENU(CommandIds::Menu::ViewSwitchToEntityTab, EditorView::OnViewSwitchToEntityInspector)
         EVT_MENU(CommandIds::Menu::ViewSwitchToFaceTab, EditorView::OnViewSwitchToFaceInspector)
         EVT_MENU(CommandIds::Menu::ViewSwitchToViewTab, EditorView::OnViewSwitchToViewInspector)
+        EVT_MENU(CommandIds::Menu::ViewToggleShowProfiler, EditorView::OnViewToggleShowProfiler)
+        EVT_MENU(CommandIds::Menu::ViewSaveProfilerTrace, EditorView::OnViewSaveProfilerTrace)
+        EVT_MENU(CommandIds::Menu::ViewPrintMemoryUsage, EditorView::OnViewPrintMemoryUsage)
 
         EVT_UPDATE_UI(wxID_SAVE, EditorView::OnUpdateMenuItem)
         EVT_UPDATE_UI(wxID_UNDO, EditorView::OnUpdateMenuItem)
@@ -382,6 +394,17 @@ namespace TrenchBroom {
             CommandProcessor::EndGroup(commandProcessor);
         }
 
+        void EditorView::moveCameraToMap(const Model::BrushList& worldBrushes) {
+            if (!worldBrushes.empty()) {
+                Vec3f newPosition = centerCameraOnObjectsPosition(Model::EmptyEntityList, worldBrushes);
+                for (size_t i = 0; i < 3; i++)
+                    newPosition[i] = std::max(std::min(newPosition[i], 1024.0f), -1024.0f);
+                m_camera->moveTo(newPosition);
+            } else {
+                m_camera->moveTo(Vec3f(160.0f, 160.0f, 48.0f));
+            }
+        }
+
         Vec3f EditorView::centerCameraOnObjectsPosition(const Model::EntityList& entities, const Model::BrushList& brushes) {
             Model::EntityList::const_iterator entityIt, entityEnd;
             Model::BrushList::const_iterator brushIt, brushEnd;
@@ -625,16 +648,18 @@ namespace TrenchBroom {
                 switch (command->type()) {
                     case Controller::Command::LoadMap: {
                         m_camera->setDirection(Vec3f(-1.0f, -1.0f, -0.65f).normalized(), Vec3f::PosZ);
-                        Model::Entity& worldspawn = mapDocument().worldspawn();
-
-                        if (!worldspawn.brushes().empty()) {
-                            Vec3f newPosition = centerCameraOnObjectsPosition(Model::EmptyEntityList, worldspawn.brushes());
-                            for (size_t i = 0; i < 3; i++)
-                                newPosition[i] = std::max(std::min(newPosition[i], 1024.0f), -1024.0f);
-                            m_camera->moveTo(newPosition);
-                        } else {
-                            m_camera->moveTo(Vec3f(160.0f, 160.0f, 48.0f));
-                        }
+                        if (mapDocument().loading())
+                            moveCameraToMap(Model::EmptyBrushList);
+                        else
+                            moveCameraToMap(mapDocument().worldspawn().brushes());
+                        break;
+                    }
+                    case Controller::Command::LoadObjects: {
+                        // center the camera on the world brushes once all of them have been loaded
+                        const Controller::LoadObjectsCommand& loadObjectsCommand = *static_cast<const Controller::LoadObjectsCommand*>(command);
+                        Model::Entity* worldspawn = mapDocument().map().worldspawn();
+                        if (loadObjectsCommand.finished() && worldspawn != NULL)
+                            moveCameraToMap(worldspawn->brushes());
                         break;
                     }
                     case Controller::Command::PreferenceChange: {
@@ -674,8 +699,8 @@ namespace TrenchBroom {
                                 mapDocument().sharedResources().modelRendererManager().clearMismatches();
                             }
                             if (entityPropertyCommand.isPropertyAffected(Model::Entity::WadKey)) {
-                                mapDocument().loadTextures();
-                                mapDocument().sharedResources().textureRendererManager().invalidate();
+                                Controller::RebindTexturesCommand rebindCommand(mapDocument().loadTextures());
+                                mapDocument().UpdateAllViews(NULL, &rebindCommand);
                             }
                         }
                         break;
@@ -1550,6 +1575,39 @@ namespace TrenchBroom {
             dialog.ShowModal();
         }
 
+        void EditorView::OnEditValidateMap(wxCommandEvent& event) {
+            mapDocument().validateMap();
+        }
+
+        void EditorView::OnEditSelectNextIssue(wxCommandEvent& event) {
+            assert(mapDocument().hasValidationIssues());
+
+            const Model::MapValidator::Issue issue = mapDocument().nextValidationIssue();
+            mapDocument().console().info(Model::MapValidator::formatIssue(issue));
+
+            Model::Brush& brush = *issue.brush;
+            Controller::ChangeEditStateCommand* command = Controller::ChangeEditStateCommand::replace(mapDocument(), brush);
+            submit(command);
+
+            Model::BrushList brushes;
+            brushes.push_back(&brush);
+            const Vec3f newPosition = centerCameraOnObjectsPosition(Model::EmptyEntityList, brushes);
+
+            CameraAnimation* animation = new CameraAnimation(*this, newPosition, camera().direction(), camera().up(), 150);
+            m_animationManager->runAnimation(animation, true);
+        }
+
+        void EditorView::OnEditRepairIssues(wxCommandEvent& event) {
+            const Model::BrushList brushes = mapDocument().repairableBrushes();
+            assert(!brushes.empty());
+
+            Controller::SnapVerticesCommand* command = Controller::SnapVerticesCommand::repair(mapDocument(), brushes);
+            submit(command);
+
+            // report what could not be repaired
+            mapDocument().validateMap();
+        }
+
         void EditorView::OnViewToggleShowGrid(wxCommandEvent& event) {
             mapDocument().grid().toggleVisible();
             mapDocument().UpdateAllViews(NULL, new Controller::Command(Controller::Command::ChangeGrid));
@@ -1717,6 +1775,62 @@ namespace TrenchBroom {
             inspector().switchToInspector(2);
         }
 
+        void EditorView::OnViewToggleShowProfiler(wxCommandEvent& event) {
+            viewOptions().setShowProfiler(!viewOptions().showProfiler());
+            OnUpdate(NULL); // will just trigger a refresh
+        }
+
+        void EditorView::OnViewSaveProfilerTrace(wxCommandEvent& event) {
+            const wxString path = wxFileSelector(wxT("Save profiler trace"), wxT(""), wxT("trace.json"), wxT("json"), wxT("*.json"), wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+            if (path.empty())
+                return;
+
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            const unsigned int seconds = static_cast<unsigned int>(prefs.getInt(Preferences::ProfilerTraceDuration));
+            if (Utility::Profiler::profiler().writeChromeTrace(path.ToStdString(), seconds))
+                console().info("Saved the last %d seconds of profiler zones to %s", seconds, path.ToStdString().c_str());
+            else
+                console().error("Could not write profiler trace to %s", path.ToStdString().c_str());
+        }
+
+        void EditorView::OnViewPrintMemoryUsage(wxCommandEvent& event) {
+            console().info(Utility::MemoryStats::stats().report());
+        }
+
+        static bool isViewCommand(int commandId) {
+            switch (commandId) {
+                case CommandIds::Menu::ViewToggleShowGrid:
+                case CommandIds::Menu::ViewToggleSnapToGrid:
+                case CommandIds::Menu::ViewSetGridSize1:
+                case CommandIds::Menu::ViewSetGridSize2:
+                case CommandIds::Menu::ViewSetGridSize4:
+                case CommandIds::Menu::ViewSetGridSize8:
+                case CommandIds::Menu::ViewSetGridSize16:
+                case CommandIds::Menu::ViewSetGridSize32:
+                case CommandIds::Menu::ViewSetGridSize64:
+                case CommandIds::Menu::ViewSetGridSize128:
+                case CommandIds::Menu::ViewSetGridSize256:
+                case CommandIds::Menu::ViewIncGridSize:
+                case CommandIds::Menu::ViewDecGridSize:
+                case CommandIds::Menu::ViewMoveCameraForward:
+                case CommandIds::Menu::ViewMoveCameraBackward:
+                case CommandIds::Menu::ViewMoveCameraLeft:
+                case CommandIds::Menu::ViewMoveCameraRight:
+                case CommandIds::Menu::ViewMoveCameraUp:
+                case CommandIds::Menu::ViewMoveCameraDown:
+                case CommandIds::Menu::ViewSwitchToEntityTab:
+                case CommandIds::Menu::ViewSwitchToFaceTab:
+                case CommandIds::Menu::ViewSwitchToViewTab:
+                case CommandIds::Menu::ViewToggleShowProfiler:
+                case CommandIds::Menu::ViewSaveProfilerTrace:
+                case CommandIds::Menu::ViewPrintMemoryUsage:
+                case CommandIds::Menu::HelpShowHelp:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
         void EditorView::OnUpdateMenuItem(wxUpdateUIEvent& event) {
             AbstractApp* app = static_cast<AbstractApp*>(wxTheApp);
             if (app->preferencesFrame() != NULL) {
@@ -1724,6 +1838,12 @@ namespace TrenchBroom {
                 return;
             }
 
+            // only navigation is possible while the map is still being loaded
+            if (mapDocument().loading() && !isViewCommand(event.GetId())) {
+                event.Enable(false);
+                return;
+            }
+
             Model::EditStateManager& editStateManager = mapDocument().editStateManager();
             wxTextCtrl* textCtrl = wxDynamicCast(GetFrame()->FindFocus(), wxTextCtrl);
             switch (event.GetId()) {
@@ -1898,6 +2018,15 @@ namespace TrenchBroom {
                 case CommandIds::Menu::EditShowMapProperties:
                     event.Enable(true);
                     break;
+                case CommandIds::Menu::EditValidateMap:
+                    event.Enable(true);
+                    break;
+                case CommandIds::Menu::EditSelectNextIssue:
+                    event.Enable(mapDocument().hasValidationIssues());
+                    break;
+                case CommandIds::Menu::EditRepairIssues:
+                    event.Enable(mapDocument().hasRepairableValidationIssues());
+                    break;
                 case CommandIds::Menu::EditCreatePointEntity:
                     event.Enable(true);
                     break;
@@ -1976,6 +2105,16 @@ namespace TrenchBroom {
                 case CommandIds::Menu::ViewSwitchToViewTab:
                     event.Enable(true);
                     break;
+                case CommandIds::Menu::ViewToggleShowProfiler:
+                    event.Enable(true);
+                    event.Check(viewOptions().showProfiler());
+                    break;
+                case CommandIds::Menu::ViewSaveProfilerTrace:
+                    event.Enable(Utility::Profiler::profiler().enabled());
+                    break;
+                case CommandIds::Menu::ViewPrintMemoryUsage:
+                    event.Enable(true);
+                    break;
             }
         }
 
@@ -89,6 +89,7 @@ namespace TrenchBroom {
             void moveVertices(Direction direction, bool snapToGrid);
             void removeObjects(const wxString& actionName);
             
+            void moveCameraToMap(const Model::BrushList& worldBrushes);
             Vec3f centerCameraOnObjectsPosition(const Model::EntityList& entities, const Model::BrushList& brushes);
         public:
             EditorView();
@@ -210,12 +211,18 @@ namespace TrenchBroom {
             void OnEditToggleTextureLock(wxCommandEvent& event);
             void OnEditNavigateUp(wxCommandEvent& event);
             void OnEditShowMapProperties(wxCommandEvent& event);
+            void OnEditValidateMap(wxCommandEvent& event);
+            void OnEditSelectNextIssue(wxCommandEvent& event);
+            void OnEditRepairIssues(wxCommandEvent& event);
             
             void OnViewToggleShowGrid(wxCommandEvent& event);
             void OnViewToggleSnapToGrid(wxCommandEvent& event);
             void OnViewSetGridSize(wxCommandEvent& event);
             void OnViewIncGridSize(wxCommandEvent& event);
             void OnViewDecGridSize(wxCommandEvent& event);
+            void OnViewToggleShowProfiler(wxCommandEvent& event);
+            void OnViewSaveProfilerTrace(wxCommandEvent& event);
+            void OnViewPrintMemoryUsage(wxCommandEvent& event);
 
             void OnViewMoveCameraForward(wxCommandEvent& event);
             void OnViewMoveCameraBackward(wxCommandEvent& event);
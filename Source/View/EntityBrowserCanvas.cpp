@@ -24,6 +24,7 @@
 #include "Renderer/ApplyMatrix.h"
 #include "Renderer/EntityModelRenderer.h"
 #include "Renderer/EntityModelRendererManager.h"
+#include "Renderer/GLState.h"
 #include "Renderer/RenderUtils.h"
 #include "Renderer/SharedResources.h"
 #include "Renderer/Vbo.h"
@@ -36,6 +37,7 @@
 #include "View/DocumentViewHolder.h"
 #include "View/EditorView.h"
 
+#include <algorithm>
 #include <map>
 
 namespace TrenchBroom {
@@ -104,6 +106,112 @@ namespace TrenchBroom {
             renderer.render(entityModelProgram);
         }
 
+        void EntityBrowserCanvas::renderEntity(Renderer::Transformation& transformation, const EntityCellData& cellData, const Vec3f& offset, float scaling) {
+            Renderer::ShaderManager& shaderManager = m_documentViewHolder.document().sharedResources().shaderManager();
+
+            Renderer::EntityModelRenderer* modelRenderer = cellData.modelRenderer;
+            if (modelRenderer == NULL) {
+                Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::EdgeShader);
+                renderEntityBounds(transformation, shader.currentShader(), *cellData.entityDefinition, cellData.bounds, offset, scaling);
+            } else {
+                Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+                Renderer::EntityModelRendererManager& modelRendererManager = m_documentViewHolder.document().sharedResources().modelRendererManager();
+
+                Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::EntityModelShader);
+                shader.setUniformVariable("ApplyTinting", false);
+                shader.setUniformVariable("Brightness", prefs.getFloat(Preferences::RendererBrightness));
+                shader.setUniformVariable("GrayScale", false);
+
+                modelRendererManager.activate();
+                renderEntityModel(transformation, shader.currentShader(), *modelRenderer, cellData.bounds, offset, scaling);
+                modelRendererManager.deactivate();
+            }
+        }
+
+        void EntityBrowserCanvas::renderThumbnail(const EntityCellData& cellData) {
+            // fit the entity into the slot, leaving a transparent border so that neighbouring slots don't bleed in
+            const Vec3f size = cellData.bounds.size();
+            const float available = static_cast<float>(ThumbnailSize - 2 * ThumbnailPadding);
+            const float scaling = available / std::max(std::max(size.y(), size.z()), 1.0f);
+            const float padding = static_cast<float>(ThumbnailPadding);
+
+            const float slotSize = static_cast<float>(ThumbnailSize);
+            const Mat4f projection = orthoMatrix(-1024.0f, 1024.0f, 0.0f, slotSize, slotSize, 0.0f);
+            const Mat4f view = viewMatrix(Vec3f::NegX, Vec3f::PosZ) * translationMatrix(Vec3f(256.0f, 0.0f, 0.0f));
+            Renderer::Transformation transformation(projection, view);
+
+            m_offscreenRenderer.setDimensions(ThumbnailSize, ThumbnailSize);
+            m_offscreenRenderer.preRender();
+
+            glViewport(0, 0, static_cast<GLsizei>(ThumbnailSize), static_cast<GLsizei>(ThumbnailSize));
+            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            renderEntity(transformation, cellData, Vec3f(0.0f, padding, padding), scaling);
+
+            const Renderer::ThumbnailAtlas::Slot slot = m_thumbnailAtlas->allocate();
+            m_offscreenRenderer.copyToTexture(m_thumbnailAtlas->pageTexture(slot.page), static_cast<GLint>(slot.x), static_cast<GLint>(slot.y));
+
+            const float pageSize = static_cast<float>(m_thumbnailAtlas->pageSize());
+            const Vec2f texCoordMin((slot.x + padding) / pageSize,
+                                    (slot.y + padding) / pageSize);
+            const Vec2f texCoordMax((slot.x + padding + size.y() * scaling) / pageSize,
+                                    (slot.y + padding + size.z() * scaling) / pageSize);
+            m_thumbnails.insert(EntityThumbnailMap::value_type(cellData.entityDefinition, EntityThumbnail(slot, texCoordMin, texCoordMax)));
+        }
+
+        void EntityBrowserCanvas::validateThumbnails(Layout& layout, float y, float height) {
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            const float brightness = prefs.getFloat(Preferences::RendererBrightness);
+            if (brightness != m_thumbnailBrightness) {
+                clearThumbnails();
+                m_thumbnailBrightness = brightness;
+            }
+
+            if (m_thumbnailAtlas == NULL)
+                m_thumbnailAtlas = new Renderer::ThumbnailAtlas(ThumbnailSize, ThumbnailPageSize);
+
+            bool rendered = false;
+            for (unsigned int i = 0; i < layout.size(); i++) {
+                const Layout::Group& group = layout[i];
+                if (group.intersectsY(y, height)) {
+                    for (unsigned int j = 0; j < group.size(); j++) {
+                        const Layout::Group::Row& row = group[j];
+                        if (row.intersectsY(y, height)) {
+                            for (unsigned int k = 0; k < row.size(); k++) {
+                                const EntityCellData& cellData = row[k].item();
+                                if (m_thumbnails.find(cellData.entityDefinition) == m_thumbnails.end()) {
+                                    if (!rendered) {
+                                        Renderer::GLState::state().enableBlend(false);
+                                        glEnable(GL_DEPTH_TEST);
+                                        rendered = true;
+                                    }
+                                    renderThumbnail(cellData);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+
+            if (rendered) {
+                m_offscreenRenderer.postRender();
+                glDisable(GL_DEPTH_TEST);
+
+                const GLint viewLeft      = static_cast<GLint>(GetClientRect().GetLeft());
+                const GLint viewTop       = static_cast<GLint>(GetClientRect().GetBottom());
+                const GLint viewRight     = static_cast<GLint>(GetClientRect().GetRight());
+                const GLint viewBottom    = static_cast<GLint>(GetClientRect().GetTop());
+                glViewport(viewLeft, viewBottom, viewRight - viewLeft, viewTop - viewBottom);
+            }
+        }
+
+        void EntityBrowserCanvas::clearThumbnails() {
+            m_thumbnails.clear();
+            if (m_thumbnailAtlas != NULL)
+                m_thumbnailAtlas->clear();
+        }
+
         void EntityBrowserCanvas::doInitLayout(Layout& layout) {
             layout.setOuterMargin(5.0f);
             layout.setGroupMargin(5.0f);
@@ -149,6 +257,7 @@ namespace TrenchBroom {
         }
 
         void EntityBrowserCanvas::doClear() {
+            clearThumbnails();
         }
 
         void EntityBrowserCanvas::doRender(Layout& layout, float y, float height) {
@@ -162,11 +271,10 @@ namespace TrenchBroom {
             Renderer::Text::FontDescriptor defaultDescriptor(prefs.getString(Preferences::RendererFontName),
                                                              static_cast<unsigned int>(prefs.getInt(Preferences::TextureBrowserFontSize)));
 
-            Renderer::EntityModelRendererManager& modelRendererManager = m_documentViewHolder.document().sharedResources().modelRendererManager();
+            validateThumbnails(layout, y, height);
 
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-            glEnable(GL_DEPTH_TEST);
+            Renderer::GLState::state().enableBlend(true);
+            Renderer::GLState::state().blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
             const float viewLeft      = static_cast<float>(GetClientRect().GetLeft());
             const float viewTop       = static_cast<float>(GetClientRect().GetBottom());
@@ -174,7 +282,7 @@ namespace TrenchBroom {
             const float viewBottom    = static_cast<float>(GetClientRect().GetTop());
 
             const Mat4f projection = orthoMatrix(-1024.0f, 1024.0f, viewLeft, viewTop, viewRight, viewBottom);
-            Renderer::Transformation transformation(projection, viewMatrix(Vec3f::NegX, Vec3f::PosZ) * translationMatrix(Vec3f(256.0f, 0.0f, 0.0f)));
+            Renderer::Transformation transformation(projection, viewMatrix(Vec3f::NegZ, Vec3f::PosY) * translationMatrix(Vec3f(0.0f, 0.0f, -1.0f)));
 
             size_t visibleGroupCount = 0;
             size_t visibleItemCount = 0;
@@ -182,6 +290,9 @@ namespace TrenchBroom {
             typedef std::map<Renderer::Text::FontDescriptor, Vec2f::List> StringMap;
             StringMap stringVertices;
 
+            typedef std::map<size_t, Vec2f::List> PageMap;
+            PageMap thumbnailVertices;
+
             for (unsigned int i = 0; i < layout.size(); i++) {
                 const Layout::Group& group = layout[i];
                 if (group.intersectsY(y, height)) {
@@ -205,6 +316,23 @@ namespace TrenchBroom {
                                 visibleItemCount++;
 
                                 const Layout::Group::Row::Cell& cell = row[k];
+                                EntityThumbnailMap::const_iterator thumbnailIt = m_thumbnails.find(cell.item().entityDefinition);
+                                assert(thumbnailIt != m_thumbnails.end());
+                                const EntityThumbnail& thumbnail = thumbnailIt->second;
+
+                                const LayoutBounds& itemBounds = cell.itemBounds();
+                                const float itemTop = height - (itemBounds.top() - y);
+                                const float itemBottom = height - (itemBounds.bottom() - y);
+                                Vec2f::List& pageVertices = thumbnailVertices[thumbnail.slot.page];
+                                pageVertices.push_back(Vec2f(itemBounds.left(), itemBottom));
+                                pageVertices.push_back(Vec2f(thumbnail.texCoordMin.x(), thumbnail.texCoordMin.y()));
+                                pageVertices.push_back(Vec2f(itemBounds.left(), itemTop));
+                                pageVertices.push_back(Vec2f(thumbnail.texCoordMin.x(), thumbnail.texCoordMax.y()));
+                                pageVertices.push_back(Vec2f(itemBounds.right(), itemTop));
+                                pageVertices.push_back(Vec2f(thumbnail.texCoordMax.x(), thumbnail.texCoordMax.y()));
+                                pageVertices.push_back(Vec2f(itemBounds.right(), itemBottom));
+                                pageVertices.push_back(Vec2f(thumbnail.texCoordMax.x(), thumbnail.texCoordMin.y()));
+
                                 const LayoutBounds titleBounds = cell.titleBounds();
                                 const Vec2f offset(titleBounds.left(), height - (titleBounds.top() - y) - titleBounds.height());
 
@@ -218,64 +346,36 @@ namespace TrenchBroom {
                 }
             }
 
-            { // render bounds
-                Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::EdgeShader);
-                for (unsigned int i = 0; i < layout.size(); i++) {
-                    const Layout::Group& group = layout[i];
-                    if (group.intersectsY(y, height)) {
-                        for (unsigned int j = 0; j < group.size(); j++) {
-                            const Layout::Group::Row& row = group[j];
-                            if (row.intersectsY(y, height)) {
-                                for (unsigned int k = 0; k < row.size(); k++) {
-                                    const Layout::Group::Row::Cell& cell = row[k];
-                                    Model::PointEntityDefinition* definition = cell.item().entityDefinition;
-                                    Renderer::EntityModelRenderer* modelRenderer = cell.item().modelRenderer;
-                                    if (modelRenderer == NULL)
-                                        renderEntityBounds(transformation,
-                                                           shader.currentShader(),
-                                                           *definition,
-                                                           cell.item().bounds, Vec3f(0.0f, cell.itemBounds().left(), height - (cell.itemBounds().bottom() - y)),
-                                                           cell.scale());
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+            if (!thumbnailVertices.empty()) { // render thumbnails, one batch per atlas page
+                // the thumbnails have been rendered onto a transparent black background, so their colors are premultiplied
+                Renderer::GLState::state().blendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
-            { // render models
-                Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::EntityModelShader);
+                Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::TextureBrowserShader);
                 shader.setUniformVariable("ApplyTinting", false);
-                shader.setUniformVariable("Brightness", prefs.getFloat(Preferences::RendererBrightness));
+                shader.setUniformVariable("Brightness", 1.0f);
                 shader.setUniformVariable("GrayScale", false);
+                shader.setUniformVariable("Texture", 0);
 
-                modelRendererManager.activate();
-                for (unsigned int i = 0; i < layout.size(); i++) {
-                    const Layout::Group& group = layout[i];
-                    if (group.intersectsY(y, height)) {
-                        for (unsigned int j = 0; j < group.size(); j++) {
-                            const Layout::Group::Row& row = group[j];
-                            if (row.intersectsY(y, height)) {
-                                for (unsigned int k = 0; k < row.size(); k++) {
-                                    const Layout::Group::Row::Cell& cell = row[k];
-                                    Renderer::EntityModelRenderer* modelRenderer = cell.item().modelRenderer;
-                                    if (modelRenderer != NULL)
-                                        renderEntityModel(transformation,
-                                                          shader.currentShader(),
-                                                          *modelRenderer,
-                                                          cell.item().bounds,
-                                                          Vec3f(0.0f, cell.itemBounds().left(), height - (cell.itemBounds().bottom() - y)),
-                                                          cell.scale());
-                                }
-                            }
-                        }
-                    }
+                PageMap::const_iterator it, end;
+                for (it = thumbnailVertices.begin(), end = thumbnailVertices.end(); it != end; ++it) {
+                    const Vec2f::List& vertices = it->second;
+
+                    unsigned int vertexCount = static_cast<unsigned int>(vertices.size() / 2);
+                    Renderer::VertexArray vertexArray(*m_vbo, GL_QUADS, vertexCount,
+                                                      Renderer::Attribute::position2f(),
+                                                      Renderer::Attribute::texCoord02f(), 0);
+
+                    Renderer::SetVboState mapVbo(*m_vbo, Renderer::Vbo::VboMapped);
+                    vertexArray.addAttributes(vertices);
+
+                    Renderer::SetVboState activateVbo(*m_vbo, Renderer::Vbo::VboActive);
+                    m_thumbnailAtlas->activatePage(it->first);
+                    vertexArray.render();
+                    m_thumbnailAtlas->deactivatePage();
                 }
-                modelRendererManager.deactivate();
-            }
 
-            glDisable(GL_DEPTH_TEST);
-            transformation = Renderer::Transformation(projection, viewMatrix(Vec3f::NegZ, Vec3f::PosY) * translationMatrix(Vec3f(0.0f, 0.0f, -1.0f)));
+                Renderer::GLState::state().blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            }
 
             if (visibleGroupCount > 0) { // render group title background
                 unsigned int vertexCount = static_cast<unsigned int>(4 * visibleGroupCount);
@@ -334,19 +434,13 @@ namespace TrenchBroom {
         wxImage* EntityBrowserCanvas::dndImage(const Layout::Group::Row::Cell& cell) {
             if (!SetCurrent(*glContext()))
                 return NULL;
+            Renderer::GLState::state().reset();
 
             const LayoutBounds& bounds = cell.itemBounds();
 
             unsigned int width = static_cast<unsigned int>(bounds.width());
             unsigned int height = static_cast<unsigned int>(bounds.height());
 
-            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
-            Renderer::EntityModelRendererManager& modelRendererManager = m_documentViewHolder.document().sharedResources().modelRendererManager();
-
-            Renderer::ShaderManager& shaderManager = m_documentViewHolder.document().sharedResources().shaderManager();
-            Renderer::ShaderProgram& boundsProgram = shaderManager.shaderProgram(Renderer::Shaders::EdgeShader);
-            Renderer::ShaderProgram& entityModelProgram = shaderManager.shaderProgram(Renderer::Shaders::EntityModelShader);
-
             m_offscreenRenderer.setDimensions(width, height);
             m_offscreenRenderer.preRender(); // Scampie's Vista machine crashes here
 
@@ -364,21 +458,7 @@ namespace TrenchBroom {
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
             glEnable(GL_DEPTH_TEST);
 
-            Renderer::EntityModelRenderer* modelRenderer = cell.item().modelRenderer;
-            if (modelRenderer == NULL) {
-                boundsProgram.activate();
-                Model::PointEntityDefinition* definition = cell.item().entityDefinition;
-                renderEntityBounds(transformation, boundsProgram, *definition, cell.item().bounds, Vec3f::Null, cell.scale());
-                boundsProgram.deactivate();
-            } else {
-                modelRendererManager.activate();
-                entityModelProgram.activate();
-                entityModelProgram.setUniformVariable("ApplyTinting", false);
-                entityModelProgram.setUniformVariable("Brightness", prefs.getFloat(Preferences::RendererBrightness));
-                renderEntityModel(transformation, entityModelProgram, *modelRenderer, cell.item().bounds, Vec3f::Null, cell.scale());
-                entityModelProgram.deactivate();
-                modelRendererManager.deactivate();
-            }
+            renderEntity(transformation, cell.item(), Vec3f::Null, cell.scale());
 
             glPixelStorei(GL_PACK_ALIGNMENT, 1);
             glPixelStorei(GL_PACK_ROW_LENGTH, 0);
@@ -400,6 +480,8 @@ namespace TrenchBroom {
         m_documentViewHolder(documentViewHolder),
         m_offscreenRenderer(m_documentViewHolder.document().sharedResources().multisample(), m_documentViewHolder.document().sharedResources().samples()),
         m_vbo(NULL),
+        m_thumbnailAtlas(NULL),
+        m_thumbnailBrightness(0.0f),
         m_group(false),
         m_hideUnused(false),
         m_sortOrder(Model::EntityDefinitionManager::Name) {
@@ -410,6 +492,8 @@ namespace TrenchBroom {
 
         EntityBrowserCanvas::~EntityBrowserCanvas() {
             clear();
+            delete m_thumbnailAtlas;
+            m_thumbnailAtlas = NULL;
             delete m_vbo;
             m_vbo = NULL;
         }
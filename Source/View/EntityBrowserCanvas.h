@@ -22,11 +22,14 @@
 
 #include "Model/EntityDefinitionManager.h"
 #include "Renderer/OffscreenRenderer.h"
+#include "Renderer/ThumbnailAtlas.h"
 #include "Renderer/Shader/Shader.h"
 #include "Utility/String.h"
 #include "Utility/VecMath.h"
 #include "View/CellLayoutGLCanvas.h"
 
+#include <map>
+
 using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
@@ -59,13 +62,40 @@ namespace TrenchBroom {
             bounds(i_bounds) {}
         };
 
+        class EntityThumbnail {
+        public:
+            Renderer::ThumbnailAtlas::Slot slot;
+            Vec2f texCoordMin;
+            Vec2f texCoordMax;
+
+            EntityThumbnail(const Renderer::ThumbnailAtlas::Slot& i_slot, const Vec2f& i_texCoordMin, const Vec2f& i_texCoordMax) :
+            slot(i_slot),
+            texCoordMin(i_texCoordMin),
+            texCoordMax(i_texCoordMax) {}
+        };
+
         class EntityBrowserCanvas : public CellLayoutGLCanvas<EntityCellData, EntityGroupData> {
         protected:
+            typedef std::map<Model::PointEntityDefinition*, EntityThumbnail> EntityThumbnailMap;
+
+            static const unsigned int ThumbnailSize = 128;
+            static const unsigned int ThumbnailPadding = 1;
+            static const unsigned int ThumbnailPageSize = 2048;
+
             DocumentViewHolder& m_documentViewHolder;
             Renderer::OffscreenRenderer m_offscreenRenderer;
             Renderer::Vbo* m_vbo;
             Quatf m_rotation;
 
+            /*
+             Every entity definition is rendered into the thumbnail atlas once, the first time its cell becomes
+             visible. The thumbnails are only discarded when the definitions, models or palette are reloaded (see
+             doClear) or the brightness changes, so scrolling and re-sorting the browser just draws textured quads.
+             */
+            Renderer::ThumbnailAtlas* m_thumbnailAtlas;
+            EntityThumbnailMap m_thumbnails;
+            float m_thumbnailBrightness;
+
             bool m_group;
             bool m_hideUnused;
             Model::EntityDefinitionManager::SortOrder m_sortOrder;
@@ -74,6 +104,10 @@ namespace TrenchBroom {
             void addEntityToLayout(Layout& layout, Model::PointEntityDefinition* definition, const Renderer::Text::FontDescriptor& font);
             void renderEntityBounds(Renderer::Transformation& transformation, Renderer::ShaderProgram& boundsProgram, const Model::PointEntityDefinition& definition, const BBoxf& rotatedBounds, const Vec3f& offset, float scaling);
             void renderEntityModel(Renderer::Transformation& transformation, Renderer::ShaderProgram& entityModelProgram, Renderer::EntityModelRenderer& renderer, const BBoxf& rotatedBounds, const Vec3f& offset, float scaling);
+            void renderEntity(Renderer::Transformation& transformation, const EntityCellData& cellData, const Vec3f& offset, float scaling);
+            void renderThumbnail(const EntityCellData& cellData);
+            void validateThumbnails(Layout& layout, float y, float height);
+            void clearThumbnails();
 
             virtual void doInitLayout(Layout& layout);
             virtual void doReloadLayout(Layout& layout);
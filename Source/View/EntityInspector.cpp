@@ -21,6 +21,7 @@
 
 #include "Controller/Command.h"
 #include "Controller/EntityPropertyCommand.h"
+#include "Controller/LoadObjectsCommand.h"
 #include "Controller/PreferenceChangeEvent.h"
 #include "Model/EditStateManager.h"
 #include "Model/MapDocument.h"
@@ -155,6 +156,15 @@ namespace TrenchBroom {
                     updateSmartEditor();
                     updateEntityBrowser();
                     break;
+                case Controller::Command::LoadObjects: {
+                    const Controller::LoadObjectsCommand& loadObjectsCommand = static_cast<const Controller::LoadObjectsCommand&>(command);
+                    if (loadObjectsCommand.finished()) {
+                        updateProperties();
+                        updateSmartEditor();
+                        updateEntityBrowser();
+                    }
+                    break;
+                }
                 case Controller::Command::SetEntityPropertyKey:
                 case Controller::Command::SetEntityPropertyValue:
                 case Controller::Command::RemoveEntityProperty: {
@@ -187,6 +197,10 @@ namespace TrenchBroom {
             updateSmartEditor();
         }
 
+        void EntityInspector::modelsLoaded() {
+            updateEntityBrowser();
+        }
+
         void EntityInspector::OnPropertyGridSize(wxSizeEvent& event) {
             m_propertyGrid->SetColSize(0, 100);
             const int newSize = m_propertyGrid->GetClientSize().x - m_propertyGrid->GetColSize(0);
@@ -71,6 +71,7 @@ namespace TrenchBroom {
             
             void update(const Controller::Command& command);
             void cameraChanged(const Renderer::Camera& camera);
+            void modelsLoaded();
 
             void OnPropertyGridSize(wxSizeEvent& event);
             void OnPropertyGridSelectCell(wxGridEvent& event);
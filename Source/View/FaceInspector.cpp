@@ -31,6 +31,7 @@
 
 #include "Controller/Command.h"
 #include "Controller/EntityPropertyCommand.h"
+#include "Controller/LoadObjectsCommand.h"
 #include "Controller/SetFaceAttributesCommand.h"
 #include "IO/FileManager.h"
 #include "Model/Brush.h"
@@ -323,6 +324,15 @@ namespace TrenchBroom {
                     updateSelectedTexture();
                     updateTextureBrowser(true);
                     break;
+                case Controller::Command::LoadObjects: {
+                    const Controller::LoadObjectsCommand& loadObjectsCommand = static_cast<const Controller::LoadObjectsCommand&>(command);
+                    if (loadObjectsCommand.finished()) {
+                        updateFaceAttributes();
+                        updateSelectedTexture();
+                        updateTextureBrowser(true);
+                    }
+                    break;
+                }
                 case Controller::Command::ChangeEditState:
                     updateFaceAttributes();
                     updateSelectedTexture();
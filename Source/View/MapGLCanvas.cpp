@@ -24,15 +24,19 @@
 #include "Model/MapDocument.h"
 #include "Renderer/ApplyMatrix.h"
 #include "Renderer/Camera.h"
+#include "Renderer/GLState.h"
 #include "Renderer/MapRenderer.h"
 #include "Renderer/OverlayRenderer.h"
+#include "Renderer/ProfilerRenderer.h"
 #include "Renderer/RenderContext.h"
 #include "Renderer/SharedResources.h"
 #include "Renderer/Vbo.h"
+#include "Renderer/Text/FontManager.h"
 #include "Renderer/VertexArray.h"
 #include "Model/Filter.h"
 #include "Utility/Console.h"
 #include "Utility/Preferences.h"
+#include "Utility/Profiler.h"
 #include "Utility/VecMath.h"
 #include "View/DocumentViewHolder.h"
 #include "View/EditorFrame.h"
@@ -140,6 +144,7 @@ namespace TrenchBroom {
         m_vbo(NULL),
         m_inputController(new Controller::InputController(documentViewHolder)),
         m_overlayRenderer(NULL),
+        m_profilerRenderer(NULL),
         m_hasFocus(false),
         m_ignoreNextClick(false) {
             SetDropTarget(new MapGLCanvasDropTarget(this, *m_inputController));
@@ -153,6 +158,8 @@ namespace TrenchBroom {
             m_inputController = NULL;
             delete m_overlayRenderer;
             m_overlayRenderer = NULL;
+            delete m_profilerRenderer;
+            m_profilerRenderer = NULL;
             delete m_vbo;
             m_vbo = NULL;
             wxDELETE(m_glContext);
@@ -198,6 +205,9 @@ namespace TrenchBroom {
             EditorView& view = m_documentViewHolder.view();
 
 			if (SetCurrent(*m_glContext)) {
+                Utility::ProfileZone paintZone("MapGLCanvas::OnPaint");
+                Renderer::GLState& glState = Renderer::GLState::state();
+                glState.reset();
                 wxPaintDC(this);
                 
                 glEnable(GL_MULTISAMPLE);
@@ -210,7 +220,8 @@ namespace TrenchBroom {
 				glDisableClientState(GL_VERTEX_ARRAY);
 				glDisableClientState(GL_COLOR_ARRAY);
 				glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-				glBindTexture(GL_TEXTURE_2D, 0);
+				glState.activeTexture(GL_TEXTURE0);
+				glState.bindTexture(0);
 				glDisable(GL_TEXTURE_2D);
 				view.camera().update(0.0f, 0.0f, GetClientSize().x, GetClientSize().y);
 
@@ -221,10 +232,12 @@ namespace TrenchBroom {
                 // render the scene
 				view.renderer().render(renderContext);
 
-                // render input controller
+                // render input controller, the tools rebuild their geometry frequently while the user drags
                 if (m_vbo == NULL)
-                    m_vbo = new Renderer::Vbo(GL_ARRAY_BUFFER, 0xFFFF);
+                    m_vbo = new Renderer::Vbo(GL_ARRAY_BUFFER, 0xFFFF, true);
+                m_vbo->beginFrame();
                 m_inputController->render(*m_vbo, renderContext);
+                m_vbo->endFrame();
 
                 // render overlays
                 if (m_overlayRenderer == NULL)
@@ -287,7 +300,16 @@ namespace TrenchBroom {
                     glEnd();
                 }
 
+                // render profiler overlay
+                if (view.viewOptions().showProfiler()) {
+                    if (m_profilerRenderer == NULL)
+                        m_profilerRenderer = new Renderer::ProfilerRenderer();
+                    Renderer::Text::FontManager& fontManager = m_documentViewHolder.document().sharedResources().fontManager();
+                    m_profilerRenderer->render(renderContext, fontManager, view.renderer().faceVbo().stats(), GetClientSize().x, GetClientSize().y);
+                }
+
 				SwapBuffers();
+                Utility::Profiler::profiler().frameEnded(paintZone.start());
 			} else {
 				view.console().error("Unable to set current OpenGL context");
 			}
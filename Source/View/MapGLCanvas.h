@@ -41,6 +41,7 @@ namespace TrenchBroom {
         class Camera;
         class MapRenderer;
         class OverlayRenderer;
+        class ProfilerRenderer;
         class Vbo;
     }
     
@@ -77,6 +78,7 @@ namespace TrenchBroom {
             Renderer::Vbo* m_vbo;
             Controller::InputController* m_inputController;
             Renderer::OverlayRenderer* m_overlayRenderer;
+            Renderer::ProfilerRenderer* m_profilerRenderer;
             
             bool m_hasFocus;
             bool m_ignoreNextClick;
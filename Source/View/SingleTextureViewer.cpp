@@ -20,6 +20,7 @@
 #include "SingleTextureViewer.h"
 
 #include "Model/Texture.h"
+#include "Renderer/GLState.h"
 #include "Renderer/SharedResources.h"
 #include "Renderer/TextureRenderer.h"
 #include "Renderer/TextureRendererManager.h"
@@ -59,6 +60,7 @@ namespace TrenchBroom {
         void SingleTextureViewer::OnPaint(wxPaintEvent& event) {
             wxPaintDC(this);
 			if (SetCurrent(*m_glContext)) {
+                Renderer::GLState::state().reset();
 				Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
 				const Color& backgroundColor = prefs.getColor(Preferences::BackgroundColor);
 				glClearColor(backgroundColor.x(), backgroundColor.y(), backgroundColor.z(), backgroundColor.w());
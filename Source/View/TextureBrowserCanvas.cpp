@@ -19,13 +19,14 @@
 
 #include "TextureBrowserCanvas.h"
 
-#include "IO/FileManager.h"
 #include "Model/MapDocument.h"
 #include "Renderer/ApplyMatrix.h"
+#include "Renderer/GLState.h"
 #include "Renderer/SharedResources.h"
 #include "Renderer/RenderUtils.h"
 #include "Renderer/TextureRenderer.h"
 #include "Renderer/TextureRendererManager.h"
+#include "Renderer/TextureThumbnailManager.h"
 #include "Renderer/Transformation.h"
 #include "Renderer/Vbo.h"
 #include "Renderer/VertexArray.h"
@@ -40,30 +41,42 @@
 #include "View/EditorView.h"
 #include "View/TextureSelectedCommand.h"
 
+#include <wx/timer.h>
+
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
 using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
     namespace View {
-        void TextureBrowserCanvas::addTextureToLayout(Layout& layout, Model::Texture* texture, const Renderer::Text::FontDescriptor& font) {
-            if ((!m_hideUnused || texture->usageCount() > 0) && (m_filterText.empty() || Utility::containsString(texture->name(), m_filterText, false))) {
-                Renderer::Text::FontManager& fontManager =  m_documentViewHolder.document().sharedResources().fontManager();
-                const float maxCellWidth = layout.maxCellWidth();
-                const Renderer::Text::FontDescriptor actualFont = fontManager.selectFontSize(font, texture->name(), maxCellWidth, 5);
-                const Vec2f actualSize = fontManager.font(actualFont)->measure(texture->name());
-
+        void TextureBrowserCanvas::addTextureToLayout(Layout& layout, Model::Texture* texture, float titleHeight) {
+            if (!m_hideUnused || texture->usageCount() > 0) {
                 Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
                 const float scaleFactor = prefs.getFloat(Preferences::TextureBrowserIconSize);
                 const unsigned int scaledTextureWidth = static_cast<unsigned int>(Math<float>::round(scaleFactor * static_cast<float>(texture->width())));
                 const unsigned int scaledTextureHeight = static_cast<unsigned int>(Math<float>::round(scaleFactor * static_cast<float>(texture->height())));
 
-                Renderer::TextureRendererManager& textureRendererManager = m_documentViewHolder.document().sharedResources().textureRendererManager();
-                Renderer::TextureRenderer& textureRenderer = textureRendererManager.renderer(texture);
-                layout.addItem(TextureCellData(texture, &textureRenderer, actualFont), scaledTextureWidth, scaledTextureHeight, actualSize.x(), font.size() + 2.0f);
+                // the title is fitted to the cell and the texture image is loaded only once the cell becomes visible
+                layout.addItem(TextureCellData(texture), scaledTextureWidth, scaledTextureHeight, layout.maxCellWidth(), titleHeight);
             }
         }
 
+        const TextureBrowserCanvas::TextureTitle& TextureBrowserCanvas::title(Model::Texture* texture) {
+            TextureTitleMap::iterator it = m_titles.find(texture);
+            if (it != m_titles.end())
+                return it->second;
+
+            Renderer::Text::FontManager& fontManager =  m_documentViewHolder.document().sharedResources().fontManager();
+            const Renderer::Text::FontDescriptor font(m_titleFontName, static_cast<unsigned int>(m_titleFontSize));
+            const Renderer::Text::FontDescriptor actualFont = fontManager.selectFontSize(font, texture->name(), m_titleMaxWidth, 5);
+            const Vec2f actualSize = fontManager.font(actualFont)->measure(texture->name());
+
+            it = m_titles.insert(TextureTitleMap::value_type(texture, TextureTitle(actualFont, actualSize.x()))).first;
+            return it->second;
+        }
+
         void TextureBrowserCanvas::doInitLayout(Layout& layout) {
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
             const float scaleFactor = prefs.getFloat(Preferences::TextureBrowserIconSize);
@@ -74,41 +87,61 @@ namespace TrenchBroom {
             layout.setCellMargin(5.0f);
             layout.setCellWidth(scaleFactor * 64.0f, scaleFactor * 64.0f);
             layout.setCellHeight(scaleFactor * 64.0f, scaleFactor * 128.0f);
+
+            const String fontName = prefs.getString(Preferences::RendererFontName);
+            const int fontSize = prefs.getInt(Preferences::TextureBrowserFontSize);
+            if (fontName != m_titleFontName || fontSize != m_titleFontSize || layout.maxCellWidth() != m_titleMaxWidth) {
+                m_titles.clear();
+                m_titleFontName = fontName;
+                m_titleFontSize = fontSize;
+                m_titleMaxWidth = layout.maxCellWidth();
+            }
         }
 
         void TextureBrowserCanvas::doReloadLayout(Layout& layout) {
-            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
             Model::TextureManager& textureManager = m_documentViewHolder.document().textureManager();
+            const Model::TextureCollectionList& collections = textureManager.collections();
+
+            if (!m_nameIndexValid) {
+                if (m_group) {
+                    Model::TextureList textures;
+                    for (size_t i = 0; i < collections.size(); i++) {
+                        const Model::TextureList collectionTextures = collections[i]->textures(m_sortOrder);
+                        textures.insert(textures.end(), collectionTextures.begin(), collectionTextures.end());
+                    }
+                    m_nameIndex.reset(textures);
+                } else {
+                    m_nameIndex.reset(textureManager.textures(m_sortOrder));
+                }
+                m_nameIndexValid = true;
+            }
 
-            String fontName = prefs.getString(Preferences::RendererFontName);
-            int fontSize = prefs.getInt(Preferences::TextureBrowserFontSize);
-
-            assert(fontSize >= 0);
-            Renderer::Text::FontDescriptor font(fontName, static_cast<unsigned int>(fontSize));
-            IO::FileManager fileManager;
+            assert(m_titleFontSize >= 0);
+            const float titleHeight = m_titleFontSize + 2.0f;
+            const Model::TextureList& textures = m_nameIndex.textures(m_filterText);
 
             if (m_group) {
-                const Model::TextureCollectionList& collections = textureManager.collections();
+                // the filtered textures are still ordered by collection
+                size_t index = 0;
                 for (size_t i = 0; i < collections.size(); i++) {
                     Model::TextureCollection* collection = collections[i];
-                    if (m_group) {
-                        String name = fileManager.pathComponents(collection->name()).back();
-                        layout.addGroup(collection, fontSize + 2.0f);
-                    }
+                    layout.addGroup(collection, titleHeight);
 
-                    Model::TextureList textures = collection->textures(m_sortOrder);
-                    for (size_t j = 0; j < textures.size(); j++)
-                        addTextureToLayout(layout, textures[j], font);
+                    while (index < textures.size() && &textures[index]->collection() == collection)
+                        addTextureToLayout(layout, textures[index++], titleHeight);
                 }
             } else {
                 layout.addGroup(NULL, 0.0f);
-                Model::TextureList textures = textureManager.textures(m_sortOrder);
                 for (size_t i = 0; i < textures.size(); i++)
-                    addTextureToLayout(layout, textures[i], font);
+                    addTextureToLayout(layout, textures[i], titleHeight);
             }
         }
 
         void TextureBrowserCanvas::doClear() {
+            m_nameIndex.reset(Model::TextureList());
+            m_nameIndexValid = false;
+            m_titles.clear();
+            m_thumbnailManager->clear();
         }
 
         void TextureBrowserCanvas::doRender(Layout& layout, float y, float height) {
@@ -122,8 +155,8 @@ namespace TrenchBroom {
             Renderer::Text::FontDescriptor defaultDescriptor(prefs.getString(Preferences::RendererFontName),
                                                              static_cast<unsigned int>(prefs.getInt(Preferences::TextureBrowserFontSize)));
 
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            Renderer::GLState::state().enableBlend(true);
+            Renderer::GLState::state().blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
             const float viewLeft      = static_cast<float>(GetClientRect().GetLeft());
             const float viewTop       = static_cast<float>(GetClientRect().GetBottom());
@@ -134,83 +167,78 @@ namespace TrenchBroom {
             const Mat4f view = viewMatrix(Vec3f::NegZ, Vec3f::PosY) * translationMatrix(Vec3f(0.0f, 0.0f, 0.1f));
             Renderer::Transformation transformation(projection, view);
 
-            size_t visibleGroupCount = 0;
-            size_t visibleItemCount = 0;
-
-            typedef std::map<Renderer::Text::FontDescriptor, Vec2f::List> StringMap;
-            StringMap stringVertices;
-
+            // only the rows that intersect the visible rect are visited, found by binary search in each group
+            GroupList visibleGroups;
+            CellList visibleCells;
             for (unsigned int i = 0; i < layout.size(); i++) {
                 const Layout::Group& group = layout[i];
                 if (group.intersectsY(y, height)) {
-                    visibleGroupCount++;
-
-                    Model::TextureCollection* collection = group.item();
-                    if (collection != NULL && !collection->name().empty()) {
-                        const LayoutBounds titleBounds = layout.titleBoundsForVisibleRect(group, y, height);
-                        const Vec2f offset(titleBounds.left() + 2.0f, height - (titleBounds.top() - y) - titleBounds.height());
-
-                        Renderer::Text::TexturedFont* font = fontManager.font(defaultDescriptor);
-                        Vec2f::List titleVertices = font->quads(collection->name(), false, offset);
-                        Vec2f::List& vertices = stringVertices[defaultDescriptor];
-                        vertices.insert(vertices.end(), titleVertices.begin(), titleVertices.end());
-                    }
-
-                    for (unsigned int j = 0; j < group.size(); j++) {
+                    visibleGroups.push_back(&group);
+                    for (size_t j = group.indexOfRowAt(y), rowEnd = group.indexOfRowAfter(y + height); j < rowEnd; j++) {
                         const Layout::Group::Row& row = group[j];
-                        if (row.intersectsY(y, height)) {
-                            for (unsigned int k = 0; k < row.size(); k++) {
-                                visibleItemCount++;
-
-                                const Layout::Group::Row::Cell& cell = row[k];
-                                const LayoutBounds titleBounds = cell.titleBounds();
-                                const Vec2f offset(titleBounds.left() + 2.0f, height - (titleBounds.top() - y) - titleBounds.height());
-
-                                Renderer::Text::TexturedFont* font = fontManager.font(cell.item().fontDescriptor);
-                                Vec2f::List titleVertices = font->quads(cell.item().texture->name(), false, offset);
-                                Vec2f::List& vertices = stringVertices[cell.item().fontDescriptor];
-                                vertices.insert(vertices.end(), titleVertices.begin(), titleVertices.end());
-                            }
-                        }
+                        for (unsigned int k = 0; k < row.size(); k++)
+                            visibleCells.push_back(&row[k]);
                     }
                 }
             }
 
-            if (visibleItemCount > 0) { // render borders
-                unsigned int vertexCount = static_cast<unsigned int>(4 * visibleItemCount);
+            typedef std::map<Renderer::Text::FontDescriptor, Vec2f::List> StringMap;
+            StringMap stringVertices;
+
+            GroupList::const_iterator groupIt, groupEnd;
+            CellList::const_iterator cellIt, cellEnd;
+            for (groupIt = visibleGroups.begin(), groupEnd = visibleGroups.end(); groupIt != groupEnd; ++groupIt) {
+                const Layout::Group& group = **groupIt;
+                Model::TextureCollection* collection = group.item();
+                if (collection != NULL && !collection->name().empty()) {
+                    const LayoutBounds titleBounds = layout.titleBoundsForVisibleRect(group, y, height);
+                    const Vec2f offset(titleBounds.left() + 2.0f, height - (titleBounds.top() - y) - titleBounds.height());
+
+                    Renderer::Text::TexturedFont* font = fontManager.font(defaultDescriptor);
+                    Vec2f::List titleVertices = font->quads(collection->name(), false, offset);
+                    Vec2f::List& vertices = stringVertices[defaultDescriptor];
+                    vertices.insert(vertices.end(), titleVertices.begin(), titleVertices.end());
+                }
+            }
+
+            for (cellIt = visibleCells.begin(), cellEnd = visibleCells.end(); cellIt != cellEnd; ++cellIt) {
+                const Layout::Group::Row::Cell& cell = **cellIt;
+                const TextureTitle& textureTitle = title(cell.item().texture);
+                const LayoutBounds titleBounds = cell.titleBounds();
+                const float titleWidth = std::min(textureTitle.width, titleBounds.width());
+                const Vec2f offset(titleBounds.midX() - titleWidth / 2.0f + 2.0f, height - (titleBounds.top() - y) - titleBounds.height());
+
+                Renderer::Text::TexturedFont* font = fontManager.font(textureTitle.fontDescriptor);
+                Vec2f::List titleVertices = font->quads(cell.item().texture->name(), false, offset);
+                Vec2f::List& vertices = stringVertices[textureTitle.fontDescriptor];
+                vertices.insert(vertices.end(), titleVertices.begin(), titleVertices.end());
+            }
+
+            if (!visibleCells.empty()) { // render borders
+                unsigned int vertexCount = static_cast<unsigned int>(4 * visibleCells.size());
                 Renderer::VertexArray vertexArray(*m_vbo, GL_QUADS, vertexCount,
                                                   Renderer::Attribute::position2f(),
                                                   Renderer::Attribute::color4f());
 
                 Renderer::SetVboState mapVbo(*m_vbo, Renderer::Vbo::VboMapped);
-                for (unsigned int i = 0; i < layout.size(); i++) {
-                    const Layout::Group& group = layout[i];
-                    if (group.intersectsY(y, height)) {
-                        for (unsigned int j = 0; j < group.size(); j++) {
-                            const Layout::Group::Row& row = group[j];
-                            if (row.intersectsY(y, height)) {
-                                for (unsigned int k = 0; k < row.size(); k++) {
-                                    const Layout::Group::Row::Cell& cell = row[k];
-
-                                    bool selected = cell.item().texture == m_selectedTexture;
-                                    bool inUse = cell.item().texture->usageCount() > 0;
-                                    bool overridden = cell.item().texture->overridden();
-
-                                    if (selected || inUse || overridden) {
-                                        const Color& color = selected ? prefs.getColor(Preferences::SelectedTextureColor) : (inUse ? prefs.getColor(Preferences::UsedTextureColor) : prefs.getColor(Preferences::OverriddenTextureColor));
-
-                                        vertexArray.addAttribute(Vec2f(cell.itemBounds().left() - 1.5f, height - (cell.itemBounds().top() - 1.5f - y)));
-                                        vertexArray.addAttribute(color);
-                                        vertexArray.addAttribute(Vec2f(cell.itemBounds().left() - 1.5f, height - (cell.itemBounds().bottom() + 1.5f - y)));
-                                        vertexArray.addAttribute(color);
-                                        vertexArray.addAttribute(Vec2f(cell.itemBounds().right() + 1.5f, height - (cell.itemBounds().bottom() + 1.5f - y)));
-                                        vertexArray.addAttribute(color);
-                                        vertexArray.addAttribute(Vec2f(cell.itemBounds().right() + 1.5f, height - (cell.itemBounds().top() - 1.5f - y)));
-                                        vertexArray.addAttribute(color);
-                                    }
-                                }
-                            }
-                        }
+                for (cellIt = visibleCells.begin(), cellEnd = visibleCells.end(); cellIt != cellEnd; ++cellIt) {
+                    const Layout::Group::Row::Cell& cell = **cellIt;
+
+                    bool selected = cell.item().texture == m_selectedTexture;
+                    bool inUse = cell.item().texture->usageCount() > 0;
+                    bool overridden = cell.item().texture->overridden();
+
+                    if (selected || inUse || overridden) {
+                        const Color& color = selected ? prefs.getColor(Preferences::SelectedTextureColor) : (inUse ? prefs.getColor(Preferences::UsedTextureColor) : prefs.getColor(Preferences::OverriddenTextureColor));
+
+                        vertexArray.addAttribute(Vec2f(cell.itemBounds().left() - 1.5f, height - (cell.itemBounds().top() - 1.5f - y)));
+                        vertexArray.addAttribute(color);
+                        vertexArray.addAttribute(Vec2f(cell.itemBounds().left() - 1.5f, height - (cell.itemBounds().bottom() + 1.5f - y)));
+                        vertexArray.addAttribute(color);
+                        vertexArray.addAttribute(Vec2f(cell.itemBounds().right() + 1.5f, height - (cell.itemBounds().bottom() + 1.5f - y)));
+                        vertexArray.addAttribute(color);
+                        vertexArray.addAttribute(Vec2f(cell.itemBounds().right() + 1.5f, height - (cell.itemBounds().top() - 1.5f - y)));
+                        vertexArray.addAttribute(color);
                     }
                 }
 
@@ -220,54 +248,55 @@ namespace TrenchBroom {
             }
 
             { // render textures
+                Renderer::TextureRendererManager& textureRendererManager = m_documentViewHolder.document().sharedResources().textureRendererManager();
+                Renderer::TextureRenderer& placeholder = textureRendererManager.renderer(NULL);
+                m_thumbnailManager->setPalette(m_documentViewHolder.document().sharedResources().palette());
+                m_thumbnailManager->setMaxSize(static_cast<unsigned int>(std::ceil(layout.maxCellWidth())),
+                                               static_cast<unsigned int>(std::ceil(layout.maxCellHeight())));
+
                 Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::TextureBrowserShader);
                 shader.setUniformVariable("ApplyTinting", false);
                 shader.setUniformVariable("Brightness", prefs.getFloat(Preferences::RendererBrightness));
-                for (unsigned int i = 0; i < layout.size(); i++) {
-                    const Layout::Group& group = layout[i];
-                    if (group.intersectsY(y, height)) {
-                        for (unsigned int j = 0; j < group.size(); j++) {
-                            const Layout::Group::Row& row = group[j];
-                            if (row.intersectsY(y, height)) {
-                                for (unsigned int k = 0; k < row.size(); k++) {
-                                    const Layout::Group::Row::Cell& cell = row[k];
-                                    shader.setUniformVariable("GrayScale", cell.item().texture->overridden());
-                                    shader.setUniformVariable("Texture", 0);
-                                    cell.item().textureRenderer->activate();
-                                    glBegin(GL_QUADS);
-                                    glTexCoord2f(0.0f, 0.0f);
-                                    glVertex2f(cell.itemBounds().left(), height - (cell.itemBounds().top() - y));
-                                    glTexCoord2f(0.0f, 1.0f);
-                                    glVertex2f(cell.itemBounds().left(), height - (cell.itemBounds().bottom() - y));
-                                    glTexCoord2f(1.0f, 1.0f);
-                                    glVertex2f(cell.itemBounds().right(), height - (cell.itemBounds().bottom() - y));
-                                    glTexCoord2f(1.0f, 0.0f);
-                                    glVertex2f(cell.itemBounds().right(), height - (cell.itemBounds().top() - y));
-                                    glEnd();
-                                    cell.item().textureRenderer->deactivate();
-                                }
-                            }
-                        }
-                    }
+                for (cellIt = visibleCells.begin(), cellEnd = visibleCells.end(); cellIt != cellEnd; ++cellIt) {
+                    const Layout::Group::Row::Cell& cell = **cellIt;
+                    Renderer::TextureRenderer* thumbnail = m_thumbnailManager->thumbnail(*cell.item().texture);
+                    Renderer::TextureRenderer& textureRenderer = thumbnail != NULL ? *thumbnail : placeholder;
+
+                    shader.setUniformVariable("GrayScale", cell.item().texture->overridden());
+                    shader.setUniformVariable("Texture", 0);
+                    textureRenderer.activate();
+                    glBegin(GL_QUADS);
+                    glTexCoord2f(0.0f, 0.0f);
+                    glVertex2f(cell.itemBounds().left(), height - (cell.itemBounds().top() - y));
+                    glTexCoord2f(0.0f, 1.0f);
+                    glVertex2f(cell.itemBounds().left(), height - (cell.itemBounds().bottom() - y));
+                    glTexCoord2f(1.0f, 1.0f);
+                    glVertex2f(cell.itemBounds().right(), height - (cell.itemBounds().bottom() - y));
+                    glTexCoord2f(1.0f, 0.0f);
+                    glVertex2f(cell.itemBounds().right(), height - (cell.itemBounds().top() - y));
+                    glEnd();
+                    textureRenderer.deactivate();
                 }
+
+                // repaint once the missing thumbnails have been generated
+                if (m_thumbnailManager->pending() && !m_thumbnailTimer->IsRunning())
+                    m_thumbnailTimer->Start(50, wxTIMER_ONE_SHOT);
             }
 
-            if (visibleGroupCount > 0) { // render group title background
-                unsigned int vertexCount = static_cast<unsigned int>(4 * visibleGroupCount);
+            if (!visibleGroups.empty()) { // render group title background
+                unsigned int vertexCount = static_cast<unsigned int>(4 * visibleGroups.size());
                 Renderer::VertexArray vertexArray(*m_vbo, GL_QUADS, vertexCount,
                                                   Renderer::Attribute::position2f());
 
                 Renderer::SetVboState mapVbo(*m_vbo, Renderer::Vbo::VboMapped);
-                for (unsigned int i = 0; i < layout.size(); i++) {
-                    const Layout::Group& group = layout[i];
-                    if (group.intersectsY(y, height)) {
-                        if (group.item() != NULL) {
-                            LayoutBounds titleBounds = layout.titleBoundsForVisibleRect(group, y, height);
-                            vertexArray.addAttribute(Vec2f(titleBounds.left(), height - (titleBounds.top() - y)));
-                            vertexArray.addAttribute(Vec2f(titleBounds.left(), height - (titleBounds.bottom() - y)));
-                            vertexArray.addAttribute(Vec2f(titleBounds.right(), height - (titleBounds.bottom() - y)));
-                            vertexArray.addAttribute(Vec2f(titleBounds.right(), height - (titleBounds.top() - y)));
-                        }
+                for (groupIt = visibleGroups.begin(), groupEnd = visibleGroups.end(); groupIt != groupEnd; ++groupIt) {
+                    const Layout::Group& group = **groupIt;
+                    if (group.item() != NULL) {
+                        LayoutBounds titleBounds = layout.titleBoundsForVisibleRect(group, y, height);
+                        vertexArray.addAttribute(Vec2f(titleBounds.left(), height - (titleBounds.top() - y)));
+                        vertexArray.addAttribute(Vec2f(titleBounds.left(), height - (titleBounds.bottom() - y)));
+                        vertexArray.addAttribute(Vec2f(titleBounds.right(), height - (titleBounds.bottom() - y)));
+                        vertexArray.addAttribute(Vec2f(titleBounds.right(), height - (titleBounds.top() - y)));
                     }
                 }
 
@@ -336,13 +365,28 @@ namespace TrenchBroom {
         m_group(false),
         m_hideUnused(false),
         m_sortOrder(Model::TextureSortOrder::Name),
-        m_vbo() {}
+        m_vbo(),
+        m_nameIndexValid(false),
+        m_titleFontSize(0),
+        m_titleMaxWidth(0.0f),
+        m_thumbnailManager(new Renderer::TextureThumbnailManager()),
+        m_thumbnailTimer(new wxTimer(this)) {
+            Bind(wxEVT_TIMER, &TextureBrowserCanvas::OnThumbnailTimer, this);
+        }
 
         TextureBrowserCanvas::~TextureBrowserCanvas() {
             clear();
             m_selectedTexture = NULL;
             delete m_vbo;
             m_vbo = NULL;
+            delete m_thumbnailTimer;
+            m_thumbnailTimer = NULL;
+            delete m_thumbnailManager;
+            m_thumbnailManager = NULL;
+        }
+
+        void TextureBrowserCanvas::OnThumbnailTimer(wxTimerEvent& event) {
+            Refresh();
         }
     }
 }
@@ -22,6 +22,12 @@
 
 #include "Model/TextureManager.h"
 #include "View/CellLayoutGLCanvas.h"
+#include "View/TextureNameIndex.h"
+
+#include <map>
+
+class wxTimer;
+class wxTimerEvent;
 
 namespace TrenchBroom {
     namespace Model {
@@ -38,6 +44,7 @@ namespace TrenchBroom {
         class Shader;
         class ShaderProgram;
         class TextureRenderer;
+        class TextureThumbnailManager;
         class Vbo;
     }
     
@@ -53,17 +60,27 @@ namespace TrenchBroom {
         class TextureCellData {
         public:
             Model::Texture* texture;
-            Renderer::TextureRenderer* textureRenderer;
-            Renderer::Text::FontDescriptor fontDescriptor;
             
-            TextureCellData(Model::Texture* i_texture, Renderer::TextureRenderer* i_textureRenderer, const Renderer::Text::FontDescriptor& i_fontDescriptor) :
-            texture(i_texture),
-            textureRenderer(i_textureRenderer),
-            fontDescriptor(i_fontDescriptor) {}
+            TextureCellData(Model::Texture* i_texture) :
+            texture(i_texture) {}
         };
         
         class TextureBrowserCanvas : public CellLayoutGLCanvas<TextureCellData, TextureGroupData> {
         protected:
+            class TextureTitle {
+            public:
+                Renderer::Text::FontDescriptor fontDescriptor;
+                float width;
+                
+                TextureTitle(const Renderer::Text::FontDescriptor& i_fontDescriptor, float i_width) :
+                fontDescriptor(i_fontDescriptor),
+                width(i_width) {}
+            };
+            
+            typedef std::map<Model::Texture*, TextureTitle> TextureTitleMap;
+            typedef std::vector<const Layout::Group*> GroupList;
+            typedef std::vector<const Layout::Group::Row::Cell*> CellList;
+
             DocumentViewHolder& m_documentViewHolder;
             Model::Texture* m_selectedTexture;
             
@@ -73,13 +90,25 @@ namespace TrenchBroom {
             String m_filterText;
             Renderer::Vbo* m_vbo;
             
-            void addTextureToLayout(Layout& layout, Model::Texture* texture, const Renderer::Text::FontDescriptor& font);
+            TextureNameIndex m_nameIndex;
+            bool m_nameIndexValid;
+            TextureTitleMap m_titles;
+            String m_titleFontName;
+            int m_titleFontSize;
+            float m_titleMaxWidth;
+            Renderer::TextureThumbnailManager* m_thumbnailManager;
+            wxTimer* m_thumbnailTimer;
+            
+            void addTextureToLayout(Layout& layout, Model::Texture* texture, float titleHeight);
+            const TextureTitle& title(Model::Texture* texture);
             virtual void doInitLayout(Layout& layout);
             virtual void doReloadLayout(Layout& layout);
             virtual void doClear();
             virtual void doRender(Layout& layout, float y, float height);
             virtual void handleLeftClick(Layout& layout, float x, float y);
             virtual wxString tooltip(const Layout::Group::Row::Cell& cell);
+            
+            void OnThumbnailTimer(wxTimerEvent& event);
         public:
             TextureBrowserCanvas(wxWindow* parent, wxWindowID windowId, wxScrollBar* scrollBar, DocumentViewHolder& documentViewHolder);
             ~TextureBrowserCanvas();
@@ -88,6 +117,7 @@ namespace TrenchBroom {
                 if (sortOrder == m_sortOrder)
                     return;
                 m_sortOrder = sortOrder;
+                m_nameIndexValid = false;
                 reload();
                 Refresh();
             }
@@ -96,6 +126,7 @@ namespace TrenchBroom {
                 if (group == m_group)
                     return;
                 m_group = group;
+                m_nameIndexValid = false;
                 reload();
                 Refresh();
             }
@@ -104,6 +135,7 @@ namespace TrenchBroom {
                 if (hideUnused == m_hideUnused)
                     return;
                 m_hideUnused = hideUnused;
+                m_nameIndexValid = false;
                 reload();
                 Refresh();
             }
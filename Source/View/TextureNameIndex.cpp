@@ -0,0 +1,59 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "TextureNameIndex.h"
+
+#include "Model/Texture.h"
+
+namespace TrenchBroom {
+    namespace View {
+        TextureNameIndex::TextureNameIndex() {
+            m_levels.push_back(Level(""));
+        }
+
+        void TextureNameIndex::reset(const Model::TextureList& textures) {
+            m_levels.clear();
+            m_levels.push_back(Level(""));
+            m_levels.back().textures = textures;
+        }
+
+        const Model::TextureList& TextureNameIndex::textures(const String& filterText) {
+            // every texture matching the filter text also matches each of its prefixes
+            while (m_levels.size() > 1 && !Utility::startsWith(filterText, m_levels.back().filterText, false))
+                m_levels.pop_back();
+
+            if (m_levels.back().filterText.size() == filterText.size())
+                return m_levels.back().textures;
+
+            m_levels.push_back(Level(filterText));
+            const Model::TextureList& candidates = m_levels[m_levels.size() - 2].textures;
+            Model::TextureList& matches = m_levels.back().textures;
+
+            Model::TextureList::const_iterator it, end;
+            for (it = candidates.begin(), end = candidates.end(); it != end; ++it) {
+                Model::Texture* texture = *it;
+                if (Utility::containsString(texture->name(), filterText, false))
+                    matches.push_back(texture);
+            }
+
+            return m_levels.back().textures;
+        }
+    }
+}
@@ -0,0 +1,59 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __TrenchBroom__TextureNameIndex__
+#define __TrenchBroom__TextureNameIndex__
+
+#include "Model/TextureTypes.h"
+#include "Utility/String.h"
+
+#include <vector>
+
+namespace TrenchBroom {
+    namespace View {
+        /*
+         Filters a list of textures by name while the user types. Every filter result is kept on a stack: when the
+         filter text grows, only the previous matches are searched again, and when it shrinks, the earlier result is
+         popped off the stack without searching at all. The order of the original list is preserved.
+         */
+        class TextureNameIndex {
+        private:
+            class Level {
+            public:
+                String filterText;
+                Model::TextureList textures;
+
+                Level(const String& i_filterText) :
+                filterText(i_filterText) {}
+            };
+
+            typedef std::vector<Level> LevelList;
+
+            LevelList m_levels;
+        public:
+            TextureNameIndex();
+
+            void reset(const Model::TextureList& textures);
+            const Model::TextureList& textures(const String& filterText);
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__TextureNameIndex__) */
@@ -55,6 +55,7 @@ namespace TrenchBroom {
             bool m_shadeFaces;
             bool m_useFog;
             LinkDisplayMode m_linkDisplayMode;
+            bool m_showProfiler;
         public:
             ViewOptions() :
             m_filterPattern(""),
@@ -73,7 +74,8 @@ namespace TrenchBroom {
             m_renderSelection(true),
             m_shadeFaces(true),
             m_useFog(false),
-            m_linkDisplayMode(LinkDisplayLocal) {}
+            m_linkDisplayMode(LinkDisplayLocal),
+            m_showProfiler(false) {}
 
             inline const String& filterPattern() const {
                 return m_filterPattern;
@@ -210,6 +212,14 @@ namespace TrenchBroom {
             inline void setLinkDisplayMode(LinkDisplayMode linkDisplayMode) {
                 m_linkDisplayMode = linkDisplayMode;
             }
+
+            inline bool showProfiler() const {
+                return m_showProfiler;
+            }
+
+            inline void setShowProfiler(bool showProfiler) {
+                m_showProfiler = showProfiler;
+            }
         };
     }
 }
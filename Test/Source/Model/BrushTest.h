@@ -0,0 +1,138 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_BrushTest_h
+#define TrenchBroom_BrushTest_h
+
+#include "TestSuite.h"
+#include "Model/Brush.h"
+#include "Model/BrushGeometry.h"
+#include "Model/Face.h"
+#include "Utility/List.h"
+#include "Utility/VecMath.h"
+
+#include <cassert>
+#include <ctime>
+#include <iostream>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class BrushTest : public TestSuite<BrushTest> {
+        private:
+            static const unsigned int BrushCount = 10000;
+
+            BBoxf m_worldBounds;
+
+            Brush* createBrush() const {
+                Brush* brush = new Brush(m_worldBounds, false, BBoxf(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(32.0f, 32.0f, 32.0f)), NULL);
+                Face* face = new Face(m_worldBounds, false, Vec3f(32.0f, 32.0f, 16.0f), Vec3f(32.0f, 16.0f, 32.0f), Vec3f(16.0f, 32.0f, 32.0f), "corner");
+                bool clipped = brush->clip(*face);
+                assert(clipped);
+                return brush;
+            }
+
+            void assertSameGeometry(const Brush& brush, const Brush& expected) const {
+                assert(brush.faces().size() == expected.faces().size());
+                assert(brush.vertices().size() == expected.vertices().size());
+                assert(brush.edges().size() == expected.edges().size());
+                assert(brush.bounds().min.equals(expected.bounds().min));
+                assert(brush.bounds().max.equals(expected.bounds().max));
+
+                // the vertices of every side must match in the same winding order
+                for (size_t i = 0; i < brush.faces().size(); i++) {
+                    const Face& face = *brush.faces()[i];
+                    const Face& expectedFace = *expected.faces()[i];
+                    assert(face.boundary().normal.equals(expectedFace.boundary().normal));
+                    assert(face.side()->hasVertices(expectedFace.side()->info().vertices));
+                }
+            }
+
+            void testTransform(const Mat4f& pointTransform, const Mat4f& vectorTransform, bool invertOrientation, bool preservesTopology) {
+                Brush* brush = createBrush();
+                Brush* expected = new Brush(m_worldBounds, false, *brush);
+                assert(brush->preservesTopology(pointTransform) == preservesTopology);
+
+                brush->transform(pointTransform, vectorTransform, false, invertOrientation);
+                expected->transform(pointTransform, vectorTransform, false, invertOrientation);
+                expected->rebuildGeometry();
+                assertSameGeometry(*brush, *expected);
+
+                delete brush;
+                delete expected;
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&BrushTest::testTranslate);
+                registerTestCase(&BrushTest::testRotate90);
+                registerTestCase(&BrushTest::testMirror);
+                registerTestCase(&BrushTest::testGeneralTransform);
+                registerTestCase(&BrushTest::benchmarkTranslate);
+            }
+
+            void setup() {
+                m_worldBounds = BBoxf(Vec3f(-16384.0f, -16384.0f, -16384.0f), Vec3f(16384.0f, 16384.0f, 16384.0f));
+            }
+        public:
+            void testTranslate() {
+                testTransform(translationMatrix(Vec3f(16.0f, -8.0f, 4.5f)), Mat4f::Identity, false, true);
+            }
+
+            void testRotate90() {
+                const Vec3f center(8.0f, 8.0f, 8.0f);
+                const Mat4f vectorTransform = rotationMatrix(Math<float>::Pi / 2.0f, Vec3f::PosZ);
+                const Mat4f pointTransform = translationMatrix(center) * vectorTransform * translationMatrix(-center);
+                testTransform(pointTransform, vectorTransform, false, true);
+            }
+
+            void testMirror() {
+                const Vec3f center(8.0f, 8.0f, 8.0f);
+                const Mat4f pointTransform = translationMatrix(center) * Mat4f::MirX * translationMatrix(-center);
+                testTransform(pointTransform, Mat4f::MirX, true, true);
+            }
+
+            void testGeneralTransform() {
+                const Mat4f vectorTransform = rotationMatrix(Math<float>::Pi / 6.0f, Vec3f::PosZ);
+                testTransform(vectorTransform, vectorTransform, false, false);
+            }
+
+            void benchmarkTranslate() {
+                BrushList brushes;
+                for (unsigned int i = 0; i < BrushCount; i++)
+                    brushes.push_back(createBrush());
+
+                const Mat4f translation = translationMatrix(Vec3f(16.0f, 16.0f, 0.0f));
+                clock_t start = clock();
+                for (unsigned int i = 0; i < BrushCount; i++)
+                    brushes[i]->transform(translation, Mat4f::Identity, false, false);
+                std::cout << "BrushTest: moving " << BrushCount << " brushes took " << (clock() - start) * 1000 / CLOCKS_PER_SEC << "ms" << std::endl;
+
+                start = clock();
+                for (unsigned int i = 0; i < BrushCount; i++)
+                    brushes[i]->rebuildGeometry();
+                std::cout << "BrushTest: rebuilding " << BrushCount << " brushes took " << (clock() - start) * 1000 / CLOCKS_PER_SEC << "ms" << std::endl;
+
+                Utility::deleteAll(brushes);
+            }
+        };
+    }
+}
+
+#endif
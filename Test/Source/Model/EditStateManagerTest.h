@@ -0,0 +1,201 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_EditStateManagerTest_h
+#define TrenchBroom_EditStateManagerTest_h
+
+#include "TestSuite.h"
+#include "Model/Brush.h"
+#include "Model/EditStateManager.h"
+#include "Model/Entity.h"
+#include "Utility/List.h"
+#include "Utility/VecMath.h"
+
+#include <cassert>
+#include <ctime>
+#include <iostream>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class EditStateManagerTest : public TestSuite<EditStateManagerTest> {
+        private:
+            static const unsigned int BrushCount = 50000;
+            static const unsigned int EntityCount = 5000;
+
+            BBoxf m_worldBounds;
+            Entity* m_worldspawn;
+            EntityList m_entities;
+            BrushList m_brushes;
+
+            inline void report(const char* name, clock_t start) const {
+                std::cout << "EditStateManagerTest: " << name << " took " << (clock() - start) * 1000 / CLOCKS_PER_SEC << "ms" << std::endl;
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&EditStateManagerTest::testSelectDeselect);
+                registerTestCase(&EditStateManagerTest::testRestoreLocked);
+                registerTestCase(&EditStateManagerTest::benchmarkSelectAll);
+                registerTestCase(&EditStateManagerTest::benchmarkInvertSelection);
+                registerTestCase(&EditStateManagerTest::benchmarkUnhideAll);
+            }
+
+            void setup() {
+                m_worldBounds = BBoxf(Vec3f(-16384.0f, -16384.0f, -16384.0f), Vec3f(16384.0f, 16384.0f, 16384.0f));
+                m_worldspawn = new Entity(m_worldBounds);
+
+                for (unsigned int i = 0; i < BrushCount; i++) {
+                    const float x = static_cast<float>(i % 256) * 32.0f - 4096.0f;
+                    const float y = static_cast<float>(i / 256) * 32.0f - 4096.0f;
+                    const BBoxf bounds(Vec3f(x, y, 0.0f), Vec3f(x + 16.0f, y + 16.0f, 16.0f));
+                    Brush* brush = new Brush(m_worldBounds, false, bounds, NULL);
+                    m_worldspawn->addBrush(*brush);
+                    m_brushes.push_back(brush);
+                }
+
+                for (unsigned int i = 0; i < EntityCount; i++)
+                    m_entities.push_back(new Entity(m_worldBounds));
+            }
+
+            void teardown() {
+                Utility::deleteAll(m_entities);
+                delete m_worldspawn;
+                m_worldspawn = NULL;
+                m_brushes.clear();
+            }
+        public:
+            void testSelectDeselect() {
+                EditStateManager manager;
+                BrushList brushes;
+                brushes.push_back(m_brushes[0]);
+                brushes.push_back(m_brushes[1]);
+                brushes.push_back(m_brushes[2]);
+
+                EditStateChangeSet changeSet = manager.setEditState(brushes, EditState::Selected);
+                assert(changeSet.brushesTo(EditState::Selected).size() == 3);
+                assert(manager.selectedBrushes().size() == 3);
+
+                BrushList deselect;
+                deselect.push_back(m_brushes[0]);
+                changeSet = manager.setEditState(deselect, EditState::Default);
+                assert(changeSet.brushesFrom(EditState::Selected).size() == 1);
+                assert(manager.selectedBrushes().size() == 2);
+                assert(!m_brushes[0]->selected());
+                assert(m_brushes[1]->selected() && m_brushes[2]->selected());
+
+                changeSet = manager.undoChangeSet(changeSet);
+                assert(manager.selectedBrushes().size() == 3);
+                assert(m_brushes[0]->selected());
+
+                BrushList replace;
+                replace.push_back(m_brushes[2]);
+                replace.push_back(m_brushes[3]);
+                changeSet = manager.setEditState(replace, EditState::Selected, true);
+                assert(manager.selectedBrushes().size() == 2);
+                assert(changeSet.brushesFrom(EditState::Selected).size() == 2);
+                assert(changeSet.brushesTo(EditState::Selected).size() == 1);
+                assert(m_brushes[2]->selected() && m_brushes[3]->selected());
+
+                manager.deselectAll();
+                assert(manager.selectedBrushes().empty());
+            }
+
+            void testRestoreLocked() {
+                EditStateManager manager;
+                BrushList brushes;
+                brushes.push_back(m_brushes[0]);
+
+                manager.setEditState(brushes, EditState::Locked);
+                manager.setEditState(brushes, EditState::Hidden);
+                assert(manager.lockedBrushes().empty());
+                assert(manager.hiddenBrushes().size() == 1);
+
+                manager.unhideAll();
+                assert(manager.hiddenBrushes().empty());
+                assert(manager.lockedBrushes().size() == 1);
+                assert(m_brushes[0]->locked());
+            }
+
+            void benchmarkSelectAll() {
+                EditStateManager manager;
+
+                clock_t start = clock();
+                manager.setEditState(m_entities, m_brushes, EditState::Selected, true);
+                report("select all", start);
+                assert(manager.selectedBrushes().size() == BrushCount);
+                assert(manager.selectedEntities().size() == EntityCount);
+
+                start = clock();
+                EditStateChangeSet changeSet = manager.deselectAll();
+                manager.undoChangeSet(changeSet);
+                report("deselect all and undo", start);
+                assert(manager.selectedBrushes().size() == BrushCount);
+            }
+
+            void benchmarkInvertSelection() {
+                EditStateManager manager;
+
+                BrushList evenBrushes;
+                BrushList oddBrushes;
+                for (unsigned int i = 0; i < BrushCount; i++) {
+                    if (i % 2 == 0)
+                        evenBrushes.push_back(m_brushes[i]);
+                    else
+                        oddBrushes.push_back(m_brushes[i]);
+                }
+                manager.setEditState(evenBrushes, EditState::Selected);
+
+                clock_t start = clock();
+                EditStateChangeSet changeSet = manager.setEditState(oddBrushes, EditState::Selected, true);
+                report("invert selection", start);
+                assert(manager.selectedBrushes().size() == oddBrushes.size());
+                assert(!m_brushes[0]->selected() && m_brushes[1]->selected());
+
+                start = clock();
+                manager.undoChangeSet(changeSet);
+                report("undo invert selection", start);
+                assert(manager.selectedBrushes().size() == evenBrushes.size());
+                assert(m_brushes[0]->selected() && !m_brushes[1]->selected());
+            }
+
+            void benchmarkUnhideAll() {
+                EditStateManager manager;
+                manager.setEditState(m_entities, m_brushes, EditState::Hidden);
+
+                // unhide every other brush individually
+                clock_t start = clock();
+                for (unsigned int i = 0; i < BrushCount; i += 2) {
+                    BrushList brushes;
+                    brushes.push_back(m_brushes[i]);
+                    manager.setEditState(brushes, EditState::Default);
+                }
+                report("unhide half one by one", start);
+                assert(manager.hiddenBrushes().size() == BrushCount / 2);
+
+                start = clock();
+                manager.unhideAll();
+                report("unhide all", start);
+                assert(!manager.hasHiddenObjects());
+            }
+        };
+    }
+}
+
+#endif
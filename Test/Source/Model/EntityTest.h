@@ -0,0 +1,173 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_EntityTest_h
+#define TrenchBroom_EntityTest_h
+
+#include "TestSuite.h"
+#include "Model/Brush.h"
+#include "Model/Entity.h"
+#include "Model/Face.h"
+#include "Utility/VecMath.h"
+
+#include <cassert>
+#include <ctime>
+#include <iostream>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class EntityTest : public TestSuite<EntityTest> {
+        private:
+            static const unsigned int BrushCount = 20000;
+
+            BBoxf m_worldBounds;
+
+            Brush* createBrush(float x, float y) const {
+                return new Brush(m_worldBounds, false, BBoxf(Vec3f(x, y, 0.0f), Vec3f(x + 16.0f, y + 16.0f, 16.0f)), NULL);
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&EntityTest::testFileRange);
+                registerTestCase(&EntityTest::testRemoveBrushes);
+                registerTestCase(&EntityTest::testBrushBounds);
+                registerTestCase(&EntityTest::benchmarkRemoveBrushes);
+            }
+
+            void setup() {
+                m_worldBounds = BBoxf(Vec3f(-16384.0f, -16384.0f, -16384.0f), Vec3f(16384.0f, 16384.0f, 16384.0f));
+            }
+        public:
+            void testFileRange() {
+                Entity entity(m_worldBounds);
+                assert(!entity.hasFileRange());
+
+                Brush* brush = new Brush(m_worldBounds, false, BBoxf(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(16.0f, 16.0f, 16.0f)), NULL);
+                entity.addBrush(*brush);
+                assert(!entity.hasFileRange());
+
+                entity.setFileRange(10, 100);
+                assert(entity.hasFileRange());
+                assert(entity.fileOffset() == 10);
+                assert(entity.fileLength() == 100);
+
+                entity.setProperty(Entity::ClassnameKey, "func_door");
+                assert(!entity.hasFileRange());
+
+                entity.setFileRange(10, 100);
+                entity.setProperty(Entity::ClassnameKey, "func_door");
+                assert(entity.hasFileRange());
+
+                brush->faces().front()->setXOffset(8.0f);
+                assert(!entity.hasFileRange());
+
+                entity.setFileRange(10, 100);
+                brush->transform(translationMatrix(Vec3f(16.0f, 0.0f, 0.0f)), Mat4f::Identity, false, false);
+                assert(!entity.hasFileRange());
+
+                entity.setFileRange(10, 100);
+                entity.removeBrush(*brush);
+                assert(!entity.hasFileRange());
+                delete brush;
+            }
+
+            void testRemoveBrushes() {
+                Entity entity(m_worldBounds);
+                BrushList brushes;
+                for (unsigned int i = 0; i < 5; i++) {
+                    brushes.push_back(createBrush(static_cast<float>(i) * 32.0f, 0.0f));
+                    entity.addBrush(*brushes.back());
+                }
+
+                entity.removeBrush(*brushes[1]);
+                entity.removeBrush(*brushes[3]);
+                assert(entity.brushCount() == 3);
+                assert(brushes[1]->entity() == NULL);
+
+                // the remaining brushes keep their order
+                const BrushList& remaining = entity.brushes();
+                assert(remaining.size() == 3);
+                assert(remaining[0] == brushes[0] && remaining[1] == brushes[2] && remaining[2] == brushes[4]);
+
+                entity.addBrush(*brushes[1]);
+                entity.removeBrush(*brushes[4]);
+                assert(entity.brushes().size() == 3);
+                assert(entity.brushes()[2] == brushes[1]);
+
+                delete brushes[3];
+                delete brushes[4];
+            }
+
+            void testBrushBounds() {
+                Entity entity(m_worldBounds);
+                Brush* left = createBrush(0.0f, 0.0f);
+                Brush* middle = createBrush(32.0f, 0.0f);
+                Brush* right = createBrush(64.0f, 0.0f);
+                entity.addBrush(*left);
+                entity.addBrush(*middle);
+                assert(entity.bounds().max.equals(Vec3f(48.0f, 16.0f, 16.0f)));
+
+                entity.addBrush(*right);
+                assert(entity.bounds().max.equals(Vec3f(80.0f, 16.0f, 16.0f)));
+
+                // removing an inner brush keeps the bounds, removing an outer one shrinks them
+                entity.removeBrush(*middle);
+                assert(entity.bounds().min.equals(Vec3f(0.0f, 0.0f, 0.0f)));
+                assert(entity.bounds().max.equals(Vec3f(80.0f, 16.0f, 16.0f)));
+
+                entity.removeBrush(*right);
+                assert(entity.bounds().max.equals(Vec3f(16.0f, 16.0f, 16.0f)));
+                assert(entity.center().equals(Vec3f(8.0f, 8.0f, 8.0f)));
+
+                delete middle;
+                delete right;
+            }
+
+            void benchmarkRemoveBrushes() {
+                Entity worldspawn(m_worldBounds);
+                worldspawn.setProperty(Entity::ClassnameKey, Entity::WorldspawnClassname);
+                BrushList brushes;
+                for (unsigned int i = 0; i < BrushCount; i++) {
+                    brushes.push_back(createBrush(static_cast<float>(i % 128) * 32.0f, static_cast<float>(i / 128) * 32.0f));
+                    worldspawn.addBrush(*brushes.back());
+                }
+                worldspawn.bounds();
+
+                clock_t start = clock();
+                for (unsigned int i = 0; i < BrushCount; i++) {
+                    worldspawn.removeBrush(*brushes[i]);
+                    assert(worldspawn.brushCount() == BrushCount - i - 1);
+                }
+                worldspawn.bounds();
+                std::cout << "EntityTest: removing " << BrushCount << " brushes from worldspawn took " << (clock() - start) * 1000 / CLOCKS_PER_SEC << "ms" << std::endl;
+                assert(worldspawn.brushes().empty());
+
+                start = clock();
+                for (unsigned int i = 0; i < BrushCount; i++)
+                    worldspawn.addBrush(*brushes[i]);
+                worldspawn.bounds();
+                std::cout << "EntityTest: adding them back took " << (clock() - start) * 1000 / CLOCKS_PER_SEC << "ms" << std::endl;
+                assert(worldspawn.brushes().size() == BrushCount);
+            }
+        };
+    }
+}
+
+#endif
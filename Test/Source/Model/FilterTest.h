@@ -0,0 +1,155 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_FilterTest_h
+#define TrenchBroom_FilterTest_h
+
+#include "TestSuite.h"
+#include "Model/Brush.h"
+#include "Model/Entity.h"
+#include "Model/Face.h"
+#include "Model/Filter.h"
+#include "Model/VisibilityClass.h"
+#include "Utility/VecMath.h"
+#include "View/ViewOptions.h"
+
+#include <cassert>
+#include <ctime>
+#include <iostream>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class FilterTest : public TestSuite<FilterTest> {
+        private:
+            static const unsigned int BrushCount = 50000;
+
+            BBoxf m_worldBounds;
+            Entity* m_worldspawn;
+
+            Brush* addCube(Entity& entity, const Vec3f& min, const String& textureName) {
+                Brush* brush = new Brush(m_worldBounds, false, BBoxf(min, min + Vec3f(16.0f, 16.0f, 16.0f)), NULL);
+                for (size_t i = 0; i < brush->faces().size(); i++)
+                    brush->faces()[i]->setTextureName(textureName);
+                entity.addBrush(*brush);
+                return brush;
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&FilterTest::testVisibilityClasses);
+                registerTestCase(&FilterTest::testDefaultFilter);
+                registerTestCase(&FilterTest::benchmarkBrushVisible);
+            }
+
+            void setup() {
+                m_worldBounds = BBoxf(Vec3f(-16384.0f, -16384.0f, -16384.0f), Vec3f(16384.0f, 16384.0f, 16384.0f));
+                m_worldspawn = new Entity(m_worldBounds);
+                m_worldspawn->setProperty(Entity::ClassnameKey, Entity::WorldspawnClassname);
+            }
+
+            void teardown() {
+                delete m_worldspawn;
+                m_worldspawn = NULL;
+            }
+        public:
+            void testVisibilityClasses() {
+                Brush* brush = addCube(*m_worldspawn, Vec3f(0.0f, 0.0f, 0.0f), "clip");
+                assert(brush->visibilityClasses() == VisibilityClass::Clip);
+
+                // a single face with another texture removes the brush from the class
+                brush->faces()[0]->setTextureName("rock");
+                assert(brush->visibilityClasses() == VisibilityClass::None);
+
+                for (size_t i = 0; i < brush->faces().size(); i++)
+                    brush->faces()[i]->setTextureName("*water");
+                assert(brush->visibilityClasses() == VisibilityClass::Liquid);
+
+                Entity trigger(m_worldBounds);
+                trigger.setProperty(Entity::ClassnameKey, "trigger_multiple");
+                Brush* triggerBrush = addCube(trigger, Vec3f(32.0f, 0.0f, 0.0f), "rock");
+                assert(triggerBrush->visibilityClasses() == VisibilityClass::Trigger);
+
+                trigger.setProperty(Entity::ClassnameKey, "func_door");
+                assert(triggerBrush->visibilityClasses() == VisibilityClass::None);
+
+                trigger.removeBrush(*triggerBrush);
+                m_worldspawn->addBrush(*triggerBrush);
+                assert(triggerBrush->visibilityClasses() == VisibilityClass::None);
+            }
+
+            void testDefaultFilter() {
+                View::ViewOptions viewOptions;
+                DefaultFilter filter(viewOptions);
+
+                Brush* clip = addCube(*m_worldspawn, Vec3f(0.0f, 0.0f, 0.0f), "clip");
+                Brush* rock = addCube(*m_worldspawn, Vec3f(32.0f, 0.0f, 0.0f), "rock");
+                assert(filter.hiddenBrushClasses() == VisibilityClass::None);
+                assert(filter.brushVisible(*clip) && filter.brushVisible(*rock));
+
+                viewOptions.setShowClipBrushes(false);
+                viewOptions.setShowTriggerBrushes(false);
+                assert(filter.hiddenBrushClasses() == (VisibilityClass::Clip | VisibilityClass::Trigger));
+                assert(!filter.brushVisible(*clip) && filter.brushVisible(*rock));
+                assert(filter.brushMatches(*clip));
+
+                // special faces do not match the pattern by their texture names
+                viewOptions.setShowClipBrushes(true);
+                viewOptions.setFilterPattern("ro");
+                assert(!filter.brushMatches(*clip) && filter.brushMatches(*rock));
+                viewOptions.setFilterPattern("cl");
+                assert(!filter.brushMatches(*clip) && !filter.brushMatches(*rock));
+
+                viewOptions.setFilterPattern("");
+                viewOptions.setShowBrushes(false);
+                assert(!filter.brushVisible(*rock));
+                assert(filter.brushMatches(*rock));
+            }
+
+            void benchmarkBrushVisible() {
+                const String textureNames[] = { "rock", "clip", "skip", "hint", "*water", "trigger" };
+                Model::BrushList brushes;
+                size_t hidden = 0;
+                for (unsigned int i = 0; i < BrushCount; i++) {
+                    if (i % 6 == 1 || i % 6 == 3)
+                        hidden++;
+                    const float x = static_cast<float>(i % 256) * 32.0f - 4096.0f;
+                    const float y = static_cast<float>(i / 256) * 32.0f - 4096.0f;
+                    brushes.push_back(addCube(*m_worldspawn, Vec3f(x, y, 0.0f), textureNames[i % 6]));
+                }
+
+                View::ViewOptions viewOptions;
+                viewOptions.setShowClipBrushes(false);
+                viewOptions.setShowHintBrushes(false);
+                DefaultFilter filter(viewOptions);
+
+                clock_t start = clock();
+                size_t visible = 0;
+                for (unsigned int j = 0; j < 20; j++)
+                    for (unsigned int i = 0; i < BrushCount; i++)
+                        if (filter.brushVisible(*brushes[i]))
+                            visible++;
+                std::cout << "FilterTest: 20 visibility passes over " << BrushCount << " brushes took " << (clock() - start) * 1000 / CLOCKS_PER_SEC << "ms" << std::endl;
+                assert(visible == 20 * (BrushCount - hidden));
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,194 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_MapTest_h
+#define TrenchBroom_MapTest_h
+
+#include "TestSuite.h"
+#include "Model/Brush.h"
+#include "Model/Entity.h"
+#include "Model/Face.h"
+#include "Model/Map.h"
+#include "Utility/String.h"
+#include "Utility/VecMath.h"
+
+#include <cassert>
+#include <ctime>
+#include <iostream>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class MapTest : public TestSuite<MapTest> {
+        private:
+            static const unsigned int EntityCount = 50000;
+            static const unsigned int ClassnameCount = 50;
+
+            BBoxf m_worldBounds;
+        protected:
+            void registerTestCases() {
+                registerTestCase(&MapTest::testPropertyIndex);
+                registerTestCase(&MapTest::testFaceTextureIndex);
+                registerTestCase(&MapTest::testWorldspawn);
+                registerTestCase(&MapTest::benchmarkPropertyQueries);
+            }
+
+            void setup() {
+                m_worldBounds = BBoxf(Vec3f(-16384.0f, -16384.0f, -16384.0f), Vec3f(16384.0f, 16384.0f, 16384.0f));
+            }
+        public:
+            void testPropertyIndex() {
+                Map map(m_worldBounds, false);
+
+                Entity* light = new Entity(m_worldBounds);
+                light->setProperty(Entity::ClassnameKey, "light");
+                light->setProperty("style", "1");
+                map.addEntity(*light);
+
+                Entity* door = new Entity(m_worldBounds);
+                door->setProperty(Entity::ClassnameKey, "func_door");
+                map.addEntity(*door);
+
+                assert(map.entitiesWithClassname("light").size() == 1);
+                assert(map.entitiesWithClassname("light").front() == light);
+                assert(map.entitiesWithClassname("info_null").empty());
+                assert(map.entitiesWithProperty("style", "1").size() == 1);
+
+                light->setProperty("style", "2");
+                assert(map.entitiesWithProperty("style", "1").empty());
+                assert(map.entitiesWithProperty("style", "2").size() == 1);
+
+                door->setProperty("style", "1");
+                assert(map.entitiesWithProperty("style").size() == 2);
+
+                light->renameProperty("style", "_style");
+                assert(map.entitiesWithProperty("style").size() == 1);
+                assert(map.entitiesWithProperty("_style", "2").size() == 1);
+
+                door->removeProperty("style");
+                assert(map.entitiesWithProperty("style").empty());
+
+                PropertyList properties;
+                properties.push_back(Property(Entity::ClassnameKey, "light_torch"));
+                light->setProperties(properties, true);
+                assert(map.entitiesWithClassname("light").empty());
+                assert(map.entitiesWithClassname("light_torch").size() == 1);
+                assert(map.entitiesWithProperty("_style").empty());
+
+                map.removeEntity(*door);
+                assert(map.entitiesWithClassname("func_door").empty());
+                delete door;
+            }
+
+            void testFaceTextureIndex() {
+                Map map(m_worldBounds, false);
+                
+                Entity* worldspawn = new Entity(m_worldBounds);
+                worldspawn->setProperty(Entity::ClassnameKey, Entity::WorldspawnClassname);
+                Brush* first = new Brush(m_worldBounds, false, BBoxf(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(16.0f, 16.0f, 16.0f)), NULL);
+                for (size_t i = 0; i < first->faces().size(); i++)
+                    first->faces()[i]->setTextureName("rock");
+                worldspawn->addBrush(*first);
+                
+                // faces are indexed when their entity is added to the map
+                assert(map.facesWithTexture("rock").empty());
+                map.addEntity(*worldspawn);
+                assert(map.facesWithTexture("rock").size() == 6);
+                assert(map.facesWithTexture("ROCK").size() == 6);
+                
+                // and when their brush is added to an entity which is already in the map
+                Brush* second = new Brush(m_worldBounds, false, BBoxf(Vec3f(32.0f, 0.0f, 0.0f), Vec3f(48.0f, 16.0f, 16.0f)), NULL);
+                for (size_t i = 0; i < second->faces().size(); i++)
+                    second->faces()[i]->setTextureName("Rock");
+                worldspawn->addBrush(*second);
+                assert(map.facesWithTexture("rock").size() == 12);
+                
+                first->faces()[0]->setTextureName("sky1");
+                assert(map.facesWithTexture("rock").size() == 11);
+                assert(map.facesWithTexture("sky1").size() == 1);
+                assert(map.facesWithTexture("sky1").front() == first->faces()[0]);
+                
+                worldspawn->removeBrush(*second);
+                assert(map.facesWithTexture("rock").size() == 5);
+                delete second;
+                
+                map.removeEntity(*worldspawn);
+                assert(map.facesWithTexture("rock").empty());
+                assert(map.facesWithTexture("sky1").empty());
+                delete worldspawn;
+            }
+
+            void testWorldspawn() {
+                Map map(m_worldBounds, false);
+                
+                Entity* light = new Entity(m_worldBounds);
+                light->setProperty(Entity::ClassnameKey, "light");
+                map.addEntity(*light);
+                assert(map.worldspawn() == NULL);
+                
+                Entity* worldspawn = new Entity(m_worldBounds);
+                worldspawn->setProperty(Entity::ClassnameKey, Entity::WorldspawnClassname);
+                map.addEntity(*worldspawn);
+                assert(map.worldspawn() == worldspawn);
+                
+                map.removeEntity(*worldspawn);
+                assert(map.worldspawn() == NULL);
+                delete worldspawn;
+            }
+
+            void benchmarkPropertyQueries() {
+                Map map(m_worldBounds, false);
+                for (unsigned int i = 0; i < EntityCount; i++) {
+                    StringStream classname;
+                    classname << "class_" << (i % ClassnameCount);
+                    StringStream targetname;
+                    targetname << "t" << i;
+
+                    Entity* entity = new Entity(m_worldBounds);
+                    entity->setProperty(Entity::ClassnameKey, classname.str());
+                    entity->setProperty(Entity::TargetnameKey, targetname.str());
+                    map.addEntity(*entity);
+                }
+
+                clock_t start = clock();
+                size_t found = 0;
+                for (unsigned int i = 0; i < ClassnameCount; i++) {
+                    StringStream classname;
+                    classname << "class_" << i;
+                    found += map.entitiesWithClassname(classname.str()).size();
+                }
+                std::cout << "MapTest: " << ClassnameCount << " classname queries took " << (clock() - start) * 1000 / CLOCKS_PER_SEC << "ms" << std::endl;
+                assert(found == EntityCount);
+
+                start = clock();
+                found = 0;
+                for (unsigned int i = 0; i < 1000; i++) {
+                    StringStream targetname;
+                    targetname << "t" << (i * 50);
+                    found += map.entitiesWithProperty(Entity::TargetnameKey, targetname.str()).size();
+                }
+                std::cout << "MapTest: 1000 key / value queries took " << (clock() - start) * 1000 / CLOCKS_PER_SEC << "ms" << std::endl;
+                assert(found == 1000);
+            }
+        };
+    }
+}
+
+#endif
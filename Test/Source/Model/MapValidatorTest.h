@@ -0,0 +1,148 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_MapValidatorTest_h
+#define TrenchBroom_MapValidatorTest_h
+
+#include "TestSuite.h"
+#include "Model/Brush.h"
+#include "Model/Entity.h"
+#include "Model/Face.h"
+#include "Model/MapValidator.h"
+#include "Utility/VecMath.h"
+
+#include <cassert>
+#include <ctime>
+#include <iostream>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class MapValidatorTest : public TestSuite<MapValidatorTest> {
+        private:
+            static const unsigned int BrushCount = 50000;
+
+            BBoxf m_worldBounds;
+            Entity* m_worldspawn;
+
+            Brush* addCube(const Vec3f& min, float size, bool forceIntegerFacePoints = false) {
+                Brush* brush = new Brush(m_worldBounds, forceIntegerFacePoints, BBoxf(min, min + Vec3f(size, size, size)), NULL);
+                m_worldspawn->addBrush(*brush);
+                return brush;
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&MapValidatorTest::testValidBrushes);
+                registerTestCase(&MapValidatorTest::testOutsideWorldBounds);
+                registerTestCase(&MapValidatorTest::testInvalidFacePoints);
+                registerTestCase(&MapValidatorTest::testDuplicatePlanes);
+                registerTestCase(&MapValidatorTest::benchmarkValidate);
+            }
+
+            void setup() {
+                m_worldBounds = BBoxf(Vec3f(-16384.0f, -16384.0f, -16384.0f), Vec3f(16384.0f, 16384.0f, 16384.0f));
+                m_worldspawn = new Entity(m_worldBounds);
+            }
+
+            void teardown() {
+                delete m_worldspawn;
+                m_worldspawn = NULL;
+            }
+        public:
+            void testValidBrushes() {
+                addCube(Vec3f(0.0f, 0.0f, 0.0f), 16.0f);
+                addCube(Vec3f(32.0f, 0.0f, 0.0f), 16.0f, true);
+
+                MapValidator validator(m_worldBounds);
+                assert(validator.validate(m_worldspawn->brushes()).empty());
+            }
+
+            void testOutsideWorldBounds() {
+                addCube(Vec3f(0.0f, 0.0f, 0.0f), 16.0f);
+                Brush* outside = addCube(Vec3f(256.0f, 0.0f, 0.0f), 16.0f);
+
+                MapValidator validator(BBoxf(Vec3f(-128.0f, -128.0f, -128.0f), Vec3f(128.0f, 128.0f, 128.0f)));
+                const MapValidator::IssueList issues = validator.validate(m_worldspawn->brushes());
+                assert(issues.size() == 1);
+                assert(issues[0].brush == outside);
+                assert(issues[0].index == 1);
+                assert(issues[0].type == MapValidator::ITOutsideWorldBounds);
+                assert(!issues[0].repairable());
+            }
+
+            void testInvalidFacePoints() {
+                FaceList faces;
+                Brush cube(m_worldBounds, false, BBoxf(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(16.0f, 16.0f, 16.0f)), NULL);
+                for (size_t i = 0; i < cube.faces().size(); i++)
+                    faces.push_back(new Face(m_worldBounds, false, *cube.faces()[i]));
+                faces.push_back(new Face(m_worldBounds, false, Vec3f(0.0f, 0.0f, 8.5f), Vec3f(0.0f, 1.0f, 8.5f), Vec3f(1.0f, 0.0f, 8.5f), ""));
+
+                Brush* brush = new Brush(m_worldBounds, true, faces);
+                m_worldspawn->addBrush(*brush);
+
+                MapValidator::IssueList issues;
+                MapValidator::checkBrush(*brush, 0, m_worldBounds, issues);
+                assert(issues.size() == 1);
+                assert(issues[0].type == MapValidator::ITInvalidFacePoints);
+                assert(issues[0].repairable());
+
+                brush->snap(1);
+                issues.clear();
+                MapValidator::checkBrush(*brush, 0, m_worldBounds, issues);
+                assert(issues.empty());
+            }
+
+            void testDuplicatePlanes() {
+                // the extra plane crosses the top face at a shallow angle, so both faces keep a part of the top
+                FaceList faces;
+                Brush cube(m_worldBounds, false, BBoxf(Vec3f(-8.0f, -8.0f, 0.0f), Vec3f(8.0f, 8.0f, 16.0f)), NULL);
+                for (size_t i = 0; i < cube.faces().size(); i++)
+                    faces.push_back(new Face(m_worldBounds, false, *cube.faces()[i]));
+                faces.push_back(new Face(m_worldBounds, false, Vec3f(-8.0f, 0.0f, 16.0f), Vec3f(0.0f, 8.0f, 15.5f), Vec3f(8.0f, 0.0f, 16.0f), ""));
+
+                Brush* brush = new Brush(m_worldBounds, false, faces);
+                m_worldspawn->addBrush(*brush);
+                assert(brush->faces().size() == 7);
+
+                MapValidator::IssueList issues;
+                MapValidator::checkBrush(*brush, 0, m_worldBounds, issues);
+                assert(issues.size() == 1);
+                assert(issues[0].type == MapValidator::ITOverlappingPlanes);
+                assert(!issues[0].repairable());
+            }
+
+            void benchmarkValidate() {
+                for (unsigned int i = 0; i < BrushCount; i++) {
+                    const float x = static_cast<float>(i % 256) * 32.0f - 4096.0f;
+                    const float y = static_cast<float>(i / 256) * 32.0f - 4096.0f;
+                    addCube(Vec3f(x, y, 0.0f), 16.0f);
+                }
+
+                MapValidator validator(m_worldBounds);
+                clock_t start = clock();
+                const MapValidator::IssueList issues = validator.validate(m_worldspawn->brushes());
+                std::cout << "MapValidatorTest: validating " << BrushCount << " brushes took " << (clock() - start) * 1000 / CLOCKS_PER_SEC << "ms" << std::endl;
+                assert(issues.empty());
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,168 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_OctreeTest_h
+#define TrenchBroom_OctreeTest_h
+
+#include "TestSuite.h"
+#include "Model/Brush.h"
+#include "Model/Entity.h"
+#include "Model/Map.h"
+#include "Model/Octree.h"
+#include "Utility/VecMath.h"
+
+#include <algorithm>
+#include <cassert>
+#include <ctime>
+#include <iostream>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class OctreeTest : public TestSuite<OctreeTest> {
+        private:
+            static const unsigned int BrushCount = 20000;
+            static const unsigned int StepCount = 10;
+
+            BBoxf m_worldBounds;
+            Map* m_map;
+            BrushList m_brushes;
+
+            bool hits(Octree& octree, const Vec3f& origin, Brush* brush) const {
+                const MapObjectList objects = octree.intersect(Rayf(origin, Vec3f::NegZ));
+                return std::find(objects.begin(), objects.end(), brush) != objects.end();
+            }
+
+            void translate(const BrushList& brushes, const Vec3f& delta) const {
+                const Mat4f transform = translationMatrix(delta);
+                for (unsigned int i = 0; i < brushes.size(); i++)
+                    brushes[i]->transform(transform, Mat4f::Identity, false, false);
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&OctreeTest::testDeferredUpdate);
+                registerTestCase(&OctreeTest::testRemoveChangedObject);
+                registerTestCase(&OctreeTest::benchmarkUpdate);
+            }
+
+            void setup() {
+                m_worldBounds = BBoxf(Vec3f(-16384.0f, -16384.0f, -16384.0f), Vec3f(16384.0f, 16384.0f, 16384.0f));
+                m_map = new Map(m_worldBounds, false);
+
+                Entity* worldspawn = new Entity(m_worldBounds);
+                worldspawn->setProperty(Entity::ClassnameKey, Entity::WorldspawnClassname);
+                for (unsigned int i = 0; i < BrushCount; i++) {
+                    const float x = static_cast<float>(i % 128) * 64.0f - 4096.0f;
+                    const float y = static_cast<float>(i / 128) * 64.0f - 4096.0f;
+                    Brush* brush = new Brush(m_worldBounds, false, BBoxf(Vec3f(x, y, 0.0f), Vec3f(x + 16.0f, y + 16.0f, 16.0f)), NULL);
+                    worldspawn->addBrush(*brush);
+                    m_brushes.push_back(brush);
+                }
+                m_map->addEntity(*worldspawn);
+            }
+
+            void teardown() {
+                delete m_map;
+                m_map = NULL;
+                m_brushes.clear();
+            }
+        public:
+            void testDeferredUpdate() {
+                Octree octree(*m_map);
+                octree.loadMap();
+                const size_t count = octree.count();
+
+                Brush* brush = m_brushes[0];
+                const Vec3f center = brush->bounds().center();
+                assert(hits(octree, center + Vec3f(0.0f, 0.0f, 64.0f), brush));
+
+                // a small move keeps the brush in its node, a large one moves it across the tree
+                BrushList brushes;
+                brushes.push_back(brush);
+                octree.objectWillChange(*brush);
+                translate(brushes, Vec3f(1.0f, 0.0f, 0.0f));
+                octree.objectWillChange(*brush);
+                translate(brushes, Vec3f(8191.0f, 8192.0f, 0.0f));
+
+                assert(!hits(octree, center + Vec3f(0.0f, 0.0f, 64.0f), brush));
+                assert(hits(octree, center + Vec3f(8192.0f, 8192.0f, 64.0f), brush));
+                assert(octree.count() == count);
+
+                octree.objectWillChange(*brush);
+                translate(brushes, Vec3f(-8192.0f, -8192.0f, 0.0f));
+                assert(hits(octree, center + Vec3f(0.0f, 0.0f, 64.0f), brush));
+                assert(octree.count() == count);
+            }
+
+            void testRemoveChangedObject() {
+                Octree octree(*m_map);
+                octree.loadMap();
+                const size_t count = octree.count();
+
+                BrushList brushes;
+                brushes.push_back(m_brushes[1]);
+                octree.objectWillChange(*m_brushes[1]);
+                translate(brushes, Vec3f(4096.0f, 0.0f, 0.0f));
+                octree.removeObject(*m_brushes[1]);
+
+                assert(octree.count() == count - 1);
+                assert(!hits(octree, m_brushes[1]->bounds().center() + Vec3f(0.0f, 0.0f, 64.0f), m_brushes[1]));
+            }
+
+            void benchmarkUpdate() {
+                MapObjectList objects;
+                objects.insert(objects.end(), m_brushes.begin(), m_brushes.end());
+                const Rayf ray(Vec3f(0.0f, 0.0f, 1024.0f), Vec3f::NegZ);
+
+                Octree removeAddOctree(*m_map);
+                removeAddOctree.loadMap();
+                clock_t octreeTime = 0;
+                for (unsigned int i = 0; i < StepCount; i++) {
+                    clock_t start = clock();
+                    removeAddOctree.removeObjects(objects);
+                    octreeTime += clock() - start;
+                    translate(m_brushes, Vec3f(1.0f, 1.0f, 0.0f));
+                    start = clock();
+                    removeAddOctree.addObjects(objects);
+                    removeAddOctree.intersect(ray);
+                    octreeTime += clock() - start;
+                }
+                std::cout << "OctreeTest: removing and adding " << BrushCount << " brushes " << StepCount << " times took " << octreeTime * 1000 / CLOCKS_PER_SEC << "ms" << std::endl;
+
+                Octree updateOctree(*m_map);
+                updateOctree.loadMap();
+                octreeTime = 0;
+                for (unsigned int i = 0; i < StepCount; i++) {
+                    clock_t start = clock();
+                    updateOctree.objectsWillChange(objects);
+                    octreeTime += clock() - start;
+                    translate(m_brushes, Vec3f(1.0f, 1.0f, 0.0f));
+                    start = clock();
+                    updateOctree.intersect(ray);
+                    octreeTime += clock() - start;
+                }
+                std::cout << "OctreeTest: updating " << BrushCount << " brushes " << StepCount << " times took " << octreeTime * 1000 / CLOCKS_PER_SEC << "ms" << std::endl;
+                assert(updateOctree.count() == removeAddOctree.count());
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,141 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_PickerTest_h
+#define TrenchBroom_PickerTest_h
+
+#include "TestSuite.h"
+#include "Model/Brush.h"
+#include "Model/Entity.h"
+#include "Model/Filter.h"
+#include "Model/Map.h"
+#include "Model/Octree.h"
+#include "Model/Picker.h"
+#include "Utility/VecMath.h"
+
+#include <cassert>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class PickerTest : public TestSuite<PickerTest> {
+        private:
+            class PickAllFilter : public Filter {
+            public:
+                bool entityVisible(const Entity& entity) const { return true; }
+                bool entityPickable(const Entity& entity) const { return true; }
+                bool brushVisible(const Brush& brush) const { return true; }
+                bool brushPickable(const Brush& brush) const { return true; }
+                bool brushVerticesPickable(const Brush& brush) const { return true; }
+            };
+            
+            BBoxf m_worldBounds;
+            Map* m_map;
+            Octree* m_octree;
+            Brush* m_selectedBrush;
+            Brush* m_otherBrush;
+            PickAllFilter m_filter;
+            
+            FaceHit* pickFace(Picker& picker, const Vec3f& origin) {
+                PickResult* result = picker.pick(Rayf(origin, Vec3f::NegZ));
+                FaceHit* hit = static_cast<FaceHit*>(result->first(HitType::FaceHit, false, m_filter));
+                FaceHit* copy = hit != NULL ? new FaceHit(hit->face(), hit->hitPoint(), hit->distance()) : NULL;
+                delete result;
+                return copy;
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&PickerTest::testPickTranslatedSelection);
+                registerTestCase(&PickerTest::testPickRotatedSelection);
+            }
+            
+            void setup() {
+                m_worldBounds = BBoxf(Vec3f(-16384.0f, -16384.0f, -16384.0f), Vec3f(16384.0f, 16384.0f, 16384.0f));
+                m_map = new Map(m_worldBounds, false);
+                
+                Entity* worldspawn = new Entity(m_worldBounds);
+                worldspawn->setProperty(Entity::ClassnameKey, Entity::WorldspawnClassname);
+                m_selectedBrush = new Brush(m_worldBounds, false, BBoxf(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(16.0f, 16.0f, 16.0f)), NULL);
+                m_otherBrush = new Brush(m_worldBounds, false, BBoxf(Vec3f(32.0f, 0.0f, 0.0f), Vec3f(48.0f, 16.0f, 16.0f)), NULL);
+                worldspawn->addBrush(*m_selectedBrush);
+                worldspawn->addBrush(*m_otherBrush);
+                m_map->addEntity(*worldspawn);
+                m_selectedBrush->setEditState(EditState::Selected);
+                
+                m_octree = new Octree(*m_map);
+                m_octree->loadMap();
+            }
+            
+            void teardown() {
+                delete m_octree;
+                m_octree = NULL;
+                delete m_map;
+                m_map = NULL;
+            }
+        public:
+            void testPickTranslatedSelection() {
+                Picker picker(*m_octree);
+                
+                FaceHit* hit = pickFace(picker, Vec3f(8.0f, 8.0f, 100.0f));
+                assert(hit != NULL && hit->face().brush() == m_selectedBrush);
+                delete hit;
+                
+                // the selection is no longer where its geometry is
+                picker.setSelectionTransform(translationMatrix(Vec3f(64.0f, 0.0f, 32.0f)));
+                hit = pickFace(picker, Vec3f(8.0f, 8.0f, 100.0f));
+                assert(hit == NULL);
+                
+                hit = pickFace(picker, Vec3f(72.0f, 8.0f, 100.0f));
+                assert(hit != NULL && hit->face().brush() == m_selectedBrush);
+                assert(hit->hitPoint().equals(Vec3f(72.0f, 8.0f, 48.0f)));
+                assert(Math<float>::eq(hit->distance(), 52.0f));
+                delete hit;
+                
+                // unselected brushes are not affected
+                hit = pickFace(picker, Vec3f(40.0f, 8.0f, 100.0f));
+                assert(hit != NULL && hit->face().brush() == m_otherBrush);
+                assert(hit->hitPoint().equals(Vec3f(40.0f, 8.0f, 16.0f)));
+                delete hit;
+                
+                picker.clearSelectionTransform();
+                hit = pickFace(picker, Vec3f(8.0f, 8.0f, 100.0f));
+                assert(hit != NULL && hit->face().brush() == m_selectedBrush);
+                delete hit;
+            }
+            
+            void testPickRotatedSelection() {
+                Picker picker(*m_octree);
+                
+                // a quarter turn about the Z axis moves the selected brush from the positive to the negative Y half space
+                picker.setSelectionTransform(rotationMatrix(Math<float>::Pi / 2.0f, Vec3f::PosZ));
+                FaceHit* hit = pickFace(picker, Vec3f(8.0f, -8.0f, 100.0f));
+                assert(hit != NULL && hit->face().brush() == m_selectedBrush);
+                assert(hit->hitPoint().equals(Vec3f(8.0f, -8.0f, 16.0f), 0.001f));
+                assert(Math<float>::eq(hit->distance(), 84.0f, 0.001f));
+                delete hit;
+                
+                hit = pickFace(picker, Vec3f(8.0f, 8.0f, 100.0f));
+                assert(hit == NULL);
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,361 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_OcclusionCullerTest_h
+#define TrenchBroom_OcclusionCullerTest_h
+
+#include "TestSuite.h"
+#include "Model/Brush.h"
+#include "Model/Entity.h"
+#include "Model/Map.h"
+#include "Model/MapObject.h"
+#include "Model/Octree.h"
+#include "Renderer/OcclusionCuller.h"
+#include "Utility/VecMath.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Renderer {
+        class OcclusionCullerTest : public TestSuite<OcclusionCullerTest> {
+        private:
+            static const int ViewportWidth = 1024;
+            static const int ViewportHeight = 576;
+            static const int RoomCount = 12;
+            static const int RoomSize = 512;
+            static const int WallThickness = 16;
+            static const int RoomHeight = 256;
+            static const int DoorWidth = 128;
+            static const int DoorHeight = 160;
+            static const unsigned int FrameCount = 400;
+
+            BBoxf m_worldBounds;
+
+            inline Mat4f matrix(const Vec3f& position, const Vec3f& direction) const {
+                return perspectiveMatrix(90.0f, 1.0f, 8192.0f, ViewportWidth, ViewportHeight) * viewMatrix(direction, Vec3f::PosZ) * translationMatrix(-position);
+            }
+
+            inline Model::Brush* createBrush(float x1, float y1, float z1, float x2, float y2, float z2) const {
+                return new Model::Brush(m_worldBounds, false, BBoxf(Vec3f(x1, y1, z1), Vec3f(x2, y2, z2)), NULL);
+            }
+
+            inline float random(float min, float max) const {
+                return min + (max - min) * static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX);
+            }
+
+            /*
+             Returns true if the given point is inside of the view and the line of sight from the camera to it is
+             not blocked by any of the given brushes.
+             */
+            bool pointVisible(const Vec3f& position, const Mat4f& matrix, const Vec3f& point, const Model::BrushList& brushes) const {
+                const Vec4f clip = matrix * Vec4f(point, 1.0f);
+                if (clip[3] <= 0.0f || clip[2] < -clip[3] ||
+                    clip[0] < -clip[3] || clip[0] > clip[3] ||
+                    clip[1] < -clip[3] || clip[1] > clip[3])
+                    return false;
+
+                Vec3f direction = point - position;
+                const float distance = direction.length();
+                direction /= distance;
+                const Rayf ray(position, direction);
+                for (size_t i = 0; i < brushes.size(); i++) {
+                    const float hit = brushes[i]->bounds().intersectWithRay(ray);
+                    if (!Math<float>::isnan(hit) && hit < distance)
+                        return false;
+                }
+                return true;
+            }
+
+            // the worldspawn entity is stored in the octree, too, but its bounds span all of its brushes
+            Model::BrushList groupBrushes(const Model::MapObjectList& group) const {
+                Model::BrushList brushes;
+                for (size_t i = 0; i < group.size(); i++)
+                    if (group[i]->objectType() == Model::MapObject::BrushObject)
+                        brushes.push_back(static_cast<Model::Brush*>(group[i]));
+                return brushes;
+            }
+
+            /*
+             Builds a grid of rooms which are connected by doorways, with a few small detail brushes in every room.
+             */
+            Model::Entity* createRooms() const {
+                Model::Entity* worldspawn = new Model::Entity(m_worldBounds);
+                const float s = static_cast<float>(RoomSize);
+                const float t = static_cast<float>(WallThickness);
+                const float h = static_cast<float>(RoomHeight);
+                const float d = static_cast<float>(DoorWidth);
+                const float dh = static_cast<float>(DoorHeight);
+
+                for (int i = 0; i < RoomCount; i++) {
+                    for (int j = 0; j < RoomCount; j++) {
+                        const float x = static_cast<float>(i) * s;
+                        const float y = static_cast<float>(j) * s;
+                        const float cx = x + s / 2.0f;
+                        const float cy = y + s / 2.0f;
+
+                        worldspawn->addBrush(*createBrush(x, y, -t, x + s, y + s, 0.0f));
+                        worldspawn->addBrush(*createBrush(x, y, h, x + s, y + s, h + t));
+
+                        // west wall with a doorway
+                        worldspawn->addBrush(*createBrush(x, y, 0.0f, x + t, cy - d / 2.0f, h));
+                        worldspawn->addBrush(*createBrush(x, cy + d / 2.0f, 0.0f, x + t, y + s, h));
+                        worldspawn->addBrush(*createBrush(x, cy - d / 2.0f, dh, x + t, cy + d / 2.0f, h));
+
+                        // south wall with a doorway
+                        worldspawn->addBrush(*createBrush(x + t, y, 0.0f, cx - d / 2.0f, y + t, h));
+                        worldspawn->addBrush(*createBrush(cx + d / 2.0f, y, 0.0f, x + s, y + t, h));
+                        worldspawn->addBrush(*createBrush(cx - d / 2.0f, y, dh, cx + d / 2.0f, y + t, h));
+
+                        for (int k = 0; k < 4; k++) {
+                            const float dx = x + 64.0f + static_cast<float>(k % 2) * 320.0f;
+                            const float dy = y + 64.0f + static_cast<float>(k / 2) * 320.0f;
+                            worldspawn->addBrush(*createBrush(dx, dy, 0.0f, dx + 32.0f, dy + 32.0f, 32.0f));
+                        }
+                    }
+                }
+                return worldspawn;
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&OcclusionCullerTest::testSingleOccluder);
+                registerTestCase(&OcclusionCullerTest::testNearPlane);
+                registerTestCase(&OcclusionCullerTest::testOccluderSelection);
+                registerTestCase(&OcclusionCullerTest::testConservative);
+                registerTestCase(&OcclusionCullerTest::testOctreeGroups);
+                registerTestCase(&OcclusionCullerTest::benchmarkCameraPath);
+            }
+
+            void setup() {
+                m_worldBounds = BBoxf(Vec3f(-16384.0f, -16384.0f, -16384.0f), Vec3f(16384.0f, 16384.0f, 16384.0f));
+            }
+        public:
+            void testSingleOccluder() {
+                const Vec3f position = Vec3f::Null;
+                OcclusionCuller culler;
+                culler.clear(matrix(position, Vec3f::PosX));
+
+                Vec3f::List wall;
+                wall.push_back(Vec3f(100.0f, -50.0f, -50.0f));
+                wall.push_back(Vec3f(100.0f,  50.0f, -50.0f));
+                wall.push_back(Vec3f(100.0f,  50.0f,  50.0f));
+                wall.push_back(Vec3f(100.0f, -50.0f,  50.0f));
+                culler.addOccluder(wall);
+
+                // behind the wall
+                assert(!culler.visible(BBoxf(Vec3f(300.0f, -50.0f, -50.0f), Vec3f(350.0f, 50.0f, 50.0f))));
+                // in front of the wall
+                assert(culler.visible(BBoxf(Vec3f(50.0f, -10.0f, -10.0f), Vec3f(60.0f, 10.0f, 10.0f))));
+                // touching the wall
+                assert(culler.visible(BBoxf(Vec3f(100.0f, -10.0f, -10.0f), Vec3f(120.0f, 10.0f, 10.0f))));
+                // reaching beyond the edge of the wall
+                assert(culler.visible(BBoxf(Vec3f(300.0f, 100.0f, -10.0f), Vec3f(350.0f, 200.0f, 10.0f))));
+                // behind the camera
+                assert(!culler.visible(BBoxf(Vec3f(-300.0f, -10.0f, -10.0f), Vec3f(-200.0f, 10.0f, 10.0f))));
+
+                // an empty buffer hides nothing
+                culler.clear(matrix(position, Vec3f::PosX));
+                assert(culler.visible(BBoxf(Vec3f(300.0f, -50.0f, -50.0f), Vec3f(350.0f, 50.0f, 50.0f))));
+            }
+
+            void testNearPlane() {
+                const Vec3f position = Vec3f::Null;
+                OcclusionCuller culler;
+                culler.clear(matrix(position, Vec3f::PosX));
+
+                // a floor which passes below and behind the camera must be clipped, not dropped or inverted
+                Vec3f::List floor;
+                floor.push_back(Vec3f(-1000.0f, -1000.0f, -32.0f));
+                floor.push_back(Vec3f( 1000.0f, -1000.0f, -32.0f));
+                floor.push_back(Vec3f( 1000.0f,  1000.0f, -32.0f));
+                floor.push_back(Vec3f(-1000.0f,  1000.0f, -32.0f));
+                culler.addOccluder(floor);
+
+                assert(!culler.visible(BBoxf(Vec3f(200.0f, -10.0f, -100.0f), Vec3f(220.0f, 10.0f, -80.0f))));
+                assert(culler.visible(BBoxf(Vec3f(200.0f, -10.0f, 0.0f), Vec3f(220.0f, 10.0f, 20.0f))));
+                // the camera is inside of this box
+                assert(culler.visible(BBoxf(Vec3f(-10.0f, -10.0f, -10.0f), Vec3f(10.0f, 10.0f, 10.0f))));
+            }
+
+            void testOccluderSelection() {
+                const Vec3f position(-200.0f, 0.0f, 0.0f);
+                Model::Brush* wall = createBrush(0.0f, -512.0f, -512.0f, 16.0f, 512.0f, 512.0f);
+                Model::Brush* pebble = createBrush(100.0f, 0.0f, 0.0f, 101.0f, 1.0f, 1.0f);
+
+                Model::BrushList occluders;
+                occluders.push_back(wall);
+                occluders.push_back(pebble);
+
+                OcclusionCuller culler(OcclusionCuller::DefaultWidth, OcclusionCuller::DefaultHeight, 1);
+                culler.setOccluders(occluders);
+                culler.update(matrix(position, Vec3f::PosX), position);
+                assert(culler.occluderCount() == 1);
+                assert(!culler.visible(BBoxf(Vec3f(100.0f, -10.0f, -10.0f), Vec3f(120.0f, 10.0f, 10.0f))));
+
+                // from inside of the wall, only back faces are left
+                const Vec3f inside(8.0f, 0.0f, 0.0f);
+                culler.update(matrix(inside, Vec3f::PosX), inside);
+                assert(culler.visible(BBoxf(Vec3f(100.0f, -10.0f, -10.0f), Vec3f(120.0f, 10.0f, 10.0f))));
+
+                delete wall;
+                delete pebble;
+            }
+
+            void testConservative() {
+                std::srand(1);
+                const Vec3f position = Vec3f::Null;
+                const Mat4f viewMatrix = matrix(position, Vec3f::PosX);
+
+                Model::BrushList walls;
+                for (unsigned int i = 0; i < 8; i++) {
+                    const float x = random(64.0f, 512.0f);
+                    const float y = random(-512.0f, 512.0f);
+                    const float z = random(-256.0f, 256.0f);
+                    walls.push_back(createBrush(x, y, z, x + random(8.0f, 64.0f), y + random(64.0f, 512.0f), z + random(64.0f, 256.0f)));
+                }
+
+                OcclusionCuller culler(OcclusionCuller::DefaultWidth, OcclusionCuller::DefaultHeight, walls.size());
+                culler.setOccluders(walls);
+                culler.update(viewMatrix, position);
+                assert(culler.occluderCount() == walls.size());
+
+                unsigned int hidden = 0;
+                for (unsigned int i = 0; i < 2000; i++) {
+                    const Vec3f min(random(64.0f, 1024.0f), random(-1024.0f, 1024.0f), random(-512.0f, 512.0f));
+                    const Vec3f max = min + Vec3f(random(1.0f, 64.0f), random(1.0f, 64.0f), random(1.0f, 64.0f));
+                    const BBoxf bounds(min, max);
+                    if (culler.visible(bounds))
+                        continue;
+
+                    hidden++;
+                    for (unsigned int x = 0; x <= 4; x++) {
+                        for (unsigned int y = 0; y <= 4; y++) {
+                            for (unsigned int z = 0; z <= 4; z++) {
+                                const Vec3f point(min[0] + (max[0] - min[0]) * static_cast<float>(x) / 4.0f,
+                                                  min[1] + (max[1] - min[1]) * static_cast<float>(y) / 4.0f,
+                                                  min[2] + (max[2] - min[2]) * static_cast<float>(z) / 4.0f);
+                                assert(!pointVisible(position, viewMatrix, point, walls));
+                            }
+                        }
+                    }
+                }
+                assert(hidden > 0);
+
+                for (size_t i = 0; i < walls.size(); i++)
+                    delete walls[i];
+            }
+
+            void testOctreeGroups() {
+                Model::Map map(m_worldBounds, false);
+                Model::Entity* worldspawn = createRooms();
+                map.addEntity(*worldspawn);
+
+                Model::Octree octree(map);
+                octree.loadMap();
+
+                const Model::MapObjectGroupList groups = octree.groupObjects(1024.0f);
+                size_t count = 0;
+                for (size_t i = 0; i < groups.size(); i++) {
+                    const Model::BrushList brushes = groupBrushes(groups[i]);
+                    if (!brushes.empty()) {
+                        const Vec3f size = Model::MapObject::bounds(brushes).size();
+                        assert(size[0] <= 1024.0f + RoomSize && size[1] <= 1024.0f + RoomSize);
+                    }
+                    count += groups[i].size();
+                }
+                assert(count == octree.count());
+                assert(groups.size() > 1);
+            }
+
+            void benchmarkCameraPath() {
+                Model::Map map(m_worldBounds, false);
+                Model::Entity* worldspawn = createRooms();
+                map.addEntity(*worldspawn);
+
+                Model::Octree octree(map);
+                octree.loadMap();
+                const Model::MapObjectGroupList groups = octree.groupObjects(1024.0f);
+
+                std::vector<BBoxf> groupBounds;
+                std::vector<size_t> groupFaces;
+                size_t totalFaces = 0;
+                for (size_t i = 0; i < groups.size(); i++) {
+                    const Model::BrushList brushes = groupBrushes(groups[i]);
+                    if (brushes.empty())
+                        continue;
+
+                    size_t faces = 0;
+                    for (size_t j = 0; j < brushes.size(); j++)
+                        faces += brushes[j]->faces().size();
+                    groupBounds.push_back(Model::MapObject::bounds(brushes));
+                    groupFaces.push_back(faces);
+                    totalFaces += faces;
+                }
+
+                // a recorded walk through the rooms: along a row of doorways, then turning north and along a column
+                static const float path[][6] = {
+                    {  256.0f, 2816.0f, 64.0f,  1.0f,  0.0f, 0.0f },
+                    { 5888.0f, 2816.0f, 64.0f,  1.0f,  0.0f, 0.0f },
+                    { 5888.0f, 2816.0f, 64.0f,  0.0f,  1.0f, 0.0f },
+                    { 5888.0f, 5888.0f, 64.0f,  0.0f,  1.0f, 0.0f },
+                    { 5888.0f, 5888.0f, 64.0f, -1.0f, -1.0f, 0.0f },
+                };
+                static const size_t KeyCount = sizeof(path) / sizeof(path[0]);
+
+                OcclusionCuller culler;
+                culler.setOccluders(worldspawn->brushes());
+
+                size_t visibleGroups = 0;
+                size_t visibleFaces = 0;
+                clock_t start = clock();
+                for (unsigned int frame = 0; frame < FrameCount; frame++) {
+                    const float t = static_cast<float>(frame) / static_cast<float>(FrameCount) * static_cast<float>(KeyCount - 1);
+                    const size_t key = std::min(static_cast<size_t>(t), KeyCount - 2);
+                    const float f = t - static_cast<float>(key);
+                    Vec3f position, direction;
+                    for (size_t i = 0; i < 3; i++) {
+                        position[i] = path[key][i] + (path[key + 1][i] - path[key][i]) * f;
+                        direction[i] = path[key][i + 3] + (path[key + 1][i + 3] - path[key][i + 3]) * f;
+                    }
+                    direction.normalize();
+
+                    culler.update(matrix(position, direction), position);
+                    for (size_t i = 0; i < groupBounds.size(); i++) {
+                        if (culler.visible(groupBounds[i])) {
+                            visibleGroups++;
+                            visibleFaces += groupFaces[i];
+                        }
+                    }
+                }
+                const clock_t elapsed = clock() - start;
+
+                std::cout << "OcclusionCullerTest: " << FrameCount << " frames took " << elapsed * 1000 / CLOCKS_PER_SEC << "ms, " <<
+                groupBounds.size() << " groups, " << visibleGroups / FrameCount << " visible on average, " <<
+                100 - visibleFaces * 100 / (totalFaces * FrameCount) << "% of " << totalFaces << " faces culled" << std::endl;
+                assert(visibleFaces < totalFaces * FrameCount);
+            }
+        };
+    }
+}
+
+#endif
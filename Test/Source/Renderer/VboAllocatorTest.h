@@ -0,0 +1,242 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_VboAllocatorTest_h
+#define TrenchBroom_VboAllocatorTest_h
+
+#include "TestSuite.h"
+#include "Renderer/VboAllocator.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        class VboAllocatorTest : public TestSuite<VboAllocatorTest> {
+        private:
+            static const unsigned int BlockCount = 100000;
+            
+            /*
+             Stands in for the VBO: keeps the buffer contents in memory so that the tests can check that compaction
+             keeps the contents of the used blocks intact.
+             */
+            class Buffer : public VboAllocator::Delegate {
+            public:
+                std::vector<unsigned char> bytes;
+                
+                Buffer(size_t capacity) :
+                bytes(capacity, 0) {}
+                
+                VboAllocator::Block* createBlock(size_t address, size_t capacity) {
+                    return new VboAllocator::Block(address, capacity);
+                }
+                
+                void moveMemory(size_t to, size_t from, size_t length) {
+                    assert(from + length <= bytes.size());
+                    memmove(&bytes[to], &bytes[from], length);
+                }
+                
+                void fill(const VboAllocator::Block& block, unsigned char value) {
+                    memset(&bytes[block.address()], value, block.capacity());
+                }
+                
+                bool filled(const VboAllocator::Block& block, unsigned char value) const {
+                    for (size_t i = 0; i < block.capacity(); i++)
+                        if (bytes[block.address() + i] != value)
+                            return false;
+                    return true;
+                }
+            };
+            
+            inline void report(const char* name, clock_t start) const {
+                std::cout << "VboAllocatorTest: " << name << " took " << (clock() - start) * 1000 / CLOCKS_PER_SEC << "ms" << std::endl;
+            }
+            
+            void checkBlocks(const VboAllocator& allocator) const {
+                size_t address = 0;
+                size_t freeCapacity = 0;
+                VboAllocator::Block* previous = NULL;
+                VboAllocator::Block* block = allocator.first();
+                while (block != NULL) {
+                    assert(block->previous() == previous);
+                    assert(block->address() == address);
+                    assert(!block->free() || previous == NULL || !previous->free());
+                    if (block->free())
+                        freeCapacity += block->capacity();
+                    address += block->capacity();
+                    previous = block;
+                    block = block->next();
+                }
+                assert(address == allocator.totalCapacity());
+                assert(freeCapacity == allocator.freeCapacity());
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&VboAllocatorTest::testAllocateFree);
+                registerTestCase(&VboAllocatorTest::testCompact);
+                registerTestCase(&VboAllocatorTest::testGrow);
+                registerTestCase(&VboAllocatorTest::benchmarkAllocateFree);
+            }
+        public:
+            void testAllocateFree() {
+                Buffer buffer(1024);
+                VboAllocator allocator(buffer, 1024);
+                
+                VboAllocator::Block* a = allocator.allocate(100);
+                VboAllocator::Block* b = allocator.allocate(200);
+                VboAllocator::Block* c = allocator.allocate(100);
+                assert(a->address() == 0 && b->address() == 100 && c->address() == 300);
+                assert(allocator.freeCapacity() == 624);
+                assert(!allocator.fragmented());
+                checkBlocks(allocator);
+                
+                allocator.free(*b);
+                assert(allocator.fragmented());
+                checkBlocks(allocator);
+                
+                // best fit takes the hole left by b rather than the larger block at the end
+                VboAllocator::Block* d = allocator.allocate(150);
+                assert(d->address() == 100);
+                checkBlocks(allocator);
+                
+                // freeing neighbours merges them
+                allocator.free(*a);
+                allocator.free(*d);
+                VboAllocator::Stats stats = allocator.stats();
+                assert(stats.freeBlockCount == 2);
+                assert(stats.largestFreeBlock == 624);
+                assert(stats.allocations == 4);
+                assert(stats.frees == 3);
+                checkBlocks(allocator);
+                
+                allocator.free(*c);
+                stats = allocator.stats();
+                assert(stats.freeBlockCount == 1);
+                assert(stats.freeCapacity == 1024);
+                assert(stats.fragmentation() == 0.0f);
+                assert(!allocator.fragmented());
+                checkBlocks(allocator);
+            }
+            
+            void testCompact() {
+                Buffer buffer(1000);
+                VboAllocator allocator(buffer, 1000);
+                
+                std::vector<VboAllocator::Block*> blocks;
+                for (unsigned int i = 0; i < 10; i++) {
+                    VboAllocator::Block* block = allocator.allocate(100);
+                    buffer.fill(*block, static_cast<unsigned char>(i + 1));
+                    blocks.push_back(block);
+                }
+                assert(allocator.freeCapacity() == 0);
+                
+                for (unsigned int i = 0; i < 10; i += 2)
+                    allocator.free(*blocks[i]);
+                assert(allocator.stats().freeBlockCount == 5);
+                assert(allocator.stats().largestFreeBlock == 100);
+                
+                // each step moves the run of used blocks behind the first hole and merges the hole into the next one
+                assert(allocator.compact(1) == 100);
+                assert(allocator.fragmented());
+                checkBlocks(allocator);
+                
+                while (allocator.fragmented())
+                    allocator.compact(150);
+                assert(allocator.stats().freeBlockCount == 1);
+                assert(allocator.stats().bytesMoved == 5 * 100);
+                checkBlocks(allocator);
+                
+                for (unsigned int i = 1; i < 10; i += 2) {
+                    assert(blocks[i]->address() == (i / 2) * 100);
+                    assert(buffer.filled(*blocks[i], static_cast<unsigned char>(i + 1)));
+                }
+                
+                // a request that only fits after compaction
+                allocator.free(*blocks[1]);
+                allocator.free(*blocks[5]);
+                VboAllocator::Block* block = allocator.allocate(700);
+                assert(block != NULL);
+                assert(block->address() == 300);
+                assert(buffer.filled(*blocks[3], 4));
+                assert(buffer.filled(*blocks[7], 8));
+                assert(buffer.filled(*blocks[9], 10));
+                checkBlocks(allocator);
+                
+                assert(allocator.allocate(1) == NULL);
+            }
+            
+            void testGrow() {
+                Buffer buffer(200);
+                VboAllocator allocator(buffer, 100);
+                
+                VboAllocator::Block* a = allocator.allocate(100);
+                assert(allocator.allocate(50) == NULL);
+                
+                allocator.grow(150);
+                VboAllocator::Block* b = allocator.allocate(50);
+                assert(b != NULL && b->address() == 100);
+                checkBlocks(allocator);
+                
+                allocator.free(*a);
+                allocator.grow(200);
+                assert(allocator.stats().freeBlockCount == 2);
+                checkBlocks(allocator);
+                
+                allocator.freeAll();
+                assert(allocator.freeCapacity() == 200);
+                assert(allocator.stats().freeBlockCount == 1);
+                checkBlocks(allocator);
+            }
+            
+            void benchmarkAllocateFree() {
+                Buffer buffer(0);
+                const size_t capacity = 64 * BlockCount * 2;
+                VboAllocator allocator(buffer, capacity);
+                
+                srand(0);
+                std::vector<VboAllocator::Block*> blocks;
+                
+                clock_t start = clock();
+                for (unsigned int i = 0; i < BlockCount; i++)
+                    blocks.push_back(allocator.allocate(static_cast<size_t>(rand() % 120 + 8)));
+                report("allocating 100000 blocks", start);
+                
+                // free every other block to create many holes, then reuse them
+                start = clock();
+                for (unsigned int i = 0; i < BlockCount; i += 2) {
+                    allocator.free(*blocks[i]);
+                    blocks[i] = NULL;
+                }
+                for (unsigned int i = 0; i < BlockCount; i += 2)
+                    blocks[i] = allocator.allocate(static_cast<size_t>(rand() % 60 + 4));
+                report("freeing and reallocating 50000 blocks", start);
+                checkBlocks(allocator);
+                
+                const VboAllocator::Stats stats = allocator.stats();
+                std::cout << "VboAllocatorTest: " << stats.freeBlockCount << " free blocks, " << static_cast<int>(stats.fragmentation() * 100.0f) << "% fragmented" << std::endl;
+            }
+        };
+    }
+}
+
+#endif
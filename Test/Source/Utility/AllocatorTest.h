@@ -0,0 +1,112 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_AllocatorTest_h
+#define TrenchBroom_AllocatorTest_h
+
+#include "TestSuite.h"
+#include "Utility/Allocator.h"
+
+#include <wx/thread.h>
+
+#include <cassert>
+#include <set>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Utility {
+        class AllocatorTest : public TestSuite<AllocatorTest> {
+        private:
+            class Pooled : public Allocator<Pooled> {
+            public:
+                size_t owner;
+                size_t index;
+
+                Pooled(size_t i_owner, size_t i_index) :
+                owner(i_owner),
+                index(i_index) {}
+            };
+
+            typedef std::vector<Pooled*> PooledList;
+
+            static const size_t ObjectCount = 500000;
+
+            static void allocate(size_t owner, PooledList& objects) {
+                for (size_t i = 0; i < ObjectCount; i++) {
+                    objects.push_back(new Pooled(owner, i));
+                    // return some objects to the pools while the other thread allocates
+                    if (i % 3 == 0) {
+                        delete objects.back();
+                        objects.pop_back();
+                    }
+                }
+            }
+
+            class AllocatingThread : public wxThread {
+            public:
+                PooledList objects;
+
+                AllocatingThread() :
+                wxThread(wxTHREAD_JOINABLE) {}
+
+                ExitCode Entry() {
+                    allocate(1, objects);
+                    return (wxThread::ExitCode)0;
+                }
+            };
+
+            static bool intact(const PooledList& objects, size_t owner, std::set<Pooled*>& seen) {
+                for (size_t i = 0; i < objects.size(); i++) {
+                    if (objects[i]->owner != owner || !seen.insert(objects[i]).second)
+                        return false;
+                }
+                return true;
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&AllocatorTest::testThreadedAllocation);
+            }
+        public:
+            void testThreadedAllocation() {
+                AllocatorLock::beginThreadedAllocation();
+
+                AllocatingThread thread;
+                thread.Create();
+                thread.Run();
+                PooledList objects;
+                allocate(0, objects);
+                thread.Wait();
+
+                AllocatorLock::endThreadedAllocation();
+
+                // no block was handed out twice
+                std::set<Pooled*> seen;
+                assert(intact(objects, 0, seen));
+                assert(intact(thread.objects, 1, seen));
+
+                for (size_t i = 0; i < objects.size(); i++)
+                    delete objects[i];
+                for (size_t i = 0; i < thread.objects.size(); i++)
+                    delete thread.objects[i];
+            }
+        };
+    }
+}
+
+#endif
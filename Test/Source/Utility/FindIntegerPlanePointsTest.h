@@ -30,6 +30,7 @@
 #include <ctime>
 #include <functional>
 #include <limits>
+#include <vector>
 
 namespace TrenchBroom {
     namespace VecMath {
@@ -39,6 +40,9 @@ namespace TrenchBroom {
                 registerTestCase(&FindIntegerPlanePointsTest::testParallelPlane);
                 registerTestCase(&FindIntegerPlanePointsTest::testNonParallelPlane);
                 registerTestCase(&FindIntegerPlanePointsTest::testRandomPlanes);
+                registerTestCase(&FindIntegerPlanePointsTest::testExtrudedPlanes);
+                registerTestCase(&FindIntegerPlanePointsTest::testCachedPlanes);
+                registerTestCase(&FindIntegerPlanePointsTest::benchmarkRotatedPlanes);
             }
         public:
             void testParallelPlane() {
@@ -228,6 +232,74 @@ namespace TrenchBroom {
                 std::cout << "Normal error min: " << Math<float>::degrees(minNormalError) << " max: " << Math<float>::degrees(maxNormalError) << " avg: " << Math<float>::degrees(avgNormalError) << std::endl;
                 std::cout << "Distance error min: " << minDistanceError << " max: " << maxDistanceError << " avg: " << avgDistanceError << std::endl;
             }
+
+            void testExtrudedPlanes() {
+                PlanePoints points;
+                Planef plane, test;
+                FindIntegerPlanePoints findPoints;
+
+                // walls rotated about the Z axis contain the Z axis, so the points must describe a vertical plane
+                for (size_t i = 1; i < 90; i++) {
+                    const float angle = Math<float>::radians(static_cast<float>(i));
+                    plane = Planef(Vec3f(std::cos(angle), std::sin(angle), 0.0f), 37.3f * static_cast<float>(i));
+                    findPoints(plane, points);
+                    assert(points[0].isInteger() && points[1].isInteger() && points[2].isInteger());
+                    assert(test.setPoints(points[0], points[1], points[2]));
+                    assert(test.normal.z() == 0.0f);
+                    assert(test.normal.dot(plane.normal) > 0.9999f);
+                    assert(Math<float>::lte(std::abs(plane.distance - test.distance), 1.0f));
+                }
+
+                plane = Planef(Vec3f(3.0f, 0.0f, -4.0f).normalized(), 0.0f);
+                findPoints(plane, points);
+                assert(test.setPoints(points[0], points[1], points[2]));
+                assert(test.normal.equals(plane.normal));
+                assert(Math<float>::zero(test.distance));
+            }
+
+            void testCachedPlanes() {
+                PlanePoints first, second;
+                FindIntegerPlanePoints findPoints;
+
+                const Planef plane(Vec3f(0.636535f, 0.702198f, 0.318969f).normalized(), 72.0f);
+                findPoints(plane, first);
+                findPoints(plane, second);
+                for (size_t i = 0; i < 3; i++)
+                    assert(first[i] == second[i]);
+
+                // initial points bypass the cache
+                second[0] = Vec3f(0.5f, 0.5f, 0.5f);
+                findPoints(plane, second, 1);
+                assert(second[0].isInteger());
+            }
+
+            void benchmarkRotatedPlanes() {
+                static const size_t NumPlanes = 2000;
+                static const size_t Repetitions = 50;
+
+                std::vector<Planef> planes;
+                for (size_t i = 0; i < NumPlanes; i++) {
+                    const float angle = Math<float>::radians(static_cast<float>(i % 360) + 0.5f);
+                    const float z = (i % 3 == 0) ? 0.3f : 0.0f;
+                    planes.push_back(Planef(Vec3f(std::cos(angle), std::sin(angle), z).normalized(), static_cast<float>(i) + 0.25f));
+                }
+
+                PlanePoints points;
+                clock_t start = clock();
+                for (size_t i = 0; i < Repetitions; i++) {
+                    FindIntegerPlanePoints findPoints;
+                    for (size_t j = 0; j < NumPlanes; j++)
+                        findPoints(planes[j], points);
+                }
+                std::cout << "FindIntegerPlanePointsTest: " << NumPlanes * Repetitions << " distinct planes took " << (clock() - start) * 1000 / CLOCKS_PER_SEC << "ms" << std::endl;
+
+                FindIntegerPlanePoints findPoints;
+                start = clock();
+                for (size_t i = 0; i < Repetitions; i++)
+                    for (size_t j = 0; j < NumPlanes; j++)
+                        findPoints(planes[j], points);
+                std::cout << "FindIntegerPlanePointsTest: " << NumPlanes * Repetitions << " repeated planes took " << (clock() - start) * 1000 / CLOCKS_PER_SEC << "ms" << std::endl;
+            }
         };
     }
 }
@@ -0,0 +1,127 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_MemoryStatsTest_h
+#define TrenchBroom_MemoryStatsTest_h
+
+#include "TestSuite.h"
+#include "Model/Brush.h"
+#include "Model/Entity.h"
+#include "Utility/MemoryStats.h"
+#include "Utility/VecMath.h"
+
+#include <cassert>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Utility {
+        class MemoryStatsTest : public TestSuite<MemoryStatsTest> {
+        private:
+            BBoxf m_worldBounds;
+        protected:
+            void registerTestCases() {
+                registerTestCase(&MemoryStatsTest::testCounters);
+                registerTestCase(&MemoryStatsTest::testPooledObjects);
+                registerTestCase(&MemoryStatsTest::testProperties);
+            }
+
+            void setup() {
+                m_worldBounds = BBoxf(Vec3f(-16384.0f, -16384.0f, -16384.0f), Vec3f(16384.0f, 16384.0f, 16384.0f));
+            }
+        public:
+            void testCounters() {
+                MemoryStats& stats = MemoryStats::stats();
+                const MemoryCategory::Type category = MemoryCategory::TextureBuffers;
+                const size_t bytes = stats.bytes(category);
+                const size_t objects = stats.objects(category);
+                const size_t totalBytes = stats.totalBytes();
+
+                stats.resetPeaks();
+                stats.add(category, 1000);
+                stats.add(category, 500);
+                assert(stats.bytes(category) == bytes + 1500);
+                assert(stats.objects(category) == objects + 2);
+                assert(stats.totalBytes() == totalBytes + 1500);
+
+                stats.remove(category, 1000);
+                assert(stats.bytes(category) == bytes + 500);
+                assert(stats.objects(category) == objects + 1);
+                assert(stats.peakBytes(category) == bytes + 1500);
+                assert(stats.peakTotalBytes() >= totalBytes + 1500);
+
+                stats.resize(category, 500, 200);
+                assert(stats.bytes(category) == bytes + 200);
+                assert(stats.objects(category) == objects + 1);
+
+                stats.remove(category, 200);
+                assert(stats.bytes(category) == bytes);
+                assert(stats.objects(category) == objects);
+
+                stats.resetPeaks();
+                assert(stats.peakBytes(category) == bytes);
+            }
+
+            void testPooledObjects() {
+                MemoryStats& stats = MemoryStats::stats();
+                const size_t geometryBytes = stats.bytes(MemoryCategory::BrushGeometry);
+                const size_t brushObjects = stats.objects(MemoryCategory::Brushes);
+                const size_t entityObjects = stats.objects(MemoryCategory::Entities);
+
+                Model::Entity* entity = new Model::Entity(m_worldBounds);
+                Model::Brush* brush = new Model::Brush(m_worldBounds, false, BBoxf(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(16.0f, 16.0f, 16.0f)), NULL);
+                entity->addBrush(*brush);
+
+                // one brush and six faces; eight vertices, twelve edges and six sides
+                assert(stats.objects(MemoryCategory::Brushes) == brushObjects + 7);
+                assert(stats.objects(MemoryCategory::Entities) == entityObjects + 1);
+                assert(stats.objects(MemoryCategory::BrushGeometry) >= 26);
+                assert(stats.bytes(MemoryCategory::BrushGeometry) > geometryBytes);
+
+                delete entity;
+                assert(stats.objects(MemoryCategory::Brushes) == brushObjects);
+                assert(stats.objects(MemoryCategory::Entities) == entityObjects);
+                assert(stats.bytes(MemoryCategory::BrushGeometry) == geometryBytes);
+            }
+
+            void testProperties() {
+                MemoryStats& stats = MemoryStats::stats();
+                const size_t bytes = stats.bytes(MemoryCategory::EntityProperties);
+
+                Model::Entity* entity = new Model::Entity(m_worldBounds);
+                const size_t objects = stats.objects(MemoryCategory::EntityProperties);
+                entity->setProperty(Model::Entity::ClassnameKey, "light");
+                entity->setProperty("style", "1");
+                assert(stats.objects(MemoryCategory::EntityProperties) == objects + 2);
+
+                const size_t withShortValue = stats.bytes(MemoryCategory::EntityProperties);
+                entity->setProperty("style", "12345");
+                assert(stats.bytes(MemoryCategory::EntityProperties) == withShortValue + 4);
+
+                entity->removeProperty("style");
+                assert(stats.objects(MemoryCategory::EntityProperties) == objects + 1);
+
+                delete entity;
+                assert(stats.bytes(MemoryCategory::EntityProperties) == bytes);
+            }
+        };
+    }
+}
+
+#endif
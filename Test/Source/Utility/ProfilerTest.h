@@ -0,0 +1,92 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TrenchBroom_ProfilerTest_h
+#define TrenchBroom_ProfilerTest_h
+
+#include "TestSuite.h"
+#include "Utility/Profiler.h"
+#include "Utility/String.h"
+
+#include <wx/thread.h>
+
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+
+namespace TrenchBroom {
+    namespace Utility {
+        class ProfilerTest : public TestSuite<ProfilerTest> {
+        private:
+            class ProfiledThread : public wxThread {
+            public:
+                ProfiledThread() :
+                wxThread(wxTHREAD_JOINABLE) {}
+
+                ExitCode Entry() {
+                    {
+                        ProfileZone zone("ProfilerTest::ProfiledThread");
+                    }
+                    Profiler::profiler().threadFinished();
+                    return (wxThread::ExitCode)0;
+                }
+            };
+
+            size_t writtenZoneCount(const String& name) {
+                const String path = "ProfilerTest.json";
+                const bool written = Profiler::profiler().writeChromeTrace(path, 3600);
+                assert(written);
+
+                size_t count = 0;
+                std::ifstream stream(path.c_str());
+                String line;
+                while (std::getline(stream, line))
+                    if (line.find(name) != String::npos)
+                        count++;
+                stream.close();
+                std::remove(path.c_str());
+                return count;
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&ProfilerTest::testThreadProfilesAreReused);
+            }
+        public:
+            void testThreadProfilesAreReused() {
+                Profiler& profiler = Profiler::profiler();
+                const size_t before = profiler.threadProfileCount();
+                for (size_t i = 0; i < 8; i++) {
+                    ProfiledThread thread;
+                    thread.Create();
+                    thread.Run();
+                    thread.Wait();
+                }
+
+                // the threads ran one after another, so they all share at most one new buffer
+                assert(profiler.threadProfileCount() <= before + 1);
+
+                // and since they have finished, their zones are written
+                assert(writtenZoneCount("ProfilerTest::ProfiledThread") == 8);
+            }
+        };
+    }
+}
+
+#endif
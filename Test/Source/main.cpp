@@ -20,9 +20,22 @@
 #include <iostream>
 
 #include "TestSuite.h"
+#include "Model/BrushTest.h"
+#include "Model/EditStateManagerTest.h"
+#include "Model/EntityTest.h"
+#include "Model/FilterTest.h"
+#include "Model/MapTest.h"
+#include "Model/MapValidatorTest.h"
+#include "Model/OctreeTest.h"
+#include "Model/PickerTest.h"
+#include "Renderer/OcclusionCullerTest.h"
+#include "Renderer/VboAllocatorTest.h"
+#include "Utility/AllocatorTest.h"
 #include "Utility/FindIntegerPlanePointsTest.h"
 #include "Utility/MatTest.h"
+#include "Utility/MemoryStatsTest.h"
 #include "Utility/PlaneTest.h"
+#include "Utility/ProfilerTest.h"
 #include "Utility/VecTest.h"
 
 int main(int argc, const char * argv[]) {
@@ -37,10 +50,50 @@ int main(int argc, const char * argv[]) {
     VecMath::PlaneTest planeTest;
     planeTest.run();
     
-    /*
+    Utility::MemoryStatsTest memoryStatsTest;
+    memoryStatsTest.run();
+    
+    Utility::AllocatorTest allocatorTest;
+    allocatorTest.run();
+    
+    Utility::ProfilerTest profilerTest;
+    profilerTest.run();
+    
+    Model::BrushTest brushTest;
+    brushTest.run();
+
+    Model::EditStateManagerTest editStateManagerTest;
+    editStateManagerTest.run();
+    
+    Model::EntityTest entityTest;
+    entityTest.run();
+
+    Model::FilterTest filterTest;
+    filterTest.run();
+    
+    Model::MapTest mapTest;
+    mapTest.run();
+
+    Model::MapValidatorTest mapValidatorTest;
+    mapValidatorTest.run();
+
+    Model::OctreeTest octreeTest;
+    octreeTest.run();
+
+    Model::PickerTest pickerTest;
+    pickerTest.run();
+    
+    Renderer::VboAllocatorTest vboAllocatorTest;
+    vboAllocatorTest.run();
+    
+    Renderer::OcclusionCullerTest occlusionCullerTest;
+    occlusionCullerTest.run();
+    
     VecMath::FindIntegerPlanePointsTest planePointsTest;
     planePointsTest.run();
-    */
+    
+    // the high-water marks show how much memory the benchmarks above needed at most
+    std::cout << Utility::MemoryStats::stats().report() << std::endl;
     
     return 0;
 }